@@ -1,5 +1,6 @@
 ﻿#include "pch.h"
 #include "Affine.h"
+#include "Mathf.h"
 
 namespace CommonLibrary
 {
@@ -69,8 +70,8 @@ namespace CommonLibrary
 	}
 	void Affine::RotateX(const F32 angle)
 	{
-		F32 s = sin(angle);
-		F32 c = cos(angle);
+		F32 s = Mathf::Sin(angle);
+		F32 c = Mathf::Cos(angle);
 		Affine mat(
 			1, 0, 0,
 			0, c, s,
@@ -82,8 +83,8 @@ namespace CommonLibrary
 	}
 	void Affine::RotateY(const F32 angle)
 	{
-		F32 s = sin(angle);
-		F32 c = cos(angle);
+		F32 s = Mathf::Sin(angle);
+		F32 c = Mathf::Cos(angle);
 		Affine mat(
 			c, 0, s,
 			0, 1, 0,
@@ -95,8 +96,8 @@ namespace CommonLibrary
 	}
 	void Affine::RotateZ(const F32 angle)
 	{
-		F32 s = sin(angle);
-		F32 c = cos(angle);
+		F32 s = Mathf::Sin(angle);
+		F32 c = Mathf::Cos(angle);
 		Affine mat(
 			c, s, 0,
 			-s, c, 0,
@@ -134,7 +135,7 @@ namespace CommonLibrary
 
 
 
-	inline bool Affine::operator == (const Affine& v) const
+	bool Affine::operator == (const Affine& v) const
 	{
 		for (U32 y = 0; y < ROW; y++)for (U32 x = 0; x < COL; x++)
 		{
@@ -143,7 +144,7 @@ namespace CommonLibrary
 		return true;
 	}
 
-	inline bool Affine::operator != (const Affine& v) const
+	bool Affine::operator != (const Affine& v) const
 	{
 		for (U32 y = 0; y < ROW; y++)for (U32 x = 0; x < COL; x++)
 		{
@@ -152,7 +153,7 @@ namespace CommonLibrary
 		return false;
 	}
 
-	inline Affine Affine::operator * (const Affine& o) const
+	Affine Affine::operator * (const Affine& o) const
 	{
 		Affine r;
 		r.m[0][0] = 0;
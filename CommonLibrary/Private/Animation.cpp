@@ -0,0 +1,375 @@
+﻿#include "pch.h"
+#include "Animation.h"
+#include "Check.h"
+#include "Mathf.h"
+#include "Parallel.h"
+
+#include <algorithm>
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	// 前回の位置から順に探すキーの数。これを超えて進んだ場合は二分探索する
+	const U32 LINEAR_SEARCH_LIMIT = 4;
+
+	/// <summary>
+	/// times[i] <= time < times[i + 1]となるiを求める
+	/// </summary>
+	/// <param name="cursor">前回の位置。結果で更新される</param>
+	U32 FindKey(const ArrayList<F32>& times, const F32 time, U32& cursor)
+	{
+		U32 count = (U32)times.size();
+		if (count <= cursor)cursor = 0;
+
+		if (times[cursor] <= time)
+		{
+			// 順方向の再生では前回の位置か、その数個先にある
+			for (U32 i = 0; i < LINEAR_SEARCH_LIMIT; i++)
+			{
+				if (cursor + 1 == count || time < times[cursor + 1])return cursor;
+				cursor++;
+			}
+		}
+		else if (time < times[0])
+		{
+			cursor = 0;
+			return cursor;
+		}
+
+		auto it = std::upper_bound(times.begin(), times.end(), time);
+		cursor = it == times.begin() ? 0 : (U32)(it - times.begin()) - 1;
+		return cursor;
+	}
+
+	/// <summary>
+	/// トラックを補間して値を求める。キーが無い場合はdefaultsを返す。
+	/// </summary>
+	void SampleTrack(const AnimationTrack& track, const F32 time, U32& cursor, const U32 componentCount, const F32* defaults, F32* dest)
+	{
+		U32 count = track.GetKeyCount();
+		if (count == 0)
+		{
+			for (U32 c = 0; c < componentCount; c++)dest[c] = defaults[c];
+			return;
+		}
+
+		U32 key = FindKey(track.times, time, cursor);
+		if (key + 1 == count || time <= track.times[key])
+		{
+			for (U32 c = 0; c < componentCount; c++)dest[c] = track.values[c][key];
+			return;
+		}
+
+		F32 t0 = track.times[key];
+		F32 t1 = track.times[key + 1];
+		F32 rate = t0 < t1 ? (time - t0) / (t1 - t0) : 0.0f;
+		for (U32 c = 0; c < componentCount; c++)
+		{
+			dest[c] = Mathf::Lerp(track.values[c][key], track.values[c][key + 1], rate);
+		}
+	}
+
+	/// <summary>
+	/// 回転トラックを補間する(正規化線形補間)
+	/// </summary>
+	void SampleRotation(const AnimationTrack& track, const F32 time, U32& cursor, F32* dest)
+	{
+		static const F32 IDENTITY[] = { 0, 0, 0, 1 };
+
+		U32 count = track.GetKeyCount();
+		if (count == 0)
+		{
+			for (U32 c = 0; c < 4; c++)dest[c] = IDENTITY[c];
+			return;
+		}
+
+		U32 key = FindKey(track.times, time, cursor);
+		if (key + 1 == count || time <= track.times[key])
+		{
+			for (U32 c = 0; c < 4; c++)dest[c] = track.values[c][key];
+			return;
+		}
+
+		F32 t0 = track.times[key];
+		F32 t1 = track.times[key + 1];
+		F32 rate = t0 < t1 ? (time - t0) / (t1 - t0) : 0.0f;
+
+		// 最短経路で補間するため、内積が負なら片方を反転する
+		F32 dot = 0.0f;
+		for (U32 c = 0; c < 4; c++)dot += track.values[c][key] * track.values[c][key + 1];
+		F32 sign = dot < 0.0f ? -1.0f : 1.0f;
+
+		F32 lengthSq = 0.0f;
+		for (U32 c = 0; c < 4; c++)
+		{
+			dest[c] = Mathf::Lerp(track.values[c][key], track.values[c][key + 1] * sign, rate);
+			lengthSq += dest[c] * dest[c];
+		}
+
+		F32 inverse = 0.0f < lengthSq ? 1.0f / Mathf::Sqrt(lengthSq) : 0.0f;
+		for (U32 c = 0; c < 4; c++)dest[c] *= inverse;
+	}
+
+	/// <summary>
+	/// 拡大、回転、平行移動から行列の上3x4を求める
+	/// </summary>
+	template<class Output>
+	void ComposeTRS(const F32* t, const F32* q, const F32* s, Output& out)
+	{
+		const F32 x = q[0], y = q[1], z = q[2], w = q[3];
+		const F32 xx = x * x, yy = y * y, zz = z * z;
+		const F32 xy = x * y, xz = x * z, yz = y * z;
+		const F32 wx = w * x, wy = w * y, wz = w * z;
+
+		out.m[0][0] = (1 - 2 * (yy + zz)) * s[0];
+		out.m[0][1] = 2 * (xy + wz) * s[0];
+		out.m[0][2] = 2 * (xz - wy) * s[0];
+
+		out.m[1][0] = 2 * (xy - wz) * s[1];
+		out.m[1][1] = (1 - 2 * (xx + zz)) * s[1];
+		out.m[1][2] = 2 * (yz + wx) * s[1];
+
+		out.m[2][0] = 2 * (xz + wy) * s[2];
+		out.m[2][1] = 2 * (yz - wx) * s[2];
+		out.m[2][2] = (1 - 2 * (xx + yy)) * s[2];
+
+		out.m[3][0] = t[0];
+		out.m[3][1] = t[1];
+		out.m[3][2] = t[2];
+	}
+
+	void FinishRow(Affine&)
+	{
+	}
+
+	void FinishRow(Matrix& out)
+	{
+		out.m[0][3] = 0;
+		out.m[1][3] = 0;
+		out.m[2][3] = 0;
+		out.m[3][3] = 1;
+	}
+}
+
+namespace CommonLibrary
+{
+	//===================================================================================//
+	// AnimationClip
+	//===================================================================================//
+
+	AnimationClip::AnimationClip(const U32 boneCount, const F32 duration) :m_bones(boneCount), m_duration(duration)
+	{
+	}
+
+	S32 AnimationClip::AddTranslationKey(const U32 bone, const F32 time, const Vector3& translation)
+	{
+		if (GetBoneCount() <= bone)return -1;
+		const F32 values[] = { translation.x, translation.y, translation.z };
+		return AddKey(m_bones[bone].translation, time, values, 3);
+	}
+
+	S32 AnimationClip::AddRotationKey(const U32 bone, const F32 time, const Quaternion& rotation)
+	{
+		if (GetBoneCount() <= bone)return -1;
+		const F32 values[] = { rotation.x, rotation.y, rotation.z, rotation.w };
+		return AddKey(m_bones[bone].rotation, time, values, 4);
+	}
+
+	S32 AnimationClip::AddScaleKey(const U32 bone, const F32 time, const Vector3& scale)
+	{
+		if (GetBoneCount() <= bone)return -1;
+		const F32 values[] = { scale.x, scale.y, scale.z };
+		return AddKey(m_bones[bone].scale, time, values, 3);
+	}
+
+	S32 AnimationClip::AddKey(AnimationTrack& track, const F32 time, const F32* values, const U32 componentCount)
+	{
+		if (!track.times.empty() && time < track.times.back())return -1;
+
+		track.times.push_back(time);
+		for (U32 c = 0; c < componentCount; c++)
+		{
+			track.values[c].push_back(values[c]);
+		}
+		return 0;
+	}
+
+	//===================================================================================//
+	// Pose
+	//===================================================================================//
+
+	Pose::Pose() :m_boneCount(0)
+	{
+	}
+
+	void Pose::Resize(const U32 boneCount)
+	{
+		m_boneCount = boneCount;
+
+		U32 padded = (boneCount + 3) & ~3u;
+		for (U32 c = 0; c < 3; c++)translation[c].resize(padded);
+		for (U32 c = 0; c < 4; c++)rotation[c].resize(padded);
+		for (U32 c = 0; c < 3; c++)scale[c].resize(padded);
+
+		SetIdentity();
+	}
+
+	void Pose::SetIdentity()
+	{
+		for (U32 c = 0; c < 3; c++)std::fill(translation[c].begin(), translation[c].end(), 0.0f);
+		for (U32 c = 0; c < 3; c++)std::fill(rotation[c].begin(), rotation[c].end(), 0.0f);
+		std::fill(rotation[3].begin(), rotation[3].end(), 1.0f);
+		for (U32 c = 0; c < 3; c++)std::fill(scale[c].begin(), scale[c].end(), 1.0f);
+	}
+
+	void Pose::GetLocalTransform(const U32 bone, Affine& dest)const
+	{
+		const F32 t[] = { translation[0][bone], translation[1][bone], translation[2][bone] };
+		const F32 q[] = { rotation[0][bone], rotation[1][bone], rotation[2][bone], rotation[3][bone] };
+		const F32 s[] = { scale[0][bone], scale[1][bone], scale[2][bone] };
+		ComposeTRS(t, q, s, dest);
+	}
+
+	S32 Pose::ToModelSpace(const S32* parents, Affine* dest, const size_t destSize)const
+	{
+		if (CheckArgs(parents, dest, m_boneCount <= destSize))return -1;
+
+		for (U32 bone = 0; bone < m_boneCount; bone++)
+		{
+			GetLocalTransform(bone, dest[bone]);
+
+			S32 parent = parents[bone];
+			if (parent < 0)continue;
+			if ((S32)bone <= parent)return -1;
+
+			// 行ベクトル規約のため、ローカル変換の後に親の変換を掛ける
+			dest[bone] = dest[bone] * dest[parent];
+		}
+		return 0;
+	}
+
+	//===================================================================================//
+	// AnimationInstance
+	//===================================================================================//
+
+	AnimationInstance::AnimationInstance() :m_time(0), m_loop(true)
+	{
+	}
+
+	S32 AnimationInstance::SetClip(const SPtr<AnimationClip>& clip)
+	{
+		if (!clip)return -1;
+
+		m_clip = clip;
+		m_time = 0;
+		m_cursors.assign(clip->GetBoneCount() * 3, 0);
+		return 0;
+	}
+
+	void AnimationInstance::SetTime(const F32 time)
+	{
+		F32 duration = m_clip ? m_clip->GetDuration() : 0.0f;
+		if (duration <= 0.0f)
+		{
+			m_time = 0.0f;
+			return;
+		}
+
+		if (m_loop)
+		{
+			m_time = fmod(time, duration);
+			if (m_time < 0.0f)m_time += duration;
+		}
+		else
+		{
+			m_time = Mathf::Clamp(time, 0.0f, duration);
+		}
+	}
+
+	void AnimationInstance::Advance(const F32 deltaTime)
+	{
+		SetTime(m_time + deltaTime);
+	}
+
+	S32 AnimationInstance::Sample(Affine* palette, const size_t paletteSize)
+	{
+		return SampleImpl(palette, paletteSize);
+	}
+
+	S32 AnimationInstance::Sample(Matrix* palette, const size_t paletteSize)
+	{
+		return SampleImpl(palette, paletteSize);
+	}
+
+	S32 AnimationInstance::Sample(Pose& pose)
+	{
+		static const F32 ZERO[] = { 0, 0, 0 };
+		static const F32 ONE[] = { 1, 1, 1 };
+
+		if (!m_clip)return -1;
+
+		U32 boneCount = m_clip->GetBoneCount();
+		if (pose.GetBoneCount() != boneCount)pose.Resize(boneCount);
+
+		for (U32 bone = 0; bone < boneCount; bone++)
+		{
+			const BoneTrack& track = m_clip->GetBoneTrack(bone);
+			U32* cursors = &m_cursors[bone * 3];
+
+			F32 t[3], q[4], s[3];
+			SampleTrack(track.translation, m_time, cursors[0], 3, ZERO, t);
+			SampleRotation(track.rotation, m_time, cursors[1], q);
+			SampleTrack(track.scale, m_time, cursors[2], 3, ONE, s);
+
+			for (U32 c = 0; c < 3; c++)pose.translation[c][bone] = t[c];
+			for (U32 c = 0; c < 4; c++)pose.rotation[c][bone] = q[c];
+			for (U32 c = 0; c < 3; c++)pose.scale[c][bone] = s[c];
+		}
+		return 0;
+	}
+
+	template<class Output>
+	S32 AnimationInstance::SampleImpl(Output* palette, const size_t paletteSize)
+	{
+		static const F32 ZERO[] = { 0, 0, 0 };
+		static const F32 ONE[] = { 1, 1, 1 };
+
+		if (!m_clip || palette == nullptr)return -1;
+
+		U32 boneCount = m_clip->GetBoneCount();
+		if (paletteSize < boneCount)return -1;
+
+		for (U32 bone = 0; bone < boneCount; bone++)
+		{
+			const BoneTrack& track = m_clip->GetBoneTrack(bone);
+			U32* cursors = &m_cursors[bone * 3];
+
+			F32 t[3], q[4], s[3];
+			SampleTrack(track.translation, m_time, cursors[0], 3, ZERO, t);
+			SampleRotation(track.rotation, m_time, cursors[1], q);
+			SampleTrack(track.scale, m_time, cursors[2], 3, ONE, s);
+
+			ComposeTRS(t, q, s, palette[bone]);
+			FinishRow(palette[bone]);
+		}
+		return 0;
+	}
+
+	void AnimationInstance::SampleAll(AnimationInstance* const* instances, Affine* const* palettes, const size_t count)
+	{
+		if (instances == nullptr || palettes == nullptr)return;
+
+		// 1インスタンスあたりの処理は小さいため、ある程度まとめてスレッドに渡す
+		Parallel::For(count, 32, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					if (instances[i] == nullptr)continue;
+					const auto& clip = instances[i]->GetClip();
+					if (!clip)continue;
+					instances[i]->Sample(palettes[i], clip->GetBoneCount());
+				}
+			});
+	}
+}
\ No newline at end of file
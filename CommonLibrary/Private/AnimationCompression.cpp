@@ -0,0 +1,487 @@
+﻿#include "pch.h"
+#include "AnimationCompression.h"
+#include "Check.h"
+#include "Mathf.h"
+
+#include <algorithm>
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	enum class TrackKind
+	{
+		Translation,
+		Rotation,
+		Scale,
+	};
+
+	// 長さを何等分して時刻を量子化するか
+	const F32 TIME_STEPS = 65535.0f;
+
+	// 16bitで量子化する値の段階数
+	const F32 VALUE_STEPS = 65535.0f;
+
+	// smallest threeで1成分に使う15bitの段階数
+	const F32 ROTATION_STEPS = 32767.0f;
+
+	// 最大成分を除いた3成分の取り得る範囲(±1/√2)
+	const F32 ROTATION_RANGE = 0.70710678f;
+
+	// 前回の位置から順に探すキーの数
+	const U32 LINEAR_SEARCH_LIMIT = 4;
+
+	const F32 ZERO[] = { 0, 0, 0 };
+	const F32 ONE[] = { 1, 1, 1 };
+	const F32 IDENTITY[] = { 0, 0, 0, 1 };
+
+	inline U32 GetComponentCount(const TrackKind kind)
+	{
+		return kind == TrackKind::Rotation ? 4 : 3;
+	}
+
+	inline const F32* GetDefaults(const TrackKind kind)
+	{
+		switch (kind)
+		{
+		case TrackKind::Rotation:return IDENTITY;
+		case TrackKind::Scale:return ONE;
+		default:return ZERO;
+		}
+	}
+
+	inline U16 Quantize(const F32 normalized, const F32 steps)
+	{
+		return (U16)(Mathf::Clamp01(normalized) * steps + 0.5f);
+	}
+
+	inline void Normalize4(F32* q)
+	{
+		F32 lengthSq = q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3];
+		F32 inverse = 0.0f < lengthSq ? 1.0f / Mathf::Sqrt(lengthSq) : 0.0f;
+		for (U32 c = 0; c < 4; c++)q[c] *= inverse;
+	}
+
+	//===================================================================================//
+	// 量子化
+	//===================================================================================//
+
+	/// <summary>
+	/// 回転をsmallest threeで48bitに量子化する
+	/// </summary>
+	/// <remarks>
+	/// 絶対値が最大の成分を正に揃えて取り除き、残りの3成分を15bitずつ格納する。
+	/// 取り除いた成分の番号は1要素目と2要素目の最上位bitに格納する。
+	/// </remarks>
+	void EncodeRotation(const F32* rotation, U16* dest)
+	{
+		F32 q[4] = { rotation[0], rotation[1], rotation[2], rotation[3] };
+		Normalize4(q);
+
+		U32 largest = 0;
+		for (U32 c = 1; c < 4; c++)
+		{
+			if (Mathf::Abs(q[largest]) < Mathf::Abs(q[c]))largest = c;
+		}
+		F32 sign = q[largest] < 0.0f ? -1.0f : 1.0f;
+
+		U32 index = 0;
+		for (U32 c = 0; c < 4; c++)
+		{
+			if (c == largest)continue;
+			dest[index++] = Quantize(q[c] * sign / ROTATION_RANGE * 0.5f + 0.5f, ROTATION_STEPS);
+		}
+
+		dest[0] |= (U16)((largest & 1) << 15);
+		dest[1] |= (U16)((largest >> 1) << 15);
+	}
+
+	void DecodeRotation(const U16* source, F32* dest)
+	{
+		U32 largest = (source[0] >> 15) | ((source[1] >> 15) << 1);
+
+		F32 lengthSq = 0.0f;
+		U32 index = 0;
+		for (U32 c = 0; c < 4; c++)
+		{
+			if (c == largest)continue;
+			F32 v = ((source[index++] & 0x7FFF) * (2.0f / ROTATION_STEPS) - 1.0f) * ROTATION_RANGE;
+			dest[c] = v;
+			lengthSq += v * v;
+		}
+		dest[largest] = Mathf::Sqrt(Mathf::Max(0.0f, 1.0f - lengthSq));
+	}
+
+	void EncodeVector(const F32* value, const CompressedTrack& track, U16* dest)
+	{
+		for (U32 c = 0; c < 3; c++)
+		{
+			dest[c] = 0.0f < track.extent[c] ? Quantize((value[c] - track.minimum[c]) / track.extent[c], VALUE_STEPS) : 0;
+		}
+	}
+
+	void DecodeVector(const U16* source, const CompressedTrack& track, F32* dest)
+	{
+		for (U32 c = 0; c < 3; c++)
+		{
+			dest[c] = track.minimum[c] + source[c] * (track.extent[c] / VALUE_STEPS);
+		}
+	}
+
+	//===================================================================================//
+	// サンプリング
+	//===================================================================================//
+
+	/// <summary>
+	/// times[i] <= time < times[i + 1]となるiを求める
+	/// </summary>
+	U32 FindKey(const U16* times, const U32 count, const F32 time, U32& cursor)
+	{
+		if (count <= cursor)cursor = 0;
+
+		if (times[cursor] <= time)
+		{
+			for (U32 i = 0; i < LINEAR_SEARCH_LIMIT; i++)
+			{
+				if (cursor + 1 == count || time < times[cursor + 1])return cursor;
+				cursor++;
+			}
+		}
+		else if (time < times[0])
+		{
+			cursor = 0;
+			return cursor;
+		}
+
+		const U16* it = std::upper_bound(times, times + count, time, [](F32 t, U16 key) { return t < key; });
+		cursor = it == times ? 0 : (U32)(it - times) - 1;
+		return cursor;
+	}
+
+	inline void DecodeKey(const TrackKind kind, const CompressedTrack& track, const U16* values, const U32 key, F32* dest)
+	{
+		const U16* source = values + (size_t)(track.firstKey + key) * 3;
+		if (kind == TrackKind::Rotation)
+		{
+			DecodeRotation(source, dest);
+		}
+		else
+		{
+			DecodeVector(source, track, dest);
+		}
+	}
+
+	/// <summary>
+	/// 圧縮されたトラックを補間して値を求める
+	/// </summary>
+	/// <param name="time">量子化した時刻の単位での時刻</param>
+	void SampleTrack(const TrackKind kind, const CompressedTrack& track, const U16* times, const U16* values, const F32 time, U32& cursor, F32* dest)
+	{
+		const U32 componentCount = GetComponentCount(kind);
+		if (track.keyCount == 0)
+		{
+			const F32* defaults = GetDefaults(kind);
+			for (U32 c = 0; c < componentCount; c++)dest[c] = defaults[c];
+			return;
+		}
+
+		const U16* trackTimes = times + track.firstKey;
+		U32 key = FindKey(trackTimes, track.keyCount, time, cursor);
+		if (key + 1 == track.keyCount || time <= trackTimes[key])
+		{
+			DecodeKey(kind, track, values, key, dest);
+			return;
+		}
+
+		F32 a[4], b[4];
+		DecodeKey(kind, track, values, key, a);
+		DecodeKey(kind, track, values, key + 1, b);
+
+		F32 t0 = trackTimes[key];
+		F32 t1 = trackTimes[key + 1];
+		F32 rate = t0 < t1 ? (time - t0) / (t1 - t0) : 0.0f;
+
+		if (kind != TrackKind::Rotation)
+		{
+			for (U32 c = 0; c < 3; c++)dest[c] = Mathf::Lerp(a[c], b[c], rate);
+			return;
+		}
+
+		F32 dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+		F32 sign = dot < 0.0f ? -1.0f : 1.0f;
+		for (U32 c = 0; c < 4; c++)dest[c] = Mathf::Lerp(a[c], b[c] * sign, rate);
+		Normalize4(dest);
+	}
+
+	//===================================================================================//
+	// キーの削減
+	//===================================================================================//
+
+	/// <summary>
+	/// 2つの値の差を求める(平行移動は距離、回転は角度、拡大は成分ごとの差の最大値)
+	/// </summary>
+	F32 Difference(const TrackKind kind, const F32* a, const F32* b)
+	{
+		switch (kind)
+		{
+		case TrackKind::Rotation:
+		{
+			F32 qa[4] = { a[0], a[1], a[2], a[3] };
+			F32 qb[4] = { b[0], b[1], b[2], b[3] };
+			Normalize4(qa);
+			Normalize4(qb);
+			// 小さい角度でも精度が落ちないように、差分の回転の虚部の長さと実部からatan2で求める
+			F32 dot = Mathf::Abs(qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3]);
+			F32 x = qa[3] * qb[0] - qb[3] * qa[0] - (qa[1] * qb[2] - qa[2] * qb[1]);
+			F32 y = qa[3] * qb[1] - qb[3] * qa[1] - (qa[2] * qb[0] - qa[0] * qb[2]);
+			F32 z = qa[3] * qb[2] - qb[3] * qa[2] - (qa[0] * qb[1] - qa[1] * qb[0]);
+			return 2.0f * Mathf::Atan2(Mathf::Sqrt(x * x + y * y + z * z), dot);
+		}
+		case TrackKind::Scale:
+			return Mathf::Max(Mathf::Abs(a[0] - b[0]), Mathf::Max(Mathf::Abs(a[1] - b[1]), Mathf::Abs(a[2] - b[2])));
+		default:
+		{
+			F32 x = a[0] - b[0], y = a[1] - b[1], z = a[2] - b[2];
+			return Mathf::Sqrt(x * x + y * y + z * z);
+		}
+		}
+	}
+
+	inline void GetKeyValue(const AnimationTrack& track, const U32 componentCount, const U32 key, F32* dest)
+	{
+		for (U32 c = 0; c < componentCount; c++)dest[c] = track.values[c][key];
+	}
+
+	/// <summary>
+	/// 2つのキーの間を実行時と同じ方法で補間する
+	/// </summary>
+	void Interpolate(const TrackKind kind, const AnimationTrack& track, const U32 from, const U32 to, const F32 time, F32* dest)
+	{
+		const U32 componentCount = GetComponentCount(kind);
+		F32 a[4], b[4];
+		GetKeyValue(track, componentCount, from, a);
+		GetKeyValue(track, componentCount, to, b);
+
+		F32 t0 = track.times[from];
+		F32 t1 = track.times[to];
+		F32 rate = t0 < t1 ? (time - t0) / (t1 - t0) : 0.0f;
+
+		F32 sign = 1.0f;
+		if (kind == TrackKind::Rotation && a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3] < 0.0f)sign = -1.0f;
+		for (U32 c = 0; c < componentCount; c++)dest[c] = Mathf::Lerp(a[c], b[c] * sign, rate);
+		if (kind == TrackKind::Rotation)Normalize4(dest);
+	}
+
+	/// <summary>
+	/// fromとtoの間のキーが全て補間で許容誤差内に再現できるか
+	/// </summary>
+	bool CanSkip(const TrackKind kind, const AnimationTrack& track, const U32 from, const U32 to, const F32 tolerance)
+	{
+		const U32 componentCount = GetComponentCount(kind);
+		for (U32 key = from + 1; key < to; key++)
+		{
+			F32 value[4], interpolated[4];
+			GetKeyValue(track, componentCount, key, value);
+			Interpolate(kind, track, from, to, track.times[key], interpolated);
+			if (tolerance < Difference(kind, value, interpolated))return false;
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// 残すキーの番号を求める
+	/// </summary>
+	void ReduceKeys(const TrackKind kind, const AnimationTrack& track, const F32 tolerance, ArrayList<U32>& kept)
+	{
+		kept.clear();
+
+		const U32 count = track.GetKeyCount();
+		if (count == 0)return;
+
+		const U32 componentCount = GetComponentCount(kind);
+		F32 first[4], value[4];
+		GetKeyValue(track, componentCount, 0, first);
+
+		// 全て先頭のキーと同じとみなせる場合は1つにし、それが初期値でもあればキーを無くす
+		bool constant = true;
+		for (U32 key = 1; key < count && constant; key++)
+		{
+			GetKeyValue(track, componentCount, key, value);
+			constant = Difference(kind, first, value) <= tolerance;
+		}
+		if (constant)
+		{
+			if (tolerance < Difference(kind, first, GetDefaults(kind)))kept.push_back(0);
+			return;
+		}
+
+		// 直前に残したキーから補間できる範囲を先へ伸ばし、伸ばせなくなった位置のキーを残す
+		U32 anchor = 0;
+		kept.push_back(anchor);
+		for (U32 key = anchor + 2; key < count; key++)
+		{
+			if (CanSkip(kind, track, anchor, key, tolerance))continue;
+
+			anchor = key - 1;
+			kept.push_back(anchor);
+		}
+		kept.push_back(count - 1);
+	}
+}
+
+namespace CommonLibrary
+{
+	//===================================================================================//
+	// CompressedClip
+	//===================================================================================//
+
+	CompressedClip::CompressedClip() :m_boneCount(0), m_duration(0)
+	{
+	}
+
+	size_t CompressedClip::GetMemorySize()const
+	{
+		return sizeof(CompressedTrack) * m_tracks.size() + sizeof(U16) * (m_times.size() + m_values.size());
+	}
+
+	S32 CompressedClip::Sample(const F32 time, U32* cursors, Pose& pose)const
+	{
+		if (CheckArgs(cursors))return -1;
+
+		if (pose.GetBoneCount() != m_boneCount)pose.Resize(m_boneCount);
+
+		F32 quantizedTime = 0.0f < m_duration ? Mathf::Clamp(time, 0.0f, m_duration) / m_duration * TIME_STEPS : 0.0f;
+		const U16* times = m_times.data();
+		const U16* values = m_values.data();
+
+		for (U32 bone = 0; bone < m_boneCount; bone++)
+		{
+			const CompressedTrack* tracks = &m_tracks[bone * 3];
+			U32* cursor = &cursors[bone * 3];
+
+			F32 t[3], q[4], s[3];
+			SampleTrack(TrackKind::Translation, tracks[0], times, values, quantizedTime, cursor[0], t);
+			SampleTrack(TrackKind::Rotation, tracks[1], times, values, quantizedTime, cursor[1], q);
+			SampleTrack(TrackKind::Scale, tracks[2], times, values, quantizedTime, cursor[2], s);
+
+			for (U32 c = 0; c < 3; c++)pose.translation[c][bone] = t[c];
+			for (U32 c = 0; c < 4; c++)pose.rotation[c][bone] = q[c];
+			for (U32 c = 0; c < 3; c++)pose.scale[c][bone] = s[c];
+		}
+		return 0;
+	}
+
+	//===================================================================================//
+	// AnimationCompressor
+	//===================================================================================//
+
+	S32 AnimationCompressor::Compress(const AnimationClip& clip, const CompressionSettings& settings, CompressedClip& dest, CompressionReport* report)
+	{
+		const U32 boneCount = clip.GetBoneCount();
+		const F32 duration = clip.GetDuration();
+
+		CompressedClip result;
+		result.m_boneCount = boneCount;
+		result.m_duration = duration;
+		result.m_tracks.resize((size_t)boneCount * 3);
+
+		CompressionReport summary;
+		ArrayList<U32> kept;
+
+		for (U32 bone = 0; bone < boneCount; bone++)
+		{
+			const BoneTrack& boneTrack = clip.GetBoneTrack(bone);
+			const AnimationTrack* sources[] = { &boneTrack.translation, &boneTrack.rotation, &boneTrack.scale };
+			const TrackKind kinds[] = { TrackKind::Translation, TrackKind::Rotation, TrackKind::Scale };
+			const F32 tolerances[] = { settings.translationTolerance, settings.rotationTolerance, settings.scaleTolerance };
+
+			for (U32 i = 0; i < 3; i++)
+			{
+				const AnimationTrack& source = *sources[i];
+				const TrackKind kind = kinds[i];
+				const U32 componentCount = GetComponentCount(kind);
+				CompressedTrack& track = result.m_tracks[bone * 3 + i];
+
+				for (F32 time : source.times)
+				{
+					if (time < 0.0f || duration < time)return -1;
+				}
+
+				ReduceKeys(kind, source, tolerances[i], kept);
+
+				track.firstKey = (U32)result.m_times.size();
+				track.keyCount = (U32)kept.size();
+
+				// 残したキーの範囲で量子化する
+				if (kind != TrackKind::Rotation && !kept.empty())
+				{
+					for (U32 c = 0; c < 3; c++)
+					{
+						F32 minimum = source.values[c][kept[0]];
+						F32 maximum = minimum;
+						for (U32 key : kept)
+						{
+							minimum = Mathf::Min(minimum, source.values[c][key]);
+							maximum = Mathf::Max(maximum, source.values[c][key]);
+						}
+						track.minimum[c] = minimum;
+						track.extent[c] = maximum - minimum;
+					}
+				}
+
+				for (U32 key : kept)
+				{
+					result.m_times.push_back(0.0f < duration ? Quantize(source.times[key] / duration, TIME_STEPS) : 0);
+
+					F32 value[4];
+					GetKeyValue(source, componentCount, key, value);
+
+					U16 encoded[3];
+					if (kind == TrackKind::Rotation)
+					{
+						EncodeRotation(value, encoded);
+					}
+					else
+					{
+						EncodeVector(value, track, encoded);
+					}
+					result.m_values.insert(result.m_values.end(), encoded, encoded + 3);
+				}
+
+				if (report == nullptr)continue;
+
+				summary.rawKeyCount += source.GetKeyCount();
+				summary.compressedKeyCount += track.keyCount;
+				summary.rawSize += sizeof(F32) * (1 + componentCount) * source.GetKeyCount();
+
+				// 元のキーの時刻で圧縮後の値と比較する
+				F32 maxError = 0.0f;
+				U32 cursor = 0;
+				for (U32 key = 0; key < source.GetKeyCount(); key++)
+				{
+					F32 value[4], decoded[4];
+					GetKeyValue(source, componentCount, key, value);
+					F32 time = 0.0f < duration ? source.times[key] / duration * TIME_STEPS : 0.0f;
+					SampleTrack(kind, track, result.m_times.data(), result.m_values.data(), time, cursor, decoded);
+					maxError = Mathf::Max(maxError, Difference(kind, value, decoded));
+				}
+
+				switch (kind)
+				{
+				case TrackKind::Translation:summary.maxTranslationError = Mathf::Max(summary.maxTranslationError, maxError); break;
+				case TrackKind::Rotation:summary.maxRotationError = Mathf::Max(summary.maxRotationError, maxError); break;
+				case TrackKind::Scale:summary.maxScaleError = Mathf::Max(summary.maxScaleError, maxError); break;
+				}
+			}
+		}
+
+		dest = std::move(result);
+
+		if (report != nullptr)
+		{
+			summary.compressedSize = dest.GetMemorySize();
+			*report = summary;
+		}
+		return 0;
+	}
+}
\ No newline at end of file
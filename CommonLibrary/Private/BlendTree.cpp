@@ -0,0 +1,492 @@
+﻿#include "pch.h"
+#include "BlendTree.h"
+#include "Check.h"
+#include "Mathf.h"
+#include "Parallel.h"
+#include "Simd.h"
+
+#include <algorithm>
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	inline void MatchBoneCount(const Pose& source, Pose& dest)
+	{
+		if (dest.GetBoneCount() != source.GetBoneCount())dest.Resize(source.GetBoneCount());
+	}
+
+	inline F32x4 LoadAt(const ArrayList<F32>& values, const U32 index)
+	{
+		return F32x4::Load(values.data() + index);
+	}
+
+	inline void StoreAt(ArrayList<F32>& values, const U32 index, const F32x4& v)
+	{
+		v.Store(values.data() + index);
+	}
+
+	/// <summary>
+	/// 4ボーン分のクォータニオンを正規化して書き込む
+	/// </summary>
+	inline void StoreNormalized(Pose& out, const U32 i, const F32x4& x, const F32x4& y, const F32x4& z, const F32x4& w)
+	{
+		F32x4 inverse = F32x4::Set1(1.0f) / F32x4::Sqrt(x * x + y * y + z * z + w * w);
+		StoreAt(out.rotation[0], i, x * inverse);
+		StoreAt(out.rotation[1], i, y * inverse);
+		StoreAt(out.rotation[2], i, z * inverse);
+		StoreAt(out.rotation[3], i, w * inverse);
+	}
+
+	/// <summary>
+	/// 2つの姿勢をボーンごとの重みで補間する(平行移動と拡大は線形補間、回転は正規化線形補間)
+	/// </summary>
+	/// <param name="weight">ボーン番号iから4ボーン分の重みを返す関数</param>
+	template<class Weight>
+	void BlendPoses(const Pose& a, const Pose& b, const Weight& weight, Pose& out)
+	{
+		MatchBoneCount(a, out);
+		if (a.GetBoneCount() != b.GetBoneCount())
+		{
+			out = a;
+			return;
+		}
+
+		const F32x4 zero = F32x4::Set1(0.0f);
+		const F32x4 one = F32x4::Set1(1.0f);
+		const F32x4 minusOne = F32x4::Set1(-1.0f);
+
+		U32 count = out.GetPaddedCount();
+		for (U32 i = 0; i < count; i += 4)
+		{
+			F32x4 w = weight(i);
+
+			for (U32 c = 0; c < 3; c++)
+			{
+				F32x4 ta = LoadAt(a.translation[c], i);
+				StoreAt(out.translation[c], i, ta + (LoadAt(b.translation[c], i) - ta) * w);
+
+				F32x4 sa = LoadAt(a.scale[c], i);
+				StoreAt(out.scale[c], i, sa + (LoadAt(b.scale[c], i) - sa) * w);
+			}
+
+			F32x4 ax = LoadAt(a.rotation[0], i), ay = LoadAt(a.rotation[1], i), az = LoadAt(a.rotation[2], i), aw = LoadAt(a.rotation[3], i);
+			F32x4 bx = LoadAt(b.rotation[0], i), by = LoadAt(b.rotation[1], i), bz = LoadAt(b.rotation[2], i), bw = LoadAt(b.rotation[3], i);
+
+			// 最短経路で補間するため、内積が負のボーンは反転する
+			F32x4 dot = ax * bx + ay * by + az * bz + aw * bw;
+			F32x4 sign = F32x4::Select(F32x4::Less(dot, zero), minusOne, one);
+			bx *= sign;
+			by *= sign;
+			bz *= sign;
+			bw *= sign;
+
+			StoreNormalized(out, i, ax + (bx - ax) * w, ay + (by - ay) * w, az + (bz - az) * w, aw + (bw - aw) * w);
+		}
+	}
+
+	/// <summary>
+	/// 基準の姿勢に差分の姿勢を重みを掛けて加算する
+	/// </summary>
+	void AddPose(const Pose& base, const Pose& additive, const F32 weight, Pose& out)
+	{
+		MatchBoneCount(base, out);
+		if (base.GetBoneCount() != additive.GetBoneCount())
+		{
+			out = base;
+			return;
+		}
+
+		const F32x4 zero = F32x4::Set1(0.0f);
+		const F32x4 one = F32x4::Set1(1.0f);
+		const F32x4 minusOne = F32x4::Set1(-1.0f);
+		const F32x4 w = F32x4::Set1(weight);
+
+		U32 count = out.GetPaddedCount();
+		for (U32 i = 0; i < count; i += 4)
+		{
+			for (U32 c = 0; c < 3; c++)
+			{
+				StoreAt(out.translation[c], i, LoadAt(base.translation[c], i) + LoadAt(additive.translation[c], i) * w);
+
+				F32x4 ratio = one + (LoadAt(additive.scale[c], i) - one) * w;
+				StoreAt(out.scale[c], i, LoadAt(base.scale[c], i) * ratio);
+			}
+
+			// 差分の回転を単位クォータニオンから重みの分だけ補間する
+			F32x4 dw = LoadAt(additive.rotation[3], i);
+			F32x4 sign = F32x4::Select(F32x4::Less(dw, zero), minusOne, one);
+			F32x4 dx = LoadAt(additive.rotation[0], i) * sign * w;
+			F32x4 dy = LoadAt(additive.rotation[1], i) * sign * w;
+			F32x4 dz = LoadAt(additive.rotation[2], i) * sign * w;
+			dw = one + (dw * sign - one) * w;
+
+			// base * delta
+			F32x4 bx = LoadAt(base.rotation[0], i), by = LoadAt(base.rotation[1], i), bz = LoadAt(base.rotation[2], i), bw = LoadAt(base.rotation[3], i);
+			StoreNormalized(out, i,
+				by * dz - bz * dy + bx * dw + bw * dx,
+				bz * dx - bx * dz + by * dw + bw * dy,
+				bx * dy - by * dx + bz * dw + bw * dz,
+				bw * dw - bx * dx - by * dy - bz * dz);
+		}
+	}
+
+	/// <summary>
+	/// 複数の姿勢を重み付きで合成する。重みの合計は1とする。
+	/// </summary>
+	void AccumulatePoses(const Pose* const* poses, const F32* weights, const U32 poseCount, Pose& out)
+	{
+		const Pose& first = *poses[0];
+		MatchBoneCount(first, out);
+
+		const F32x4 zero = F32x4::Set1(0.0f);
+		const F32x4 one = F32x4::Set1(1.0f);
+		const F32x4 minusOne = F32x4::Set1(-1.0f);
+
+		U32 count = out.GetPaddedCount();
+		for (U32 i = 0; i < count; i += 4)
+		{
+			F32x4 t[3], s[3], q[4];
+			F32x4 px = LoadAt(first.rotation[0], i), py = LoadAt(first.rotation[1], i), pz = LoadAt(first.rotation[2], i), pw = LoadAt(first.rotation[3], i);
+
+			for (U32 k = 0; k < poseCount; k++)
+			{
+				const Pose& pose = *poses[k];
+				if (pose.GetBoneCount() != first.GetBoneCount())continue;
+
+				F32x4 w = F32x4::Set1(weights[k]);
+				for (U32 c = 0; c < 3; c++)
+				{
+					t[c] += LoadAt(pose.translation[c], i) * w;
+					s[c] += LoadAt(pose.scale[c], i) * w;
+				}
+
+				F32x4 x = LoadAt(pose.rotation[0], i), y = LoadAt(pose.rotation[1], i), z = LoadAt(pose.rotation[2], i), qw = LoadAt(pose.rotation[3], i);
+				F32x4 dot = x * px + y * py + z * pz + qw * pw;
+				F32x4 sign = F32x4::Select(F32x4::Less(dot, zero), minusOne, one) * w;
+				q[0] += x * sign;
+				q[1] += y * sign;
+				q[2] += z * sign;
+				q[3] += qw * sign;
+			}
+
+			for (U32 c = 0; c < 3; c++)
+			{
+				StoreAt(out.translation[c], i, t[c]);
+				StoreAt(out.scale[c], i, s[c]);
+			}
+			StoreNormalized(out, i, q[0], q[1], q[2], q[3]);
+		}
+	}
+}
+
+namespace CommonLibrary
+{
+	//===================================================================================//
+	// ClipNode
+	//===================================================================================//
+
+	ClipNode::ClipNode(const SPtr<AnimationClip>& clip)
+	{
+		m_instance.SetClip(clip);
+	}
+
+	void ClipNode::Advance(const F32 deltaTime)
+	{
+		m_instance.Advance(deltaTime);
+	}
+
+	void ClipNode::Evaluate(const BlendTree&)
+	{
+		m_instance.Sample(m_pose);
+	}
+
+	//===================================================================================//
+	// LerpNode
+	//===================================================================================//
+
+	LerpNode::LerpNode(const SPtr<BlendNode>& a, const SPtr<BlendNode>& b, const U32 parameter) :m_a(a), m_b(b), m_parameter(parameter)
+	{
+	}
+
+	void LerpNode::Advance(const F32 deltaTime)
+	{
+		if (m_a)m_a->Advance(deltaTime);
+		if (m_b)m_b->Advance(deltaTime);
+	}
+
+	void LerpNode::Evaluate(const BlendTree& tree)
+	{
+		if (CheckArgs(m_a != nullptr, m_b != nullptr))return;
+
+		F32 weight = Mathf::Clamp01(tree.GetParameter(m_parameter));
+
+		// 片方の重みが0の場合はもう片方だけを評価する
+		if (weight <= 0.0f)
+		{
+			m_a->Evaluate(tree);
+			m_pose = m_a->GetPose();
+			return;
+		}
+		if (1.0f <= weight)
+		{
+			m_b->Evaluate(tree);
+			m_pose = m_b->GetPose();
+			return;
+		}
+
+		m_a->Evaluate(tree);
+		m_b->Evaluate(tree);
+
+		F32x4 w = F32x4::Set1(weight);
+		BlendPoses(m_a->GetPose(), m_b->GetPose(), [&](U32) { return w; }, m_pose);
+	}
+
+	//===================================================================================//
+	// AdditiveNode
+	//===================================================================================//
+
+	AdditiveNode::AdditiveNode(const SPtr<BlendNode>& base, const SPtr<BlendNode>& additive, const U32 parameter) :m_base(base), m_additive(additive), m_parameter(parameter)
+	{
+	}
+
+	void AdditiveNode::Advance(const F32 deltaTime)
+	{
+		if (m_base)m_base->Advance(deltaTime);
+		if (m_additive)m_additive->Advance(deltaTime);
+	}
+
+	void AdditiveNode::Evaluate(const BlendTree& tree)
+	{
+		if (CheckArgs(m_base != nullptr, m_additive != nullptr))return;
+
+		m_base->Evaluate(tree);
+
+		F32 weight = tree.GetParameter(m_parameter);
+		if (weight == 0.0f)
+		{
+			m_pose = m_base->GetPose();
+			return;
+		}
+
+		m_additive->Evaluate(tree);
+		AddPose(m_base->GetPose(), m_additive->GetPose(), weight, m_pose);
+	}
+
+	//===================================================================================//
+	// MaskedLayerNode
+	//===================================================================================//
+
+	MaskedLayerNode::MaskedLayerNode(const SPtr<BlendNode>& base, const SPtr<BlendNode>& layer, const ArrayList<F32>& boneMask, const U32 parameter) :
+		m_base(base), m_layer(layer), m_boneMask(boneMask), m_parameter(parameter)
+	{
+	}
+
+	void MaskedLayerNode::Advance(const F32 deltaTime)
+	{
+		if (m_base)m_base->Advance(deltaTime);
+		if (m_layer)m_layer->Advance(deltaTime);
+	}
+
+	void MaskedLayerNode::Evaluate(const BlendTree& tree)
+	{
+		if (CheckArgs(m_base != nullptr, m_layer != nullptr))return;
+
+		m_base->Evaluate(tree);
+
+		F32 weight = Mathf::Clamp01(tree.GetParameter(m_parameter));
+		if (weight <= 0.0f)
+		{
+			m_pose = m_base->GetPose();
+			return;
+		}
+
+		m_layer->Evaluate(tree);
+
+		// マスクの無いボーンとパディングの要素は影響度0とする
+		const Pose& basePose = m_base->GetPose();
+		U32 padded = basePose.GetPaddedCount();
+		if (m_boneMask.size() < padded)m_boneMask.resize(padded, 0.0f);
+		m_weights.resize(m_boneMask.size());
+		for (size_t i = 0; i < m_boneMask.size(); i++)m_weights[i] = m_boneMask[i] * weight;
+
+		BlendPoses(basePose, m_layer->GetPose(), [&](U32 i) { return F32x4::Load(m_weights.data() + i); }, m_pose);
+	}
+
+	//===================================================================================//
+	// BlendSpace1DNode
+	//===================================================================================//
+
+	BlendSpace1DNode::BlendSpace1DNode(const U32 parameter) :m_parameter(parameter)
+	{
+	}
+
+	S32 BlendSpace1DNode::AddChild(const SPtr<BlendNode>& node, const F32 position)
+	{
+		if (!node)return -1;
+
+		Child child = { node, position };
+		auto it = std::upper_bound(m_children.begin(), m_children.end(), position, [](F32 p, const Child& c) { return p < c.position; });
+		m_children.insert(it, child);
+		return 0;
+	}
+
+	void BlendSpace1DNode::Advance(const F32 deltaTime)
+	{
+		for (auto& child : m_children)child.node->Advance(deltaTime);
+	}
+
+	void BlendSpace1DNode::Evaluate(const BlendTree& tree)
+	{
+		if (m_children.empty())return;
+
+		F32 value = tree.GetParameter(m_parameter);
+
+		// 範囲外は端の子
+		const Child* single = nullptr;
+		if (value <= m_children.front().position)single = &m_children.front();
+		else if (m_children.back().position <= value)single = &m_children.back();
+		if (single != nullptr)
+		{
+			single->node->Evaluate(tree);
+			m_pose = single->node->GetPose();
+			return;
+		}
+
+		size_t upper = 1;
+		while (m_children[upper].position < value)upper++;
+		const Child& a = m_children[upper - 1];
+		const Child& b = m_children[upper];
+
+		a.node->Evaluate(tree);
+		b.node->Evaluate(tree);
+
+		F32 range = b.position - a.position;
+		F32x4 w = F32x4::Set1(0.0f < range ? (value - a.position) / range : 0.0f);
+		BlendPoses(a.node->GetPose(), b.node->GetPose(), [&](U32) { return w; }, m_pose);
+	}
+
+	//===================================================================================//
+	// BlendSpace2DNode
+	//===================================================================================//
+
+	BlendSpace2DNode::BlendSpace2DNode(const U32 parameterX, const U32 parameterY) :m_parameterX(parameterX), m_parameterY(parameterY)
+	{
+	}
+
+	S32 BlendSpace2DNode::AddChild(const SPtr<BlendNode>& node, const F32 x, const F32 y)
+	{
+		if (!node)return -1;
+
+		Child child = { node, x, y };
+		m_children.push_back(child);
+		return 0;
+	}
+
+	void BlendSpace2DNode::Advance(const F32 deltaTime)
+	{
+		for (auto& child : m_children)child.node->Advance(deltaTime);
+	}
+
+	void BlendSpace2DNode::Evaluate(const BlendTree& tree)
+	{
+		if (m_children.empty())return;
+
+		const F32 x = tree.GetParameter(m_parameterX);
+		const F32 y = tree.GetParameter(m_parameterY);
+
+		// 子iの重みは、他の子jとの各組で、iからjへ向かう軸上の位置を1から0に写した値の最小値とする。
+		// 子の位置では自身が1、他が0になり、他の子を越えた先にある子の重みは0になる。
+		m_weights.resize(m_children.size());
+		F32 total = 0.0f;
+		for (size_t i = 0; i < m_children.size(); i++)
+		{
+			const Child& a = m_children[i];
+			F32 weight = 1.0f;
+			for (size_t j = 0; j < m_children.size() && 0.0f < weight; j++)
+			{
+				const Child& b = m_children[j];
+				F32 axisX = b.x - a.x;
+				F32 axisY = b.y - a.y;
+				F32 lengthSq = axisX * axisX + axisY * axisY;
+				if (i == j || lengthSq < Mathf::EPSILON)continue;
+
+				F32 t = ((x - a.x) * axisX + (y - a.y) * axisY) / lengthSq;
+				weight = Mathf::Min(weight, Mathf::Clamp01(1.0f - t));
+			}
+			m_weights[i] = weight;
+			total += weight;
+		}
+
+		// 重みが0の子は評価せずに除く
+		m_poses.clear();
+		size_t used = 0;
+		for (size_t i = 0; i < m_children.size(); i++)
+		{
+			if (m_weights[i] <= 0.0f)continue;
+
+			m_children[i].node->Evaluate(tree);
+			m_poses.push_back(&m_children[i].node->GetPose());
+			m_weights[used++] = m_weights[i] / total;
+		}
+		m_weights.resize(used);
+
+		if (used == 1)
+		{
+			m_pose = *m_poses.front();
+			return;
+		}
+		AccumulatePoses(m_poses.data(), m_weights.data(), (U32)m_poses.size(), m_pose);
+	}
+
+	//===================================================================================//
+	// BlendTree
+	//===================================================================================//
+
+	BlendTree::BlendTree(const ArrayList<S32>& parents, const U32 parameterCount) :m_parents(parents), m_parameters(parameterCount, 0.0f)
+	{
+	}
+
+	S32 BlendTree::SetParameter(const U32 index, const F32 value)
+	{
+		if (m_parameters.size() <= index)return -1;
+		m_parameters[index] = value;
+		return 0;
+	}
+
+	F32 BlendTree::GetParameter(const U32 index)const
+	{
+		if (m_parameters.size() <= index)return 0.0f;
+		return m_parameters[index];
+	}
+
+	void BlendTree::Advance(const F32 deltaTime)
+	{
+		if (m_root)m_root->Advance(deltaTime);
+	}
+
+	S32 BlendTree::Evaluate(Affine* palette, const size_t paletteSize)
+	{
+		if (CheckArgs(m_root != nullptr, palette))return -1;
+
+		m_root->Evaluate(*this);
+
+		const Pose& pose = m_root->GetPose();
+		if (m_parents.size() < pose.GetBoneCount())return -1;
+		return pose.ToModelSpace(m_parents.data(), palette, paletteSize);
+	}
+
+	void BlendTree::EvaluateAll(BlendTree* const* trees, Affine* const* palettes, const size_t count)
+	{
+		if (trees == nullptr || palettes == nullptr)return;
+
+		Parallel::For(count, 4, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					if (trees[i] == nullptr)continue;
+					trees[i]->Evaluate(palettes[i], trees[i]->GetBoneCount());
+				}
+			});
+	}
+}
\ No newline at end of file
@@ -0,0 +1,290 @@
+﻿#include "pch.h"
+#include "Broadphase.h"
+#include "Parallel.h"
+#include "RadixSort.h"
+#include "Simd.h"
+
+#include <algorithm>
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	// これより多くのプロキシが追加された場合は挿入ソートではなく全体を整列し直す(全体に対する割合の逆数)
+	const U32 FULL_SORT_RATIO = 16;
+
+	// 整列に使う軸を変更するには、現在の軸の分散の何倍が必要か
+	const F32 AXIS_SWITCH_RATIO = 1.5f;
+
+	// これより少ない組は基数ソートではなくstd::sortで整列する
+	const size_t RADIX_SORT_THRESHOLD = 256;
+
+	inline F32 GetAxis(const Vector3& v, const U32 axis)
+	{
+		return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+	}
+
+	inline U64 MakeKey(const U32 a, const U32 b)
+	{
+		return a < b ? ((U64)a << 32) | b : ((U64)b << 32) | a;
+	}
+
+	inline BroadphasePair MakePair(const U64 key)
+	{
+		BroadphasePair pair = { (U32)(key >> 32), (U32)key };
+		return pair;
+	}
+}
+
+namespace CommonLibrary
+{
+	const U32 Broadphase::INVALID_PROXY = ~0u;
+
+	Broadphase::Broadphase() :m_axis(0), m_insertedCount(0)
+	{
+	}
+
+	U32 Broadphase::Add(const Bounds& bounds)
+	{
+		U32 proxy;
+		if (!m_freeProxies.empty())
+		{
+			proxy = m_freeProxies.back();
+			m_freeProxies.pop_back();
+			m_bounds[proxy] = bounds;
+			m_alive[proxy] = 1;
+		}
+		else
+		{
+			proxy = (U32)m_bounds.size();
+			m_bounds.push_back(bounds);
+			m_alive.push_back(1);
+		}
+
+		m_order.push_back(proxy);
+		m_keys.push_back(GetAxis(bounds.min, m_axis));
+		m_insertedCount++;
+		return proxy;
+	}
+
+	S32 Broadphase::Remove(const U32 proxy)
+	{
+		if (m_alive.size() <= proxy || !m_alive[proxy])return -1;
+
+		m_alive[proxy] = 0;
+		m_pendingFree.push_back(proxy);
+		return 0;
+	}
+
+	S32 Broadphase::Move(const U32 proxy, const Bounds& bounds)
+	{
+		if (m_alive.size() <= proxy || !m_alive[proxy])return -1;
+
+		m_bounds[proxy] = bounds;
+		return 0;
+	}
+
+	const Bounds* Broadphase::GetBounds(const U32 proxy)const
+	{
+		if (m_alive.size() <= proxy || !m_alive[proxy])return nullptr;
+		return &m_bounds[proxy];
+	}
+
+	void Broadphase::Update()
+	{
+		// 削除されたプロキシを整列済みの配列から取り除く
+		if (!m_pendingFree.empty())
+		{
+			size_t count = 0;
+			for (size_t i = 0; i < m_order.size(); i++)
+			{
+				if (!m_alive[m_order[i]])continue;
+				m_order[count] = m_order[i];
+				m_keys[count] = m_keys[i];
+				count++;
+			}
+			m_order.resize(count);
+			m_keys.resize(count);
+		}
+
+		SortProxies();
+
+		// 整列した順に境界ボックスを並べる。末尾の4要素は4つずつ読み込むための余白
+		const size_t count = m_order.size();
+		const U32 axes[] = { m_axis, (m_axis + 1) % 3, (m_axis + 2) % 3 };
+		for (U32 k = 0; k < 3; k++)
+		{
+			m_min[k].resize(count + 4, FLT_MAX);
+			m_max[k].resize(count + 4, -FLT_MAX);
+		}
+		for (size_t i = 0; i < count; i++)
+		{
+			const Bounds& bounds = m_bounds[m_order[i]];
+			for (U32 k = 0; k < 3; k++)
+			{
+				m_min[k][i] = GetAxis(bounds.min, axes[k]);
+				m_max[k][i] = GetAxis(bounds.max, axes[k]);
+			}
+		}
+
+		// 分割ごとに走査する
+		const size_t taskCount = (count + PROXIES_PER_TASK - 1) / PROXIES_PER_TASK;
+		if (m_taskPairs.size() < taskCount)m_taskPairs.resize(taskCount);
+		Parallel::For(taskCount, 1, [&](size_t begin, size_t end)
+			{
+				for (size_t task = begin; task < end; task++)
+				{
+					size_t first = task * PROXIES_PER_TASK;
+					size_t last = first + PROXIES_PER_TASK < count ? first + PROXIES_PER_TASK : count;
+					m_taskPairs[task].clear();
+					Sweep(first, last, m_taskPairs[task]);
+				}
+			});
+
+		m_current.clear();
+		for (size_t task = 0; task < taskCount; task++)
+		{
+			m_current.insert(m_current.end(), m_taskPairs[task].begin(), m_taskPairs[task].end());
+		}
+		RadixSort(m_current, m_keysScratch, [](const U64 key) { return key; }, RADIX_SORT_THRESHOLD);
+
+		// 前回の組と比較して追加と削除を求める
+		m_addedPairs.clear();
+		m_removedPairs.clear();
+		size_t p = 0, c = 0;
+		while (p < m_previous.size() || c < m_current.size())
+		{
+			if (c == m_current.size() || (p < m_previous.size() && m_previous[p] < m_current[c]))
+			{
+				m_removedPairs.push_back(MakePair(m_previous[p++]));
+			}
+			else if (p == m_previous.size() || m_current[c] < m_previous[p])
+			{
+				m_addedPairs.push_back(MakePair(m_current[c++]));
+			}
+			else
+			{
+				p++;
+				c++;
+			}
+		}
+
+		m_pairs.resize(m_current.size());
+		for (size_t i = 0; i < m_current.size(); i++)m_pairs[i] = MakePair(m_current[i]);
+		m_previous.swap(m_current);
+
+		m_freeProxies.insert(m_freeProxies.end(), m_pendingFree.begin(), m_pendingFree.end());
+		m_pendingFree.clear();
+
+		ChooseAxis();
+	}
+
+	void Broadphase::SortProxies()
+	{
+		const size_t count = m_order.size();
+		for (size_t i = 0; i < count; i++)m_keys[i] = GetAxis(m_bounds[m_order[i]].min, m_axis);
+
+		if (count < (size_t)m_insertedCount * FULL_SORT_RATIO)
+		{
+			// 追加が多い場合はまとめて整列する
+			ArrayList<std::pair<F32, U32>> sorted(count);
+			for (size_t i = 0; i < count; i++)sorted[i] = std::make_pair(m_keys[i], m_order[i]);
+			std::sort(sorted.begin(), sorted.end());
+			for (size_t i = 0; i < count; i++)
+			{
+				m_keys[i] = sorted[i].first;
+				m_order[i] = sorted[i].second;
+			}
+		}
+		else
+		{
+			// 前回からの移動は小さいため、ほぼ整列済みの配列に対する挿入ソートはほぼO(n)で済む
+			for (size_t i = 1; i < count; i++)
+			{
+				F32 key = m_keys[i];
+				if (m_keys[i - 1] <= key)continue;
+
+				U32 proxy = m_order[i];
+				size_t j = i;
+				for (; 0 < j && key < m_keys[j - 1]; j--)
+				{
+					m_keys[j] = m_keys[j - 1];
+					m_order[j] = m_order[j - 1];
+				}
+				m_keys[j] = key;
+				m_order[j] = proxy;
+			}
+		}
+
+		m_insertedCount = 0;
+	}
+
+	void Broadphase::Sweep(const size_t begin, const size_t end, ArrayList<U64>& dest)const
+	{
+		const size_t count = m_order.size();
+		const F32* minA = m_min[0].data();
+		const F32* minB = m_min[1].data();
+		const F32* maxB = m_max[1].data();
+		const F32* minC = m_min[2].data();
+		const F32* maxC = m_max[2].data();
+
+		for (size_t i = begin; i < end; i++)
+		{
+			const F32x4 minBi = F32x4::Set1(minB[i]);
+			const F32x4 maxBi = F32x4::Set1(maxB[i]);
+			const F32x4 minCi = F32x4::Set1(minC[i]);
+			const F32x4 maxCi = F32x4::Set1(maxC[i]);
+			const U32 proxy = m_order[i];
+
+			// 整列に使う軸で重なる範囲は最小値の二分探索で求め、残り2軸を4つずつ判定する
+			const size_t last = std::upper_bound(minA + i + 1, minA + count, m_max[0][i]) - minA;
+			for (size_t j = i + 1; j < last; j += 4)
+			{
+				F32x4 separated = F32x4::Or(
+					F32x4::Or(F32x4::Less(maxBi, F32x4::Load(minB + j)), F32x4::Less(F32x4::Load(maxB + j), minBi)),
+					F32x4::Or(F32x4::Less(maxCi, F32x4::Load(minC + j)), F32x4::Less(F32x4::Load(maxC + j), minCi)));
+
+				S32 overlap = ~separated.MoveMask() & 0xF;
+				if (overlap == 0)continue;
+				if (last < j + 4)overlap &= (1 << (last - j)) - 1;
+
+				for (U32 k = 0; overlap != 0; k++, overlap >>= 1)
+				{
+					if (overlap & 1)dest.push_back(MakeKey(proxy, m_order[j + k]));
+				}
+			}
+		}
+	}
+
+	void Broadphase::ChooseAxis()
+	{
+		const size_t count = m_order.size();
+		if (count < 2)return;
+
+		F32 variances[3];
+		for (U32 axis = 0; axis < 3; axis++)
+		{
+			F64 sum = 0.0, sumSq = 0.0;
+			for (U32 proxy : m_order)
+			{
+				const Bounds& bounds = m_bounds[proxy];
+				F64 center = (GetAxis(bounds.min, axis) + GetAxis(bounds.max, axis)) * 0.5;
+				sum += center;
+				sumSq += center * center;
+			}
+			F64 mean = sum / count;
+			variances[axis] = (F32)(sumSq / count - mean * mean);
+		}
+
+		U32 best = m_axis;
+		for (U32 axis = 0; axis < 3; axis++)
+		{
+			if (variances[best] < variances[axis])best = axis;
+		}
+		if (best == m_axis || variances[best] < variances[m_axis] * AXIS_SWITCH_RATIO)return;
+
+		// 次のUpdateで全体を整列し直す
+		m_axis = best;
+		m_insertedCount = (U32)count;
+	}
+}
\ No newline at end of file
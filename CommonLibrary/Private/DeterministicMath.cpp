@@ -0,0 +1,568 @@
+﻿#include "pch.h"
+#include "DeterministicMath.h"
+
+// 乗算と加算がFMAに縮約されると環境によって結果が変わるため、このファイルでは縮約を禁止する
+#if defined(_MSC_VER)
+#pragma fp_contract(off)
+#elif defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+// x87のように中間結果を拡張精度で保持する環境では結果が一致しない
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD != 0 && FLT_EVAL_METHOD != -1
+#error DeterministicMath requires FLT_EVAL_METHOD == 0 (SSE2 floating point).
+#endif
+
+namespace
+{
+	const F64 PI = 3.14159265358979323846;
+	const F64 HALF_PI = 1.57079632679489661923;
+	const F64 QUARTER_PI = 0.78539816339744830962;
+	const F64 TAN_PI_8 = 0.41421356237309504880;
+	const F64 SQRT_HALF = 0.70710678118654752440;
+	const F64 INV_LN10 = 0.43429448190325182765;
+
+	// π/2を3つに分割した値(Cody-Waite法による引数の縮小用)
+	const F64 INV_PIO2 = 6.36619772367581382433e-01;
+	const F64 PIO2_1 = 1.57079632673412561417e+00;
+	const F64 PIO2_2 = 6.07710050630396597660e-11;
+	const F64 PIO2_3 = 2.02226624871116645580e-21;
+
+	// これ以上の入力ではCody-Waite法の誤差が大きくなるため、Payne-Hanek法で縮小する(2^19 * π/2)
+	const F32 LARGE_REDUCTION_THRESHOLD = 823549.6f;
+
+	// 2/πの小数部のビット列(先頭から256bit)
+	const U32 TWO_OVER_PI_BITS[] = {
+		0xA2F9836E, 0x4E441529, 0xFC2757D1, 0xF534DDC0,
+		0xDB629599, 0x3C439041, 0xFE5163AB, 0xDEBBC561,
+	};
+
+	// log(2)を2つに分割した値
+	const F64 INV_LN2 = 1.44269504088896338700e+00;
+	const F64 LN2_HI = 6.93147180369123816490e-01;
+	const F64 LN2_LO = 1.90821492927058770002e-10;
+
+	// [-π/4, π/4]でのsin, cosの多項式近似の係数
+	const F64 SIN_COEF[] = {
+		-1.66666666666666324348e-01,
+		8.33333333332248946124e-03,
+		-1.98412698298579493134e-04,
+		2.75573137070700676789e-06,
+		-2.50507602534068634195e-08,
+		1.58969099521155010221e-10,
+	};
+	const F64 COS_COEF[] = {
+		4.16666666666666019037e-02,
+		-1.38888888888741095749e-03,
+		2.48015872894767294178e-05,
+		-2.75573143513906633035e-07,
+		2.08757232129817482790e-09,
+		-1.13596475577881948265e-11,
+	};
+
+	// 1/n!
+	const F64 INV_FACTORIAL[] = {
+		1.0,
+		1.0,
+		0.5,
+		1.66666666666666666667e-01,
+		4.16666666666666666667e-02,
+		8.33333333333333333333e-03,
+		1.38888888888888888889e-03,
+		1.98412698412698412698e-04,
+		2.48015873015873015873e-05,
+		2.75573192239858906526e-06,
+		2.75573192239858906526e-07,
+		2.50521083854417187751e-08,
+		2.08767569878680989792e-09,
+		1.60590438368216145994e-10,
+	};
+
+	F64 SinKernel(const F64 r)
+	{
+		F64 z = r * r;
+		F64 p = SIN_COEF[5];
+		for (S32 i = 4; 0 <= i; i--)p = SIN_COEF[i] + z * p;
+		return r + r * z * p;
+	}
+
+	F64 CosKernel(const F64 r)
+	{
+		F64 z = r * r;
+		F64 p = COS_COEF[5];
+		for (S32 i = 4; 0 <= i; i--)p = COS_COEF[i] + z * p;
+		return 1.0 - 0.5 * z + z * z * p;
+	}
+
+	inline bool IsFinite(const F32 f)
+	{
+		return f == f && f != std::numeric_limits<F32>::infinity() && f != -std::numeric_limits<F32>::infinity();
+	}
+
+	/// <summary>
+	/// 2/πの小数部のfirst番目(1始まり)から32bitを返す。範囲外のビットは0とする
+	/// </summary>
+	U32 GetTwoOverPiBits(const S32 first)
+	{
+		const S32 position = first - 1;
+		const S32 word = position < 0 ? -((31 - position) / 32) : position / 32;
+		const S32 shift = position - word * 32;
+		const S32 count = (S32)(sizeof(TWO_OVER_PI_BITS) / sizeof(TWO_OVER_PI_BITS[0]));
+
+		const U64 high = 0 <= word && word < count ? TWO_OVER_PI_BITS[word] : 0;
+		const U64 low = 0 <= word + 1 && word + 1 < count ? TWO_OVER_PI_BITS[word + 1] : 0;
+		return (U32)((((high << 32) | low) << shift) >> 32);
+	}
+
+	/// <summary>
+	/// Payne-Hanek法で大きな入力を縮小する
+	/// </summary>
+	/// <remarks>
+	/// x = m * 2^e (mは24bitの整数)として、x * 2/πの4の倍数にならない部分だけを2/πのビット列から取り出し、整数演算で掛ける。
+	/// </remarks>
+	S32 ReduceHalfPiLarge(const F32 x, F64& r)
+	{
+		U32 bits;
+		memcpy(&bits, &x, sizeof(bits));
+		const bool negative = (bits >> 31) != 0;
+		const U32 mantissa = (bits & 0x7FFFFF) | 0x800000;
+		const S32 exponent = (S32)((bits >> 23) & 0xFF) - 150;
+
+		// m * 2^e * 2/πのうち4未満の部分 = m * window * 2^-126
+		// windowは2/πの(e - 1)番目からの128bit
+		U32 window[4];
+		for (S32 i = 0; i < 4; i++)window[i] = GetTwoOverPiBits(exponent - 1 + i * 32);
+
+		// m * windowの下位128bit(上位の語から順に格納)
+		U32 product[4];
+		U64 carry = 0;
+		for (S32 i = 3; 0 <= i; i--)
+		{
+			const U64 value = (U64)mantissa * window[i] + carry;
+			product[i] = (U32)value;
+			carry = value >> 32;
+		}
+
+		// 上位2bitが象限、残りが小数部。小数部が1/2以上なら次の象限からの負の値にする
+		S32 quadrant = (S32)(product[0] >> 30);
+		const U64 fraction = ((U64)product[0] << 34) | ((U64)product[1] << 2) | (product[2] >> 30);
+		if (fraction >> 63)quadrant = (quadrant + 1) & 3;
+
+		// 符号付きの64bitとして解釈すると[-1/2, 1/2)の固定小数点数になる
+		F64 f = (F64)(S64)fraction * (1.0 / 18446744073709551616.0);
+		r = f * HALF_PI;
+		if (negative)
+		{
+			r = -r;
+			quadrant = (4 - quadrant) & 3;
+		}
+		return quadrant;
+	}
+
+	/// <summary>
+	/// xを[-π/4, π/4]に縮小し、象限を返す
+	/// </summary>
+	/// <remarks>
+	/// xは有限の値であること。
+	/// </remarks>
+	S32 ReduceHalfPi(const F32 x, F64& r)
+	{
+		if (!(-LARGE_REDUCTION_THRESHOLD < x && x < LARGE_REDUCTION_THRESHOLD))return ReduceHalfPiLarge(x, r);
+
+		// kの絶対値は2^19程度に収まるため、PIO2_1との積は丸め誤差なく求まる
+		F64 k = floor(x * INV_PIO2 + 0.5);
+		r = ((x - k * PIO2_1) - k * PIO2_2) - k * PIO2_3;
+		S32 quadrant = (S32)k & 3;
+		return quadrant;
+	}
+
+	F64 ExpD(const F64 x)
+	{
+		if (x != x)return x;
+		if (709.782712893384 < x)return std::numeric_limits<F64>::infinity();
+		if (x < -745.1332191019411)return 0.0;
+
+		F64 k = floor(x * INV_LN2 + 0.5);
+		F64 r = (x - k * LN2_HI) - k * LN2_LO;
+
+		F64 p = INV_FACTORIAL[13];
+		for (S32 i = 12; 0 <= i; i--)p = INV_FACTORIAL[i] + r * p;
+
+		// 2の累乗の乗算は丸め誤差が生じない
+		return ldexp(p, (int)k);
+	}
+
+	F64 LogD(const F64 x)
+	{
+		if (x != x)return x;
+		if (x < 0.0)return std::numeric_limits<F64>::quiet_NaN();
+		if (x == 0.0)return -std::numeric_limits<F64>::infinity();
+		if (x == std::numeric_limits<F64>::infinity())return x;
+
+		// x = m * 2^e, m ∈ [√0.5, √2)
+		int e;
+		F64 m = frexp(x, &e);
+		if (m < SQRT_HALF)
+		{
+			m *= 2.0;
+			e--;
+		}
+
+		// log(m) = 2 * atanh(s), s = (m - 1) / (m + 1)
+		F64 f = m - 1.0;
+		F64 s = f / (2.0 + f);
+		F64 z = s * s;
+		F64 p = 1.0 / 21.0;
+		for (S32 n = 9; 0 <= n; n--)p = 1.0 / (2 * n + 1) + z * p;
+
+		return e * LN2_HI + (e * LN2_LO + 2.0 * s * p);
+	}
+
+	F64 AtanD(const F64 x)
+	{
+		if (x != x)return x;
+
+		bool negative = x < 0.0;
+		F64 a = negative ? -x : x;
+
+		// atan(a) = π/2 - atan(1/a)
+		bool inverted = 1.0 < a;
+		if (inverted)a = 1.0 / a;
+
+		// atan(a) = π/4 + atan((a - 1) / (a + 1))
+		F64 base = 0.0;
+		if (TAN_PI_8 < a)
+		{
+			a = (a - 1.0) / (a + 1.0);
+			base = QUARTER_PI;
+		}
+
+		// |a| <= tan(π/8)でのテイラー展開
+		F64 z = a * a;
+		F64 p = 0.0;
+		for (S32 n = 22; 0 <= n; n--)p = ((n & 1) ? -1.0 : 1.0) / (2 * n + 1) + z * p;
+
+		F64 result = base + a * p;
+		if (inverted)result = HALF_PI - result;
+		return negative ? -result : result;
+	}
+
+	F64 Atan2D(const F64 y, const F64 x)
+	{
+		if (x != x || y != y)return x + y;
+
+		const F64 inf = std::numeric_limits<F64>::infinity();
+		bool yNegative = std::signbit(y);
+
+		if (x == inf || x == -inf)
+		{
+			if (y == inf || y == -inf)
+			{
+				F64 angle = 0.0 < x ? QUARTER_PI : 3.0 * QUARTER_PI;
+				return yNegative ? -angle : angle;
+			}
+			if (0.0 < x)return yNegative ? -0.0 : 0.0;
+			return yNegative ? -PI : PI;
+		}
+		if (y == inf || y == -inf)return yNegative ? -HALF_PI : HALF_PI;
+
+		if (x == 0.0)
+		{
+			if (y == 0.0)
+			{
+				if (std::signbit(x))return yNegative ? -PI : PI;
+				return y;
+			}
+			return yNegative ? -HALF_PI : HALF_PI;
+		}
+
+		F64 a = AtanD(y / x);
+		if (0.0 < x)return a;
+		return yNegative ? a - PI : a + PI;
+	}
+
+	// 検証用のハッシュ(FNV-1a)
+	void HashF32(U64& hash, const F32 f)
+	{
+		U32 bits;
+		memcpy(&bits, &f, sizeof(bits));
+		for (S32 i = 0; i < 4; i++)
+		{
+			hash ^= (bits >> (i * 8)) & 0xff;
+			hash *= 1099511628211ull;
+		}
+	}
+
+	// 検証用の乱数(グローバルなRandomの状態を変えないように独立させる)
+	struct SampleGenerator
+	{
+		U32 state = 2463534242u;
+
+		// [minimum, maximum)の値を返す
+		F32 Next(const F32 minimum, const F32 maximum)
+		{
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			F32 t = (F32)(state >> 8) * (1.0f / 16777216.0f);
+			return minimum + (maximum - minimum) * t;
+		}
+	};
+}
+
+namespace CommonLibrary
+{
+	F32 DeterministicMath::Sin(const F32 f)
+	{
+		if (!IsFinite(f))return std::numeric_limits<F32>::quiet_NaN();
+
+		F64 r;
+		switch (ReduceHalfPi(f, r))
+		{
+		case 0: return (F32)SinKernel(r);
+		case 1: return (F32)CosKernel(r);
+		case 2: return (F32)-SinKernel(r);
+		default: return (F32)-CosKernel(r);
+		}
+	}
+
+	F32 DeterministicMath::Cos(const F32 f)
+	{
+		if (!IsFinite(f))return std::numeric_limits<F32>::quiet_NaN();
+
+		F64 r;
+		switch (ReduceHalfPi(f, r))
+		{
+		case 0: return (F32)CosKernel(r);
+		case 1: return (F32)-SinKernel(r);
+		case 2: return (F32)-CosKernel(r);
+		default: return (F32)SinKernel(r);
+		}
+	}
+
+	F32 DeterministicMath::Tan(const F32 f)
+	{
+		if (!IsFinite(f))return std::numeric_limits<F32>::quiet_NaN();
+
+		F64 r;
+		S32 quadrant = ReduceHalfPi(f, r);
+		F64 s = SinKernel(r);
+		F64 c = CosKernel(r);
+		return (F32)((quadrant & 1) ? -c / s : s / c);
+	}
+
+	F32 DeterministicMath::Asin(const F32 f)
+	{
+		if (f < -1.0f || 1.0f < f)return std::numeric_limits<F32>::quiet_NaN();
+		F64 x = f;
+		return (F32)Atan2D(x, sqrt((1.0 - x) * (1.0 + x)));
+	}
+
+	F32 DeterministicMath::Acos(const F32 f)
+	{
+		if (f < -1.0f || 1.0f < f)return std::numeric_limits<F32>::quiet_NaN();
+		F64 x = f;
+		return (F32)Atan2D(sqrt((1.0 - x) * (1.0 + x)), x);
+	}
+
+	F32 DeterministicMath::Atan(const F32 f)
+	{
+		return (F32)AtanD(f);
+	}
+
+	F32 DeterministicMath::Atan2(const F32 y, const F32 x)
+	{
+		return (F32)Atan2D(y, x);
+	}
+
+	F32 DeterministicMath::Exp(const F32 f)
+	{
+		return (F32)ExpD(f);
+	}
+
+	F32 DeterministicMath::Log(const F32 f)
+	{
+		return (F32)LogD(f);
+	}
+
+	F32 DeterministicMath::Log10(const F32 f)
+	{
+		return (F32)(LogD(f) * INV_LN10);
+	}
+
+	F32 DeterministicMath::Pow(const F32 f, const F32 p)
+	{
+		const F32 inf = std::numeric_limits<F32>::infinity();
+
+		if (p == 0.0f || f == 1.0f)return 1.0f;
+		if (f != f || p != p)return f + p;
+
+		bool isInteger = floor(p) == p;
+		bool isOddInteger = isInteger && fmod(p, 2.0f) != 0.0f;
+
+		if (p == inf || p == -inf)
+		{
+			F32 a = f < 0.0f ? -f : f;
+			if (a == 1.0f)return 1.0f;
+			return (1.0f < a) == (0.0f < p) ? inf : 0.0f;
+		}
+		if (f == 0.0f)
+		{
+			if (0.0f < p)return isOddInteger ? f : 0.0f;
+			return isOddInteger ? (std::signbit(f) ? -inf : inf) : inf;
+		}
+		if (f == inf)return 0.0f < p ? inf : 0.0f;
+		if (f == -inf)
+		{
+			if (0.0f < p)return isOddInteger ? -inf : inf;
+			return isOddInteger ? -0.0f : 0.0f;
+		}
+
+		if (f < 0.0f)
+		{
+			if (!isInteger)return std::numeric_limits<F32>::quiet_NaN();
+			F64 result = ExpD((F64)p * LogD(-(F64)f));
+			return (F32)(isOddInteger ? -result : result);
+		}
+		return (F32)ExpD((F64)p * LogD(f));
+	}
+
+	F32 DeterministicMath::Sqrt(const F32 f)
+	{
+		// sqrtはIEEE754で正しく丸めることが規定されている
+		return std::sqrt(f);
+	}
+
+
+
+	F32 DeterministicMath::Lerp(const F32 a, const F32 b, const F32 t)
+	{
+		return a * (1 - t) + b * t;
+	}
+
+	F32 DeterministicMath::LerpAngle(const F32 a, const F32 b, const F32 t)
+	{
+		return fmod(a + fmod(b - a, (F32)(2.0 * PI)) * t, (F32)(2.0 * PI));
+	}
+
+	F32 DeterministicMath::PingPong(const F32 f)
+	{
+		F32 half = f * 0.5f;
+		F32 result = half - ceil(half) - 0.5f;
+		return result < 0.0f ? -result : result;
+	}
+
+
+
+	F64 DeterministicMath::PartialSum(const F32* values, const size_t count)
+	{
+		F64 sum = 0.0;
+		for (size_t i = 0; i < count; i++)sum += values[i];
+		return sum;
+	}
+
+	F64 DeterministicMath::PartialDot(const F32* a, const F32* b, const size_t count)
+	{
+		// F32同士の積はF64で誤差なく表せるため、FMAの有無で結果は変わらない
+		F64 sum = 0.0;
+		for (size_t i = 0; i < count; i++)sum += (F64)a[i] * (F64)b[i];
+		return sum;
+	}
+
+	F32 DeterministicMath::CombinePartialSums(const F64* partials, const size_t count)
+	{
+		if (count == 0)return 0.0f;
+
+		ArrayList<F64> sums(partials, partials + count);
+		size_t n = count;
+		while (1 < n)
+		{
+			size_t half = n / 2;
+			for (size_t i = 0; i < half; i++)sums[i] = sums[i * 2] + sums[i * 2 + 1];
+			if (n & 1)sums[half] = sums[n - 1];
+			n = (n + 1) / 2;
+		}
+		return (F32)sums[0];
+	}
+
+	F32 DeterministicMath::Sum(const F32* values, const size_t count)
+	{
+		ArrayList<F64> partials;
+		partials.reserve((count + REDUCTION_BLOCK_SIZE - 1) / REDUCTION_BLOCK_SIZE);
+		for (size_t i = 0; i < count; i += REDUCTION_BLOCK_SIZE)
+		{
+			size_t blockCount = count - i < REDUCTION_BLOCK_SIZE ? count - i : REDUCTION_BLOCK_SIZE;
+			partials.push_back(PartialSum(values + i, blockCount));
+		}
+		return CombinePartialSums(partials.data(), partials.size());
+	}
+
+	F32 DeterministicMath::Dot(const F32* a, const F32* b, const size_t count)
+	{
+		ArrayList<F64> partials;
+		partials.reserve((count + REDUCTION_BLOCK_SIZE - 1) / REDUCTION_BLOCK_SIZE);
+		for (size_t i = 0; i < count; i += REDUCTION_BLOCK_SIZE)
+		{
+			size_t blockCount = count - i < REDUCTION_BLOCK_SIZE ? count - i : REDUCTION_BLOCK_SIZE;
+			partials.push_back(PartialDot(a + i, b + i, blockCount));
+		}
+		return CombinePartialSums(partials.data(), partials.size());
+	}
+
+
+
+	U64 DeterministicMath::Checksum(const U32 sampleCount)
+	{
+		U64 hash = 14695981039346656037ull;
+		SampleGenerator generator;
+		ArrayList<F32> values(sampleCount);
+
+		for (U32 i = 0; i < sampleCount; i++)
+		{
+			F32 angle = generator.Next(-1000.0f, 1000.0f);
+			F32 unit = generator.Next(-1.0f, 1.0f);
+			F32 wide = generator.Next(-100.0f, 100.0f);
+			F32 positive = generator.Next(0.0f, 1000000.0f);
+			F32 exponent = generator.Next(-8.0f, 8.0f);
+			// 引数の縮小の方法が切り替わる大きな値も含める
+			F32 huge = ldexp(generator.Next(-1.0f, 1.0f), (int)generator.Next(0.0f, 128.0f));
+
+			HashF32(hash, Sin(angle));
+			HashF32(hash, Cos(angle));
+			HashF32(hash, Tan(angle));
+			HashF32(hash, Sin(huge));
+			HashF32(hash, Cos(huge));
+			HashF32(hash, Tan(huge));
+			HashF32(hash, Asin(unit));
+			HashF32(hash, Acos(unit));
+			HashF32(hash, Atan(wide));
+			HashF32(hash, Atan2(wide, unit));
+			HashF32(hash, Exp(wide));
+			HashF32(hash, Log(positive));
+			HashF32(hash, Log10(positive));
+			HashF32(hash, Pow(positive, exponent));
+			HashF32(hash, Sqrt(positive));
+			HashF32(hash, Lerp(angle, wide, unit));
+			HashF32(hash, LerpAngle(angle, wide, unit));
+			HashF32(hash, PingPong(wide));
+
+			values[i] = wide;
+		}
+
+		HashF32(hash, Sum(values.data(), values.size()));
+		HashF32(hash, Dot(values.data(), values.data(), values.size()));
+		return hash;
+	}
+
+	S32 DeterministicMath::VerifyChecksum()
+	{
+		return Checksum(REFERENCE_SAMPLE_COUNT) == REFERENCE_CHECKSUM ? 0 : -1;
+	}
+
+	S32 DeterministicMath::VerifyFullChecksum()
+	{
+		return Checksum(FULL_SAMPLE_COUNT) == FULL_REFERENCE_CHECKSUM ? 0 : -1;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,676 @@
+﻿#include "pch.h"
+#include "Ecs.h"
+#include "Parallel.h"
+
+#include <string>
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 16KBのチャンク
+	/// </summary>
+	/// <remarks>
+	/// 先頭にエンティティの配列、続けてアーキタイプのコンポーネントごとの配列が並ぶ。
+	/// </remarks>
+	struct EntityChunk
+	{
+		static const size_t SIZE = 16 * 1024;
+		static const size_t ALIGNMENT = 64;
+
+		UPtr<Byte[]> storage;
+		Byte* data = nullptr;
+		U32 count = 0;
+		// コンポーネントごとに最後に書き込まれたバージョン
+		ArrayList<U32> versions;
+
+		explicit EntityChunk(const size_t columnCount, const U32 version) :storage(new Byte[SIZE + ALIGNMENT]), versions(columnCount, version)
+		{
+			size_t address = reinterpret_cast<size_t>(storage.get());
+			data = storage.get() + ((ALIGNMENT - address % ALIGNMENT) % ALIGNMENT);
+		}
+
+		inline Entity* GetEntities() { return reinterpret_cast<Entity*>(data); }
+	};
+
+
+	/// <summary>
+	/// 同じ組み合わせのコンポーネントを持つエンティティの集まり
+	/// </summary>
+	/// <remarks>
+	/// 末尾以外のチャンクは常に満杯になるように詰めて格納する。
+	/// </remarks>
+	struct Archetype
+	{
+		ComponentMask mask;
+		// コンポーネントの番号(昇順)と、チャンク内の配列の位置と要素のサイズ
+		ArrayList<U32> componentIds;
+		ArrayList<U32> offsets;
+		ArrayList<U32> sizes;
+		// コンポーネントの番号から列の番号への変換(持っていない場合は－１)
+		S32 columns[MAX_COMPONENT_TYPES];
+		U32 capacity = 0;
+		ArrayList<UPtr<EntityChunk>> chunks;
+		// コンポーネントを追加、削除したときの移動先
+		HashMap<U32, Archetype*> addEdges;
+		HashMap<U32, Archetype*> removeEdges;
+
+		inline S32 GetColumn(const U32 componentId)const
+		{
+			return componentId < MAX_COMPONENT_TYPES ? columns[componentId] : -1;
+		}
+
+		inline Byte* GetData(EntityChunk* chunk, const U32 column, const U32 row)const
+		{
+			return chunk->data + offsets[column] + (size_t)sizes[column] * row;
+		}
+	};
+}
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	struct ComponentInfo
+	{
+		std::string name;
+		size_t size;
+		size_t alignment;
+	};
+
+	std::mutex s_componentMutex;
+	ArrayList<ComponentInfo> s_components;
+
+	// EntityCommandBufferのコマンドの種類
+	const U8 COMMAND_CREATE = 0;
+	const U8 COMMAND_DESTROY = 1;
+	const U8 COMMAND_ADD = 2;
+	const U8 COMMAND_REMOVE = 3;
+	const U8 COMMAND_SET = 4;
+
+	// EntityCommandBuffer::CreateEntityで返す仮のエンティティの番号に立てるbit
+	const U32 DEFERRED_BIT = 1u << 31;
+
+	struct CommandHeader
+	{
+		U8 type;
+		U32 componentId;
+		Entity entity;
+		// 続く値のサイズ(8の倍数に切り上げて格納する)
+		U32 size;
+	};
+
+	inline size_t AlignUp(const size_t value, const size_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	/// <summary>
+	/// チャンク内の配置を求める
+	/// </summary>
+	/// <returns>　０：成功\n－１：1エンティティ分もチャンクに収まらない</returns>
+	S32 BuildLayout(Archetype& archetype)
+	{
+		size_t entitySize = sizeof(Entity);
+		size_t padding = 0;
+		for (U32 id : archetype.componentIds)
+		{
+			entitySize += ComponentType::GetSize(id);
+			padding += ComponentType::GetAlignment(id);
+		}
+
+		if (EntityChunk::SIZE < padding + entitySize)return -1;
+
+		// 配列の先頭を揃えるための余白を見込んで容量を決め、収まらなければ減らす
+		U32 capacity = (U32)((EntityChunk::SIZE - padding) / entitySize);
+		for (; 0 < capacity; capacity--)
+		{
+			archetype.offsets.clear();
+			archetype.sizes.clear();
+
+			size_t offset = sizeof(Entity) * capacity;
+			for (U32 id : archetype.componentIds)
+			{
+				offset = AlignUp(offset, ComponentType::GetAlignment(id));
+				archetype.offsets.push_back((U32)offset);
+				archetype.sizes.push_back((U32)ComponentType::GetSize(id));
+				offset += ComponentType::GetSize(id) * capacity;
+			}
+			if (offset <= EntityChunk::SIZE)break;
+		}
+
+		archetype.capacity = capacity;
+		return capacity == 0 ? -1 : 0;
+	}
+}
+
+namespace CommonLibrary
+{
+	//===================================================================================//
+	// ComponentType
+	//===================================================================================//
+
+	U32 ComponentType::Register(const char* name, const size_t size, const size_t alignment)
+	{
+		std::lock_guard<std::mutex> lock(s_componentMutex);
+
+		for (size_t i = 0; i < s_components.size(); i++)
+		{
+			if (s_components[i].name == name)return (U32)i;
+		}
+		if (MAX_COMPONENT_TYPES <= s_components.size())return MAX_COMPONENT_TYPES;
+
+		ComponentInfo info = { name, size, alignment };
+		s_components.push_back(info);
+		return (U32)s_components.size() - 1;
+	}
+
+	size_t ComponentType::GetSize(const U32 id)
+	{
+		std::lock_guard<std::mutex> lock(s_componentMutex);
+		return id < s_components.size() ? s_components[id].size : 0;
+	}
+
+	size_t ComponentType::GetAlignment(const U32 id)
+	{
+		std::lock_guard<std::mutex> lock(s_componentMutex);
+		return id < s_components.size() ? s_components[id].alignment : 1;
+	}
+
+	//===================================================================================//
+	// ChunkView
+	//===================================================================================//
+
+	ChunkView::ChunkView(Archetype* archetype, EntityChunk* chunk, const U32 version) :m_archetype(archetype), m_chunk(chunk), m_version(version)
+	{
+	}
+
+	U32 ChunkView::GetCount()const
+	{
+		return m_chunk->count;
+	}
+
+	const Entity* ChunkView::GetEntities()const
+	{
+		return m_chunk->GetEntities();
+	}
+
+	bool ChunkView::Has(const U32 componentId)const
+	{
+		return 0 <= m_archetype->GetColumn(componentId);
+	}
+
+	const void* ChunkView::Read(const U32 componentId)const
+	{
+		S32 column = m_archetype->GetColumn(componentId);
+		if (column < 0)return nullptr;
+		return m_archetype->GetData(m_chunk, column, 0);
+	}
+
+	void* ChunkView::Write(const U32 componentId)
+	{
+		S32 column = m_archetype->GetColumn(componentId);
+		if (column < 0)return nullptr;
+		m_chunk->versions[column] = m_version;
+		return m_archetype->GetData(m_chunk, column, 0);
+	}
+
+	bool ChunkView::IsChanged(const U32 componentId, const U32 version)const
+	{
+		S32 column = m_archetype->GetColumn(componentId);
+		if (column < 0)return false;
+		return version < m_chunk->versions[column];
+	}
+
+	//===================================================================================//
+	// World
+	//===================================================================================//
+
+	World::World() :m_entityCount(0), m_version(0)
+	{
+	}
+
+	World::~World()
+	{
+	}
+
+	Entity World::CreateEntity(const ComponentMask& mask)
+	{
+		Archetype* archetype = GetArchetype(mask);
+		if (archetype == nullptr)return Entity();
+
+		U32 index;
+		if (!m_freeRecords.empty())
+		{
+			index = m_freeRecords.back();
+			m_freeRecords.pop_back();
+		}
+		else
+		{
+			index = (U32)m_records.size();
+			m_records.push_back(EntityRecord());
+		}
+
+		Entity entity;
+		entity.index = index;
+		entity.generation = m_records[index].generation;
+
+		// 末尾のチャンクに空きが無ければ追加する
+		if (archetype->chunks.empty() || archetype->chunks.back()->count == archetype->capacity)
+		{
+			archetype->chunks.push_back(std::make_unique<EntityChunk>(archetype->componentIds.size(), m_version + 1));
+		}
+
+		U32 chunkIndex = (U32)archetype->chunks.size() - 1;
+		EntityChunk* chunk = archetype->chunks.back().get();
+		U32 row = chunk->count++;
+
+		chunk->GetEntities()[row] = entity;
+		for (U32 column = 0; column < archetype->componentIds.size(); column++)
+		{
+			memset(archetype->GetData(chunk, column, row), 0, archetype->sizes[column]);
+			chunk->versions[column] = m_version + 1;
+		}
+
+		EntityRecord& record = m_records[index];
+		record.archetype = archetype;
+		record.chunk = chunkIndex;
+		record.row = row;
+
+		m_entityCount++;
+		return entity;
+	}
+
+	S32 World::DestroyEntity(const Entity entity)
+	{
+		if (!IsAlive(entity))return -1;
+
+		EntityRecord& record = m_records[entity.index];
+		RemoveRow(record.archetype, record.chunk, record.row);
+
+		record.archetype = nullptr;
+		record.generation++;
+		// 世代が0に戻ると無効なエンティティと区別できないため飛ばす
+		if (record.generation == 0)record.generation = 1;
+		m_freeRecords.push_back(entity.index);
+
+		m_entityCount--;
+		return 0;
+	}
+
+	bool World::IsAlive(const Entity entity)const
+	{
+		if (m_records.size() <= entity.index)return false;
+		const EntityRecord& record = m_records[entity.index];
+		return record.archetype != nullptr && record.generation == entity.generation;
+	}
+
+	S32 World::AddComponent(const Entity entity, const U32 componentId, const void* value)
+	{
+		if (!IsAlive(entity) || ComponentType::GetSize(componentId) == 0)return -1;
+
+		Archetype* source = m_records[entity.index].archetype;
+		if (source->columns[componentId] < 0)
+		{
+			Archetype* destination;
+			auto it = source->addEdges.find(componentId);
+			if (it != source->addEdges.end())
+			{
+				destination = it->second;
+			}
+			else
+			{
+				ComponentMask mask = source->mask;
+				mask.set(componentId);
+				destination = GetArchetype(mask);
+				if (destination == nullptr)return -1;
+				source->addEdges[componentId] = destination;
+			}
+			if (MoveEntity(entity, destination) != 0)return -1;
+		}
+
+		if (value != nullptr)return SetComponent(entity, componentId, value);
+
+		// 既に持っていた場合も前の値を残さず0にする
+		memset(GetComponentPointer(entity, componentId, true), 0, ComponentType::GetSize(componentId));
+		return 0;
+	}
+
+	S32 World::RemoveComponent(const Entity entity, const U32 componentId)
+	{
+		if (!HasComponent(entity, componentId))return -1;
+
+		Archetype* source = m_records[entity.index].archetype;
+		Archetype* destination;
+		auto it = source->removeEdges.find(componentId);
+		if (it != source->removeEdges.end())
+		{
+			destination = it->second;
+		}
+		else
+		{
+			ComponentMask mask = source->mask;
+			mask.reset(componentId);
+			destination = GetArchetype(mask);
+			if (destination == nullptr)return -1;
+			source->removeEdges[componentId] = destination;
+		}
+		return MoveEntity(entity, destination);
+	}
+
+	S32 World::SetComponent(const Entity entity, const U32 componentId, const void* value)
+	{
+		if (value == nullptr || !IsAlive(entity))return -1;
+
+		const EntityRecord& record = m_records[entity.index];
+		S32 column = record.archetype->GetColumn(componentId);
+		if (column < 0)return -1;
+
+		memcpy(GetComponentPointer(entity, componentId, true), value, record.archetype->sizes[column]);
+		return 0;
+	}
+
+	bool World::HasComponent(const Entity entity, const U32 componentId)const
+	{
+		if (!IsAlive(entity))return false;
+		return 0 <= m_records[entity.index].archetype->GetColumn(componentId);
+	}
+
+	const void* World::GetComponent(const Entity entity, const U32 componentId)const
+	{
+		return const_cast<World*>(this)->GetComponentPointer(entity, componentId, false);
+	}
+
+	void World::ForEach(const EntityQuery& query, const std::function<void(ChunkView& chunk)>& function)
+	{
+		ArrayList<std::pair<Archetype*, EntityChunk*>> chunks;
+		CollectChunks(query, chunks);
+
+		const U32 version = ++m_version;
+		for (auto& pair : chunks)
+		{
+			ChunkView view(pair.first, pair.second, version);
+			function(view);
+		}
+	}
+
+	void World::ParallelForEach(const EntityQuery& query, const std::function<void(ChunkView& chunk)>& function)
+	{
+		ArrayList<std::pair<Archetype*, EntityChunk*>> chunks;
+		CollectChunks(query, chunks);
+
+		const U32 version = ++m_version;
+		Parallel::For(chunks.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					ChunkView view(chunks[i].first, chunks[i].second, version);
+					function(view);
+				}
+			});
+	}
+
+	U32 World::Count(const EntityQuery& query)const
+	{
+		ArrayList<std::pair<Archetype*, EntityChunk*>> chunks;
+		CollectChunks(query, chunks);
+
+		U32 count = 0;
+		for (auto& pair : chunks)count += pair.second->count;
+		return count;
+	}
+
+	Archetype* World::GetArchetype(const ComponentMask& mask)
+	{
+		auto it = m_archetypeMap.find(mask);
+		if (it != m_archetypeMap.end())return it->second;
+
+		auto archetype = std::make_unique<Archetype>();
+		archetype->mask = mask;
+		for (U32 id = 0; id < MAX_COMPONENT_TYPES; id++)
+		{
+			archetype->columns[id] = -1;
+			if (!mask.test(id))continue;
+
+			archetype->columns[id] = (S32)archetype->componentIds.size();
+			archetype->componentIds.push_back(id);
+		}
+		if (BuildLayout(*archetype) != 0)return nullptr;
+
+		Archetype* result = archetype.get();
+		m_archetypes.push_back(std::move(archetype));
+		m_archetypeMap[mask] = result;
+		return result;
+	}
+
+	S32 World::MoveEntity(const Entity entity, Archetype* destination)
+	{
+		EntityRecord& record = m_records[entity.index];
+		Archetype* source = record.archetype;
+		EntityChunk* sourceChunk = source->chunks[record.chunk].get();
+
+		if (destination->chunks.empty() || destination->chunks.back()->count == destination->capacity)
+		{
+			destination->chunks.push_back(std::make_unique<EntityChunk>(destination->componentIds.size(), m_version + 1));
+		}
+
+		U32 chunkIndex = (U32)destination->chunks.size() - 1;
+		EntityChunk* chunk = destination->chunks.back().get();
+		U32 row = chunk->count++;
+
+		// 共通するコンポーネントはコピーし、新しいコンポーネントは0で初期化する
+		chunk->GetEntities()[row] = entity;
+		for (U32 column = 0; column < destination->componentIds.size(); column++)
+		{
+			Byte* dest = destination->GetData(chunk, column, row);
+			S32 sourceColumn = source->GetColumn(destination->componentIds[column]);
+			if (0 <= sourceColumn)
+			{
+				memcpy(dest, source->GetData(sourceChunk, sourceColumn, record.row), destination->sizes[column]);
+			}
+			else
+			{
+				memset(dest, 0, destination->sizes[column]);
+			}
+			chunk->versions[column] = m_version + 1;
+		}
+
+		RemoveRow(source, record.chunk, record.row);
+
+		record.archetype = destination;
+		record.chunk = chunkIndex;
+		record.row = row;
+		return 0;
+	}
+
+	void World::RemoveRow(Archetype* archetype, const U32 chunkIndex, const U32 row)
+	{
+		EntityChunk* chunk = archetype->chunks[chunkIndex].get();
+		EntityChunk* last = archetype->chunks.back().get();
+		U32 lastRow = last->count - 1;
+
+		// アーキタイプの末尾のエンティティで穴を埋める
+		if (chunk != last || row != lastRow)
+		{
+			Entity moved = last->GetEntities()[lastRow];
+			chunk->GetEntities()[row] = moved;
+			for (U32 column = 0; column < archetype->componentIds.size(); column++)
+			{
+				memcpy(archetype->GetData(chunk, column, row), archetype->GetData(last, column, lastRow), archetype->sizes[column]);
+				chunk->versions[column] = m_version + 1;
+			}
+
+			EntityRecord& record = m_records[moved.index];
+			record.chunk = chunkIndex;
+			record.row = row;
+		}
+
+		last->count--;
+		if (last->count == 0)archetype->chunks.pop_back();
+	}
+
+	void* World::GetComponentPointer(const Entity entity, const U32 componentId, const bool write)
+	{
+		if (!IsAlive(entity))return nullptr;
+
+		const EntityRecord& record = m_records[entity.index];
+		S32 column = record.archetype->GetColumn(componentId);
+		if (column < 0)return nullptr;
+
+		EntityChunk* chunk = record.archetype->chunks[record.chunk].get();
+		if (write)chunk->versions[column] = m_version + 1;
+		return record.archetype->GetData(chunk, column, record.row);
+	}
+
+	void World::CollectChunks(const EntityQuery& query, ArrayList<std::pair<Archetype*, EntityChunk*>>& dest)const
+	{
+		for (auto& archetype : m_archetypes)
+		{
+			if ((archetype->mask & query.all) != query.all)continue;
+			if ((archetype->mask & query.none).any())continue;
+
+			ArrayList<S32> changedColumns;
+			if (query.changed.any())
+			{
+				for (U32 id : archetype->componentIds)
+				{
+					if (query.changed.test(id))changedColumns.push_back(archetype->columns[id]);
+				}
+				if (changedColumns.empty())continue;
+			}
+
+			for (auto& chunk : archetype->chunks)
+			{
+				if (!changedColumns.empty())
+				{
+					bool changed = false;
+					for (S32 column : changedColumns)changed |= query.changedSince < chunk->versions[column];
+					if (!changed)continue;
+				}
+				dest.push_back(std::make_pair(archetype.get(), chunk.get()));
+			}
+		}
+	}
+
+	//===================================================================================//
+	// EntityCommandBuffer
+	//===================================================================================//
+
+	EntityCommandBuffer::EntityCommandBuffer() :m_createdCount(0)
+	{
+	}
+
+	Entity EntityCommandBuffer::CreateEntity()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		Entity entity;
+		entity.index = DEFERRED_BIT | m_createdCount++;
+		Record(COMMAND_CREATE, entity, 0, nullptr, 0);
+		return entity;
+	}
+
+	void EntityCommandBuffer::DestroyEntity(const Entity entity)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Record(COMMAND_DESTROY, entity, 0, nullptr, 0);
+	}
+
+	void EntityCommandBuffer::AddComponent(const Entity entity, const U32 componentId, const void* value)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Record(COMMAND_ADD, entity, componentId, value, value != nullptr ? ComponentType::GetSize(componentId) : 0);
+	}
+
+	void EntityCommandBuffer::RemoveComponent(const Entity entity, const U32 componentId)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Record(COMMAND_REMOVE, entity, componentId, nullptr, 0);
+	}
+
+	void EntityCommandBuffer::SetComponent(const Entity entity, const U32 componentId, const void* value)
+	{
+		if (value == nullptr)return;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Record(COMMAND_SET, entity, componentId, value, ComponentType::GetSize(componentId));
+	}
+
+	bool EntityCommandBuffer::IsEmpty()const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_commands.empty();
+	}
+
+	void EntityCommandBuffer::Clear()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_commands.clear();
+		m_createdCount = 0;
+	}
+
+	S32 EntityCommandBuffer::Playback(World& world)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// 仮のエンティティから生成したエンティティへの変換
+		ArrayList<Entity> created;
+		created.reserve(m_createdCount);
+
+		S32 result = 0;
+		size_t position = 0;
+		while (position < m_commands.size())
+		{
+			CommandHeader header;
+			memcpy(&header, &m_commands[position], sizeof(header));
+			position += AlignUp(sizeof(header), 8);
+			const void* value = header.size != 0 ? &m_commands[position] : nullptr;
+			position += AlignUp(header.size, 8);
+
+			Entity entity = header.entity;
+			if (entity.index & DEFERRED_BIT)
+			{
+				U32 local = entity.index & ~DEFERRED_BIT;
+				entity = local < created.size() ? created[local] : Entity();
+			}
+
+			S32 ret = 0;
+			switch (header.type)
+			{
+			case COMMAND_CREATE:
+				created.push_back(world.CreateEntity());
+				break;
+			case COMMAND_DESTROY:
+				ret = world.DestroyEntity(entity);
+				break;
+			case COMMAND_ADD:
+				ret = world.AddComponent(entity, header.componentId, value);
+				break;
+			case COMMAND_REMOVE:
+				ret = world.RemoveComponent(entity, header.componentId);
+				break;
+			case COMMAND_SET:
+				ret = world.SetComponent(entity, header.componentId, value);
+				break;
+			}
+			if (ret != 0)result = -1;
+		}
+
+		m_commands.clear();
+		m_createdCount = 0;
+		return result;
+	}
+
+	void EntityCommandBuffer::Record(const U8 type, const Entity entity, const U32 componentId, const void* value, const size_t size)
+	{
+		CommandHeader header;
+		header.type = type;
+		header.componentId = componentId;
+		header.entity = entity;
+		header.size = (U32)size;
+
+		size_t position = m_commands.size();
+		m_commands.resize(position + AlignUp(sizeof(header), 8) + AlignUp(size, 8));
+		memcpy(&m_commands[position], &header, sizeof(header));
+		if (size != 0)memcpy(&m_commands[position + AlignUp(sizeof(header), 8)], value, size);
+	}
+}
\ No newline at end of file
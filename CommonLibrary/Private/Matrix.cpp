@@ -162,24 +162,66 @@ namespace CommonLibrary
 
 	F32 Matrix::Determinant()
 	{
-		F32 ret = 0;
-		for (S32 i = 0; i < ROW; i++)
-		{
-			F32 tmp = 1;
-			F32 tmp2 = 1;
-			for (S32 j = 0; j < COL; j++)
-			{
-				tmp *= m[(i + j) % COL][j];
-				tmp2 *= m[(i + j) % COL][COL - j - 1];
-			}
-			ret += tmp - tmp2;
-		}
-		return ret;
+		// 上2行と下2行の2x2小行列式によるラプラス展開
+		const F32 s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+		const F32 s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+		const F32 s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+		const F32 s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+		const F32 s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+		const F32 s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+		const F32 c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+		const F32 c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+		const F32 c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+		const F32 c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+		const F32 c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+		const F32 c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+		return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
 	}
 
 	Matrix Matrix::Inverted()
 	{
+		const F32 s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+		const F32 s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+		const F32 s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+		const F32 s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+		const F32 s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+		const F32 s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+		const F32 c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+		const F32 c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+		const F32 c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+		const F32 c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+		const F32 c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+		const F32 c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+		const F32 det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+
+		// 逆行列が存在しない場合は単位行列を返す
 		Matrix ret;
+		if (det == 0.0f)return ret;
+		const F32 inv = 1.0f / det;
+
+		ret.m[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * inv;
+		ret.m[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * inv;
+		ret.m[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * inv;
+		ret.m[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * inv;
+
+		ret.m[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * inv;
+		ret.m[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * inv;
+		ret.m[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * inv;
+		ret.m[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * inv;
+
+		ret.m[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * inv;
+		ret.m[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * inv;
+		ret.m[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * inv;
+		ret.m[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * inv;
+
+		ret.m[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * inv;
+		ret.m[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * inv;
+		ret.m[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * inv;
+		ret.m[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * inv;
 		return ret;
 	}
 
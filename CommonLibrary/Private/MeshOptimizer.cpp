@@ -0,0 +1,644 @@
+﻿#include "pch.h"
+#include "MeshOptimizer.h"
+#include "Check.h"
+#include "Mathf.h"
+#include "Parallel.h"
+#include "Vector3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	// Forsythの手法で模擬するLRUキャッシュの大きさ
+	const U32 MAX_CACHE_SIZE = 32;
+
+	// スコアの計算に使う値(Forsythの論文の推奨値)
+	const F32 CACHE_DECAY_POWER = 1.5f;
+	const F32 LAST_TRIANGLE_SCORE = 0.75f;
+	const F32 VALENCE_BOOST_SCALE = 2.0f;
+	const F32 VALENCE_BOOST_POWER = 0.5f;
+
+	// 未処理の三角形の数によるスコアを表にする上限
+	const U32 MAX_VALENCE = 64;
+
+	// オーバードローの最適化で塊を分けるのに使うFIFOキャッシュの大きさ
+	const U32 OVERDRAW_CACHE_SIZE = 16;
+
+	const U32 INVALID_TRIANGLE = ~0u;
+
+	// 頂点の統合で重複を検出する区画の数(ハッシュ値の下位ビットで分ける)
+	const U32 WELD_PARTITION_BITS = 6;
+	const U32 WELD_PARTITION_COUNT = 1u << WELD_PARTITION_BITS;
+
+	// 頂点の統合で1回の並列処理に渡す頂点数
+	const size_t WELD_GRAIN_SIZE = 4096;
+
+	/// <summary>
+	/// キャッシュ内の位置と未処理の三角形の数から頂点のスコアを求める表
+	/// </summary>
+	struct ScoreTable
+	{
+		F32 cache[MAX_CACHE_SIZE];
+		F32 valence[MAX_VALENCE];
+
+		ScoreTable()
+		{
+			for (U32 i = 0; i < MAX_CACHE_SIZE; i++)
+			{
+				if (i < 3)
+				{
+					// 直前の三角形の頂点は、同じ三角形を続けて選ばないように固定の値にする
+					cache[i] = LAST_TRIANGLE_SCORE;
+				}
+				else
+				{
+					const F32 scale = 1.0f / (MAX_CACHE_SIZE - 3);
+					cache[i] = Mathf::Pow(1.0f - (i - 3) * scale, CACHE_DECAY_POWER);
+				}
+			}
+			valence[0] = 0.0f;
+			for (U32 i = 1; i < MAX_VALENCE; i++)
+			{
+				valence[i] = VALENCE_BOOST_SCALE * Mathf::Pow((F32)i, -VALENCE_BOOST_POWER);
+			}
+		}
+
+		inline F32 Score(const S32 position, const U32 liveCount)const
+		{
+			if (liveCount == 0)return 0.0f;
+			F32 score = valence[liveCount < MAX_VALENCE ? liveCount : MAX_VALENCE - 1];
+			if (0 <= position)score += cache[position];
+			return score;
+		}
+	};
+
+	inline bool IsValidIndices(const U32* indices, const U32 indexCount, const U32 vertexCount)
+	{
+		for (U32 i = 0; i < indexCount; i++)
+		{
+			if (vertexCount <= indices[i])return false;
+		}
+		return true;
+	}
+
+	inline Vector3 LoadPosition(const Byte* vertices, const U32 stride, const U32 positionOffset, const U32 index)
+	{
+		F32 position[3];
+		memcpy(position, vertices + (size_t)index * stride + positionOffset, sizeof(position));
+		return Vector3(position[0], position[1], position[2]);
+	}
+
+	/// <summary>
+	/// タイムスタンプで模擬するFIFOキャッシュ
+	/// </summary>
+	/// <remarks>
+	/// 頂点がキャッシュに入った時刻を記録し、その後のミスの回数がキャッシュの大きさ以上なら追い出されたとみなす。
+	/// </remarks>
+	struct FifoCache
+	{
+		ArrayList<U32> timestamps;
+		U32 time;
+		U32 size;
+
+		FifoCache(const U32 vertexCount, const U32 cacheSize) :timestamps(vertexCount, 0), time(cacheSize + 1), size(cacheSize) {}
+
+		/// <summary>
+		/// 頂点を参照する
+		/// </summary>
+		/// <returns>ミスしたか</returns>
+		inline bool Access(const U32 vertex)
+		{
+			if (time - timestamps[vertex] <= size)return false;
+			timestamps[vertex] = time++;
+			return true;
+		}
+
+		inline U32 AccessTriangle(const U32* triangle)
+		{
+			return (U32)Access(triangle[0]) + (U32)Access(triangle[1]) + (U32)Access(triangle[2]);
+		}
+
+		/// <summary>
+		/// 全ての頂点を追い出す
+		/// </summary>
+		inline void Flush()
+		{
+			time += size + 1;
+		}
+	};
+
+	/// <summary>
+	/// 三角形の塊の境界(塊の先頭の三角形の番号)を求める
+	/// </summary>
+	/// <remarks>
+	/// 3頂点ともキャッシュにない三角形でキャッシュが実質リセットされるため、そこで塊を分ける。
+	/// さらに塊ごとのACMRを求め、先頭からのACMRがその threshold 倍以下になった位置で細かく分ける。
+	/// 分けた位置ではキャッシュを空にして数えるので、塊をどの順に並べてもACMRの悪化は threshold 倍程度に収まる。
+	/// </remarks>
+	void FindClusters(const U32* indices, const U32 triangleCount, const U32 vertexCount, const F32 threshold, ArrayList<U32>& clusters)
+	{
+		ArrayList<U32> hardBoundaries;
+		{
+			FifoCache cache(vertexCount, OVERDRAW_CACHE_SIZE);
+			for (U32 i = 0; i < triangleCount; i++)
+			{
+				if (cache.AccessTriangle(indices + i * 3) == 3)hardBoundaries.push_back(i);
+			}
+		}
+		if (hardBoundaries.empty() || hardBoundaries[0] != 0)hardBoundaries.insert(hardBoundaries.begin(), 0);
+
+		clusters.clear();
+		FifoCache cache(vertexCount, OVERDRAW_CACHE_SIZE);
+		for (size_t c = 0; c < hardBoundaries.size(); c++)
+		{
+			const U32 start = hardBoundaries[c];
+			const U32 end = c + 1 < hardBoundaries.size() ? hardBoundaries[c + 1] : triangleCount;
+
+			cache.Flush();
+			U32 clusterMisses = 0;
+			for (U32 i = start; i < end; i++)clusterMisses += cache.AccessTriangle(indices + i * 3);
+			const F32 target = threshold * clusterMisses / (end - start);
+
+			cache.Flush();
+			clusters.push_back(start);
+			U32 runningMisses = 0;
+			U32 runningTriangles = 0;
+			for (U32 i = start; i < end; i++)
+			{
+				runningMisses += cache.AccessTriangle(indices + i * 3);
+				runningTriangles++;
+				if (i + 1 < end && runningMisses <= target * runningTriangles)
+				{
+					clusters.push_back(i + 1);
+					cache.Flush();
+					runningMisses = 0;
+					runningTriangles = 0;
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// バイト列のハッシュ値(4バイト単位のFNV-1aに最後にビットを撹拌したもの)
+	/// </summary>
+	inline U64 HashBytes(const Byte* data, const U32 size)
+	{
+		U64 hash = 14695981039346656037ull;
+		U32 i = 0;
+		for (; i + 4 <= size; i += 4)
+		{
+			U32 word;
+			memcpy(&word, data + i, sizeof(word));
+			hash = (hash ^ word) * 1099511628211ull;
+		}
+		for (; i < size; i++)hash = (hash ^ data[i]) * 1099511628211ull;
+
+		hash ^= hash >> 33;
+		hash *= 0xff51afd7ed558ccdull;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	/// <summary>
+	/// 比較用に頂点のF32の範囲を丸めたバイト列を作る
+	/// </summary>
+	inline void QuantizeVertex(Byte* destination, const Byte* vertex, const U32 stride, const VertexWeldSettings& settings)
+	{
+		memcpy(destination, vertex, stride);
+		const F64 scale = 1.0 / settings.epsilon;
+		for (U32 i = 0; i < settings.quantizeCount; i++)
+		{
+			const U32 offset = settings.quantizeOffset + i * sizeof(F32);
+			F32 value;
+			memcpy(&value, vertex + offset, sizeof(value));
+			// NaNは0とし、範囲外の値はS32に収まるように丸めてから変換する
+			F64 step = std::floor(value * scale + 0.5);
+			if (step != step)step = 0.0;
+			step = step < -2147483648.0 ? -2147483648.0 : 2147483647.0 < step ? 2147483647.0 : step;
+			const S32 quantized = (S32)step;
+			memcpy(destination + offset, &quantized, sizeof(quantized));
+		}
+	}
+
+	struct ClusterKey
+	{
+		F32 key;
+		U32 cluster;
+
+		inline bool operator<(const ClusterKey& other)const
+		{
+			// 外側を向いている塊ほど先に描画する。同じ値の場合は元の順序を保つ
+			if (key != other.key)return other.key < key;
+			return cluster < other.cluster;
+		}
+	};
+}
+
+namespace CommonLibrary
+{
+	//===================================================================================//
+
+	S32 MeshOptimizer::OptimizeVertexCache(U32* destination, const U32* indices, const U32 indexCount, const U32 vertexCount)
+	{
+		if (indexCount == 0)return 0;
+		if (CheckArgs(destination, indices))return -1;
+		if (indexCount % 3 != 0)return -1;
+		if (!IsValidIndices(indices, indexCount, vertexCount))return -1;
+
+		static const ScoreTable table;
+
+		const U32 triangleCount = indexCount / 3;
+		// destinationとindicesが同じ場合に備えて複製する
+		ArrayList<U32> source(indices, indices + indexCount);
+
+		// 頂点ごとの未処理の三角形の一覧。[offsets[v], offsets[v] + liveCounts[v]) が未処理
+		ArrayList<U32> liveCounts(vertexCount, 0);
+		for (U32 i = 0; i < indexCount; i++)liveCounts[source[i]]++;
+		ArrayList<U32> offsets(vertexCount + 1, 0);
+		for (U32 v = 0; v < vertexCount; v++)offsets[v + 1] = offsets[v] + liveCounts[v];
+		ArrayList<U32> adjacency(indexCount);
+		{
+			ArrayList<U32> fill(offsets.begin(), offsets.end() - 1);
+			for (U32 i = 0; i < indexCount; i++)adjacency[fill[source[i]]++] = i / 3;
+		}
+
+		ArrayList<S32> cachePositions(vertexCount, -1);
+		ArrayList<F32> vertexScores(vertexCount);
+		for (U32 v = 0; v < vertexCount; v++)vertexScores[v] = table.Score(-1, liveCounts[v]);
+
+		ArrayList<F32> triangleScores(triangleCount);
+		U32 best = 0;
+		for (U32 t = 0; t < triangleCount; t++)
+		{
+			const U32* triangle = &source[t * 3];
+			triangleScores[t] = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+			if (triangleScores[best] < triangleScores[t])best = t;
+		}
+
+		ArrayList<U8> emitted(triangleCount, 0);
+		U32 cache[MAX_CACHE_SIZE + 3];
+		U32 cacheCount = 0;
+		U32 cursor = 0;
+
+		for (U32 output = 0; output < triangleCount; output++)
+		{
+			// キャッシュ内の頂点から続く三角形が無い場合は、未処理の三角形を先頭から探す
+			if (best == INVALID_TRIANGLE)
+			{
+				while (emitted[cursor])cursor++;
+				best = cursor;
+			}
+
+			const U32* triangle = &source[best * 3];
+			destination[output * 3 + 0] = triangle[0];
+			destination[output * 3 + 1] = triangle[1];
+			destination[output * 3 + 2] = triangle[2];
+			emitted[best] = 1;
+
+			U32 newCache[MAX_CACHE_SIZE + 3];
+			U32 newCacheCount = 0;
+			for (U32 k = 0; k < 3; k++)
+			{
+				const U32 v = triangle[k];
+
+				// 未処理の一覧から取り除く
+				U32* list = &adjacency[offsets[v]];
+				const U32 count = liveCounts[v];
+				for (U32 i = 0; i < count; i++)
+				{
+					if (list[i] == best)
+					{
+						list[i] = list[count - 1];
+						liveCounts[v]--;
+						break;
+					}
+				}
+
+				bool isDuplicated = false;
+				for (U32 i = 0; i < newCacheCount; i++)isDuplicated |= newCache[i] == v;
+				if (!isDuplicated)newCache[newCacheCount++] = v;
+			}
+			for (U32 i = 0; i < cacheCount; i++)
+			{
+				const U32 v = cache[i];
+				if (v != triangle[0] && v != triangle[1] && v != triangle[2])newCache[newCacheCount++] = v;
+			}
+
+			// キャッシュ内の頂点のスコアを更新し、その頂点を使う三角形から次の三角形を選ぶ
+			best = INVALID_TRIANGLE;
+			F32 bestScore = -1.0f;
+			for (U32 i = 0; i < newCacheCount; i++)
+			{
+				const U32 v = newCache[i];
+				const S32 position = i < MAX_CACHE_SIZE ? (S32)i : -1;
+				cachePositions[v] = position;
+
+				const F32 score = table.Score(position, liveCounts[v]);
+				const F32 delta = score - vertexScores[v];
+				vertexScores[v] = score;
+
+				const U32* list = &adjacency[offsets[v]];
+				for (U32 j = 0; j < liveCounts[v]; j++)
+				{
+					const U32 t = list[j];
+					triangleScores[t] += delta;
+					if (bestScore < triangleScores[t])
+					{
+						bestScore = triangleScores[t];
+						best = t;
+					}
+				}
+			}
+
+			cacheCount = newCacheCount < MAX_CACHE_SIZE ? newCacheCount : MAX_CACHE_SIZE;
+			memcpy(cache, newCache, cacheCount * sizeof(U32));
+		}
+
+		return 0;
+	}
+
+	//===================================================================================//
+
+	S32 MeshOptimizer::OptimizeOverdraw(U32* destination, const U32* indices, const U32 indexCount, const Byte* vertices, const U32 vertexCount, const U32 stride, const U32 positionOffset, const F32 threshold)
+	{
+		if (indexCount % 3 != 0 || stride < positionOffset + sizeof(F32) * 3)return -1;
+		if (indexCount == 0)return 0;
+		if (CheckArgs(destination, indices, vertices))return -1;
+		if (!IsValidIndices(indices, indexCount, vertexCount))return -1;
+
+		const U32 triangleCount = indexCount / 3;
+		ArrayList<U32> source(indices, indices + indexCount);
+
+		ArrayList<U32> clusters;
+		FindClusters(source.data(), triangleCount, vertexCount, threshold, clusters);
+		const U32 clusterCount = (U32)clusters.size();
+
+		// 塊ごとの面積で重み付けした中心と法線
+		ArrayList<Vector3> centroids(clusterCount);
+		ArrayList<Vector3> normals(clusterCount);
+		Vector3 meshCentroid;
+		F32 meshArea = 0.0f;
+		for (U32 c = 0; c < clusterCount; c++)
+		{
+			const U32 end = c + 1 < clusterCount ? clusters[c + 1] : triangleCount;
+			Vector3 centroid;
+			Vector3 normal;
+			F32 area = 0.0f;
+			for (U32 t = clusters[c]; t < end; t++)
+			{
+				const Vector3 p0 = LoadPosition(vertices, stride, positionOffset, source[t * 3 + 0]);
+				const Vector3 p1 = LoadPosition(vertices, stride, positionOffset, source[t * 3 + 1]);
+				const Vector3 p2 = LoadPosition(vertices, stride, positionOffset, source[t * 3 + 2]);
+				const Vector3 n = Vector3::Cross(p1 - p0, p2 - p0);
+				const F32 a = n.Length();
+				centroid += (p0 + p1 + p2) * (a / 3.0f);
+				normal += n;
+				area += a;
+			}
+			meshCentroid += centroid;
+			meshArea += area;
+
+			centroids[c] = 0.0f < area ? centroid / area : centroid;
+			const F32 length = normal.Length();
+			normals[c] = 0.0f < length ? normal / length : normal;
+		}
+		if (0.0f < meshArea)meshCentroid = meshCentroid / meshArea;
+
+		ArrayList<ClusterKey> keys(clusterCount);
+		for (U32 c = 0; c < clusterCount; c++)
+		{
+			keys[c].key = Vector3::Dot(centroids[c] - meshCentroid, normals[c]);
+			keys[c].cluster = c;
+		}
+		std::sort(keys.begin(), keys.end());
+
+		U32 output = 0;
+		for (const auto& key : keys)
+		{
+			const U32 c = key.cluster;
+			const U32 start = clusters[c] * 3;
+			const U32 end = (c + 1 < clusterCount ? clusters[c + 1] : triangleCount) * 3;
+			memcpy(destination + output, &source[start], (end - start) * sizeof(U32));
+			output += end - start;
+		}
+
+		return 0;
+	}
+
+	//===================================================================================//
+
+	S32 MeshOptimizer::OptimizeVertexFetch(Byte* destination, U32* indices, const U32 indexCount, const Byte* vertices, const U32 vertexCount, const U32 stride)
+	{
+		if (stride == 0)return -1;
+		if (indexCount == 0)return 0;
+		if (CheckArgs(destination, indices, vertices))return -1;
+		if (destination == vertices)return -1;
+		if (!IsValidIndices(indices, indexCount, vertexCount))return -1;
+
+		ArrayList<U32> remap(vertexCount, ~0u);
+		U32 next = 0;
+		for (U32 i = 0; i < indexCount; i++)
+		{
+			const U32 v = indices[i];
+			if (remap[v] == ~0u)
+			{
+				memcpy(destination + (size_t)next * stride, vertices + (size_t)v * stride, stride);
+				remap[v] = next++;
+			}
+			indices[i] = remap[v];
+		}
+
+		return (S32)next;
+	}
+
+	//===================================================================================//
+
+	S32 MeshOptimizer::GenerateVertexRemap(U32* remap, const Byte* vertices, const U32 vertexCount, const U32 stride, const VertexWeldSettings& settings)
+	{
+		if (stride == 0)return -1;
+		if (vertexCount == 0)return 0;
+		if (CheckArgs(remap, vertices))return -1;
+		const bool isQuantized = 0 < settings.quantizeCount;
+		if (isQuantized && (settings.epsilon <= 0.0f || stride < settings.quantizeOffset + settings.quantizeCount * sizeof(F32)))return -1;
+
+		// 比較に使うバイト列とハッシュ値
+		ArrayList<Byte> quantized(isQuantized ? (size_t)vertexCount * stride : 0);
+		const Byte* keys = isQuantized ? quantized.data() : vertices;
+		ArrayList<U64> hashes(vertexCount);
+		Parallel::For(vertexCount, WELD_GRAIN_SIZE, [&](const size_t begin, const size_t end)
+		{
+			for (size_t v = begin; v < end; v++)
+			{
+				if (isQuantized)QuantizeVertex(&quantized[v * stride], vertices + v * stride, stride, settings);
+				hashes[v] = HashBytes(keys + v * stride, stride);
+			}
+		});
+
+		// ハッシュ値で区画に分ける。区画内は元の頂点の順序になる
+		U32 partitionOffsets[WELD_PARTITION_COUNT + 1] = {};
+		for (U32 v = 0; v < vertexCount; v++)partitionOffsets[(hashes[v] & (WELD_PARTITION_COUNT - 1)) + 1]++;
+		for (U32 p = 0; p < WELD_PARTITION_COUNT; p++)partitionOffsets[p + 1] += partitionOffsets[p];
+		ArrayList<U32> order(vertexCount);
+		{
+			U32 fill[WELD_PARTITION_COUNT];
+			memcpy(fill, partitionOffsets, sizeof(fill));
+			for (U32 v = 0; v < vertexCount; v++)order[fill[hashes[v] & (WELD_PARTITION_COUNT - 1)]++] = v;
+		}
+
+		// 区画ごとに並列に、同じ頂点のうち最初に現れた頂点を求める
+		ArrayList<U32> firsts(vertexCount);
+		Parallel::For(WELD_PARTITION_COUNT, 1, [&](const size_t begin, const size_t end)
+		{
+			ArrayList<U32> table;
+			for (size_t p = begin; p < end; p++)
+			{
+				const U32 first = partitionOffsets[p];
+				const U32 count = partitionOffsets[p + 1] - first;
+				U32 capacity = 16;
+				while (capacity < count * 2)capacity *= 2;
+				const U32 mask = capacity - 1;
+				table.assign(capacity, ~0u);
+
+				for (U32 i = first; i < first + count; i++)
+				{
+					const U32 v = order[i];
+					const U64 hash = hashes[v];
+					U32 slot = (U32)(hash >> WELD_PARTITION_BITS) & mask;
+					firsts[v] = v;
+					while (table[slot] != ~0u)
+					{
+						const U32 other = table[slot];
+						if (hashes[other] == hash && memcmp(keys + (size_t)other * stride, keys + (size_t)v * stride, stride) == 0)
+						{
+							firsts[v] = other;
+							break;
+						}
+						slot = (slot + 1) & mask;
+					}
+					if (firsts[v] == v)table[slot] = v;
+				}
+			}
+		});
+
+		// 最初に現れた頂点から順に番号を振る。それ以外は対応する頂点の番号を使う
+		U32 uniqueCount = 0;
+		for (U32 v = 0; v < vertexCount; v++)
+		{
+			remap[v] = firsts[v] == v ? uniqueCount++ : remap[firsts[v]];
+		}
+		return (S32)uniqueCount;
+	}
+
+	//===================================================================================//
+
+	S32 MeshOptimizer::WeldVertices(ArrayList<Byte>& vertices, ArrayList<U32>& indices, const U32 stride, const VertexWeldSettings& settings)
+	{
+		if (stride == 0 || vertices.size() % stride != 0)return -1;
+		const U32 vertexCount = (U32)(vertices.size() / stride);
+		if (indices.empty() && vertexCount % 3 != 0)return -1;
+		if (!IsValidIndices(indices.data(), (U32)indices.size(), vertexCount))return -1;
+
+		ArrayList<U32> remap(vertexCount);
+		const S32 uniqueCount = GenerateVertexRemap(remap.data(), vertices.data(), vertexCount, stride, settings);
+		if (uniqueCount < 0)return -1;
+
+		ArrayList<Byte> welded((size_t)uniqueCount * stride);
+		U32 written = 0;
+		for (U32 v = 0; v < vertexCount; v++)
+		{
+			if (remap[v] != written)continue;
+			memcpy(&welded[(size_t)written * stride], &vertices[(size_t)v * stride], stride);
+			written++;
+		}
+		vertices.swap(welded);
+
+		if (indices.empty())
+		{
+			indices.swap(remap);
+		}
+		else
+		{
+			Parallel::For(indices.size(), WELD_GRAIN_SIZE, [&](const size_t begin, const size_t end)
+			{
+				for (size_t i = begin; i < end; i++)indices[i] = remap[indices[i]];
+			});
+		}
+
+		return uniqueCount;
+	}
+
+	//===================================================================================//
+
+	VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const U32* indices, const U32 indexCount, const U32 vertexCount, const U32 cacheSize)
+	{
+		VertexCacheStatistics statistics;
+		if (CheckArgs(indices))return statistics;
+		if (indexCount < 3 || cacheSize == 0)return statistics;
+		if (!IsValidIndices(indices, indexCount, vertexCount))return statistics;
+
+		FifoCache cache(vertexCount, cacheSize);
+		ArrayList<U8> used(vertexCount, 0);
+		U32 usedCount = 0;
+		for (U32 i = 0; i < indexCount; i++)
+		{
+			const U32 v = indices[i];
+			if (cache.Access(v))statistics.transformedVertexCount++;
+			if (!used[v])
+			{
+				used[v] = 1;
+				usedCount++;
+			}
+		}
+
+		statistics.acmr = (F32)statistics.transformedVertexCount / (indexCount / 3);
+		statistics.atvr = (F32)statistics.transformedVertexCount / usedCount;
+		return statistics;
+	}
+
+	//===================================================================================//
+
+	S32 MeshOptimizer::Optimize(ArrayList<Byte>& vertices, ArrayList<U32>& indices, const U32 stride, const MeshOptimizeSettings& settings, MeshOptimizeReport* report)
+	{
+		if (stride == 0 || vertices.size() % stride != 0 || indices.size() % 3 != 0)return -1;
+		if (settings.optimizeOverdraw && stride < settings.positionOffset + sizeof(F32) * 3)return -1;
+
+		const U32 vertexCount = (U32)(vertices.size() / stride);
+		const U32 indexCount = (U32)indices.size();
+		if (!IsValidIndices(indices.data(), indexCount, vertexCount))return -1;
+
+		if (report)
+		{
+			report->before = AnalyzeVertexCache(indices.data(), indexCount, vertexCount, settings.statisticsCacheSize);
+			report->vertexCountBefore = vertexCount;
+		}
+
+		U32 optimizedVertexCount = vertexCount;
+		if (0 < indexCount)
+		{
+			OptimizeVertexCache(indices.data(), indices.data(), indexCount, vertexCount);
+			if (settings.optimizeOverdraw)
+			{
+				OptimizeOverdraw(indices.data(), indices.data(), indexCount, vertices.data(), vertexCount, stride, settings.positionOffset, settings.overdrawThreshold);
+			}
+			if (settings.optimizeVertexFetch)
+			{
+				ArrayList<Byte> optimized(vertices.size());
+				optimizedVertexCount = (U32)OptimizeVertexFetch(optimized.data(), indices.data(), indexCount, vertices.data(), vertexCount, stride);
+				optimized.resize((size_t)optimizedVertexCount * stride);
+				vertices.swap(optimized);
+			}
+		}
+
+		if (report)
+		{
+			report->after = AnalyzeVertexCache(indices.data(), indexCount, optimizedVertexCount, settings.statisticsCacheSize);
+			report->vertexCountAfter = optimizedVertexCount;
+		}
+
+		return 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,699 @@
+﻿#include "pch.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "Check.h"
+#include "Mathf.h"
+#include "Vector3.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	// 縁の辺に垂直な平面の重み(三角形の面の重みに対する比率)
+	const F32 BORDER_WEIGHT = 10.0f;
+
+	// 統合の前後で三角形の法線がなす角の余弦の下限
+	const F32 FLIP_THRESHOLD = 0.25f;
+
+	/// <summary>
+	/// 頂点の種類
+	/// </summary>
+	enum class VertexKind : U8
+	{
+		// 周囲が三角形で閉じている
+		Manifold,
+		// 縁の上にある
+		Border,
+		// 継ぎ目や非多様体の辺の上にあるため動かさない
+		Locked,
+	};
+
+	/// <summary>
+	/// 位置の二次誤差。平面までの距離の2乗を面積で重み付けして合計したもの
+	/// </summary>
+	struct Quadric
+	{
+		F32 a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+		F32 b0 = 0, b1 = 0, b2 = 0;
+		F32 c = 0;
+		F32 weight = 0;
+
+		inline void AddPlane(const Vector3& n, const F32 d, const F32 w)
+		{
+			a00 += w * n.x * n.x; a11 += w * n.y * n.y; a22 += w * n.z * n.z;
+			a01 += w * n.x * n.y; a02 += w * n.x * n.z; a12 += w * n.y * n.z;
+			b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+			c += w * d * d;
+			weight += w;
+		}
+
+		inline void Add(const Quadric& q)
+		{
+			a00 += q.a00; a11 += q.a11; a22 += q.a22; a01 += q.a01; a02 += q.a02; a12 += q.a12;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2;
+			c += q.c;
+			weight += q.weight;
+		}
+
+		inline F32 Evaluate(const Vector3& p)const
+		{
+			const F32 rx = a00 * p.x + a01 * p.y + a02 * p.z;
+			const F32 ry = a01 * p.x + a11 * p.y + a12 * p.z;
+			const F32 rz = a02 * p.x + a12 * p.y + a22 * p.z;
+			return p.x * rx + p.y * ry + p.z * rz + 2.0f * (p.x * b0 + p.y * b1 + p.z * b2) + c;
+		}
+	};
+
+	/// <summary>
+	/// 属性1要素の二次誤差
+	/// </summary>
+	/// <remarks>
+	/// 三角形上で属性を a(p) = g・p + d と線形に表し、(g・p + d - a)^2 を面積で重み付けして合計したもの。
+	/// </remarks>
+	struct AttributeQuadric
+	{
+		F32 g00 = 0, g11 = 0, g22 = 0, g01 = 0, g02 = 0, g12 = 0;
+		F32 gd0 = 0, gd1 = 0, gd2 = 0;
+		F32 dd = 0;
+		F32 g0 = 0, g1 = 0, g2 = 0;
+		F32 d = 0;
+		F32 weight = 0;
+
+		inline void AddGradient(const Vector3& g, const F32 offset, const F32 w)
+		{
+			g00 += w * g.x * g.x; g11 += w * g.y * g.y; g22 += w * g.z * g.z;
+			g01 += w * g.x * g.y; g02 += w * g.x * g.z; g12 += w * g.y * g.z;
+			gd0 += w * g.x * offset; gd1 += w * g.y * offset; gd2 += w * g.z * offset;
+			dd += w * offset * offset;
+			g0 += w * g.x; g1 += w * g.y; g2 += w * g.z;
+			d += w * offset;
+			weight += w;
+		}
+
+		inline void Add(const AttributeQuadric& q)
+		{
+			g00 += q.g00; g11 += q.g11; g22 += q.g22; g01 += q.g01; g02 += q.g02; g12 += q.g12;
+			gd0 += q.gd0; gd1 += q.gd1; gd2 += q.gd2;
+			dd += q.dd;
+			g0 += q.g0; g1 += q.g1; g2 += q.g2;
+			d += q.d;
+			weight += q.weight;
+		}
+
+		inline F32 Evaluate(const Vector3& p, const F32 a)const
+		{
+			const F32 rx = g00 * p.x + g01 * p.y + g02 * p.z;
+			const F32 ry = g01 * p.x + g11 * p.y + g12 * p.z;
+			const F32 rz = g02 * p.x + g12 * p.y + g22 * p.z;
+			const F32 predicted = p.x * g0 + p.y * g1 + p.z * g2 + d;
+			return p.x * rx + p.y * ry + p.z * rz + 2.0f * (p.x * gd0 + p.y * gd1 + p.z * gd2) + dd - 2.0f * a * predicted + a * a * weight;
+		}
+	};
+
+	struct Collapse
+	{
+		U32 from;
+		U32 to;
+		F32 error;
+
+		inline bool operator<(const Collapse& other)const
+		{
+			if (error != other.error)return error < other.error;
+			if (from != other.from)return from < other.from;
+			return to < other.to;
+		}
+	};
+
+	inline U64 MakeEdge(const U32 a, const U32 b)
+	{
+		return ((U64)a << 32) | b;
+	}
+
+	inline bool HasEdge(const ArrayList<U64>& edges, const U32 a, const U32 b)
+	{
+		return std::binary_search(edges.begin(), edges.end(), MakeEdge(a, b));
+	}
+
+	/// <summary>
+	/// 位置が同じ頂点を最初の頂点に対応させる
+	/// </summary>
+	void BuildPositionRemap(const ArrayList<Vector3>& positions, ArrayList<U32>& remap)
+	{
+		const U32 vertexCount = (U32)positions.size();
+		ArrayList<U32> order(vertexCount);
+		for (U32 v = 0; v < vertexCount; v++)order[v] = v;
+		std::sort(order.begin(), order.end(), [&](const U32 a, const U32 b)
+		{
+			const Vector3& pa = positions[a];
+			const Vector3& pb = positions[b];
+			if (pa.x != pb.x)return pa.x < pb.x;
+			if (pa.y != pb.y)return pa.y < pb.y;
+			if (pa.z != pb.z)return pa.z < pb.z;
+			return a < b;
+		});
+
+		remap.resize(vertexCount);
+		for (U32 i = 0; i < vertexCount; i++)
+		{
+			const U32 v = order[i];
+			remap[v] = 0 < i && positions[order[i - 1]] == positions[v] ? remap[order[i - 1]] : v;
+		}
+	}
+
+	/// <summary>
+	/// 位置の番号での有向辺の一覧(昇順)を作る
+	/// </summary>
+	void BuildEdges(const ArrayList<U32>& indices, const ArrayList<U32>& positionRemap, ArrayList<U64>& edges)
+	{
+		edges.resize(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (U32 k = 0; k < 3; k++)
+			{
+				const U32 a = positionRemap[indices[i + k]];
+				const U32 b = positionRemap[indices[i + (k + 1) % 3]];
+				edges[i + k] = MakeEdge(a, b);
+			}
+		}
+		std::sort(edges.begin(), edges.end());
+	}
+
+	/// <summary>
+	/// 頂点の種類を判定する
+	/// </summary>
+	void ClassifyVertices(const ArrayList<U32>& indices, const ArrayList<U32>& positionRemap, const ArrayList<U64>& edges, const bool lockBorder, ArrayList<VertexKind>& kinds)
+	{
+		const U32 vertexCount = (U32)positionRemap.size();
+		ArrayList<U32> wedgeCounts(vertexCount, 0);
+		for (U32 v = 0; v < vertexCount; v++)wedgeCounts[positionRemap[v]]++;
+
+		ArrayList<U8> openOut(vertexCount, 0);
+		ArrayList<U8> openIn(vertexCount, 0);
+		ArrayList<U8> isComplex(vertexCount, 0);
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (U32 k = 0; k < 3; k++)
+			{
+				const U32 a = indices[i + k];
+				const U32 b = indices[i + (k + 1) % 3];
+				const U64 edge = MakeEdge(positionRemap[a], positionRemap[b]);
+				const auto range = std::equal_range(edges.begin(), edges.end(), edge);
+				if (1 < range.second - range.first)
+				{
+					// 同じ向きの辺が複数ある(非多様体)
+					isComplex[a] = isComplex[b] = 1;
+				}
+				if (!HasEdge(edges, positionRemap[b], positionRemap[a]))
+				{
+					if (openOut[a] < 255)openOut[a]++;
+					if (openIn[b] < 255)openIn[b]++;
+				}
+			}
+		}
+
+		kinds.resize(vertexCount);
+		for (U32 v = 0; v < vertexCount; v++)
+		{
+			if (1 < wedgeCounts[positionRemap[v]] || isComplex[v])kinds[v] = VertexKind::Locked;
+			else if (openOut[v] == 0 && openIn[v] == 0)kinds[v] = VertexKind::Manifold;
+			else if (openOut[v] == 1 && openIn[v] == 1 && !lockBorder)kinds[v] = VertexKind::Border;
+			else kinds[v] = VertexKind::Locked;
+		}
+	}
+
+	inline Vector3 LoadFloat3(const Byte* vertices, const U32 stride, const U32 offset, const U32 index)
+	{
+		F32 value[3];
+		memcpy(value, vertices + (size_t)index * stride + offset, sizeof(value));
+		return Vector3(value[0], value[1], value[2]);
+	}
+
+	/// <summary>
+	/// 簡略化の作業データ
+	/// </summary>
+	class Simplifier
+	{
+	public:
+		Simplifier(const Byte* vertices, const U32 vertexCount, const U32 stride, const SimplifySettings& settings) :
+			m_vertexCount(vertexCount),
+			m_attributeCount(settings.attributeCount),
+			m_settings(settings)
+		{
+			// 誤差をメッシュの大きさによらない値にするため、最も長い辺が1になるように正規化する
+			Vector3 minimum(FLT_MAX, FLT_MAX, FLT_MAX);
+			Vector3 maximum(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+			m_positions.resize(vertexCount);
+			for (U32 v = 0; v < vertexCount; v++)
+			{
+				const Vector3 p = LoadFloat3(vertices, stride, settings.positionOffset, v);
+				m_positions[v] = p;
+				minimum = Vector3(Mathf::Min(minimum.x, p.x), Mathf::Min(minimum.y, p.y), Mathf::Min(minimum.z, p.z));
+				maximum = Vector3(Mathf::Max(maximum.x, p.x), Mathf::Max(maximum.y, p.y), Mathf::Max(maximum.z, p.z));
+			}
+			const Vector3 size = maximum - minimum;
+			const F32 extent = Mathf::Max(Mathf::Max(size.x, size.y), size.z);
+			m_scale = 0.0f < extent ? 1.0f / extent : 1.0f;
+			for (auto& p : m_positions)p = (p - minimum) * m_scale;
+
+			m_attributes.resize((size_t)vertexCount * m_attributeCount);
+			for (U32 v = 0; v < vertexCount && 0 < m_attributeCount; v++)
+			{
+				memcpy(&m_attributes[(size_t)v * m_attributeCount], vertices + (size_t)v * stride + settings.attributeOffset, m_attributeCount * sizeof(F32));
+			}
+		}
+
+		/// <summary>
+		/// 簡略化する
+		/// </summary>
+		/// <returns>結果の誤差(オブジェクト空間の距離)</returns>
+		F32 Run(ArrayList<U32>& indices, const U32 targetIndexCount, const F32 targetError)
+		{
+			BuildPositionRemap(m_positions, m_positionRemap);
+			BuildEdges(indices, m_positionRemap, m_edges);
+			BuildQuadrics(indices);
+			BuildTriangleNormals(indices);
+
+			const F32 scaledError = targetError * m_scale;
+			const F32 errorLimit = scaledError < FLT_MAX ? scaledError * scaledError : FLT_MAX;
+			F32 resultError = 0.0f;
+
+			ArrayList<Collapse> collapses;
+			while (targetIndexCount < indices.size())
+			{
+				// 前の処理で縁や継ぎ目の形が変わっているので、毎回判定し直す
+				ClassifyVertices(indices, m_positionRemap, m_edges, m_settings.lockBorder, m_kinds);
+				BuildAdjacency(indices);
+				CollectCollapses(indices, collapses);
+				if (collapses.empty())break;
+				std::sort(collapses.begin(), collapses.end());
+
+				const U32 collapsed = PerformCollapses(indices, collapses, targetIndexCount, errorLimit, resultError);
+				if (collapsed == 0)break;
+
+				// 統合した頂点を参照する三角形を置き換え、潰れた三角形を取り除く
+				size_t write = 0;
+				for (size_t i = 0; i < indices.size(); i += 3)
+				{
+					const U32 a = m_remap[indices[i + 0]];
+					const U32 b = m_remap[indices[i + 1]];
+					const U32 c = m_remap[indices[i + 2]];
+					if (a == b || b == c || c == a)continue;
+					m_triangleNormals[write / 3] = m_triangleNormals[i / 3];
+					indices[write++] = a;
+					indices[write++] = b;
+					indices[write++] = c;
+				}
+				indices.resize(write);
+				m_triangleNormals.resize(write / 3);
+				BuildEdges(indices, m_positionRemap, m_edges);
+			}
+
+			return Mathf::Sqrt(resultError) / m_scale;
+		}
+
+	private:
+		U32 m_vertexCount;
+		U32 m_attributeCount;
+		F32 m_scale;
+		const SimplifySettings& m_settings;
+
+		// 正規化した位置
+		ArrayList<Vector3> m_positions;
+		ArrayList<F32> m_attributes;
+		ArrayList<U32> m_positionRemap;
+		ArrayList<U64> m_edges;
+		ArrayList<VertexKind> m_kinds;
+		ArrayList<Quadric> m_quadrics;
+		ArrayList<AttributeQuadric> m_attributeQuadrics;
+
+		// 三角形ごとの簡略化前の法線(縮退していた場合は0)
+		ArrayList<Vector3> m_triangleNormals;
+
+		// 頂点ごとの三角形の一覧
+		ArrayList<U32> m_adjacencyOffsets;
+		ArrayList<U32> m_adjacency;
+
+		// 1回の処理での統合先と、統合に関わった頂点
+		ArrayList<U32> m_remap;
+		ArrayList<U8> m_isTouched;
+
+		void BuildQuadrics(const ArrayList<U32>& indices)
+		{
+			m_quadrics.assign(m_vertexCount, Quadric());
+			m_attributeQuadrics.assign((size_t)m_vertexCount * m_attributeCount, AttributeQuadric());
+
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				const U32 v[3] = { indices[i], indices[i + 1], indices[i + 2] };
+				const Vector3& p0 = m_positions[v[0]];
+				const Vector3 e1 = m_positions[v[1]] - p0;
+				const Vector3 e2 = m_positions[v[2]] - p0;
+				Vector3 normal = Vector3::Cross(e1, e2);
+				const F32 length = normal.Length();
+				if (length == 0.0f)continue;
+				normal = normal / length;
+				const F32 area = length * 0.5f;
+
+				Quadric plane;
+				plane.AddPlane(normal, -Vector3::Dot(normal, p0), area);
+				for (U32 k = 0; k < 3; k++)m_quadrics[v[k]].Add(plane);
+
+				// 縁の辺には面に垂直な平面を加え、縁の形を保つ
+				for (U32 k = 0; k < 3; k++)
+				{
+					const U32 a = v[k];
+					const U32 b = v[(k + 1) % 3];
+					if (HasEdge(m_edges, m_positionRemap[b], m_positionRemap[a]))continue;
+
+					const Vector3 edge = m_positions[b] - m_positions[a];
+					Vector3 side = Vector3::Cross(edge, normal);
+					const F32 sideLength = side.Length();
+					if (sideLength == 0.0f)continue;
+					side = side / sideLength;
+
+					Quadric border;
+					border.AddPlane(side, -Vector3::Dot(side, m_positions[a]), edge.SquaredLength() * BORDER_WEIGHT);
+					m_quadrics[a].Add(border);
+					m_quadrics[b].Add(border);
+				}
+
+				if (m_attributeCount == 0)continue;
+
+				// 三角形上の属性の勾配。gは三角形の平面上のベクトルで、g・e1 = a1 - a0、g・e2 = a2 - a0 を満たす
+				const F32 d11 = Vector3::Dot(e1, e1);
+				const F32 d12 = Vector3::Dot(e1, e2);
+				const F32 d22 = Vector3::Dot(e2, e2);
+				const F32 denominator = d11 * d22 - d12 * d12;
+				if (denominator == 0.0f)continue;
+				const F32 inverse = 1.0f / denominator;
+
+				for (U32 j = 0; j < m_attributeCount; j++)
+				{
+					const F32 a0 = GetAttribute(v[0], j);
+					const F32 da1 = GetAttribute(v[1], j) - a0;
+					const F32 da2 = GetAttribute(v[2], j) - a0;
+					const F32 s = (d22 * da1 - d12 * da2) * inverse;
+					const F32 t = (d11 * da2 - d12 * da1) * inverse;
+					const Vector3 gradient = e1 * s + e2 * t;
+
+					AttributeQuadric quadric;
+					quadric.AddGradient(gradient, a0 - Vector3::Dot(gradient, p0), area * m_settings.attributeWeights[j]);
+					for (U32 k = 0; k < 3; k++)m_attributeQuadrics[(size_t)v[k] * m_attributeCount + j].Add(quadric);
+				}
+			}
+		}
+
+		void BuildTriangleNormals(const ArrayList<U32>& indices)
+		{
+			m_triangleNormals.resize(indices.size() / 3);
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				const Vector3& p0 = m_positions[indices[i]];
+				const Vector3 normal = Vector3::Cross(m_positions[indices[i + 1]] - p0, m_positions[indices[i + 2]] - p0);
+				const F32 length = normal.Length();
+				m_triangleNormals[i / 3] = 0.0f < length ? normal / length : Vector3(0.0f, 0.0f, 0.0f);
+			}
+		}
+
+		inline F32 GetAttribute(const U32 vertex, const U32 attribute)const
+		{
+			return m_attributes[(size_t)vertex * m_attributeCount + attribute];
+		}
+
+		void BuildAdjacency(const ArrayList<U32>& indices)
+		{
+			m_adjacencyOffsets.assign(m_vertexCount + 1, 0);
+			for (const U32 v : indices)m_adjacencyOffsets[v + 1]++;
+			for (U32 v = 0; v < m_vertexCount; v++)m_adjacencyOffsets[v + 1] += m_adjacencyOffsets[v];
+
+			m_adjacency.resize(indices.size());
+			ArrayList<U32> fill(m_adjacencyOffsets.begin(), m_adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < indices.size(); i++)m_adjacency[fill[indices[i]]++] = (U32)(i / 3);
+		}
+
+		/// <summary>
+		/// fromをtoに統合した場合の誤差(正規化した距離の2乗)
+		/// </summary>
+		F32 ComputeError(const U32 from, const U32 to)const
+		{
+			const Quadric& quadric = m_quadrics[from];
+			const Vector3& p = m_positions[to];
+			F32 error = quadric.Evaluate(p);
+			for (U32 j = 0; j < m_attributeCount; j++)
+			{
+				error += m_attributeQuadrics[(size_t)from * m_attributeCount + j].Evaluate(p, GetAttribute(to, j));
+			}
+			error = 0.0f < quadric.weight ? error / quadric.weight : 0.0f;
+			return Mathf::Max(error, 0.0f);
+		}
+
+		bool CanCollapse(const U32 from, const U32 to)const
+		{
+			switch (m_kinds[from])
+			{
+			case VertexKind::Manifold:
+				return true;
+			case VertexKind::Border:
+				// 縁の頂点は縁の辺に沿ってのみ統合する
+				if (m_kinds[to] == VertexKind::Manifold)return false;
+				{
+					const U32 a = m_positionRemap[from];
+					const U32 b = m_positionRemap[to];
+					return (HasEdge(m_edges, a, b) && !HasEdge(m_edges, b, a)) || (HasEdge(m_edges, b, a) && !HasEdge(m_edges, a, b));
+				}
+			default:
+				return false;
+			}
+		}
+
+		void CollectCollapses(const ArrayList<U32>& indices, ArrayList<Collapse>& collapses)const
+		{
+			collapses.clear();
+			collapses.reserve(indices.size());
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				for (U32 k = 0; k < 3; k++)
+				{
+					const U32 a = indices[i + k];
+					const U32 b = indices[i + (k + 1) % 3];
+
+					// 内部の辺は両側の三角形から2回現れるので、片方の向きだけ扱う
+					if (b < a && HasEdge(m_edges, m_positionRemap[b], m_positionRemap[a]))continue;
+
+					const bool canCollapseA = CanCollapse(a, b);
+					const bool canCollapseB = CanCollapse(b, a);
+					if (!canCollapseA && !canCollapseB)continue;
+
+					const F32 errorA = canCollapseA ? ComputeError(a, b) : FLT_MAX;
+					const F32 errorB = canCollapseB ? ComputeError(b, a) : FLT_MAX;
+					if (errorA <= errorB)collapses.push_back({ a, b, errorA });
+					else collapses.push_back({ b, a, errorB });
+				}
+			}
+		}
+
+		/// <summary>
+		/// fromをtoに寄せたときに向きが反転する三角形があるか
+		/// </summary>
+		bool HasFlippedTriangle(const ArrayList<U32>& indices, const U32 from, const U32 to)const
+		{
+			const Vector3& target = m_positions[to];
+			for (U32 i = m_adjacencyOffsets[from]; i < m_adjacencyOffsets[from + 1]; i++)
+			{
+				const U32 triangle = m_adjacency[i];
+				U32 v[3];
+				for (U32 k = 0; k < 3; k++)v[k] = m_remap[indices[triangle * 3 + k]];
+
+				// toを含む三角形は統合で潰れる
+				if (v[0] == to || v[1] == to || v[2] == to)continue;
+
+				const U32 corner = v[0] == from ? 0 : v[1] == from ? 1 : 2;
+				const Vector3& p1 = m_positions[v[(corner + 1) % 3]];
+				const Vector3& p2 = m_positions[v[(corner + 2) % 3]];
+				const Vector3 before = Vector3::Cross(p1 - m_positions[from], p2 - m_positions[from]);
+				const Vector3 after = Vector3::Cross(p1 - target, p2 - target);
+				// 反転だけでなく大きく傾く場合も、後の統合で反転しやすいので避ける
+				const F32 afterLength = after.Length();
+				if (Vector3::Dot(before, after) <= FLIP_THRESHOLD * before.Length() * afterLength)return true;
+
+				// 小さな傾きが統合を重ねて積み重ならないように、簡略化前の向きとも比べる
+				const Vector3& original = m_triangleNormals[triangle];
+				if (original.SquaredLength() != 0.0f && Vector3::Dot(original, after) <= FLIP_THRESHOLD * afterLength)return true;
+			}
+			return false;
+		}
+
+		/// <summary>
+		/// 誤差の小さい順に統合する。1回の処理では、統合に関わった頂点は再び統合しない
+		/// </summary>
+		/// <returns>統合した数</returns>
+		U32 PerformCollapses(const ArrayList<U32>& indices, const ArrayList<Collapse>& collapses, const U32 targetIndexCount, const F32 errorLimit, F32& resultError)
+		{
+			m_remap.resize(m_vertexCount);
+			for (U32 v = 0; v < m_vertexCount; v++)m_remap[v] = v;
+			m_isTouched.assign(m_vertexCount, 0);
+
+			size_t triangleCount = indices.size() / 3;
+			const size_t targetTriangleCount = targetIndexCount / 3;
+			U32 collapsed = 0;
+
+			for (const auto& collapse : collapses)
+			{
+				if (triangleCount <= targetTriangleCount)break;
+				if (errorLimit < collapse.error)break;
+
+				const U32 from = collapse.from;
+				const U32 to = collapse.to;
+				if (m_isTouched[from] || m_isTouched[to])continue;
+				if (HasFlippedTriangle(indices, from, to))continue;
+
+				// 潰れる三角形の数
+				for (U32 i = m_adjacencyOffsets[from]; i < m_adjacencyOffsets[from + 1]; i++)
+				{
+					const U32 triangle = m_adjacency[i];
+					for (U32 k = 0; k < 3; k++)
+					{
+						if (m_remap[indices[triangle * 3 + k]] == to)
+						{
+							triangleCount--;
+							break;
+						}
+					}
+				}
+
+				m_remap[from] = to;
+				m_isTouched[from] = 1;
+				m_isTouched[to] = 1;
+				m_quadrics[to].Add(m_quadrics[from]);
+				for (U32 j = 0; j < m_attributeCount; j++)
+				{
+					m_attributeQuadrics[(size_t)to * m_attributeCount + j].Add(m_attributeQuadrics[(size_t)from * m_attributeCount + j]);
+				}
+				resultError = Mathf::Max(resultError, collapse.error);
+				collapsed++;
+			}
+
+			return collapsed;
+		}
+	};
+}
+
+namespace CommonLibrary
+{
+	//===================================================================================//
+
+	S32 MeshSimplifier::Simplify(U32* destination, const U32* indices, const U32 indexCount, const Byte* vertices, const U32 vertexCount, const U32 stride, const U32 targetIndexCount, const F32 targetError, const SimplifySettings& settings, F32* resultError)
+	{
+		if (CheckArgs(destination, indices, vertices))return -1;
+		if (indexCount % 3 != 0 || stride < settings.positionOffset + sizeof(F32) * 3)return -1;
+		if (SimplifySettings::MAX_ATTRIBUTES < settings.attributeCount)return -1;
+		if (0 < settings.attributeCount && stride < settings.attributeOffset + settings.attributeCount * sizeof(F32))return -1;
+		for (U32 i = 0; i < indexCount; i++)
+		{
+			if (vertexCount <= indices[i])return -1;
+		}
+
+		ArrayList<U32> result(indices, indices + indexCount);
+		Simplifier simplifier(vertices, vertexCount, stride, settings);
+		const F32 error = simplifier.Run(result, targetIndexCount, targetError);
+
+		if (0 < result.size())memcpy(destination, result.data(), result.size() * sizeof(U32));
+		if (resultError)*resultError = error;
+		return (S32)result.size();
+	}
+
+	//===================================================================================//
+
+	S32 MeshSimplifier::GenerateLods(const Byte* vertices, const U32 vertexCount, const U32 stride, const U32* indices, const U32 indexCount, const LodChainSettings& settings, ArrayList<MeshLod>& lods)
+	{
+		if (CheckArgs(vertices, indices))return -1;
+		if (indexCount % 3 != 0 || stride < settings.simplify.positionOffset + sizeof(F32) * 3)return -1;
+		for (U32 i = 0; i < indexCount; i++)
+		{
+			if (vertexCount <= indices[i])return -1;
+		}
+
+		// 誤差の上限を求めるためのメッシュの大きさ
+		Vector3 minimum(FLT_MAX, FLT_MAX, FLT_MAX);
+		Vector3 maximum(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (U32 v = 0; v < vertexCount; v++)
+		{
+			const Vector3 p = LoadFloat3(vertices, stride, settings.simplify.positionOffset, v);
+			minimum = Vector3(Mathf::Min(minimum.x, p.x), Mathf::Min(minimum.y, p.y), Mathf::Min(minimum.z, p.z));
+			maximum = Vector3(Mathf::Max(maximum.x, p.x), Mathf::Max(maximum.y, p.y), Mathf::Max(maximum.z, p.z));
+		}
+		const F32 maxError = 0 < vertexCount ? (maximum - minimum).Length() * settings.maxRelativeError : 0.0f;
+
+		lods.clear();
+		lods.emplace_back();
+		lods[0].indices.assign(indices, indices + indexCount);
+
+		while (lods.size() < settings.maxLodCount)
+		{
+			const MeshLod& previous = lods.back();
+			const U32 previousCount = (U32)previous.indices.size();
+			const U32 targetCount = (U32)(previousCount / 3 * settings.reductionRatio) * 3;
+			if (targetCount < settings.minTriangleCount * 3)break;
+
+			// 前の段階までの誤差を差し引いた分だけ許容する
+			const F32 remainingError = maxError - previous.error;
+			if (remainingError <= 0.0f)break;
+
+			MeshLod lod;
+			lod.indices.resize(previousCount);
+			F32 error = 0.0f;
+			const S32 count = Simplify(lod.indices.data(), previous.indices.data(), previousCount, vertices, vertexCount, stride, targetCount, remainingError, settings.simplify, &error);
+			if (count < 0)return -1;
+
+			// ほとんど減らない場合は、それ以上簡略化できない
+			if (previousCount * 0.95f < (F32)count)break;
+
+			lod.indices.resize(count);
+			lod.error = previous.error + error;
+			lods.push_back(std::move(lod));
+		}
+
+		for (auto& lod : lods)
+		{
+			if (settings.optimizeVertexCache)
+			{
+				MeshOptimizer::OptimizeVertexCache(lod.indices.data(), lod.indices.data(), (U32)lod.indices.size(), vertexCount);
+			}
+			if (settings.compactVertices)
+			{
+				lod.vertices.resize((size_t)vertexCount * stride);
+				const S32 count = MeshOptimizer::OptimizeVertexFetch(lod.vertices.data(), lod.indices.data(), (U32)lod.indices.size(), vertices, vertexCount, stride);
+				lod.vertices.resize((size_t)count * stride);
+			}
+		}
+
+		return 0;
+	}
+
+	//===================================================================================//
+
+	F32 LodSelector::ComputeProjectionScale(const F32 screenHeight, const F32 fovY)
+	{
+		return screenHeight / (2.0f * Mathf::Tan(fovY * 0.5f));
+	}
+
+	F32 LodSelector::ComputeScreenError(const F32 error, const F32 distance, const F32 projectionScale)
+	{
+		// カメラに近すぎる場合は最も細かいLODが選ばれるように大きな値を返す
+		if (distance <= 0.0f)return FLT_MAX;
+		return error * projectionScale / distance;
+	}
+
+	U32 LodSelector::Select(const ArrayList<MeshLod>& lods, const F32 distance, const F32 projectionScale, const F32 scale, const F32 pixelThreshold)
+	{
+		// 誤差は粗いLODほど大きいので、粗い方から順に調べる
+		for (U32 i = (U32)lods.size(); 1 < i; i--)
+		{
+			if (ComputeScreenError(lods[i - 1].error * scale, distance, projectionScale) <= pixelThreshold)return i - 1;
+		}
+		return 0;
+	}
+}
\ No newline at end of file
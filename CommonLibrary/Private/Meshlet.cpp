@@ -0,0 +1,281 @@
+﻿#include "pch.h"
+#include "Meshlet.h"
+#include "Check.h"
+#include "Mathf.h"
+
+#include <cstring>
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	const U32 INVALID_INDEX = ~0u;
+
+	// 法線の円錐がこれより広い場合は裏面の判定を行わない(開き角の余弦)
+	const F32 CONE_DISABLE_THRESHOLD = 0.1f;
+
+	inline Vector3 LoadPosition(const Byte* vertices, const U32 stride, const U32 positionOffset, const U32 index)
+	{
+		F32 position[3];
+		memcpy(position, vertices + (size_t)index * stride + positionOffset, sizeof(position));
+		return Vector3(position[0], position[1], position[2]);
+	}
+
+	/// <summary>
+	/// 構築中のメッシュレット
+	/// </summary>
+	struct MeshletState
+	{
+		ArrayList<U32> vertices;
+		ArrayList<U32> triangles;
+		Vector3 centroidSum;
+		Vector3 normalSum;
+
+		inline void Clear()
+		{
+			vertices.clear();
+			triangles.clear();
+			centroidSum = Vector3();
+			normalSum = Vector3();
+		}
+	};
+
+	/// <summary>
+	/// 三角形を加える候補の評価。新しく加わる頂点の数を優先し、次に中心からの距離と法線の向きで比較する
+	/// </summary>
+	struct Candidate
+	{
+		U32 triangle = INVALID_INDEX;
+		U32 newVertexCount = 0;
+		F32 cost = 0;
+
+		inline bool IsBetterThan(const Candidate& other)const
+		{
+			if (other.triangle == INVALID_INDEX)return true;
+			if (newVertexCount != other.newVertexCount)return newVertexCount < other.newVertexCount;
+			if (cost != other.cost)return cost < other.cost;
+			return triangle < other.triangle;
+		}
+	};
+}
+
+namespace CommonLibrary
+{
+	MeshletMesh::MeshletMesh()
+	{
+	}
+
+	//===================================================================================//
+
+	S32 MeshletMesh::Build(const Byte* vertices, const U32 vertexCount, const U32 stride, const U32 positionOffset, const U32* indices, const U32 indexCount,
+		const U32 maxVertices, const U32 maxTriangles, const F32 coneWeight)
+	{
+		if (CheckArgs(vertices, indices))return -1;
+		if (indexCount % 3 != 0 || stride < positionOffset + sizeof(F32) * 3)return -1;
+		if (maxVertices < 3 || 256 < maxVertices || maxTriangles == 0)return -1;
+		for (U32 i = 0; i < indexCount; i++)
+		{
+			if (vertexCount <= indices[i])return -1;
+		}
+
+		m_meshlets.clear();
+		m_vertices.clear();
+		m_triangles.clear();
+		m_indices.clear();
+
+		const U32 triangleCount = indexCount / 3;
+		if (triangleCount == 0)return 0;
+
+		ArrayList<Vector3> positions(vertexCount);
+		for (U32 v = 0; v < vertexCount; v++)positions[v] = LoadPosition(vertices, stride, positionOffset, v);
+
+		ArrayList<Vector3> centroids(triangleCount);
+		ArrayList<Vector3> normals(triangleCount);
+		for (U32 t = 0; t < triangleCount; t++)
+		{
+			const Vector3& p0 = positions[indices[t * 3 + 0]];
+			const Vector3& p1 = positions[indices[t * 3 + 1]];
+			const Vector3& p2 = positions[indices[t * 3 + 2]];
+			centroids[t] = (p0 + p1 + p2) / 3.0f;
+			Vector3 normal = Vector3::Cross(p1 - p0, p2 - p0);
+			const F32 length = normal.Length();
+			normals[t] = 0.0f < length ? normal / length : Vector3();
+		}
+
+		// 頂点ごとの未割り当ての三角形の一覧。[offsets[v], offsets[v] + liveCounts[v]) が未割り当て
+		ArrayList<U32> liveCounts(vertexCount, 0);
+		for (U32 i = 0; i < indexCount; i++)liveCounts[indices[i]]++;
+		ArrayList<U32> offsets(vertexCount + 1, 0);
+		for (U32 v = 0; v < vertexCount; v++)offsets[v + 1] = offsets[v] + liveCounts[v];
+		ArrayList<U32> adjacency(indexCount);
+		{
+			ArrayList<U32> fill(offsets.begin(), offsets.end() - 1);
+			for (U32 i = 0; i < indexCount; i++)adjacency[fill[indices[i]]++] = i / 3;
+		}
+
+		ArrayList<U8> assigned(triangleCount, 0);
+		// 頂点が構築中のメッシュレットでの番号。INVALID_INDEXの場合は含まれない
+		ArrayList<U32> localIndices(vertexCount, INVALID_INDEX);
+
+		MeshletState state;
+		U32 cursor = 0;
+		U32 assignedCount = 0;
+
+		auto addTriangle = [&](const U32 triangle)
+		{
+			assigned[triangle] = 1;
+			assignedCount++;
+			state.triangles.push_back(triangle);
+			state.centroidSum += centroids[triangle];
+			state.normalSum += normals[triangle];
+
+			for (U32 k = 0; k < 3; k++)
+			{
+				const U32 v = indices[triangle * 3 + k];
+				U32* list = &adjacency[offsets[v]];
+				const U32 count = liveCounts[v];
+				for (U32 i = 0; i < count; i++)
+				{
+					if (list[i] == triangle)
+					{
+						list[i] = list[count - 1];
+						liveCounts[v]--;
+						break;
+					}
+				}
+				if (localIndices[v] == INVALID_INDEX)
+				{
+					localIndices[v] = (U32)state.vertices.size();
+					state.vertices.push_back(v);
+				}
+			}
+		};
+
+		auto finishMeshlet = [&]()
+		{
+			Meshlet meshlet;
+			meshlet.vertexOffset = (U32)m_vertices.size();
+			meshlet.triangleOffset = (U32)(m_triangles.size() / 3);
+			meshlet.vertexCount = (U32)state.vertices.size();
+			meshlet.triangleCount = (U32)state.triangles.size();
+
+			Bounds bounds(positions[state.vertices[0]], positions[state.vertices[0]]);
+			for (const U32 v : state.vertices)bounds.Encapsulate(positions[v]);
+			meshlet.center = bounds.GetCenter();
+			F32 radiusSq = 0.0f;
+			for (const U32 v : state.vertices)radiusSq = Mathf::Max(radiusSq, (positions[v] - meshlet.center).SquaredLength());
+			meshlet.radius = Mathf::Sqrt(radiusSq);
+
+			// 全ての三角形の法線を含む円錐。広すぎる場合は裏面の判定を行わない
+			const F32 axisLength = state.normalSum.Length();
+			if (0.0f < axisLength)
+			{
+				meshlet.coneAxis = state.normalSum / axisLength;
+				F32 minimumDot = 1.0f;
+				for (const U32 t : state.triangles)minimumDot = Mathf::Min(minimumDot, Vector3::Dot(meshlet.coneAxis, normals[t]));
+				meshlet.coneCutoff = CONE_DISABLE_THRESHOLD < minimumDot ? Mathf::Sqrt(1.0f - minimumDot * minimumDot) : 1.0f;
+			}
+
+			m_meshlets.push_back(meshlet);
+			for (const U32 v : state.vertices)
+			{
+				m_vertices.push_back(v);
+			}
+			for (const U32 t : state.triangles)
+			{
+				for (U32 k = 0; k < 3; k++)
+				{
+					const U32 v = indices[t * 3 + k];
+					m_triangles.push_back((U8)localIndices[v]);
+					m_indices.push_back(v);
+				}
+			}
+			for (const U32 v : state.vertices)localIndices[v] = INVALID_INDEX;
+		};
+
+		// 直前のメッシュレットに隣接する三角形から次のメッシュレットを始める
+		auto findSeed = [&]()
+		{
+			for (const U32 v : state.vertices)
+			{
+				if (0 < liveCounts[v])return adjacency[offsets[v]];
+			}
+			while (assigned[cursor])cursor++;
+			return cursor;
+		};
+
+		U32 seed = 0;
+		while (assignedCount < triangleCount)
+		{
+			state.Clear();
+			addTriangle(seed);
+
+			while (state.triangles.size() < maxTriangles)
+			{
+				const F32 count = (F32)state.triangles.size();
+				const Vector3 center = state.centroidSum / count;
+				const F32 axisLength = state.normalSum.Length();
+				const Vector3 axis = 0.0f < axisLength ? state.normalSum / axisLength : Vector3();
+
+				Candidate best;
+				for (const U32 v : state.vertices)
+				{
+					const U32* list = &adjacency[offsets[v]];
+					for (U32 i = 0; i < liveCounts[v]; i++)
+					{
+						Candidate candidate;
+						candidate.triangle = list[i];
+						for (U32 k = 0; k < 3; k++)
+						{
+							if (localIndices[indices[candidate.triangle * 3 + k]] == INVALID_INDEX)candidate.newVertexCount++;
+						}
+						if (maxVertices < state.vertices.size() + candidate.newVertexCount)continue;
+
+						const F32 spread = 1.0f - Vector3::Dot(axis, normals[candidate.triangle]);
+						candidate.cost = (centroids[candidate.triangle] - center).SquaredLength() * (1.0f + coneWeight * spread);
+						if (candidate.IsBetterThan(best))best = candidate;
+					}
+				}
+				if (best.triangle == INVALID_INDEX)break;
+				addTriangle(best.triangle);
+			}
+
+			finishMeshlet();
+			if (assignedCount < triangleCount)seed = findSeed();
+		}
+
+		return 0;
+	}
+
+	//===================================================================================//
+
+	U32 MeshletMesh::Cull(const Frustum& frustum, const Vector3& cameraPosition, ArrayList<MeshletIndexRange>& ranges)const
+	{
+		ranges.clear();
+		U32 visibleCount = 0;
+		for (const auto& meshlet : m_meshlets)
+		{
+			if (!frustum.Intersects(meshlet.center, meshlet.radius))continue;
+
+			// 境界球のどの点から見ても円錐内の法線が全てカメラと反対を向いていれば、全ての三角形が裏を向いている
+			const Vector3 direction = meshlet.center - cameraPosition;
+			if (meshlet.coneCutoff * direction.Length() + meshlet.radius <= Vector3::Dot(direction, meshlet.coneAxis))continue;
+
+			visibleCount++;
+			const U32 first = meshlet.triangleOffset * 3;
+			const U32 count = meshlet.triangleCount * 3;
+			if (!ranges.empty() && ranges.back().first + ranges.back().count == first)
+			{
+				ranges.back().count += count;
+			}
+			else
+			{
+				MeshletIndexRange range;
+				range.first = first;
+				range.count = count;
+				ranges.push_back(range);
+			}
+		}
+		return visibleCount;
+	}
+}
\ No newline at end of file
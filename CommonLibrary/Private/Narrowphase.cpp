@@ -0,0 +1,599 @@
+﻿#include "pch.h"
+#include "Narrowphase.h"
+#include "Mathf.h"
+
+namespace
+{
+	using namespace CommonLibrary;
+	using namespace CommonLibrary::Narrowphase;
+
+	// 平行とみなす外積の長さ
+	const F32 PARALLEL_EPSILON = 1e-5f;
+
+	// 面の軸を辺の軸より優先するための許容値(分離距離は負のため、割合を掛けると浅くなる)
+	const F32 AXIS_RELATIVE_TOLERANCE = 0.95f;
+	const F32 AXIS_ABSOLUTE_TOLERANCE = 0.001f;
+
+	// 箱同士の面の接触で、切り取り後の多角形の頂点の最大数
+	const U32 MAX_CLIP_POINTS = 16;
+
+	inline F32 GetAxis(const Vector3& v, const U32 axis)
+	{
+		return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+	}
+
+	inline F32 LengthOf(const Vector3& v)
+	{
+		return Mathf::Sqrt(Vector3::Dot(v, v));
+	}
+
+	inline void AddPoint(ContactResult& result, const Vector3& position, const F32 depth)
+	{
+		if (MAX_CONTACT_POINTS <= result.count)return;
+		result.points[result.count].position = position;
+		result.points[result.count].depth = depth;
+		result.count++;
+	}
+
+	inline void FlipNormal(ContactResult& result)
+	{
+		result.normal = -result.normal;
+	}
+
+	inline void GetSegment(const ShapeInstance& capsule, Vector3& p, Vector3& q)
+	{
+		Vector3 offset = capsule.rotation.axes[1] * capsule.shape->halfHeight;
+		p = capsule.position - offset;
+		q = capsule.position + offset;
+	}
+
+	/// <summary>
+	/// 線分pq上でxに最も近い点の媒介変数
+	/// </summary>
+	F32 ClosestOnSegment(const Vector3& p, const Vector3& q, const Vector3& x)
+	{
+		Vector3 d = q - p;
+		F32 lengthSq = Vector3::Dot(d, d);
+		if (lengthSq <= FLT_EPSILON)return 0.0f;
+		return Mathf::Clamp01(Vector3::Dot(x - p, d) / lengthSq);
+	}
+
+	/// <summary>
+	/// 2つの線分の最近点の媒介変数を求める(Real-Time Collision Detection 5.1.9)
+	/// </summary>
+	void ClosestSegmentSegment(const Vector3& p1, const Vector3& q1, const Vector3& p2, const Vector3& q2, F32& s, F32& t)
+	{
+		Vector3 d1 = q1 - p1;
+		Vector3 d2 = q2 - p2;
+		Vector3 r = p1 - p2;
+		F32 a = Vector3::Dot(d1, d1);
+		F32 e = Vector3::Dot(d2, d2);
+		F32 f = Vector3::Dot(d2, r);
+
+		if (a <= FLT_EPSILON && e <= FLT_EPSILON)
+		{
+			s = t = 0.0f;
+			return;
+		}
+		if (a <= FLT_EPSILON)
+		{
+			s = 0.0f;
+			t = Mathf::Clamp01(f / e);
+			return;
+		}
+
+		F32 c = Vector3::Dot(d1, r);
+		if (e <= FLT_EPSILON)
+		{
+			t = 0.0f;
+			s = Mathf::Clamp01(-c / a);
+			return;
+		}
+
+		F32 b = Vector3::Dot(d1, d2);
+		F32 denom = a * e - b * b;
+		s = denom != 0.0f ? Mathf::Clamp01((b * f - c * e) / denom) : 0.0f;
+		t = (b * s + f) / e;
+		if (t < 0.0f)
+		{
+			t = 0.0f;
+			s = Mathf::Clamp01(-c / a);
+		}
+		else if (1.0f < t)
+		{
+			t = 1.0f;
+			s = Mathf::Clamp01((b - c) / a);
+		}
+	}
+
+	/// <summary>
+	/// 2つの球の接触。法線はaからbへ向かう。
+	/// </summary>
+	bool SphereSphere(const Vector3& ca, const F32 ra, const Vector3& cb, const F32 rb, const F32 margin, ContactResult& result)
+	{
+		Vector3 d = cb - ca;
+		F32 distanceSq = Vector3::Dot(d, d);
+		F32 radius = ra + rb;
+		if ((radius + margin) * (radius + margin) < distanceSq)return false;
+
+		F32 distance = Mathf::Sqrt(distanceSq);
+		result.normal = distance > FLT_EPSILON ? d / distance : Vector3(0, 1, 0);
+		F32 depth = radius - distance;
+		AddPoint(result, ca + result.normal * (ra - depth * 0.5f), depth);
+		return true;
+	}
+
+	/// <summary>
+	/// 箱と球の接触。法線は箱から球へ向かう。
+	/// </summary>
+	bool BoxSphere(const ShapeInstance& box, const Vector3& center, const F32 radius, const F32 margin, ContactResult& result)
+	{
+		const Vector3& h = box.shape->halfExtents;
+		Vector3 local = box.rotation.InverseTransform(center - box.position);
+		Vector3 clamped(Mathf::Clamp(local.x, -h.x, h.x), Mathf::Clamp(local.y, -h.y, h.y), Mathf::Clamp(local.z, -h.z, h.z));
+		Vector3 d = local - clamped;
+		F32 distanceSq = Vector3::Dot(d, d);
+
+		Vector3 normal;
+		Vector3 surface;
+		F32 depth;
+		if (distanceSq <= FLT_EPSILON)
+		{
+			// 中心が箱の内部にある場合は最も近い面から押し出す
+			U32 axis = 0;
+			F32 best = FLT_MAX;
+			for (U32 i = 0; i < 3; i++)
+			{
+				F32 distance = GetAxis(h, i) - Mathf::Abs(GetAxis(local, i));
+				if (distance < best)
+				{
+					best = distance;
+					axis = i;
+				}
+			}
+			F32 sign = GetAxis(local, axis) < 0.0f ? -1.0f : 1.0f;
+			normal = box.rotation.axes[axis] * sign;
+			surface = center + normal * best;
+			depth = radius + best;
+		}
+		else
+		{
+			if ((radius + margin) * (radius + margin) < distanceSq)return false;
+
+			F32 distance = Mathf::Sqrt(distanceSq);
+			normal = box.rotation.Transform(d / distance);
+			surface = box.position + box.rotation.Transform(clamped);
+			depth = radius - distance;
+		}
+
+		result.normal = normal;
+		AddPoint(result, surface - normal * (depth * 0.5f), depth);
+		return true;
+	}
+
+	bool SphereCapsule(const Vector3& center, const F32 radius, const ShapeInstance& capsule, const F32 margin, ContactResult& result)
+	{
+		Vector3 p, q;
+		GetSegment(capsule, p, q);
+		F32 t = ClosestOnSegment(p, q, center);
+		return SphereSphere(center, radius, p + (q - p) * t, capsule.shape->radius, margin, result);
+	}
+
+	bool CapsuleCapsule(const ShapeInstance& a, const ShapeInstance& b, const F32 margin, ContactResult& result)
+	{
+		Vector3 pa, qa, pb, qb;
+		GetSegment(a, pa, qa);
+		GetSegment(b, pb, qb);
+
+		F32 s, t;
+		ClosestSegmentSegment(pa, qa, pb, qb, s, t);
+		const F32 ra = a.shape->radius, rb = b.shape->radius;
+		if (!SphereSphere(pa + (qa - pa) * s, ra, pb + (qb - pb) * t, rb, margin, result))return false;
+
+		// 平行に並んでいる場合は1点では転がるため、重なっている範囲の両端を接触点にする
+		Vector3 da = qa - pa, db = qb - pb;
+		Vector3 cross = Vector3::Cross(da, db);
+		if (PARALLEL_EPSILON * Vector3::Dot(da, da) * Vector3::Dot(db, db) < Vector3::Dot(cross, cross))return true;
+
+		result.count = 0;
+		const Vector3 normal = result.normal;
+		const Vector3 endpoints[] = { pa, qa };
+		const Vector3 others[] = { pb, qb };
+		for (U32 i = 0; i < 2; i++)
+		{
+			Vector3 onB = pb + db * ClosestOnSegment(pb, qb, endpoints[i]);
+			F32 depth = ra + rb - Vector3::Dot(onB - endpoints[i], normal);
+			if (-margin <= depth)AddPoint(result, endpoints[i] + normal * (ra - depth * 0.5f), depth);
+
+			Vector3 onA = pa + da * ClosestOnSegment(pa, qa, others[i]);
+			depth = ra + rb - Vector3::Dot(others[i] - onA, normal);
+			if (-margin <= depth)AddPoint(result, onA + normal * (ra - depth * 0.5f), depth);
+		}
+		if (result.count == 0)
+		{
+			// 端点がどれも範囲外の場合(交差している場合など)は最近点を使う
+			return SphereSphere(pa + da * s, ra, pb + db * t, rb, margin, result);
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// 箱とカプセルの接触。線分の両端と、線分上で箱に最も近い点を球として判定する。
+	/// </summary>
+	bool BoxCapsule(const ShapeInstance& box, const ShapeInstance& capsule, const F32 margin, ContactResult& result)
+	{
+		Vector3 p, q;
+		GetSegment(capsule, p, q);
+		const F32 radius = capsule.shape->radius;
+
+		// 線分上の最近点は、箱の中心に近い点から交互に最近点を求めて近似する
+		const Vector3& h = box.shape->halfExtents;
+		F32 t = ClosestOnSegment(p, q, box.position);
+		for (U32 i = 0; i < 2; i++)
+		{
+			Vector3 local = box.rotation.InverseTransform(p + (q - p) * t - box.position);
+			Vector3 clamped(Mathf::Clamp(local.x, -h.x, h.x), Mathf::Clamp(local.y, -h.y, h.y), Mathf::Clamp(local.z, -h.z, h.z));
+			t = ClosestOnSegment(p, q, box.position + box.rotation.Transform(clamped));
+		}
+
+		ContactResult candidates[3];
+		const Vector3 centers[] = { p, q, p + (q - p) * t };
+		S32 deepest = -1;
+		for (U32 i = 0; i < 3; i++)
+		{
+			candidates[i].count = 0;
+			if (!BoxSphere(box, centers[i], radius, margin, candidates[i]))continue;
+			if (deepest < 0 || candidates[deepest].points[0].depth < candidates[i].points[0].depth)deepest = (S32)i;
+		}
+		if (deepest < 0)return false;
+
+		// 法線は最も深い接触のものを使い、両端の接触のうち向きが大きく異なるものは除く
+		result.normal = candidates[deepest].normal;
+		AddPoint(result, candidates[deepest].points[0].position, candidates[deepest].points[0].depth);
+		for (U32 i = 0; i < 2; i++)
+		{
+			if ((S32)i == deepest || candidates[i].count == 0)continue;
+			if (Vector3::Dot(candidates[i].normal, result.normal) < 0.7f)continue;
+			AddPoint(result, candidates[i].points[0].position, candidates[i].points[0].depth);
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// 多角形を平面 dot(normal, x) <= offset で切り取る
+	/// </summary>
+	U32 ClipPolygon(const Vector3* input, const U32 count, const Vector3& normal, const F32 offset, Vector3* output)
+	{
+		U32 outputCount = 0;
+		for (U32 i = 0; i < count; i++)
+		{
+			const Vector3& a = input[i];
+			const Vector3& b = input[(i + 1) % count];
+			F32 da = Vector3::Dot(normal, a) - offset;
+			F32 db = Vector3::Dot(normal, b) - offset;
+
+			if (da <= 0.0f)output[outputCount++] = a;
+			if ((da < 0.0f && 0.0f < db) || (db < 0.0f && 0.0f < da))
+			{
+				output[outputCount++] = a + (b - a) * (da / (da - db));
+			}
+		}
+		return outputCount;
+	}
+
+	/// <summary>
+	/// 接触点を4つに減らす。最も深い点、そこから最も遠い点、その2点と面積が最大になる両側の点を選ぶ。
+	/// </summary>
+	void ReducePoints(const Vector3* positions, const F32* depths, const U32 count, const Vector3& normal, ContactResult& result)
+	{
+		if (count <= MAX_CONTACT_POINTS)
+		{
+			for (U32 i = 0; i < count; i++)AddPoint(result, positions[i], depths[i]);
+			return;
+		}
+
+		U32 first = 0;
+		for (U32 i = 1; i < count; i++)
+		{
+			if (depths[first] < depths[i])first = i;
+		}
+
+		U32 second = first;
+		F32 farthest = -1.0f;
+		for (U32 i = 0; i < count; i++)
+		{
+			Vector3 d = positions[i] - positions[first];
+			F32 distanceSq = Vector3::Dot(d, d);
+			if (farthest < distanceSq)
+			{
+				farthest = distanceSq;
+				second = i;
+			}
+		}
+
+		U32 third = first, fourth = first;
+		F32 maxArea = 0.0f, minArea = 0.0f;
+		Vector3 edge = positions[second] - positions[first];
+		for (U32 i = 0; i < count; i++)
+		{
+			F32 area = Vector3::Dot(Vector3::Cross(edge, positions[i] - positions[first]), normal);
+			if (maxArea < area)
+			{
+				maxArea = area;
+				third = i;
+			}
+			if (area < minArea)
+			{
+				minArea = area;
+				fourth = i;
+			}
+		}
+
+		const U32 selected[] = { first, second, third, fourth };
+		for (U32 i = 0; i < 4; i++)
+		{
+			bool duplicate = false;
+			for (U32 j = 0; j < i; j++)duplicate |= selected[i] == selected[j];
+			if (!duplicate)AddPoint(result, positions[selected[i]], depths[selected[i]]);
+		}
+	}
+
+	/// <summary>
+	/// 箱同士の接触。15軸の分離軸判定で最も浅い軸を求め、面の軸なら接触面の切り取り、辺の軸なら辺同士の最近点で接触点を求める。
+	/// </summary>
+	bool BoxBox(const ShapeInstance& a, const ShapeInstance& b, const F32 margin, ContactResult& result)
+	{
+		const Vector3& ha = a.shape->halfExtents;
+		const Vector3& hb = b.shape->halfExtents;
+		const Vector3* ua = a.rotation.axes;
+		const Vector3* ub = b.rotation.axes;
+		const Vector3 d = b.position - a.position;
+
+		F32 absC[3][3];
+		for (U32 i = 0; i < 3; i++)
+		{
+			for (U32 j = 0; j < 3; j++)absC[i][j] = Mathf::Abs(Vector3::Dot(ua[i], ub[j])) + PARALLEL_EPSILON;
+		}
+
+		// Aの面
+		F32 faceSeparation = -FLT_MAX;
+		U32 faceAxis = 0;
+		bool faceOnA = true;
+		for (U32 i = 0; i < 3; i++)
+		{
+			F32 separation = Mathf::Abs(Vector3::Dot(d, ua[i])) - (GetAxis(ha, i) + hb.x * absC[i][0] + hb.y * absC[i][1] + hb.z * absC[i][2]);
+			if (margin < separation)return false;
+			if (faceSeparation < separation)
+			{
+				faceSeparation = separation;
+				faceAxis = i;
+			}
+		}
+
+		// Bの面
+		for (U32 j = 0; j < 3; j++)
+		{
+			F32 separation = Mathf::Abs(Vector3::Dot(d, ub[j])) - (GetAxis(hb, j) + ha.x * absC[0][j] + ha.y * absC[1][j] + ha.z * absC[2][j]);
+			if (margin < separation)return false;
+			if (faceSeparation * AXIS_RELATIVE_TOLERANCE + AXIS_ABSOLUTE_TOLERANCE < separation)
+			{
+				faceSeparation = separation;
+				faceAxis = j;
+				faceOnA = false;
+			}
+		}
+
+		// 辺同士
+		F32 edgeSeparation = -FLT_MAX;
+		U32 edgeA = 0, edgeB = 0;
+		Vector3 edgeNormal;
+		for (U32 i = 0; i < 3; i++)
+		{
+			for (U32 j = 0; j < 3; j++)
+			{
+				Vector3 axis = Vector3::Cross(ua[i], ub[j]);
+				F32 length = LengthOf(axis);
+				if (length < PARALLEL_EPSILON)continue;
+				axis = axis / length;
+
+				F32 radiusA = ha.x * Mathf::Abs(Vector3::Dot(ua[0], axis)) + ha.y * Mathf::Abs(Vector3::Dot(ua[1], axis)) + ha.z * Mathf::Abs(Vector3::Dot(ua[2], axis));
+				F32 radiusB = hb.x * Mathf::Abs(Vector3::Dot(ub[0], axis)) + hb.y * Mathf::Abs(Vector3::Dot(ub[1], axis)) + hb.z * Mathf::Abs(Vector3::Dot(ub[2], axis));
+				F32 separation = Mathf::Abs(Vector3::Dot(d, axis)) - (radiusA + radiusB);
+				if (margin < separation)return false;
+				if (edgeSeparation < separation)
+				{
+					edgeSeparation = separation;
+					edgeA = i;
+					edgeB = j;
+					edgeNormal = axis;
+				}
+			}
+		}
+
+		if (faceSeparation * AXIS_RELATIVE_TOLERANCE + AXIS_ABSOLUTE_TOLERANCE < edgeSeparation)
+		{
+			// 辺同士の接触
+			if (Vector3::Dot(d, edgeNormal) < 0.0f)edgeNormal = -edgeNormal;
+			result.normal = edgeNormal;
+
+			Vector3 centerA = a.position;
+			Vector3 centerB = b.position;
+			for (U32 k = 0; k < 3; k++)
+			{
+				if (k != edgeA)centerA += ua[k] * (GetAxis(ha, k) * (Vector3::Dot(ua[k], edgeNormal) < 0.0f ? -1.0f : 1.0f));
+				if (k != edgeB)centerB += ub[k] * (GetAxis(hb, k) * (Vector3::Dot(ub[k], edgeNormal) < 0.0f ? 1.0f : -1.0f));
+			}
+			Vector3 extentA = ua[edgeA] * GetAxis(ha, edgeA);
+			Vector3 extentB = ub[edgeB] * GetAxis(hb, edgeB);
+
+			F32 s, t;
+			ClosestSegmentSegment(centerA - extentA, centerA + extentA, centerB - extentB, centerB + extentB, s, t);
+			Vector3 pointA = centerA - extentA + extentA * (2.0f * s);
+			Vector3 pointB = centerB - extentB + extentB * (2.0f * t);
+			AddPoint(result, (pointA + pointB) * 0.5f, -edgeSeparation);
+			return true;
+		}
+
+		// 面の接触。基準面の側面で接触面を切り取る
+		const ShapeInstance& reference = faceOnA ? a : b;
+		const ShapeInstance& incident = faceOnA ? b : a;
+		const Vector3& hr = reference.shape->halfExtents;
+		const Vector3& hi = incident.shape->halfExtents;
+		const Vector3* ur = reference.rotation.axes;
+		const Vector3* ui = incident.rotation.axes;
+
+		Vector3 toIncident = incident.position - reference.position;
+		Vector3 referenceNormal = ur[faceAxis];
+		if (Vector3::Dot(toIncident, referenceNormal) < 0.0f)referenceNormal = -referenceNormal;
+		result.normal = faceOnA ? referenceNormal : -referenceNormal;
+
+		// 接触面は基準面の法線と最も逆向きの面
+		U32 incidentAxis = 0;
+		F32 best = -1.0f;
+		for (U32 k = 0; k < 3; k++)
+		{
+			F32 alignment = Mathf::Abs(Vector3::Dot(ui[k], referenceNormal));
+			if (best < alignment)
+			{
+				best = alignment;
+				incidentAxis = k;
+			}
+		}
+		Vector3 incidentNormal = ui[incidentAxis];
+		if (0.0f < Vector3::Dot(incidentNormal, referenceNormal))incidentNormal = -incidentNormal;
+
+		Vector3 incidentCenter = incident.position + incidentNormal * GetAxis(hi, incidentAxis);
+		U32 k1 = (incidentAxis + 1) % 3, k2 = (incidentAxis + 2) % 3;
+		Vector3 e1 = ui[k1] * GetAxis(hi, k1);
+		Vector3 e2 = ui[k2] * GetAxis(hi, k2);
+
+		Vector3 buffers[2][MAX_CLIP_POINTS];
+		buffers[0][0] = incidentCenter + e1 + e2;
+		buffers[0][1] = incidentCenter - e1 + e2;
+		buffers[0][2] = incidentCenter - e1 - e2;
+		buffers[0][3] = incidentCenter + e1 - e2;
+		U32 count = 4;
+		U32 current = 0;
+
+		for (U32 n = 1; n <= 2 && 0 < count; n++)
+		{
+			U32 side = (faceAxis + n) % 3;
+			F32 center = Vector3::Dot(ur[side], reference.position);
+			F32 extent = GetAxis(hr, side);
+			count = ClipPolygon(buffers[current], count, ur[side], center + extent, buffers[1 - current]);
+			current = 1 - current;
+			count = ClipPolygon(buffers[current], count, -ur[side], -center + extent, buffers[1 - current]);
+			current = 1 - current;
+		}
+
+		F32 faceOffset = Vector3::Dot(referenceNormal, reference.position) + GetAxis(hr, faceAxis);
+		Vector3 positions[MAX_CLIP_POINTS];
+		F32 depths[MAX_CLIP_POINTS];
+		U32 pointCount = 0;
+		for (U32 i = 0; i < count; i++)
+		{
+			const Vector3& v = buffers[current][i];
+			F32 separation = Vector3::Dot(referenceNormal, v) - faceOffset;
+			if (margin < separation)continue;
+			positions[pointCount] = v - referenceNormal * (separation * 0.5f);
+			depths[pointCount] = -separation;
+			pointCount++;
+		}
+		if (pointCount == 0)return false;
+
+		ReducePoints(positions, depths, pointCount, referenceNormal, result);
+		return true;
+	}
+}
+
+namespace CommonLibrary
+{
+	namespace Narrowphase
+	{
+		Mat3 Mat3::FromQuaternion(const Quaternion& q)
+		{
+			const F32 xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+			const F32 xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+			const F32 wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+			Mat3 m;
+			m.axes[0] = Vector3(1 - 2 * (yy + zz), 2 * (xy + wz), 2 * (xz - wy));
+			m.axes[1] = Vector3(2 * (xy - wz), 1 - 2 * (xx + zz), 2 * (yz + wx));
+			m.axes[2] = Vector3(2 * (xz + wy), 2 * (yz - wx), 1 - 2 * (xx + yy));
+			return m;
+		}
+
+		bool Collide(const ShapeInstance& a, const ShapeInstance& b, const F32 margin, ContactResult& result)
+		{
+			// 種類の順に並べて組み合わせを減らし、入れ替えた場合は法線を反転する
+			if (b.shape->type < a.shape->type)
+			{
+				if (!Collide(b, a, margin, result))return false;
+				FlipNormal(result);
+				return true;
+			}
+
+			result.count = 0;
+			switch (a.shape->type)
+			{
+			case CollisionShapeType::Sphere:
+				switch (b.shape->type)
+				{
+				case CollisionShapeType::Sphere:
+					return SphereSphere(a.position, a.shape->radius, b.position, b.shape->radius, margin, result);
+				case CollisionShapeType::Box:
+					if (!BoxSphere(b, a.position, a.shape->radius, margin, result))return false;
+					FlipNormal(result);
+					return true;
+				case CollisionShapeType::Capsule:
+					return SphereCapsule(a.position, a.shape->radius, b, margin, result);
+				}
+				break;
+			case CollisionShapeType::Box:
+				switch (b.shape->type)
+				{
+				case CollisionShapeType::Box:
+					return BoxBox(a, b, margin, result);
+				case CollisionShapeType::Capsule:
+					return BoxCapsule(a, b, margin, result);
+				default:
+					break;
+				}
+				break;
+			case CollisionShapeType::Capsule:
+				return CapsuleCapsule(a, b, margin, result);
+			}
+			return false;
+		}
+
+		Bounds ComputeBounds(const ShapeInstance& instance)
+		{
+			const CollisionShape& shape = *instance.shape;
+			const Vector3* axes = instance.rotation.axes;
+			Vector3 extents;
+			switch (shape.type)
+			{
+			case CollisionShapeType::Sphere:
+				extents = Vector3(shape.radius, shape.radius, shape.radius);
+				break;
+			case CollisionShapeType::Box:
+			{
+				const Vector3& h = shape.halfExtents;
+				extents = Vector3(
+					Mathf::Abs(axes[0].x) * h.x + Mathf::Abs(axes[1].x) * h.y + Mathf::Abs(axes[2].x) * h.z,
+					Mathf::Abs(axes[0].y) * h.x + Mathf::Abs(axes[1].y) * h.y + Mathf::Abs(axes[2].y) * h.z,
+					Mathf::Abs(axes[0].z) * h.x + Mathf::Abs(axes[1].z) * h.y + Mathf::Abs(axes[2].z) * h.z);
+				break;
+			}
+			case CollisionShapeType::Capsule:
+			{
+				const Vector3& axis = axes[1];
+				extents = Vector3(Mathf::Abs(axis.x), Mathf::Abs(axis.y), Mathf::Abs(axis.z)) * shape.halfHeight
+					+ Vector3(shape.radius, shape.radius, shape.radius);
+				break;
+			}
+			}
+			return Bounds::FromCenter(instance.position, extents);
+		}
+	}
+}
\ No newline at end of file
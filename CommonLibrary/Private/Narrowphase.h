@@ -0,0 +1,66 @@
+﻿#pragma once
+
+#include "Physics.h"
+
+namespace CommonLibrary
+{
+	namespace Narrowphase
+	{
+		/// <summary> 1つの接触で生成する接触点の最大数 </summary>
+		const U32 MAX_CONTACT_POINTS = 4;
+
+		/// <summary>
+		/// 3x3の回転行列。列が物体の各軸を表す。
+		/// </summary>
+		struct Mat3
+		{
+			Vector3 axes[3];
+
+			static Mat3 FromQuaternion(const Quaternion& q);
+
+			/// <summary> ローカル座標の方向をワールド座標に変換する </summary>
+			inline Vector3 Transform(const Vector3& v)const { return axes[0] * v.x + axes[1] * v.y + axes[2] * v.z; }
+
+			/// <summary> ワールド座標の方向をローカル座標に変換する </summary>
+			inline Vector3 InverseTransform(const Vector3& v)const { return Vector3(Vector3::Dot(axes[0], v), Vector3::Dot(axes[1], v), Vector3::Dot(axes[2], v)); }
+		};
+
+		/// <summary>
+		/// 判定に使う形状と姿勢
+		/// </summary>
+		struct ShapeInstance
+		{
+			const CollisionShape* shape;
+			Vector3 position;
+			Mat3 rotation;
+		};
+
+		struct ContactPoint
+		{
+			/// <summary> 2つの表面の中間にある接触点(ワールド座標) </summary>
+			Vector3 position;
+			/// <summary> めり込みの深さ(離れている場合は負の値) </summary>
+			F32 depth;
+		};
+
+		struct ContactResult
+		{
+			/// <summary> AからBへ向かう法線 </summary>
+			Vector3 normal;
+			U32 count;
+			ContactPoint points[MAX_CONTACT_POINTS];
+		};
+
+		/// <summary>
+		/// 2つの形状の接触を求める
+		/// </summary>
+		/// <param name="margin">離れていても接触点を生成する距離。この範囲の接触点の深さは負になる</param>
+		/// <returns>接触しているか</returns>
+		bool Collide(const ShapeInstance& a, const ShapeInstance& b, const F32 margin, ContactResult& result);
+
+		/// <summary>
+		/// 形状を囲む境界ボックスを求める
+		/// </summary>
+		Bounds ComputeBounds(const ShapeInstance& instance);
+	}
+}
\ No newline at end of file
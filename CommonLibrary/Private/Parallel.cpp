@@ -0,0 +1,188 @@
+﻿#include "pch.h"
+#include "Parallel.h"
+#include "Platform.h"
+#include "Thread.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	// Forの処理の中で実行中か(入れ子のForは呼び出し元のスレッドで順に実行する)
+	thread_local bool t_inParallel = false;
+
+	/// <summary>
+	/// 1回のForで実行する処理
+	/// </summary>
+	struct Job
+	{
+		const std::function<void(size_t, size_t)>* function;
+		size_t count;
+		size_t grainSize;
+		size_t chunkCount;
+		std::atomic<size_t> nextChunk;
+		std::atomic<size_t> pendingChunks;
+	};
+
+	/// <summary>
+	/// Parallelで使用するワーカースレッド
+	/// </summary>
+	class WorkerPool
+	{
+	public:
+		WorkerPool() :m_job(nullptr), m_generation(0), m_activeWorkers(0), m_exit(false)
+		{
+			U32 processorCount = Platform::GetProcessorCount();
+			U32 workerCount = 1 < processorCount ? processorCount - 1 : 0;
+
+			for (U32 i = 0; i < workerCount; i++)
+			{
+				auto thread = MUPtr<Thread>();
+				if (thread->Start([this]() { WorkerMain(); }) != 0)break;
+				m_threads.push_back(std::move(thread));
+			}
+		}
+
+		~WorkerPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_exit = true;
+			}
+			m_wake.notify_all();
+			for (auto& thread : m_threads)thread->Join();
+		}
+
+		inline U32 GetWorkerCount()const { return (U32)m_threads.size(); }
+
+		void Run(Job& job)
+		{
+			// Forの同時呼び出しは順番に処理する
+			std::lock_guard<std::mutex> submitLock(m_submitMutex);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_job = &job;
+				m_generation++;
+			}
+			m_wake.notify_all();
+
+			t_inParallel = true;
+			RunChunks(job);
+			t_inParallel = false;
+
+			// jobは呼び出し元のスタックにあるため、全てのワーカーが手放すまで待つ
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done.wait(lock, [&]() { return job.pendingChunks == 0 && m_activeWorkers == 0; });
+			m_job = nullptr;
+		}
+
+	private:
+		ArrayList<UPtr<Thread>> m_threads;
+
+		std::mutex m_submitMutex;
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_done;
+
+		Job* m_job;
+		U64 m_generation;
+		U32 m_activeWorkers;
+		bool m_exit;
+
+		void WorkerMain()
+		{
+			t_inParallel = true;
+			U64 generation = 0;
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (true)
+			{
+				m_wake.wait(lock, [&]() { return m_exit || (m_job != nullptr && m_generation != generation); });
+				if (m_exit)break;
+
+				generation = m_generation;
+				Job* job = m_job;
+				m_activeWorkers++;
+
+				lock.unlock();
+				RunChunks(*job);
+				lock.lock();
+
+				m_activeWorkers--;
+				m_done.notify_all();
+			}
+		}
+
+		void RunChunks(Job& job)
+		{
+			while (true)
+			{
+				size_t chunk = job.nextChunk++;
+				if (job.chunkCount <= chunk)break;
+
+				size_t begin = chunk * job.grainSize;
+				size_t end = begin + job.grainSize < job.count ? begin + job.grainSize : job.count;
+				(*job.function)(begin, end);
+
+				if (--job.pendingChunks == 0)
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_done.notify_all();
+				}
+			}
+		}
+	};
+
+	std::mutex s_poolMutex;
+	WorkerPool* s_pool = nullptr;
+
+	WorkerPool* GetPool()
+	{
+		std::lock_guard<std::mutex> lock(s_poolMutex);
+		if (s_pool == nullptr)s_pool = new WorkerPool();
+		return s_pool;
+	}
+}
+
+namespace CommonLibrary
+{
+	void Parallel::For(const size_t count, const size_t grainSize, const std::function<void(size_t begin, size_t end)>& function)
+	{
+		if (count == 0 || !function)return;
+
+		size_t grain = 0 < grainSize ? grainSize : 1;
+		size_t chunkCount = (count + grain - 1) / grain;
+
+		WorkerPool* pool = (chunkCount <= 1 || t_inParallel) ? nullptr : GetPool();
+		if (pool == nullptr || pool->GetWorkerCount() == 0)
+		{
+			function(0, count);
+			return;
+		}
+
+		Job job;
+		job.function = &function;
+		job.count = count;
+		job.grainSize = grain;
+		job.chunkCount = chunkCount;
+		job.nextChunk = 0;
+		job.pendingChunks = chunkCount;
+		pool->Run(job);
+	}
+
+	U32 Parallel::GetWorkerCount()
+	{
+		return GetPool()->GetWorkerCount();
+	}
+
+	void Parallel::Shutdown()
+	{
+		std::lock_guard<std::mutex> lock(s_poolMutex);
+		delete s_pool;
+		s_pool = nullptr;
+	}
+}
\ No newline at end of file
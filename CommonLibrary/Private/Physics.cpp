@@ -0,0 +1,784 @@
+﻿#include "pch.h"
+#include "Physics.h"
+#include "Mathf.h"
+#include "Narrowphase.h"
+#include "Parallel.h"
+#include "Platform.h"
+
+#include <algorithm>
+
+namespace
+{
+	using namespace CommonLibrary;
+	using Narrowphase::Mat3;
+
+	// 前回の接触点を同じ点とみなす距離(剛体のローカル座標)
+	const F32 WARM_START_DISTANCE = 0.05f;
+
+	// これより遅い衝突では反発を無視する
+	const F32 RESTITUTION_THRESHOLD = 1.0f;
+
+	// 組ごとの接触判定で1回に処理する組の数
+	const size_t PAIRS_PER_TASK = 64;
+
+	inline U64 MakeKey(const U32 a, const U32 b)
+	{
+		return ((U64)a << 32) | b;
+	}
+
+	inline Vector3 Multiply(const Vector3* rows, const Vector3& v)
+	{
+		return Vector3(Vector3::Dot(rows[0], v), Vector3::Dot(rows[1], v), Vector3::Dot(rows[2], v));
+	}
+
+	/// <summary>
+	/// 法線に直交する2つの接線を求める
+	/// </summary>
+	void ComputeTangents(const Vector3& normal, Vector3& t1, Vector3& t2)
+	{
+		if (0.57735f <= Mathf::Abs(normal.x))t1 = Vector3(normal.y, -normal.x, 0.0f);
+		else t1 = Vector3(0.0f, normal.z, -normal.y);
+		t1 = t1 / Mathf::Sqrt(Vector3::Dot(t1, t1));
+		t2 = Vector3::Cross(normal, t1);
+	}
+
+	/// <summary>
+	/// 形状と質量から慣性テンソルの逆数(対角成分)を求める
+	/// </summary>
+	Vector3 ComputeInverseInertia(const CollisionShape& shape, const F32 mass)
+	{
+		if (mass <= 0.0f)return Vector3();
+
+		Vector3 inertia;
+		switch (shape.type)
+		{
+		case CollisionShapeType::Sphere:
+		{
+			F32 i = 0.4f * mass * shape.radius * shape.radius;
+			inertia = Vector3(i, i, i);
+			break;
+		}
+		case CollisionShapeType::Box:
+		{
+			Vector3 size = shape.halfExtents * 2.0f;
+			Vector3 sq = size * size;
+			inertia = Vector3(sq.y + sq.z, sq.x + sq.z, sq.x + sq.y) * (mass / 12.0f);
+			break;
+		}
+		case CollisionShapeType::Capsule:
+		{
+			// 円柱と2つの半球に質量を体積で分け、半球は中心をずらして加える
+			const F32 r = shape.radius, h = shape.halfHeight * 2.0f;
+			const F32 cylinderVolume = Mathf::PI * r * r * h;
+			const F32 sphereVolume = 4.0f / 3.0f * Mathf::PI * r * r * r;
+			const F32 density = mass / (cylinderVolume + sphereVolume);
+			const F32 mc = density * cylinderVolume, ms = density * sphereVolume;
+			F32 axial = mc * r * r * 0.5f + ms * r * r * 0.4f;
+			F32 lateral = mc * (h * h / 12.0f + r * r * 0.25f) + ms * (r * r * 0.4f + h * h * 0.25f + 0.375f * h * r);
+			inertia = Vector3(lateral, axial, lateral);
+			break;
+		}
+		}
+		return Vector3(1.0f / inertia.x, 1.0f / inertia.y, 1.0f / inertia.z);
+	}
+
+	bool IsValidShape(const CollisionShape& shape)
+	{
+		switch (shape.type)
+		{
+		case CollisionShapeType::Sphere:
+			return 0.0f < shape.radius;
+		case CollisionShapeType::Box:
+			return 0.0f < shape.halfExtents.x && 0.0f < shape.halfExtents.y && 0.0f < shape.halfExtents.z;
+		case CollisionShapeType::Capsule:
+			return 0.0f < shape.radius && 0.0f <= shape.halfHeight;
+		}
+		return false;
+	}
+
+	Quaternion Normalize(const Quaternion& q)
+	{
+		F32 lengthSq = q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w;
+		if (lengthSq <= FLT_EPSILON)return Quaternion(0, 0, 0, 1);
+		F32 inverse = 1.0f / Mathf::Sqrt(lengthSq);
+		return Quaternion(q.x * inverse, q.y * inverse, q.z * inverse, q.w * inverse);
+	}
+
+	inline U64 HashBytes(U64 hash, const void* data, const size_t size)
+	{
+		const Byte* bytes = static_cast<const Byte*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+}
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 2つの剛体の接触
+	/// </summary>
+	struct PhysicsWorld::Manifold
+	{
+		/// <summary>
+		/// 1方向の拘束で反復中に使う値
+		/// </summary>
+		struct Row
+		{
+			// 接触点への位置と方向の外積
+			Vector3 angularA;
+			Vector3 angularB;
+			// 単位の力積による角速度の変化
+			Vector3 impulseA;
+			Vector3 impulseB;
+			// 有効質量
+			F32 mass;
+		};
+
+		struct Point
+		{
+			Vector3 position;
+			// 前回の接触点との対応に使うローカル座標
+			Vector3 localA;
+			Vector3 localB;
+			F32 depth;
+
+			// 蓄積した力積(次のステップに引き継ぐ)
+			F32 normalImpulse;
+			F32 tangentImpulses[2];
+
+			// 解く前に求める値(0が法線、1と2が接線)
+			Row rows[3];
+			F32 targetVelocity;
+		};
+
+		U64 key;
+		U32 bodyA;
+		U32 bodyB;
+		Vector3 normal;
+		Vector3 tangents[2];
+		F32 friction;
+		F32 restitution;
+		F32 inverseMassA;
+		F32 inverseMassB;
+		U32 count;
+		Point points[Narrowphase::MAX_CONTACT_POINTS];
+	};
+
+	/// <summary>
+	/// ステップ中に使う剛体ごとの値
+	/// </summary>
+	struct PhysicsWorld::SolverBody
+	{
+		Mat3 rotation;
+		// ワールド座標の慣性テンソルの逆数の各行
+		Vector3 inverseInertia[3];
+	};
+
+
+	//===================================================================================//
+	// PhysicsWorld
+	//===================================================================================//
+
+	const U32 PhysicsWorld::INVALID_BODY = ~0u;
+
+	PhysicsWorld::PhysicsWorld(const PhysicsSettings& settings) :m_settings(settings), m_accumulator(0), m_bodyCount(0)
+	{
+	}
+
+	PhysicsWorld::~PhysicsWorld()
+	{
+	}
+
+	U32 PhysicsWorld::CreateBody(const BodyDesc& desc)
+	{
+		if (!IsValidShape(desc.shape) || desc.mass < 0.0f)return INVALID_BODY;
+
+		U32 body;
+		if (!m_freeBodies.empty())
+		{
+			body = m_freeBodies.back();
+			m_freeBodies.pop_back();
+		}
+		else
+		{
+			body = (U32)m_positions.size();
+			m_positions.emplace_back();
+			m_rotations.emplace_back();
+			m_linearVelocities.emplace_back();
+			m_angularVelocities.emplace_back();
+			m_inverseMasses.emplace_back();
+			m_inverseInertias.emplace_back();
+			m_frictions.emplace_back();
+			m_restitutions.emplace_back();
+			m_shapes.emplace_back();
+			m_proxies.emplace_back();
+			m_alive.emplace_back();
+			m_solverBodies.emplace_back();
+		}
+
+		const bool dynamic = 0.0f < desc.mass;
+		m_positions[body] = desc.position;
+		m_rotations[body] = Normalize(desc.rotation);
+		m_linearVelocities[body] = dynamic ? desc.linearVelocity : Vector3();
+		m_angularVelocities[body] = dynamic ? desc.angularVelocity : Vector3();
+		m_inverseMasses[body] = dynamic ? 1.0f / desc.mass : 0.0f;
+		m_inverseInertias[body] = ComputeInverseInertia(desc.shape, desc.mass);
+		m_frictions[body] = desc.friction;
+		m_restitutions[body] = desc.restitution;
+		m_shapes[body] = desc.shape;
+		m_alive[body] = 1;
+
+		Narrowphase::ShapeInstance instance = { &m_shapes[body], m_positions[body], Mat3::FromQuaternion(m_rotations[body]) };
+		U32 proxy = m_broadphase.Add(Narrowphase::ComputeBounds(instance));
+		m_proxies[body] = proxy;
+		if (m_proxyBodies.size() <= proxy)m_proxyBodies.resize(proxy + 1, INVALID_BODY);
+		m_proxyBodies[proxy] = body;
+
+		m_bodyCount++;
+		return body;
+	}
+
+	S32 PhysicsWorld::DestroyBody(const U32 body)
+	{
+		if (!IsAlive(body))return -1;
+
+		m_broadphase.Remove(m_proxies[body]);
+		m_proxyBodies[m_proxies[body]] = INVALID_BODY;
+		m_alive[body] = 0;
+		m_inverseMasses[body] = 0.0f;
+		m_inverseInertias[body] = Vector3();
+		m_linearVelocities[body] = Vector3();
+		m_angularVelocities[body] = Vector3();
+		m_pendingFree.push_back(body);
+		m_bodyCount--;
+		return 0;
+	}
+
+	bool PhysicsWorld::IsAlive(const U32 body)const
+	{
+		return body < m_alive.size() && m_alive[body];
+	}
+
+	void PhysicsWorld::Step(const F32 deltaTime)
+	{
+		if (deltaTime <= 0.0f)return;
+
+		IntegrateVelocities(deltaTime);
+		UpdateBroadphase();
+		FindContacts();
+		BuildIslands();
+
+		Parallel::For(m_islandRanges.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t island = begin; island < end; island++)SolveIsland((U32)island, deltaTime);
+			});
+
+		IntegratePositions(deltaTime);
+
+		// 破棄された番号は前回の接触が残らなくなってから再利用する
+		m_freeBodies.insert(m_freeBodies.end(), m_pendingFree.begin(), m_pendingFree.end());
+		m_pendingFree.clear();
+	}
+
+	U32 PhysicsWorld::Simulate(const F32 elapsedTime)
+	{
+		const F32 step = m_settings.fixedTimeStep;
+		if (step <= 0.0f)return 0;
+
+		m_accumulator += elapsedTime;
+		U32 count = 0;
+		while (step <= m_accumulator && count < m_settings.maxSubSteps)
+		{
+			Step(step);
+			m_accumulator -= step;
+			count++;
+		}
+
+		// 処理が追いつかない場合は残りの時間を捨てて遅れが蓄積しないようにする
+		if (step <= m_accumulator)m_accumulator = 0.0f;
+		return count;
+	}
+
+	U64 PhysicsWorld::ComputeStateHash()const
+	{
+		U64 hash = 14695981039346656037ull;
+		for (U32 body = 0; body < m_positions.size(); body++)
+		{
+			if (!m_alive[body])continue;
+			hash = HashBytes(hash, &body, sizeof(body));
+			hash = HashBytes(hash, &m_positions[body], sizeof(Vector3));
+			hash = HashBytes(hash, &m_rotations[body], sizeof(Quaternion));
+			hash = HashBytes(hash, &m_linearVelocities[body], sizeof(Vector3));
+			hash = HashBytes(hash, &m_angularVelocities[body], sizeof(Vector3));
+		}
+		return hash;
+	}
+
+	S32 PhysicsWorld::SetPosition(const U32 body, const Vector3& position)
+	{
+		if (!IsAlive(body))return -1;
+
+		m_positions[body] = position;
+		Narrowphase::ShapeInstance instance = { &m_shapes[body], position, Mat3::FromQuaternion(m_rotations[body]) };
+		m_broadphase.Move(m_proxies[body], Narrowphase::ComputeBounds(instance));
+		return 0;
+	}
+
+	S32 PhysicsWorld::SetRotation(const U32 body, const Quaternion& rotation)
+	{
+		if (!IsAlive(body))return -1;
+
+		m_rotations[body] = Normalize(rotation);
+		Narrowphase::ShapeInstance instance = { &m_shapes[body], m_positions[body], Mat3::FromQuaternion(m_rotations[body]) };
+		m_broadphase.Move(m_proxies[body], Narrowphase::ComputeBounds(instance));
+		return 0;
+	}
+
+	S32 PhysicsWorld::SetLinearVelocity(const U32 body, const Vector3& velocity)
+	{
+		if (!IsAlive(body) || m_inverseMasses[body] == 0.0f)return -1;
+		m_linearVelocities[body] = velocity;
+		return 0;
+	}
+
+	S32 PhysicsWorld::SetAngularVelocity(const U32 body, const Vector3& velocity)
+	{
+		if (!IsAlive(body) || m_inverseMasses[body] == 0.0f)return -1;
+		m_angularVelocities[body] = velocity;
+		return 0;
+	}
+
+	S32 PhysicsWorld::ApplyImpulse(const U32 body, const Vector3& impulse)
+	{
+		if (!IsAlive(body))return -1;
+		m_linearVelocities[body] += impulse * m_inverseMasses[body];
+		return 0;
+	}
+
+	S32 PhysicsWorld::GetTransform(const U32 body, Affine& dest)const
+	{
+		if (!IsAlive(body))return -1;
+
+		Mat3 rotation = Mat3::FromQuaternion(m_rotations[body]);
+		const Vector3& p = m_positions[body];
+		dest.Set(
+			rotation.axes[0].x, rotation.axes[0].y, rotation.axes[0].z,
+			rotation.axes[1].x, rotation.axes[1].y, rotation.axes[1].z,
+			rotation.axes[2].x, rotation.axes[2].y, rotation.axes[2].z,
+			p.x, p.y, p.z);
+		return 0;
+	}
+
+	U32 PhysicsWorld::GetContactCount()const
+	{
+		U32 count = 0;
+		for (const Manifold& manifold : m_manifolds)count += manifold.count;
+		return count;
+	}
+
+	void PhysicsWorld::IntegrateVelocities(const F32 deltaTime)
+	{
+		const Vector3 gravity = m_settings.gravity * deltaTime;
+		const F32 linearDamping = 1.0f / (1.0f + deltaTime * m_settings.linearDamping);
+		const F32 angularDamping = 1.0f / (1.0f + deltaTime * m_settings.angularDamping);
+		const U32 capacity = (U32)m_positions.size();
+
+		Parallel::For(capacity, 256, [&](size_t begin, size_t end)
+			{
+				for (size_t body = begin; body < end; body++)
+				{
+					if (!m_alive[body])continue;
+
+					SolverBody& solverBody = m_solverBodies[body];
+					solverBody.rotation = Mat3::FromQuaternion(m_rotations[body]);
+					if (m_inverseMasses[body] == 0.0f)
+					{
+						solverBody.inverseInertia[0] = solverBody.inverseInertia[1] = solverBody.inverseInertia[2] = Vector3();
+						continue;
+					}
+
+					// R * diag(I^-1) * R^T
+					const Vector3* axes = solverBody.rotation.axes;
+					const Vector3& inverse = m_inverseInertias[body];
+					for (U32 row = 0; row < 3; row++)
+					{
+						const F32 r0 = row == 0 ? axes[0].x : row == 1 ? axes[0].y : axes[0].z;
+						const F32 r1 = row == 0 ? axes[1].x : row == 1 ? axes[1].y : axes[1].z;
+						const F32 r2 = row == 0 ? axes[2].x : row == 1 ? axes[2].y : axes[2].z;
+						solverBody.inverseInertia[row] = axes[0] * (r0 * inverse.x) + axes[1] * (r1 * inverse.y) + axes[2] * (r2 * inverse.z);
+					}
+
+					m_linearVelocities[body] = (m_linearVelocities[body] + gravity) * linearDamping;
+					m_angularVelocities[body] = m_angularVelocities[body] * angularDamping;
+				}
+			});
+	}
+
+	void PhysicsWorld::UpdateBroadphase()
+	{
+		const Vector3 margin(m_settings.contactMargin, m_settings.contactMargin, m_settings.contactMargin);
+		const U32 capacity = (U32)m_positions.size();
+
+		// 動かない物体の境界ボックスは生成時とSetPositionで更新される
+		for (U32 body = 0; body < capacity; body++)
+		{
+			if (!m_alive[body] || m_inverseMasses[body] == 0.0f)continue;
+
+			Narrowphase::ShapeInstance instance = { &m_shapes[body], m_positions[body], m_solverBodies[body].rotation };
+			Bounds bounds = Narrowphase::ComputeBounds(instance);
+			m_broadphase.Move(m_proxies[body], Bounds(bounds.min - margin, bounds.max + margin));
+		}
+		m_broadphase.Update();
+	}
+
+	void PhysicsWorld::FindContacts()
+	{
+		m_previousManifolds.swap(m_manifolds);
+		const ArrayList<BroadphasePair>& pairs = m_broadphase.GetPairs();
+		m_manifolds.resize(pairs.size());
+
+		const F32 margin = m_settings.contactMargin;
+		const F32 matchDistanceSq = WARM_START_DISTANCE * WARM_START_DISTANCE;
+
+		// 組ごとに書き込み先が決まっているため、並列に処理しても結果の順序は変わらない
+		Parallel::For(pairs.size(), PAIRS_PER_TASK, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; i++)
+				{
+					Manifold& manifold = m_manifolds[i];
+					manifold.count = 0;
+
+					U32 a = m_proxyBodies[pairs[i].a];
+					U32 b = m_proxyBodies[pairs[i].b];
+					if (b < a)std::swap(a, b);
+					if (m_inverseMasses[a] == 0.0f && m_inverseMasses[b] == 0.0f)continue;
+
+					const SolverBody& bodyA = m_solverBodies[a];
+					const SolverBody& bodyB = m_solverBodies[b];
+					Narrowphase::ShapeInstance instanceA = { &m_shapes[a], m_positions[a], bodyA.rotation };
+					Narrowphase::ShapeInstance instanceB = { &m_shapes[b], m_positions[b], bodyB.rotation };
+					Narrowphase::ContactResult result;
+					if (!Narrowphase::Collide(instanceA, instanceB, margin, result) || result.count == 0)continue;
+
+					manifold.key = MakeKey(a, b);
+					manifold.bodyA = a;
+					manifold.bodyB = b;
+					manifold.normal = result.normal;
+					manifold.friction = Mathf::Sqrt(m_frictions[a] * m_frictions[b]);
+					manifold.restitution = Mathf::Max(m_restitutions[a], m_restitutions[b]);
+					manifold.count = result.count;
+
+					// 前回の同じ組の接触から、ローカル座標が近い点の力積を引き継ぐ
+					auto previous = std::lower_bound(m_previousManifolds.begin(), m_previousManifolds.end(), manifold.key,
+						[](const Manifold& m, const U64 key) { return m.key < key; });
+					const bool hasPrevious = previous != m_previousManifolds.end() && previous->key == manifold.key;
+
+					for (U32 k = 0; k < result.count; k++)
+					{
+						Manifold::Point& point = manifold.points[k];
+						point.position = result.points[k].position;
+						point.depth = result.points[k].depth;
+						point.localA = bodyA.rotation.InverseTransform(point.position - m_positions[a]);
+						point.localB = bodyB.rotation.InverseTransform(point.position - m_positions[b]);
+						point.normalImpulse = 0.0f;
+						point.tangentImpulses[0] = point.tangentImpulses[1] = 0.0f;
+						if (!hasPrevious)continue;
+
+						F32 best = matchDistanceSq;
+						for (U32 p = 0; p < previous->count; p++)
+						{
+							const Manifold::Point& old = previous->points[p];
+							Vector3 d = old.localA - point.localA;
+							F32 distanceSq = Vector3::Dot(d, d);
+							if (best <= distanceSq)continue;
+
+							best = distanceSq;
+							point.normalImpulse = old.normalImpulse;
+							point.tangentImpulses[0] = old.tangentImpulses[0];
+							point.tangentImpulses[1] = old.tangentImpulses[1];
+						}
+					}
+
+					// 接線は前回と同じ向きにして摩擦の力積を引き継げるようにする
+					if (hasPrevious && 0.99f < Vector3::Dot(previous->normal, manifold.normal))
+					{
+						Vector3 t1 = previous->tangents[0] - manifold.normal * Vector3::Dot(previous->tangents[0], manifold.normal);
+						manifold.tangents[0] = t1 / Mathf::Sqrt(Vector3::Dot(t1, t1));
+						manifold.tangents[1] = Vector3::Cross(manifold.normal, manifold.tangents[0]);
+					}
+					else
+					{
+						ComputeTangents(manifold.normal, manifold.tangents[0], manifold.tangents[1]);
+					}
+				}
+			});
+
+		// 接触していない組を取り除き、剛体の組の順に並べる
+		size_t count = 0;
+		for (size_t i = 0; i < m_manifolds.size(); i++)
+		{
+			if (m_manifolds[i].count == 0)continue;
+			if (count != i)m_manifolds[count] = m_manifolds[i];
+			count++;
+		}
+		m_manifolds.resize(count);
+		std::sort(m_manifolds.begin(), m_manifolds.end(), [](const Manifold& a, const Manifold& b) { return a.key < b.key; });
+	}
+
+	U32 PhysicsWorld::FindIslandRoot(U32 body)
+	{
+		while (m_islandParents[body] != body)
+		{
+			m_islandParents[body] = m_islandParents[m_islandParents[body]];
+			body = m_islandParents[body];
+		}
+		return body;
+	}
+
+	void PhysicsWorld::BuildIslands()
+	{
+		const U32 capacity = (U32)m_positions.size();
+		m_islandParents.resize(capacity);
+		for (U32 body = 0; body < capacity; body++)m_islandParents[body] = body;
+
+		// 動く物体同士の接触でつなぐ。根は常に小さい番号にして、アイランドの順序を番号で決める
+		for (const Manifold& manifold : m_manifolds)
+		{
+			if (m_inverseMasses[manifold.bodyA] == 0.0f || m_inverseMasses[manifold.bodyB] == 0.0f)continue;
+
+			U32 rootA = FindIslandRoot(manifold.bodyA);
+			U32 rootB = FindIslandRoot(manifold.bodyB);
+			if (rootA < rootB)m_islandParents[rootB] = rootA;
+			else if (rootB < rootA)m_islandParents[rootA] = rootB;
+		}
+
+		// 接触を根ごとに数え、根の番号順に並べる(計数ソート)
+		ArrayList<U32> roots(m_manifolds.size());
+		ArrayList<U32> offsets(capacity + 1, 0);
+		for (size_t i = 0; i < m_manifolds.size(); i++)
+		{
+			const Manifold& manifold = m_manifolds[i];
+			U32 dynamicBody = m_inverseMasses[manifold.bodyA] != 0.0f ? manifold.bodyA : manifold.bodyB;
+			roots[i] = FindIslandRoot(dynamicBody);
+			offsets[roots[i] + 1]++;
+		}
+
+		m_islandRanges.clear();
+		for (U32 body = 0; body < capacity; body++)
+		{
+			U32 count = offsets[body + 1];
+			offsets[body + 1] = offsets[body] + count;
+			if (0 < count)m_islandRanges.push_back(std::make_pair(offsets[body], offsets[body + 1]));
+		}
+
+		m_islandManifolds.resize(m_manifolds.size());
+		for (size_t i = 0; i < m_manifolds.size(); i++)m_islandManifolds[offsets[roots[i]]++] = (U32)i;
+	}
+
+	void PhysicsWorld::SolveIsland(const U32 island, const F32 deltaTime)
+	{
+		const U32 first = m_islandRanges[island].first;
+		const U32 last = m_islandRanges[island].second;
+		const F32 inverseDeltaTime = 1.0f / deltaTime;
+		const F32 baumgarte = m_settings.baumgarte * inverseDeltaTime;
+		const F32 slop = m_settings.linearSlop;
+
+		Vector3* const linear = m_linearVelocities.data();
+		Vector3* const angular = m_angularVelocities.data();
+
+		// 動かない物体は複数のアイランドから参照されるため書き込まない
+		auto apply = [&](const Manifold& m, const Manifold::Row& row, const Vector3& direction, const F32 lambda)
+		{
+			if (m.inverseMassA != 0.0f)
+			{
+				linear[m.bodyA] -= direction * (lambda * m.inverseMassA);
+				angular[m.bodyA] -= row.impulseA * lambda;
+			}
+			if (m.inverseMassB != 0.0f)
+			{
+				linear[m.bodyB] += direction * (lambda * m.inverseMassB);
+				angular[m.bodyB] += row.impulseB * lambda;
+			}
+		};
+
+		auto velocity = [&](const Manifold& m, const Manifold::Row& row, const Vector3& direction)
+		{
+			return Vector3::Dot(linear[m.bodyB] - linear[m.bodyA], direction)
+				+ Vector3::Dot(angular[m.bodyB], row.angularB) - Vector3::Dot(angular[m.bodyA], row.angularA);
+		};
+
+		// 準備とウォームスタート
+		for (U32 i = first; i < last; i++)
+		{
+			Manifold& m = m_manifolds[m_islandManifolds[i]];
+			m.inverseMassA = m_inverseMasses[m.bodyA];
+			m.inverseMassB = m_inverseMasses[m.bodyB];
+			const Vector3* inertiaA = m_solverBodies[m.bodyA].inverseInertia;
+			const Vector3* inertiaB = m_solverBodies[m.bodyB].inverseInertia;
+			const Vector3 directions[] = { m.normal, m.tangents[0], m.tangents[1] };
+
+			for (U32 k = 0; k < m.count; k++)
+			{
+				Manifold::Point& point = m.points[k];
+				const Vector3 rA = point.position - m_positions[m.bodyA];
+				const Vector3 rB = point.position - m_positions[m.bodyB];
+				for (U32 r = 0; r < 3; r++)
+				{
+					Manifold::Row& row = point.rows[r];
+					row.angularA = Vector3::Cross(rA, directions[r]);
+					row.angularB = Vector3::Cross(rB, directions[r]);
+					row.impulseA = Multiply(inertiaA, row.angularA);
+					row.impulseB = Multiply(inertiaB, row.angularB);
+					F32 k = m.inverseMassA + m.inverseMassB + Vector3::Dot(row.angularA, row.impulseA) + Vector3::Dot(row.angularB, row.impulseB);
+					row.mass = 0.0f < k ? 1.0f / k : 0.0f;
+				}
+
+				// めり込んでいる場合は押し戻し、離れている場合は隙間を埋める速度までの接近を許す
+				point.targetVelocity = 0.0f <= point.depth ?
+					baumgarte * Mathf::Max(point.depth - slop, 0.0f) :
+					point.depth * inverseDeltaTime;
+
+				F32 approach = velocity(m, point.rows[0], m.normal);
+				if (approach < -RESTITUTION_THRESHOLD)
+				{
+					point.targetVelocity = Mathf::Max(point.targetVelocity, -m.restitution * approach);
+				}
+
+				apply(m, point.rows[0], m.normal, point.normalImpulse);
+				apply(m, point.rows[1], m.tangents[0], point.tangentImpulses[0]);
+				apply(m, point.rows[2], m.tangents[1], point.tangentImpulses[1]);
+			}
+		}
+
+		for (U32 iteration = 0; iteration < m_settings.velocityIterations; iteration++)
+		{
+			// 接触点を毎回同じ順に解くと先に解いた角に力積が偏り、積んだ物体が傾いていくため、反復ごとに順序を逆にする
+			const bool reverse = (iteration & 1) != 0;
+			for (U32 i = first; i < last; i++)
+			{
+				Manifold& m = m_manifolds[m_islandManifolds[i]];
+
+				// 摩擦は前回の垂直方向の力積で制限する
+				for (U32 j = 0; j < m.count; j++)
+				{
+					Manifold::Point& point = m.points[reverse ? m.count - 1 - j : j];
+					const F32 maxFriction = m.friction * point.normalImpulse;
+					for (U32 t = 0; t < 2; t++)
+					{
+						const Manifold::Row& row = point.rows[t + 1];
+						F32 lambda = -velocity(m, row, m.tangents[t]) * row.mass;
+						F32 accumulated = Mathf::Clamp(point.tangentImpulses[t] + lambda, -maxFriction, maxFriction);
+						lambda = accumulated - point.tangentImpulses[t];
+						point.tangentImpulses[t] = accumulated;
+						apply(m, row, m.tangents[t], lambda);
+					}
+				}
+
+				for (U32 j = 0; j < m.count; j++)
+				{
+					Manifold::Point& point = m.points[reverse ? m.count - 1 - j : j];
+					const Manifold::Row& row = point.rows[0];
+					F32 lambda = (point.targetVelocity - velocity(m, row, m.normal)) * row.mass;
+					F32 accumulated = Mathf::Max(point.normalImpulse + lambda, 0.0f);
+					lambda = accumulated - point.normalImpulse;
+					point.normalImpulse = accumulated;
+					apply(m, row, m.normal, lambda);
+				}
+			}
+		}
+	}
+
+	void PhysicsWorld::IntegratePositions(const F32 deltaTime)
+	{
+		const U32 capacity = (U32)m_positions.size();
+		const F32 halfDeltaTime = deltaTime * 0.5f;
+
+		Parallel::For(capacity, 256, [&](size_t begin, size_t end)
+			{
+				for (size_t body = begin; body < end; body++)
+				{
+					if (!m_alive[body] || m_inverseMasses[body] == 0.0f)continue;
+
+					m_positions[body] += m_linearVelocities[body] * deltaTime;
+
+					// dq/dt = 0.5 * ω * q
+					const Vector3& w = m_angularVelocities[body];
+					Quaternion& q = m_rotations[body];
+					Quaternion dq = Quaternion(w.x, w.y, w.z, 0) * q;
+					q = Normalize(Quaternion(q.x + dq.x * halfDeltaTime, q.y + dq.y * halfDeltaTime, q.z + dq.z * halfDeltaTime, q.w + dq.w * halfDeltaTime));
+				}
+			});
+	}
+
+
+	//===================================================================================//
+	// PhysicsBenchmark
+	//===================================================================================//
+
+	U32 PhysicsBenchmark::CreateBoxStacks(PhysicsWorld& world, const U32 columns, const U32 height)
+	{
+		const F32 spacing = 3.0f;
+		const F32 halfWidth = columns * spacing * 0.5f;
+
+		BodyDesc ground;
+		ground.shape = CollisionShape::CreateBox(Vector3(halfWidth + spacing, 1.0f, halfWidth + spacing));
+		ground.position = Vector3(0.0f, -1.0f, 0.0f);
+		ground.mass = 0.0f;
+		world.CreateBody(ground);
+
+		BodyDesc box;
+		box.shape = CollisionShape::CreateBox(Vector3(0.5f, 0.5f, 0.5f));
+		U32 count = 0;
+		for (U32 x = 0; x < columns; x++)
+		{
+			for (U32 z = 0; z < columns; z++)
+			{
+				for (U32 y = 0; y < height; y++)
+				{
+					box.position = Vector3(x * spacing - halfWidth, 0.5f + y * 1.0f, z * spacing - halfWidth);
+					if (world.CreateBody(box) != PhysicsWorld::INVALID_BODY)count++;
+				}
+			}
+		}
+		return count;
+	}
+
+	F64 PhysicsBenchmark::Run(PhysicsWorld& world, const U32 stepCount)
+	{
+		if (stepCount == 0)return 0.0;
+
+		const F32 step = world.GetSettings().fixedTimeStep;
+		F64 start = Platform::GetTime();
+		for (U32 i = 0; i < stepCount; i++)world.Step(step);
+		return (Platform::GetTime() - start) * 1000.0 / stepCount;
+	}
+
+	F32 PhysicsBenchmark::MeasureDrift(PhysicsWorld& world, const U32 stepCount)
+	{
+		const PhysicsSettings& settings = world.GetSettings();
+		const F32 gravityLengthSq = Vector3::Dot(settings.gravity, settings.gravity);
+		const Vector3 up = 0.0f < gravityLengthSq ? settings.gravity / -Mathf::Sqrt(gravityLengthSq) : Vector3(0.0f, 1.0f, 0.0f);
+
+		const ArrayList<Vector3> start = world.GetPositions();
+		F32 maxDriftSq = 0.0f;
+		for (U32 i = 0; i < stepCount; i++)
+		{
+			world.Step(settings.fixedTimeStep);
+
+			const ArrayList<Vector3>& positions = world.GetPositions();
+			for (U32 body = 0; body < start.size(); body++)
+			{
+				if (!world.IsAlive(body))continue;
+
+				Vector3 d = positions[body] - start[body];
+				d -= up * Vector3::Dot(d, up);
+				maxDriftSq = Mathf::Max(maxDriftSq, Vector3::Dot(d, d));
+			}
+		}
+		return Mathf::Sqrt(maxDriftSq);
+	}
+}
\ No newline at end of file
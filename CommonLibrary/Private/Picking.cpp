@@ -0,0 +1,580 @@
+﻿#include "pch.h"
+#include "Picking.h"
+#include "Check.h"
+#include "Mathf.h"
+#include "Simd.h"
+
+#include <algorithm>
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	// SAHで分割位置を探す区間の数
+	const U32 SAH_BIN_COUNT = 16;
+
+	// 走査に使うスタックの深さ(木の深さの上限)
+	const U32 MAX_STACK_DEPTH = 64;
+
+	// 上位の木の葉が持つインスタンスの最大数
+	const U32 MAX_LEAF_INSTANCES = 2;
+
+	inline F32 GetAxis(const Vector3& v, const U32 axis)
+	{
+		return axis == 0 ? v.x : axis == 1 ? v.y : v.z;
+	}
+
+	inline U32 GetBin(const F32 value, const F32 minimum, const F32 scale)
+	{
+		U32 bin = (U32)((value - minimum) * scale);
+		return bin < SAH_BIN_COUNT ? bin : SAH_BIN_COUNT - 1;
+	}
+
+	inline Bounds EmptyBounds()
+	{
+		return Bounds(Vector3(FLT_MAX, FLT_MAX, FLT_MAX), Vector3(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+	}
+
+	inline F32 SurfaceArea(const Bounds& bounds)
+	{
+		Vector3 size = bounds.max - bounds.min;
+		if (size.x < 0.0f || size.y < 0.0f || size.z < 0.0f)return 0.0f;
+		return size.x * size.y + size.y * size.z + size.z * size.x;
+	}
+
+	inline Vector3 TransformPoint(const Vector3& p, const Affine& a)
+	{
+		return Vector3(
+			p.x * a.m[0][0] + p.y * a.m[1][0] + p.z * a.m[2][0] + a.m[3][0],
+			p.x * a.m[0][1] + p.y * a.m[1][1] + p.z * a.m[2][1] + a.m[3][1],
+			p.x * a.m[0][2] + p.y * a.m[1][2] + p.z * a.m[2][2] + a.m[3][2]);
+	}
+
+	inline Vector3 TransformVector(const Vector3& v, const Affine& a)
+	{
+		return Vector3(
+			v.x * a.m[0][0] + v.y * a.m[1][0] + v.z * a.m[2][0],
+			v.x * a.m[0][1] + v.y * a.m[1][1] + v.z * a.m[2][1],
+			v.x * a.m[0][2] + v.y * a.m[1][2] + v.z * a.m[2][2]);
+	}
+
+	/// <summary>
+	/// アフィン行列の逆行列。逆行列が存在しない場合は単位行列を返す。
+	/// </summary>
+	Affine Inverse(const Affine& a)
+	{
+		const F32(*m)[3] = a.m;
+		const F32 c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+		const F32 c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+		const F32 c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+		const F32 det = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+
+		Affine ret;
+		if (det == 0.0f)return ret;
+		const F32 inv = 1.0f / det;
+
+		ret.m[0][0] = c00 * inv;
+		ret.m[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * inv;
+		ret.m[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * inv;
+		ret.m[1][0] = c01 * inv;
+		ret.m[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * inv;
+		ret.m[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * inv;
+		ret.m[2][0] = c02 * inv;
+		ret.m[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * inv;
+		ret.m[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inv;
+
+		Vector3 t = TransformVector(Vector3(m[3][0], m[3][1], m[3][2]), ret);
+		ret.m[3][0] = -t.x;
+		ret.m[3][1] = -t.y;
+		ret.m[3][2] = -t.z;
+		return ret;
+	}
+
+	/// <summary>
+	/// レイと境界ボックスの交差(スラブ法)
+	/// </summary>
+	/// <returns>交差する場合は入る距離、交差しない場合はFLT_MAX</returns>
+	inline F32 IntersectNode(const BvhNode& node, const Vector3& origin, const Vector3& inverseDirection, const F32 maxDistance)
+	{
+		F32 tx1 = (node.min.x - origin.x) * inverseDirection.x, tx2 = (node.max.x - origin.x) * inverseDirection.x;
+		F32 ty1 = (node.min.y - origin.y) * inverseDirection.y, ty2 = (node.max.y - origin.y) * inverseDirection.y;
+		F32 tz1 = (node.min.z - origin.z) * inverseDirection.z, tz2 = (node.max.z - origin.z) * inverseDirection.z;
+
+		F32 tmin = Mathf::Max(Mathf::Max(Mathf::Min(tx1, tx2), Mathf::Min(ty1, ty2)), Mathf::Max(Mathf::Min(tz1, tz2), 0.0f));
+		F32 tmax = Mathf::Min(Mathf::Min(Mathf::Max(tx1, tx2), Mathf::Max(ty1, ty2)), Mathf::Min(Mathf::Max(tz1, tz2), maxDistance));
+		return tmin <= tmax ? tmin : FLT_MAX;
+	}
+
+	inline Vector3 InverseDirection(const Vector3& d)
+	{
+		// 0の成分は無限大にして、その軸のスラブを常に満たす(または常に外れる)ようにする
+		return Vector3(d.x != 0.0f ? 1.0f / d.x : FLT_MAX, d.y != 0.0f ? 1.0f / d.y : FLT_MAX, d.z != 0.0f ? 1.0f / d.z : FLT_MAX);
+	}
+
+	/// <summary>
+	/// 要素の境界ボックスと中心からSAHで木を構築する
+	/// </summary>
+	/// <param name="order">葉の要素の並び順を書き込む</param>
+	void BuildBvh(const ArrayList<Bounds>& bounds, const ArrayList<Vector3>& centroids, const U32 maxLeafSize, ArrayList<BvhNode>& nodes, ArrayList<U32>& order)
+	{
+		const U32 count = (U32)bounds.size();
+		nodes.clear();
+		order.resize(count);
+		for (U32 i = 0; i < count; i++)order[i] = i;
+		if (count == 0)return;
+
+		struct Task
+		{
+			U32 node;
+			U32 begin;
+			U32 end;
+		};
+		ArrayList<Task> tasks;
+		nodes.reserve(count * 2);
+		nodes.emplace_back();
+		tasks.push_back({ 0, 0, count });
+
+		while (!tasks.empty())
+		{
+			const Task task = tasks.back();
+			tasks.pop_back();
+
+			Bounds nodeBounds = EmptyBounds();
+			Bounds centroidBounds = EmptyBounds();
+			for (U32 i = task.begin; i < task.end; i++)
+			{
+				nodeBounds.Encapsulate(bounds[order[i]]);
+				centroidBounds.Encapsulate(centroids[order[i]]);
+			}
+
+			BvhNode& node = nodes[task.node];
+			node.min = nodeBounds.min;
+			node.max = nodeBounds.max;
+			node.first = task.begin;
+			node.count = task.end - task.begin;
+			if (node.count <= maxLeafSize)continue;
+
+			// 3軸それぞれで区間ごとに集計し、表面積と要素数の積の和が最小になる位置で分ける
+			F32 bestCost = FLT_MAX;
+			U32 bestAxis = 0, bestBin = 0;
+			for (U32 axis = 0; axis < 3; axis++)
+			{
+				const F32 minimum = GetAxis(centroidBounds.min, axis);
+				const F32 extent = GetAxis(centroidBounds.max, axis) - minimum;
+				if (extent <= 0.0f)continue;
+
+				const F32 scale = SAH_BIN_COUNT / extent;
+				U32 binCounts[SAH_BIN_COUNT] = {};
+				Bounds binBounds[SAH_BIN_COUNT];
+				for (U32 b = 0; b < SAH_BIN_COUNT; b++)binBounds[b] = EmptyBounds();
+				for (U32 i = task.begin; i < task.end; i++)
+				{
+					U32 b = GetBin(GetAxis(centroids[order[i]], axis), minimum, scale);
+					binCounts[b]++;
+					binBounds[b].Encapsulate(bounds[order[i]]);
+				}
+
+				F32 rightCosts[SAH_BIN_COUNT];
+				Bounds right = EmptyBounds();
+				U32 rightCount = 0;
+				for (U32 b = SAH_BIN_COUNT - 1; 0 < b; b--)
+				{
+					right.Encapsulate(binBounds[b]);
+					rightCount += binCounts[b];
+					rightCosts[b] = SurfaceArea(right) * rightCount;
+				}
+
+				Bounds left = EmptyBounds();
+				U32 leftCount = 0;
+				for (U32 b = 0; b < SAH_BIN_COUNT - 1; b++)
+				{
+					left.Encapsulate(binBounds[b]);
+					leftCount += binCounts[b];
+					F32 cost = SurfaceArea(left) * leftCount + rightCosts[b + 1];
+					if (0 < leftCount && leftCount < node.count && cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestBin = b;
+					}
+				}
+			}
+
+			U32 middle;
+			if (bestCost == FLT_MAX)
+			{
+				// 中心が全て同じ位置にある場合は半分に分ける
+				middle = (task.begin + task.end) / 2;
+			}
+			else
+			{
+				const F32 minimum = GetAxis(centroidBounds.min, bestAxis);
+				const F32 scale = SAH_BIN_COUNT / (GetAxis(centroidBounds.max, bestAxis) - minimum);
+				U32* split = std::partition(order.data() + task.begin, order.data() + task.end, [&](const U32 item)
+					{
+						return GetBin(GetAxis(centroids[item], bestAxis), minimum, scale) <= bestBin;
+					});
+				middle = (U32)(split - order.data());
+				if (middle == task.begin || middle == task.end)middle = (task.begin + task.end) / 2;
+			}
+
+			const U32 left = (U32)nodes.size();
+			nodes[task.node].first = left;
+			nodes[task.node].count = 0;
+			nodes.emplace_back();
+			nodes.emplace_back();
+			tasks.push_back({ left, task.begin, middle });
+			tasks.push_back({ left + 1, middle, task.end });
+		}
+	}
+
+	/// <summary>
+	/// 走査中のノード
+	/// </summary>
+	struct TraversalEntry
+	{
+		U32 node;
+		F32 distance;
+	};
+
+	/// <summary>
+	/// BVHを手前のノードから走査し、葉ごとにtestLeafを呼ぶ
+	/// </summary>
+	/// <param name="best">最も近い交点の距離。testLeafが更新する</param>
+	template<class TestLeaf>
+	void Traverse(const ArrayList<BvhNode>& nodes, const Vector3& origin, const Vector3& direction, F32& best, const TestLeaf& testLeaf)
+	{
+		if (nodes.empty())return;
+
+		const Vector3 inverseDirection = InverseDirection(direction);
+		TraversalEntry stack[MAX_STACK_DEPTH];
+		U32 size = 0;
+
+		F32 rootDistance = IntersectNode(nodes[0], origin, inverseDirection, best);
+		if (rootDistance == FLT_MAX)return;
+		stack[size++] = { 0, rootDistance };
+
+		while (0 < size)
+		{
+			const TraversalEntry entry = stack[--size];
+			if (best < entry.distance)continue;
+
+			const BvhNode& node = nodes[entry.node];
+			if (node.count != 0)
+			{
+				testLeaf(node);
+				continue;
+			}
+
+			U32 nearChild = node.first, farChild = node.first + 1;
+			F32 nearDistance = IntersectNode(nodes[nearChild], origin, inverseDirection, best);
+			F32 farDistance = IntersectNode(nodes[farChild], origin, inverseDirection, best);
+			if (farDistance < nearDistance)
+			{
+				std::swap(nearChild, farChild);
+				std::swap(nearDistance, farDistance);
+			}
+
+			// 遠い方を先に積み、手前から処理する
+			if (farDistance != FLT_MAX && size < MAX_STACK_DEPTH)stack[size++] = { farChild, farDistance };
+			if (nearDistance != FLT_MAX && size < MAX_STACK_DEPTH)stack[size++] = { nearChild, nearDistance };
+		}
+	}
+}
+
+namespace CommonLibrary
+{
+	//===================================================================================//
+	// MeshBvh
+	//===================================================================================//
+
+	MeshBvh::MeshBvh() :m_triangleCount(0)
+	{
+	}
+
+	S32 MeshBvh::Build(const Byte* vertices, const U32 stride, const U32 vertexCount, const U32* indices, const U32 indexCount, const U32 positionOffset)
+	{
+		if (CheckArgs(vertices, positionOffset + sizeof(F32) * 3 <= stride))return -1;
+
+		const U32 triangleCount = indices ? indexCount / 3 : vertexCount / 3;
+		if (indices)
+		{
+			for (U32 i = 0; i < triangleCount * 3; i++)
+			{
+				if (vertexCount <= indices[i])return -1;
+			}
+		}
+
+		auto position = [&](const U32 triangle, const U32 corner)
+		{
+			U32 index = indices ? indices[triangle * 3 + corner] : triangle * 3 + corner;
+			F32 p[3];
+			memcpy(p, vertices + (size_t)index * stride + positionOffset, sizeof(p));
+			return Vector3(p[0], p[1], p[2]);
+		};
+
+		ArrayList<Bounds> bounds(triangleCount);
+		ArrayList<Vector3> centroids(triangleCount);
+		for (U32 t = 0; t < triangleCount; t++)
+		{
+			Vector3 a = position(t, 0), b = position(t, 1), c = position(t, 2);
+			bounds[t] = Bounds(a, a);
+			bounds[t].Encapsulate(b);
+			bounds[t].Encapsulate(c);
+			centroids[t] = bounds[t].GetCenter();
+		}
+
+		ArrayList<U32> order;
+		BuildBvh(bounds, centroids, MAX_LEAF_TRIANGLES, m_nodes, order);
+
+		// 葉の三角形を4つずつまとめ、葉は三角形ではなくまとまりを指すようにする
+		m_packets.clear();
+		m_packets.reserve((triangleCount + 3) / 4 + m_nodes.size() / 2);
+		for (BvhNode& node : m_nodes)
+		{
+			if (node.count == 0)continue;
+
+			const U32 first = (U32)m_packets.size();
+			for (U32 i = 0; i < node.count; i += 4)
+			{
+				TrianglePacket packet = {};
+				for (U32 lane = 0; lane < 4; lane++)
+				{
+					if (node.count <= i + lane)
+					{
+						packet.triangles[lane] = ~0u;
+						continue;
+					}
+
+					const U32 triangle = order[node.first + i + lane];
+					Vector3 v0 = position(triangle, 0);
+					Vector3 e1 = position(triangle, 1) - v0;
+					Vector3 e2 = position(triangle, 2) - v0;
+					packet.v0[0][lane] = v0.x; packet.v0[1][lane] = v0.y; packet.v0[2][lane] = v0.z;
+					packet.e1[0][lane] = e1.x; packet.e1[1][lane] = e1.y; packet.e1[2][lane] = e1.z;
+					packet.e2[0][lane] = e2.x; packet.e2[1][lane] = e2.y; packet.e2[2][lane] = e2.z;
+					packet.triangles[lane] = triangle;
+				}
+				m_packets.push_back(packet);
+			}
+			node.first = first;
+			node.count = (U32)m_packets.size() - first;
+		}
+
+		m_triangleCount = triangleCount;
+		m_bounds = m_nodes.empty() ? Bounds() : Bounds(m_nodes[0].min, m_nodes[0].max);
+		return 0;
+	}
+
+	bool MeshBvh::Raycast(const Ray& ray, const F32 maxDistance, RayHit& hit)const
+	{
+		const F32x4 ox = F32x4::Set1(ray.origin.x), oy = F32x4::Set1(ray.origin.y), oz = F32x4::Set1(ray.origin.z);
+		const F32x4 dx = F32x4::Set1(ray.direction.x), dy = F32x4::Set1(ray.direction.y), dz = F32x4::Set1(ray.direction.z);
+		const F32x4 zero = F32x4::Set1(0.0f), one = F32x4::Set1(1.0f), epsilon = F32x4::Set1(FLT_MIN);
+
+		F32 best = maxDistance;
+		bool found = false;
+		Traverse(m_nodes, ray.origin, ray.direction, best, [&](const BvhNode& node)
+			{
+				for (U32 p = node.first; p < node.first + node.count; p++)
+				{
+					const TrianglePacket& packet = m_packets[p];
+					const F32x4 e1x = F32x4::Load(packet.e1[0]), e1y = F32x4::Load(packet.e1[1]), e1z = F32x4::Load(packet.e1[2]);
+					const F32x4 e2x = F32x4::Load(packet.e2[0]), e2y = F32x4::Load(packet.e2[1]), e2z = F32x4::Load(packet.e2[2]);
+
+					// Möller–Trumbore
+					const F32x4 px = dy * e2z - dz * e2y;
+					const F32x4 py = dz * e2x - dx * e2z;
+					const F32x4 pz = dx * e2y - dy * e2x;
+					const F32x4 det = e1x * px + e1y * py + e1z * pz;
+					const F32x4 inverseDet = one / det;
+
+					const F32x4 sx = ox - F32x4::Load(packet.v0[0]);
+					const F32x4 sy = oy - F32x4::Load(packet.v0[1]);
+					const F32x4 sz = oz - F32x4::Load(packet.v0[2]);
+					const F32x4 u = (sx * px + sy * py + sz * pz) * inverseDet;
+
+					const F32x4 qx = sy * e1z - sz * e1y;
+					const F32x4 qy = sz * e1x - sx * e1z;
+					const F32x4 qz = sx * e1y - sy * e1x;
+					const F32x4 v = (dx * qx + dy * qy + dz * qz) * inverseDet;
+					const F32x4 t = (e2x * qx + e2y * qy + e2z * qz) * inverseDet;
+
+					// 辺が0の三角形はdetが0になるため、ここで除かれる
+					const F32x4 miss = F32x4::Or(
+						F32x4::Or(F32x4::Less(det * det, epsilon), F32x4::Less(u, zero)),
+						F32x4::Or(F32x4::Or(F32x4::Less(v, zero), F32x4::Less(one, u + v)),
+							F32x4::Or(F32x4::Less(t, zero), F32x4::Less(F32x4::Set1(best), t))));
+					S32 mask = ~miss.MoveMask() & 0xF;
+					if (mask == 0)continue;
+
+					F32 ts[4], us[4], vs[4];
+					t.Store(ts);
+					u.Store(us);
+					v.Store(vs);
+					for (U32 lane = 0; mask != 0; lane++, mask >>= 1)
+					{
+						if (!(mask & 1) || best <= ts[lane])continue;
+						best = ts[lane];
+						hit.distance = ts[lane];
+						hit.u = us[lane];
+						hit.v = vs[lane];
+						hit.triangle = packet.triangles[lane];
+						found = true;
+					}
+				}
+			});
+
+		if (found)hit.point = ray.GetPoint(hit.distance);
+		return found;
+	}
+
+
+	//===================================================================================//
+	// SceneBvh
+	//===================================================================================//
+
+	const U32 SceneBvh::INVALID_INSTANCE = ~0u;
+
+	SceneBvh::SceneBvh() :m_instanceCount(0), m_isDirty(false)
+	{
+	}
+
+	U32 SceneBvh::AddInstance(const SPtr<const MeshBvh>& mesh, const Affine& transform)
+	{
+		if (!mesh)return INVALID_INSTANCE;
+
+		U32 instance;
+		if (!m_freeInstances.empty())
+		{
+			instance = m_freeInstances.back();
+			m_freeInstances.pop_back();
+		}
+		else
+		{
+			instance = (U32)m_instances.size();
+			m_instances.emplace_back();
+		}
+
+		m_instances[instance].mesh = mesh;
+		m_instanceCount++;
+		SetTransform(instance, transform);
+		return instance;
+	}
+
+	S32 SceneBvh::RemoveInstance(const U32 instance)
+	{
+		if (m_instances.size() <= instance || !m_instances[instance].mesh)return -1;
+
+		m_instances[instance].mesh.reset();
+		m_freeInstances.push_back(instance);
+		m_instanceCount--;
+		m_isDirty = true;
+		return 0;
+	}
+
+	S32 SceneBvh::SetTransform(const U32 instance, const Affine& transform)
+	{
+		if (m_instances.size() <= instance || !m_instances[instance].mesh)return -1;
+
+		Instance& target = m_instances[instance];
+		target.transform = transform;
+		target.inverse = Inverse(transform);
+
+		// ローカル座標の境界ボックスの8頂点を変換して囲む
+		const Bounds& local = target.mesh->GetBounds();
+		target.bounds = EmptyBounds();
+		for (U32 corner = 0; corner < 8; corner++)
+		{
+			Vector3 p(corner & 1 ? local.max.x : local.min.x, corner & 2 ? local.max.y : local.min.y, corner & 4 ? local.max.z : local.min.z);
+			target.bounds.Encapsulate(TransformPoint(p, transform));
+		}
+		m_isDirty = true;
+		return 0;
+	}
+
+	void SceneBvh::Update()
+	{
+		if (!m_isDirty)return;
+		m_isDirty = false;
+
+		ArrayList<U32> alive;
+		alive.reserve(m_instanceCount);
+		for (U32 i = 0; i < m_instances.size(); i++)
+		{
+			if (m_instances[i].mesh && 0 < m_instances[i].mesh->GetTriangleCount())alive.push_back(i);
+		}
+
+		ArrayList<Bounds> bounds(alive.size());
+		ArrayList<Vector3> centroids(alive.size());
+		for (size_t i = 0; i < alive.size(); i++)
+		{
+			bounds[i] = m_instances[alive[i]].bounds;
+			centroids[i] = bounds[i].GetCenter();
+		}
+
+		BuildBvh(bounds, centroids, MAX_LEAF_INSTANCES, m_nodes, m_order);
+		for (U32& index : m_order)index = alive[index];
+	}
+
+	bool SceneBvh::Raycast(const Ray& ray, RayHit& hit, const F32 maxDistance)const
+	{
+		F32 best = maxDistance;
+		bool found = false;
+		Traverse(m_nodes, ray.origin, ray.direction, best, [&](const BvhNode& node)
+			{
+				for (U32 i = node.first; i < node.first + node.count; i++)
+				{
+					const U32 index = m_order[i];
+					const Instance& instance = m_instances[index];
+
+					// 方向は正規化しないため、ローカル座標での距離はワールド座標の距離と一致する
+					Ray local(TransformPoint(ray.origin, instance.inverse), TransformVector(ray.direction, instance.inverse));
+					RayHit localHit;
+					if (!instance.mesh->Raycast(local, best, localHit))continue;
+
+					best = localHit.distance;
+					hit = localHit;
+					hit.instance = index;
+					found = true;
+				}
+			});
+
+		if (found)hit.point = ray.GetPoint(hit.distance);
+		return found;
+	}
+
+
+	//===================================================================================//
+	// Picking
+	//===================================================================================//
+
+	Ray Picking::ScreenPointToRay(const F32 x, const F32 y, const F32 width, const F32 height, const Matrix& viewProjection)
+	{
+		if (width <= 0.0f || height <= 0.0f)return Ray();
+
+		const F32 ndcX = x / width * 2.0f - 1.0f;
+		const F32 ndcY = 1.0f - y / height * 2.0f;
+		Matrix inverse = Matrix(viewProjection).Inverted();
+
+		auto unproject = [&](const F32 z)
+		{
+			const F32(*m)[4] = inverse.m;
+			F32 px = ndcX * m[0][0] + ndcY * m[1][0] + z * m[2][0] + m[3][0];
+			F32 py = ndcX * m[0][1] + ndcY * m[1][1] + z * m[2][1] + m[3][1];
+			F32 pz = ndcX * m[0][2] + ndcY * m[1][2] + z * m[2][2] + m[3][2];
+			F32 pw = ndcX * m[0][3] + ndcY * m[1][3] + z * m[2][3] + m[3][3];
+			return pw != 0.0f ? Vector3(px / pw, py / pw, pz / pw) : Vector3(px, py, pz);
+		};
+
+		Vector3 nearPoint = unproject(0.0f);
+		Vector3 direction = unproject(1.0f) - nearPoint;
+		F32 length = Mathf::Sqrt(Vector3::Dot(direction, direction));
+		return Ray(nearPoint, 0.0f < length ? direction / length : Vector3(0, 0, 1));
+	}
+
+	bool Picking::Pick(const SceneBvh& scene, const F32 x, const F32 y, const F32 width, const F32 height, const Matrix& viewProjection, RayHit& hit)
+	{
+		return scene.Raycast(ScreenPointToRay(x, y, width, height, viewProjection), hit);
+	}
+}
\ No newline at end of file
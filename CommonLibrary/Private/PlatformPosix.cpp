@@ -0,0 +1,206 @@
+﻿#include "pch.h"
+#include "Platform.h"
+#include "Thread.h"
+
+#if defined(PLATFORM_POSIX)
+
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace CommonLibrary
+{
+	S32 Platform::FormatString(Char* dest, const size_t destSize, const Char* format, ...)
+	{
+		if (dest == nullptr || destSize == 0 || format == nullptr)return -1;
+
+		va_list args;
+		va_start(args, format);
+		S32 length = vsnprintf(dest, destSize, format, args);
+		va_end(args);
+
+		if (length < 0 || destSize <= (size_t)length)return -1;
+		return length;
+	}
+
+	S32 Platform::EnumerateDirectory(const Path& path, ArrayList<FileEntry>& dest)
+	{
+		DIR* dir = opendir(path.ToString().c_str());
+		if (dir == nullptr)return -1;
+
+		while (dirent* entry = readdir(dir))
+		{
+			if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)continue;
+
+			String childPath = path.ToString() + TC("/") + entry->d_name;
+
+			struct stat st;
+			if (stat(childPath.c_str(), &st) != 0)continue;
+
+			FileEntry fileEntry;
+			fileEntry.name = entry->d_name;
+			fileEntry.isDirectory = S_ISDIR(st.st_mode);
+			fileEntry.size = fileEntry.isDirectory ? 0 : (U64)st.st_size;
+			fileEntry.lastWriteTime = (S64)st.st_mtime;
+			dest.push_back(fileEntry);
+		}
+
+		closedir(dir);
+		return 0;
+	}
+
+	bool Platform::FileExists(const Path& path)
+	{
+		struct stat st;
+		if (stat(path.ToString().c_str(), &st) != 0)return false;
+		return S_ISREG(st.st_mode);
+	}
+
+	bool Platform::DirectoryExists(const Path& path)
+	{
+		struct stat st;
+		if (stat(path.ToString().c_str(), &st) != 0)return false;
+		return S_ISDIR(st.st_mode);
+	}
+
+	S32 Platform::MakeDirectory(const Path& path)
+	{
+		if (DirectoryExists(path))return 0;
+		return mkdir(path.ToString().c_str(), 0755) == 0 ? 0 : -1;
+	}
+
+	S32 Platform::RemoveFile(const Path& path)
+	{
+		return unlink(path.ToString().c_str()) == 0 ? 0 : -1;
+	}
+
+	S32 Platform::RenameFile(const Path& from, const Path& to)
+	{
+		// rename(2)は置き換えをアトミックに行う
+		return rename(from.ToString().c_str(), to.ToString().c_str()) == 0 ? 0 : -1;
+	}
+
+	S32 Platform::TouchFile(const Path& path)
+	{
+		// 時刻にnullptrを渡すと現在の時刻になる
+		return utimensat(AT_FDCWD, path.ToString().c_str(), nullptr, 0) == 0 ? 0 : -1;
+	}
+
+
+
+	U64 Platform::GetTimeCounter()
+	{
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (U64)ts.tv_sec * 1000000000ull + (U64)ts.tv_nsec;
+	}
+
+	U64 Platform::GetTimeFrequency()
+	{
+		return 1000000000ull;
+	}
+
+	F64 Platform::GetTime()
+	{
+		return (F64)GetTimeCounter() / (F64)GetTimeFrequency();
+	}
+
+	void Platform::SleepThread(const U32 milliseconds)
+	{
+		timespec ts;
+		ts.tv_sec = milliseconds / 1000;
+		ts.tv_nsec = (long)(milliseconds % 1000) * 1000000;
+		while (nanosleep(&ts, &ts) != 0);
+	}
+
+
+
+	U32 Platform::GetProcessorCount()
+	{
+		long count = sysconf(_SC_NPROCESSORS_ONLN);
+		return 0 < count ? (U32)count : 1;
+	}
+
+	U64 Platform::GetCurrentThreadID()
+	{
+		return (U64)pthread_self();
+	}
+
+
+
+	void* Platform::LoadDynamicLibrary(const Path& path)
+	{
+		return dlopen(path.ToString().c_str(), RTLD_NOW | RTLD_LOCAL);
+	}
+
+	void* Platform::GetLibraryFunction(void* library, const String& name)
+	{
+		if (library == nullptr)return nullptr;
+		return dlsym(library, name.c_str());
+	}
+
+	void Platform::FreeDynamicLibrary(void* library)
+	{
+		if (library == nullptr)return;
+		dlclose(library);
+	}
+
+
+
+	struct ThreadLauncher
+	{
+		static void* Run(void* arg)
+		{
+			auto thread = reinterpret_cast<Thread*>(arg);
+			thread->m_function();
+			return nullptr;
+		}
+	};
+
+	Thread::Thread() :m_handle(nullptr)
+	{
+	}
+
+	Thread::~Thread()
+	{
+		Join();
+	}
+
+	S32 Thread::Start(const std::function<void()>& function)
+	{
+		if (m_handle != nullptr)return -1;
+		if (!function)return -1;
+
+		m_function = function;
+
+		auto handle = new pthread_t;
+		if (pthread_create(handle, nullptr, &ThreadLauncher::Run, this) != 0)
+		{
+			delete handle;
+			return -1;
+		}
+		m_handle = handle;
+		return 0;
+	}
+
+	S32 Thread::Join()
+	{
+		if (m_handle == nullptr)return -1;
+
+		auto handle = reinterpret_cast<pthread_t*>(m_handle);
+		pthread_join(*handle, nullptr);
+		delete handle;
+		m_handle = nullptr;
+		return 0;
+	}
+}
+
+#endif
\ No newline at end of file
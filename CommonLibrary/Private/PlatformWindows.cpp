@@ -0,0 +1,236 @@
+﻿#include "pch.h"
+#include "Platform.h"
+#include "Thread.h"
+
+#if defined(PLATFORM_WINDOWS)
+
+#include <cstdarg>
+#include <cstdio>
+#include <process.h>
+
+namespace
+{
+	// UTF-8の文字列をWindowsのワイド文字列に変換する
+	std::wstring ToWide(const CommonLibrary::String& str)
+	{
+		if (str.empty())return std::wstring();
+		int length = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), nullptr, 0);
+		std::wstring wide(length, L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, str.c_str(), (int)str.size(), &wide[0], length);
+		return wide;
+	}
+
+	// Windowsのワイド文字列をUTF-8の文字列に変換する
+	CommonLibrary::String ToUTF8(const wchar_t* wide)
+	{
+		int length = WideCharToMultiByte(CP_UTF8, 0, wide, -1, nullptr, 0, nullptr, nullptr);
+		if (length <= 1)return CommonLibrary::String();
+		std::string str(length - 1, '\0');
+		WideCharToMultiByte(CP_UTF8, 0, wide, -1, &str[0], length, nullptr, nullptr);
+		return str;
+	}
+
+	// FILETIME(1601年からの100ナノ秒単位)をUNIX時間の秒に変換する
+	S64 ToUnixTime(const FILETIME& time)
+	{
+		ULARGE_INTEGER value;
+		value.LowPart = time.dwLowDateTime;
+		value.HighPart = time.dwHighDateTime;
+		return (S64)(value.QuadPart / 10000000ull) - 11644473600ll;
+	}
+}
+
+namespace CommonLibrary
+{
+	S32 Platform::FormatString(Char* dest, const size_t destSize, const Char* format, ...)
+	{
+		if (dest == nullptr || destSize == 0 || format == nullptr)return -1;
+
+		va_list args;
+		va_start(args, format);
+		S32 length = _vsnprintf_s(dest, destSize, _TRUNCATE, format, args);
+		va_end(args);
+
+		return length;
+	}
+
+	S32 Platform::EnumerateDirectory(const Path& path, ArrayList<FileEntry>& dest)
+	{
+		WIN32_FIND_DATAW findData;
+		std::wstring searchPath = ToWide(path.ToString() + TC("/*"));
+
+		HANDLE hFind = FindFirstFileW(searchPath.c_str(), &findData);
+		if (hFind == INVALID_HANDLE_VALUE)return -1;
+
+		do
+		{
+			if (wcscmp(findData.cFileName, L".") == 0 || wcscmp(findData.cFileName, L"..") == 0)continue;
+
+			FileEntry entry;
+			entry.name = ToUTF8(findData.cFileName);
+			entry.isDirectory = (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+			entry.size = entry.isDirectory ? 0 : ((U64)findData.nFileSizeHigh << 32) | findData.nFileSizeLow;
+			entry.lastWriteTime = ToUnixTime(findData.ftLastWriteTime);
+			dest.push_back(entry);
+		} while (FindNextFileW(hFind, &findData));
+
+		FindClose(hFind);
+		return 0;
+	}
+
+	bool Platform::FileExists(const Path& path)
+	{
+		DWORD attributes = GetFileAttributesW(ToWide(path.ToString()).c_str());
+		if (attributes == INVALID_FILE_ATTRIBUTES)return false;
+		return (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0;
+	}
+
+	bool Platform::DirectoryExists(const Path& path)
+	{
+		DWORD attributes = GetFileAttributesW(ToWide(path.ToString()).c_str());
+		if (attributes == INVALID_FILE_ATTRIBUTES)return false;
+		return (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+	}
+
+	S32 Platform::MakeDirectory(const Path& path)
+	{
+		if (DirectoryExists(path))return 0;
+		return CreateDirectoryW(ToWide(path.ToString()).c_str(), nullptr) ? 0 : -1;
+	}
+
+	S32 Platform::RemoveFile(const Path& path)
+	{
+		return DeleteFileW(ToWide(path.ToString()).c_str()) ? 0 : -1;
+	}
+
+	S32 Platform::RenameFile(const Path& from, const Path& to)
+	{
+		auto result = MoveFileExW(ToWide(from.ToString()).c_str(), ToWide(to.ToString()).c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+		return result ? 0 : -1;
+	}
+
+	S32 Platform::TouchFile(const Path& path)
+	{
+		HANDLE file = CreateFileW(ToWide(path.ToString()).c_str(), FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+								  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)return -1;
+
+		FILETIME now;
+		GetSystemTimeAsFileTime(&now);
+		const BOOL result = SetFileTime(file, nullptr, nullptr, &now);
+		CloseHandle(file);
+		return result ? 0 : -1;
+	}
+
+
+
+	U64 Platform::GetTimeCounter()
+	{
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return (U64)counter.QuadPart;
+	}
+
+	U64 Platform::GetTimeFrequency()
+	{
+		static U64 frequency = 0;
+		if (frequency == 0)
+		{
+			LARGE_INTEGER value;
+			QueryPerformanceFrequency(&value);
+			frequency = (U64)value.QuadPart;
+		}
+		return frequency;
+	}
+
+	F64 Platform::GetTime()
+	{
+		return (F64)GetTimeCounter() / (F64)GetTimeFrequency();
+	}
+
+	void Platform::SleepThread(const U32 milliseconds)
+	{
+		Sleep(milliseconds);
+	}
+
+
+
+	U32 Platform::GetProcessorCount()
+	{
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return 0 < info.dwNumberOfProcessors ? (U32)info.dwNumberOfProcessors : 1;
+	}
+
+	U64 Platform::GetCurrentThreadID()
+	{
+		return (U64)GetCurrentThreadId();
+	}
+
+
+
+	void* Platform::LoadDynamicLibrary(const Path& path)
+	{
+		return LoadLibraryW(ToWide(path.ToString()).c_str());
+	}
+
+	void* Platform::GetLibraryFunction(void* library, const String& name)
+	{
+		if (library == nullptr)return nullptr;
+		return reinterpret_cast<void*>(GetProcAddress(reinterpret_cast<HMODULE>(library), name.c_str()));
+	}
+
+	void Platform::FreeDynamicLibrary(void* library)
+	{
+		if (library == nullptr)return;
+		FreeLibrary(reinterpret_cast<HMODULE>(library));
+	}
+
+
+
+	struct ThreadLauncher
+	{
+		static unsigned __stdcall Run(void* arg)
+		{
+			auto thread = reinterpret_cast<Thread*>(arg);
+			thread->m_function();
+			return 0;
+		}
+	};
+
+	Thread::Thread() :m_handle(nullptr)
+	{
+	}
+
+	Thread::~Thread()
+	{
+		Join();
+	}
+
+	S32 Thread::Start(const std::function<void()>& function)
+	{
+		if (m_handle != nullptr)return -1;
+		if (!function)return -1;
+
+		m_function = function;
+
+		// CRTを使用するスレッドのため_beginthreadexで生成する
+		auto handle = _beginthreadex(nullptr, 0, &ThreadLauncher::Run, this, 0, nullptr);
+		if (handle == 0)return -1;
+
+		m_handle = reinterpret_cast<void*>(handle);
+		return 0;
+	}
+
+	S32 Thread::Join()
+	{
+		if (m_handle == nullptr)return -1;
+
+		WaitForSingleObject(reinterpret_cast<HANDLE>(m_handle), INFINITE);
+		CloseHandle(reinterpret_cast<HANDLE>(m_handle));
+		m_handle = nullptr;
+		return 0;
+	}
+}
+
+#endif
\ No newline at end of file
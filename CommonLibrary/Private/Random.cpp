@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "Random.h"
+#include "DeterministicMath.h"
 
 namespace
 {
@@ -46,8 +47,14 @@ namespace CommonLibrary
 
 	F32 Random::Range(F32 minimum, F32 maximum)
 	{
+#if defined(USE_DETERMINISTIC_MATH)
+		// 24bit̂܂܉ƂĎgAۂ߂܂܂Ȃϊ[0, 1)̒l
+		F32 result = (F32)(GetU32() >> 8) * (1.0f / 16777216.0f);
+		return DeterministicMath::Lerp(minimum, maximum, result);
+#else
 		GetU32();
 		F32 result = ((x + 0.5f) / 4294967296.0f + w) / 4294967296.0f;
 		return minimum + result * (maximum - minimum);
+#endif
 	}
 }
\ No newline at end of file
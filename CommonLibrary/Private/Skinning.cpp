@@ -0,0 +1,341 @@
+﻿#include "pch.h"
+#include "Skinning.h"
+#include "Check.h"
+#include "Mathf.h"
+#include "Parallel.h"
+#include "Platform.h"
+#include "Simd.h"
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	// ボーン1本分の行列を4要素ずつの行に並べ直したもの
+	const U32 ROW_FLOATS = 16;
+
+	// ボーン1本分のデュアルクォータニオン(実部xyzw、双対部xyzw)
+	const U32 DUAL_FLOATS = 8;
+
+	inline const F32* ReadF32(const Byte* base, const U32 stride, const U32 index)
+	{
+		return reinterpret_cast<const F32*>(base + (size_t)stride * index);
+	}
+
+	inline void WriteVector3(Byte* base, const U32 stride, const U32 index, const F32* value)
+	{
+		memcpy(base + (size_t)stride * index, value, sizeof(F32) * 3);
+	}
+
+	inline void Normalize3(F32* v)
+	{
+		F32 lengthSq = v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+		if (lengthSq <= 0.0f)return;
+		F32 inverse = 1.0f / Mathf::Sqrt(lengthSq);
+		v[0] *= inverse;
+		v[1] *= inverse;
+		v[2] *= inverse;
+	}
+
+	inline void Cross(const F32* a, const F32* b, F32* dest)
+	{
+		dest[0] = a[1] * b[2] - a[2] * b[1];
+		dest[1] = a[2] * b[0] - a[0] * b[2];
+		dest[2] = a[0] * b[1] - a[1] * b[0];
+	}
+
+	/// <summary>
+	/// Affineの各行を4要素に揃える(SIMDで読み込めるようにする)
+	/// </summary>
+	void BuildRows(const Affine* palette, const U32 boneCount, ArrayList<F32>& rows)
+	{
+		rows.assign((size_t)boneCount * ROW_FLOATS, 0.0f);
+		for (U32 bone = 0; bone < boneCount; bone++)
+		{
+			F32* dest = &rows[(size_t)bone * ROW_FLOATS];
+			for (U32 r = 0; r < 4; r++)
+			{
+				dest[r * 4 + 0] = palette[bone].m[r][0];
+				dest[r * 4 + 1] = palette[bone].m[r][1];
+				dest[r * 4 + 2] = palette[bone].m[r][2];
+			}
+		}
+	}
+
+	/// <summary>
+	/// Affineをデュアルクォータニオンに変換する。拡大は取り除かれる。
+	/// </summary>
+	void BuildDualQuaternions(const Affine* palette, const U32 boneCount, ArrayList<F32>& duals)
+	{
+		duals.assign((size_t)boneCount * DUAL_FLOATS, 0.0f);
+		for (U32 bone = 0; bone < boneCount; bone++)
+		{
+			// 拡大を取り除いた回転行列
+			F32 m[3][3];
+			for (U32 r = 0; r < 3; r++)
+			{
+				for (U32 c = 0; c < 3; c++)m[r][c] = palette[bone].m[r][c];
+				Normalize3(m[r]);
+			}
+
+			// 行ベクトル規約の回転行列からクォータニオンを求める
+			F32 q[4];
+			F32 trace = m[0][0] + m[1][1] + m[2][2];
+			if (0.0f < trace)
+			{
+				F32 s = Mathf::Sqrt(trace + 1.0f) * 2.0f;
+				q[3] = 0.25f * s;
+				q[0] = (m[1][2] - m[2][1]) / s;
+				q[1] = (m[2][0] - m[0][2]) / s;
+				q[2] = (m[0][1] - m[1][0]) / s;
+			}
+			else if (m[1][1] < m[0][0] && m[2][2] < m[0][0])
+			{
+				F32 s = Mathf::Sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2.0f;
+				q[3] = (m[1][2] - m[2][1]) / s;
+				q[0] = 0.25f * s;
+				q[1] = (m[1][0] + m[0][1]) / s;
+				q[2] = (m[2][0] + m[0][2]) / s;
+			}
+			else if (m[2][2] < m[1][1])
+			{
+				F32 s = Mathf::Sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2.0f;
+				q[3] = (m[2][0] - m[0][2]) / s;
+				q[0] = (m[1][0] + m[0][1]) / s;
+				q[1] = 0.25f * s;
+				q[2] = (m[2][1] + m[1][2]) / s;
+			}
+			else
+			{
+				F32 s = Mathf::Sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2.0f;
+				q[3] = (m[0][1] - m[1][0]) / s;
+				q[0] = (m[2][0] + m[0][2]) / s;
+				q[1] = (m[2][1] + m[1][2]) / s;
+				q[2] = 0.25f * s;
+			}
+
+			// 双対部 = 0.5 * t * q
+			const F32* t = palette[bone].m[3];
+			F32 cross[3];
+			Cross(t, q, cross);
+
+			F32* dest = &duals[(size_t)bone * DUAL_FLOATS];
+			dest[0] = q[0];
+			dest[1] = q[1];
+			dest[2] = q[2];
+			dest[3] = q[3];
+			dest[4] = 0.5f * (q[3] * t[0] + cross[0]);
+			dest[5] = 0.5f * (q[3] * t[1] + cross[1]);
+			dest[6] = 0.5f * (q[3] * t[2] + cross[2]);
+			dest[7] = -0.5f * (t[0] * q[0] + t[1] * q[1] + t[2] * q[2]);
+		}
+	}
+
+	void SkinLinearBlend(const SkinningDesc& desc, const F32* rows, const U32 boneCount, const U32 begin, const U32 end)
+	{
+		for (U32 i = begin; i < end; i++)
+		{
+			const U8* indices = desc.boneIndices + (size_t)desc.boneIndexStride * i;
+			const F32* weights = ReadF32(desc.boneWeights, desc.boneWeightStride, i);
+
+			// ウェイトで行列をブレンドする
+			F32x4 r0, r1, r2, r3;
+			for (U32 k = 0; k < 4; k++)
+			{
+				if (weights[k] == 0.0f || boneCount <= indices[k])continue;
+
+				const F32* bone = rows + (size_t)indices[k] * ROW_FLOATS;
+				F32x4 w = F32x4::Set1(weights[k]);
+				r0 += w * F32x4::Load(bone);
+				r1 += w * F32x4::Load(bone + 4);
+				r2 += w * F32x4::Load(bone + 8);
+				r3 += w * F32x4::Load(bone + 12);
+			}
+
+			F32 result[4];
+			const F32* p = ReadF32(desc.positions, desc.positionStride, i);
+			(F32x4::Set1(p[0]) * r0 + F32x4::Set1(p[1]) * r1 + F32x4::Set1(p[2]) * r2 + r3).Store(result);
+			WriteVector3(desc.skinnedPositions, desc.skinnedPositionStride, i, result);
+
+			if (desc.normals != nullptr && desc.skinnedNormals != nullptr)
+			{
+				const F32* n = ReadF32(desc.normals, desc.normalStride, i);
+				(F32x4::Set1(n[0]) * r0 + F32x4::Set1(n[1]) * r1 + F32x4::Set1(n[2]) * r2).Store(result);
+				Normalize3(result);
+				WriteVector3(desc.skinnedNormals, desc.skinnedNormalStride, i, result);
+			}
+		}
+	}
+
+	void SkinDualQuaternion(const SkinningDesc& desc, const F32* duals, const U32 boneCount, const U32 begin, const U32 end)
+	{
+		for (U32 i = begin; i < end; i++)
+		{
+			const U8* indices = desc.boneIndices + (size_t)desc.boneIndexStride * i;
+			const F32* weights = ReadF32(desc.boneWeights, desc.boneWeightStride, i);
+
+			// 最初のボーンと同じ半球に揃えてブレンドする
+			F32x4 real, dual;
+			const F32* pivot = nullptr;
+			for (U32 k = 0; k < 4; k++)
+			{
+				if (weights[k] == 0.0f || boneCount <= indices[k])continue;
+
+				const F32* bone = duals + (size_t)indices[k] * DUAL_FLOATS;
+				if (pivot == nullptr)pivot = bone;
+
+				F32 dot = pivot[0] * bone[0] + pivot[1] * bone[1] + pivot[2] * bone[2] + pivot[3] * bone[3];
+				F32x4 w = F32x4::Set1(dot < 0.0f ? -weights[k] : weights[k]);
+				real += w * F32x4::Load(bone);
+				dual += w * F32x4::Load(bone + 4);
+			}
+
+			F32 r[4], d[4];
+			real.Store(r);
+			dual.Store(d);
+
+			F32 lengthSq = r[0] * r[0] + r[1] * r[1] + r[2] * r[2] + r[3] * r[3];
+			if (lengthSq <= 0.0f)
+			{
+				r[0] = r[1] = r[2] = 0.0f;
+				r[3] = 1.0f;
+				d[0] = d[1] = d[2] = d[3] = 0.0f;
+			}
+			else
+			{
+				F32 inverse = 1.0f / Mathf::Sqrt(lengthSq);
+				for (U32 c = 0; c < 4; c++)
+				{
+					r[c] *= inverse;
+					d[c] *= inverse;
+				}
+			}
+
+			// 平行移動 t = 2 * (r.w * d.xyz - d.w * r.xyz + r.xyz × d.xyz)
+			F32 cross[3];
+			Cross(r, d, cross);
+			F32 t[3];
+			for (U32 c = 0; c < 3; c++)t[c] = 2.0f * (r[3] * d[c] - d[3] * r[c] + cross[c]);
+
+			// 回転 v' = v + 2 * r.xyz × (r.xyz × v + r.w * v)
+			auto rotate = [&](const F32* v, F32* dest)
+			{
+				F32 a[3], b[3];
+				Cross(r, v, a);
+				for (U32 c = 0; c < 3; c++)a[c] += r[3] * v[c];
+				Cross(r, a, b);
+				for (U32 c = 0; c < 3; c++)dest[c] = v[c] + 2.0f * b[c];
+			};
+
+			F32 result[3];
+			rotate(ReadF32(desc.positions, desc.positionStride, i), result);
+			for (U32 c = 0; c < 3; c++)result[c] += t[c];
+			WriteVector3(desc.skinnedPositions, desc.skinnedPositionStride, i, result);
+
+			if (desc.normals != nullptr && desc.skinnedNormals != nullptr)
+			{
+				rotate(ReadF32(desc.normals, desc.normalStride, i), result);
+				WriteVector3(desc.skinnedNormals, desc.skinnedNormalStride, i, result);
+			}
+		}
+	}
+}
+
+namespace CommonLibrary
+{
+	S32 Skinning::Skin(const SkinningDesc& desc, const Affine* palette, const U32 boneCount, const SkinningMode mode)
+	{
+		if (CheckArgs(palette, desc.positions, desc.boneIndices, desc.boneWeights))return -1;
+		if (CheckArgs(desc.skinnedPositions, 0 < boneCount))return -1;
+		if (desc.vertexCount == 0)return 0;
+
+		// ボーンごとの前処理は呼び出しごとに1回だけ行う
+		ArrayList<F32> bones;
+		if (mode == SkinningMode::DualQuaternion)
+		{
+			BuildDualQuaternions(palette, boneCount, bones);
+		}
+		else
+		{
+			BuildRows(palette, boneCount, bones);
+		}
+
+		const F32* data = bones.data();
+		Parallel::For(desc.vertexCount, VERTICES_PER_TASK, [&](size_t begin, size_t end)
+			{
+				if (mode == SkinningMode::DualQuaternion)
+				{
+					SkinDualQuaternion(desc, data, boneCount, (U32)begin, (U32)end);
+				}
+				else
+				{
+					SkinLinearBlend(desc, data, boneCount, (U32)begin, (U32)end);
+				}
+			});
+
+		return 0;
+	}
+
+
+
+	F64 SkinningBenchmark::Run(const U32 vertexCount, const U32 boneCount, const SkinningMode mode, const U32 iterationCount)
+	{
+		if (vertexCount == 0 || boneCount == 0 || 256 < boneCount || iterationCount == 0)return 0.0;
+
+		const U32 ringCount = (vertexCount + 15) / 16;
+		const F32 ringHeight = (F32)boneCount / ringCount;
+
+		ArrayList<F32> positions((size_t)vertexCount * 3);
+		ArrayList<F32> normals((size_t)vertexCount * 3);
+		ArrayList<U8> boneIndices((size_t)vertexCount * 4);
+		ArrayList<F32> boneWeights((size_t)vertexCount * 4);
+		for (U32 i = 0; i < vertexCount; i++)
+		{
+			// 高さ1あたりボーン1本になるよう、16頂点ずつの輪を積み上げる
+			const F32 angle = (i % 16) * (Mathf::TWO_PI / 16.0f);
+			const F32 height = (i / 16) * ringHeight;
+			const F32 c = Mathf::Cos(angle);
+			const F32 s = Mathf::Sin(angle);
+			positions[i * 3 + 0] = c;
+			positions[i * 3 + 1] = height;
+			positions[i * 3 + 2] = s;
+			normals[i * 3 + 0] = c;
+			normals[i * 3 + 1] = 0.0f;
+			normals[i * 3 + 2] = s;
+
+			const U32 bone = (U32)Mathf::Min((F32)(boneCount - 1), height);
+			const F32 weights[4] = { 0.4f, 0.3f, 0.2f, 0.1f };
+			for (U32 j = 0; j < 4; j++)
+			{
+				boneIndices[i * 4 + j] = (U8)((bone + j) % boneCount);
+				boneWeights[i * 4 + j] = weights[j];
+			}
+		}
+
+		// ボーンごとに少しずつ曲げて、回転と移動を含む行列にする
+		ArrayList<Affine> palette(boneCount);
+		for (U32 i = 0; i < boneCount; i++)
+		{
+			palette[i].RotateZ(0.1f * i);
+			palette[i].RotateY(0.05f * i);
+			palette[i].Translate(0.0f, 0.01f * i, 0.0f);
+		}
+
+		ArrayList<F32> skinnedPositions((size_t)vertexCount * 3);
+		ArrayList<F32> skinnedNormals((size_t)vertexCount * 3);
+
+		SkinningDesc desc;
+		desc.vertexCount = vertexCount;
+		desc.positions = reinterpret_cast<const Byte*>(positions.data());
+		desc.normals = reinterpret_cast<const Byte*>(normals.data());
+		desc.boneIndices = reinterpret_cast<const Byte*>(boneIndices.data());
+		desc.boneWeights = reinterpret_cast<const Byte*>(boneWeights.data());
+		desc.skinnedPositions = reinterpret_cast<Byte*>(skinnedPositions.data());
+		desc.skinnedNormals = reinterpret_cast<Byte*>(skinnedNormals.data());
+
+		if (Skinning::Skin(desc, palette.data(), boneCount, mode))return 0.0;
+
+		F64 start = Platform::GetTime();
+		for (U32 i = 0; i < iterationCount; i++)Skinning::Skin(desc, palette.data(), boneCount, mode);
+		return (Platform::GetTime() - start) * 1000.0 / iterationCount;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,341 @@
+﻿#include "pch.h"
+#include "TransformHierarchy.h"
+#include "Parallel.h"
+
+#include <atomic>
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	// ローカル変換が変更され、ワールド変換の再計算が必要
+	const U8 FLAG_DIRTY = 1 << 0;
+	// 破棄された
+	const U8 FLAG_REMOVED = 1 << 1;
+
+	const U32 SLOT_BITS = 24;
+	const U32 SLOT_MASK = (1u << SLOT_BITS) - 1;
+
+	const U32 UNKNOWN_DEPTH = ~0u;
+
+	inline U32 GetSlot(const TransformHandle handle)
+	{
+		return handle & SLOT_MASK;
+	}
+
+	inline U8 GetGeneration(const TransformHandle handle)
+	{
+		return (U8)(handle >> SLOT_BITS);
+	}
+
+	inline TransformHandle MakeHandle(const U32 slot, const U8 generation)
+	{
+		return ((TransformHandle)generation << SLOT_BITS) | slot;
+	}
+
+	template<class T>
+	void Reorder(ArrayList<T>& values, const ArrayList<S32>& newIndices, const U32 count)
+	{
+		ArrayList<T> sorted(count);
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			if (0 <= newIndices[i])sorted[newIndices[i]] = values[i];
+		}
+		values.swap(sorted);
+	}
+}
+
+namespace CommonLibrary
+{
+	const TransformHandle TransformHierarchy::INVALID_HANDLE = ~0u;
+
+	TransformHierarchy::TransformHierarchy() :m_count(0), m_version(0), m_needsRebuild(false)
+	{
+		m_levels.push_back(0);
+	}
+
+	TransformHandle TransformHierarchy::Create(const TransformHandle parent)
+	{
+		S32 parentIndex = -1;
+		if (parent != INVALID_HANDLE)
+		{
+			parentIndex = Find(parent);
+			if (parentIndex < 0)return INVALID_HANDLE;
+		}
+
+		U32 slot;
+		if (!m_freeSlots.empty())
+		{
+			slot = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else
+		{
+			if (SLOT_MASK <= m_slots.size())return INVALID_HANDLE;
+			slot = (U32)m_slots.size();
+			m_slots.push_back(-1);
+			m_generations.push_back(0);
+		}
+
+		// 新しいノードは末尾に追加し、次のUpdateで深さ順の位置に移動する
+		S32 index = (S32)m_local.size();
+		TransformHandle handle = MakeHandle(slot, m_generations[slot]);
+		m_slots[slot] = index;
+
+		m_local.push_back(Affine());
+		m_world.push_back(parentIndex < 0 ? Affine() : m_world[parentIndex]);
+		m_parents.push_back(parentIndex);
+		m_depths.push_back(parentIndex < 0 ? 0 : m_depths[parentIndex] + 1);
+		m_versions.push_back(0);
+		m_flags.push_back(FLAG_DIRTY);
+		m_handles.push_back(handle);
+
+		m_count++;
+		m_needsRebuild = true;
+		return handle;
+	}
+
+	S32 TransformHierarchy::Destroy(const TransformHandle handle)
+	{
+		S32 index = Find(handle);
+		if (index < 0)return -1;
+
+		m_flags[index] |= FLAG_REMOVED;
+
+		U32 slot = GetSlot(handle);
+		m_slots[slot] = -1;
+		m_generations[slot]++;
+		m_freeSlots.push_back(slot);
+
+		m_count--;
+		m_needsRebuild = true;
+		return 0;
+	}
+
+	S32 TransformHierarchy::SetParent(const TransformHandle handle, const TransformHandle parent)
+	{
+		S32 index = Find(handle);
+		if (index < 0)return -1;
+
+		S32 parentIndex = -1;
+		if (parent != INVALID_HANDLE)
+		{
+			parentIndex = Find(parent);
+			if (parentIndex < 0)return -1;
+		}
+
+		// 新しい親が自身の子孫であれば循環する
+		for (S32 p = parentIndex; 0 <= p; p = m_parents[p])
+		{
+			if (p == index)return -1;
+		}
+
+		m_parents[index] = parentIndex;
+		MarkDirty(index);
+		m_needsRebuild = true;
+		return 0;
+	}
+
+	TransformHandle TransformHierarchy::GetParent(const TransformHandle handle)const
+	{
+		S32 index = Find(handle);
+		if (index < 0 || m_parents[index] < 0)return INVALID_HANDLE;
+		return m_handles[m_parents[index]];
+	}
+
+	bool TransformHierarchy::IsValid(const TransformHandle handle)const
+	{
+		return 0 <= Find(handle);
+	}
+
+	S32 TransformHierarchy::SetLocal(const TransformHandle handle, const Affine& local)
+	{
+		S32 index = Find(handle);
+		if (index < 0)return -1;
+
+		m_local[index] = local;
+		MarkDirty(index);
+		return 0;
+	}
+
+	S32 TransformHierarchy::GetLocal(const TransformHandle handle, Affine& dest)const
+	{
+		S32 index = Find(handle);
+		if (index < 0)return -1;
+
+		dest = m_local[index];
+		return 0;
+	}
+
+	S32 TransformHierarchy::GetWorld(const TransformHandle handle, Affine& dest)const
+	{
+		S32 index = Find(handle);
+		if (index < 0)return -1;
+
+		dest = m_world[index];
+		return 0;
+	}
+
+	bool TransformHierarchy::IsWorldChanged(const TransformHandle handle)const
+	{
+		S32 index = Find(handle);
+		if (index < 0)return false;
+
+		return m_version != 0 && m_versions[index] == m_version;
+	}
+
+	S32 TransformHierarchy::GetIndex(const TransformHandle handle)const
+	{
+		return Find(handle);
+	}
+
+	void TransformHierarchy::Update()
+	{
+		if (m_needsRebuild)Rebuild();
+
+		m_version++;
+		const U32 version = m_version;
+
+		// 変更の無い深さは、親の深さでも更新が無ければ飛ばす
+		bool parentChanged = false;
+		for (U32 depth = 0; depth + 1 < m_levels.size(); depth++)
+		{
+			if (!m_levelDirty[depth] && !parentChanged)continue;
+			m_levelDirty[depth] = 0;
+
+			const U32 begin = m_levels[depth];
+			const U32 end = m_levels[depth + 1];
+			const bool checkParent = parentChanged;
+			std::atomic<bool> changed(false);
+
+			Parallel::For(end - begin, NODES_PER_TASK, [&](size_t taskBegin, size_t taskEnd)
+				{
+					bool updated = false;
+					for (size_t i = begin + taskBegin; i < begin + taskEnd; i++)
+					{
+						S32 parent = m_parents[i];
+						bool parentUpdated = checkParent && 0 <= parent && m_versions[parent] == version;
+						if (!(m_flags[i] & FLAG_DIRTY) && !parentUpdated)continue;
+
+						// 行ベクトル規約のため、ローカル変換の後に親の変換を掛ける
+						m_world[i] = parent < 0 ? m_local[i] : m_local[i] * m_world[parent];
+						m_versions[i] = version;
+						m_flags[i] &= ~FLAG_DIRTY;
+						updated = true;
+					}
+					if (updated)changed.store(true, std::memory_order_relaxed);
+				});
+
+			parentChanged = changed.load(std::memory_order_relaxed);
+		}
+	}
+
+	S32 TransformHierarchy::Find(const TransformHandle handle)const
+	{
+		U32 slot = GetSlot(handle);
+		if (m_slots.size() <= slot || m_generations[slot] != GetGeneration(handle))return -1;
+		return m_slots[slot];
+	}
+
+	void TransformHierarchy::MarkDirty(const U32 index)
+	{
+		m_flags[index] |= FLAG_DIRTY;
+
+		// 並べ替えが必要な場合はRebuildで深さごとのフラグを作り直す
+		if (!m_needsRebuild)m_levelDirty[m_depths[index]] = 1;
+	}
+
+	void TransformHierarchy::Rebuild()
+	{
+		const U32 nodeCount = (U32)m_local.size();
+
+		// 深さを求め直し、破棄されたノードの子孫を破棄する
+		ArrayList<U32> depths(nodeCount, UNKNOWN_DEPTH);
+		ArrayList<U32> chain;
+		U32 maxDepth = 0;
+		for (U32 i = 0; i < nodeCount; i++)
+		{
+			if (depths[i] != UNKNOWN_DEPTH)continue;
+
+			chain.clear();
+			S32 node = (S32)i;
+			while (0 <= node && depths[node] == UNKNOWN_DEPTH)
+			{
+				chain.push_back((U32)node);
+				node = m_parents[node];
+			}
+
+			// 根に近い方から確定させる
+			for (size_t k = chain.size(); 0 < k; k--)
+			{
+				U32 current = chain[k - 1];
+				S32 parent = m_parents[current];
+				depths[current] = parent < 0 ? 0 : depths[parent] + 1;
+				if (0 <= parent && (m_flags[parent] & FLAG_REMOVED))m_flags[current] |= FLAG_REMOVED;
+				if (maxDepth < depths[current])maxDepth = depths[current];
+			}
+		}
+
+		// 深さごとに数えて、各深さの先頭の位置を求める
+		ArrayList<U32> counts(maxDepth + 1, 0);
+		for (U32 i = 0; i < nodeCount; i++)
+		{
+			if (!(m_flags[i] & FLAG_REMOVED))counts[depths[i]]++;
+		}
+
+		U32 levelCount = 0;
+		while (levelCount <= maxDepth && 0 < counts[levelCount])levelCount++;
+
+		m_levels.assign(levelCount + 1, 0);
+		for (U32 depth = 0; depth < levelCount; depth++)m_levels[depth + 1] = m_levels[depth] + counts[depth];
+
+		// 同じ深さの中では元の順序を保つ
+		ArrayList<U32> offsets(m_levels.begin(), m_levels.end() - 1);
+		ArrayList<S32> newIndices(nodeCount, -1);
+		for (U32 i = 0; i < nodeCount; i++)
+		{
+			TransformHandle handle = m_handles[i];
+			U32 slot = GetSlot(handle);
+			bool ownsSlot = m_slots[slot] == (S32)i && m_generations[slot] == GetGeneration(handle);
+
+			if (m_flags[i] & FLAG_REMOVED)
+			{
+				// Destroyで解放されていない子孫のスロットを解放する
+				if (ownsSlot)
+				{
+					m_slots[slot] = -1;
+					m_generations[slot]++;
+					m_freeSlots.push_back(slot);
+				}
+				continue;
+			}
+
+			newIndices[i] = (S32)offsets[depths[i]]++;
+			m_slots[slot] = newIndices[i];
+		}
+
+		const U32 count = m_levels.back();
+		for (U32 i = 0; i < nodeCount; i++)
+		{
+			if (0 <= m_parents[i])m_parents[i] = newIndices[m_parents[i]];
+		}
+
+		Reorder(m_local, newIndices, count);
+		Reorder(m_world, newIndices, count);
+		Reorder(m_parents, newIndices, count);
+		Reorder(depths, newIndices, count);
+		Reorder(m_versions, newIndices, count);
+		Reorder(m_flags, newIndices, count);
+		Reorder(m_handles, newIndices, count);
+		m_depths.swap(depths);
+
+		m_levelDirty.assign(levelCount, 0);
+		for (U32 i = 0; i < count; i++)
+		{
+			if (m_flags[i] & FLAG_DIRTY)m_levelDirty[m_depths[i]] = 1;
+		}
+
+		m_count = count;
+		m_needsRebuild = false;
+	}
+}
\ No newline at end of file
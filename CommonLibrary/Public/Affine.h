@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include"Fwd.h"
 #include "Matrix.h"
+#include "Platform.h"
 
 namespace CommonLibrary
 {
@@ -70,7 +71,7 @@ namespace CommonLibrary
 
 		inline Affine& operator = (const Affine& v)
 		{
-			memcpy_s(m, sizeof(m), v.m, sizeof(m));
+			Platform::MemoryCopy(m, sizeof(m), v.m, sizeof(m));
 
 			return *this;
 		}
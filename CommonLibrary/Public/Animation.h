@@ -0,0 +1,226 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "Vector3.h"
+#include "Quaternion.h"
+#include "Affine.h"
+#include "Matrix.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// キーフレームのトラック
+	/// </summary>
+	/// <remarks>
+	/// キーの時刻と各成分を別々の配列(SoA)で保持する。timesは昇順に並んでいる。
+	/// </remarks>
+	struct AnimationTrack
+	{
+		/// <summary> キーの時刻(秒) </summary>
+		ArrayList<F32> times;
+		/// <summary> 成分ごとの値(平行移動と拡大はxyz、回転はxyzw) </summary>
+		ArrayList<F32> values[4];
+
+		/// <summary> キーの数 </summary>
+		inline U32 GetKeyCount()const { return (U32)times.size(); }
+	};
+
+
+	/// <summary>
+	/// ボーン1本分のトラック
+	/// </summary>
+	struct BoneTrack
+	{
+		AnimationTrack translation;
+		AnimationTrack rotation;
+		AnimationTrack scale;
+	};
+
+
+	/// <summary>
+	/// キーフレームアニメーションのデータ
+	/// </summary>
+	/// <remarks>
+	/// キーは時刻の昇順に追加する必要がある。
+	/// キーが無いトラックは平行移動0、回転なし、拡大1として扱われる。
+	/// </remarks>
+	class DLL AnimationClip
+	{
+	public:
+		/// <summary>
+		/// 空のクリップを生成する
+		/// </summary>
+		/// <param name="boneCount">ボーンの数</param>
+		/// <param name="duration">長さ(秒)</param>
+		AnimationClip(const U32 boneCount, const F32 duration);
+
+		/// <summary>
+		/// 平行移動のキーを追加する
+		/// </summary>
+		/// <returns>　０：成功\n－１：ボーンの番号が不正、または時刻が直前のキーより前</returns>
+		S32 AddTranslationKey(const U32 bone, const F32 time, const Vector3& translation);
+
+		/// <summary>
+		/// 回転のキーを追加する
+		/// </summary>
+		/// <returns>　０：成功\n－１：ボーンの番号が不正、または時刻が直前のキーより前</returns>
+		S32 AddRotationKey(const U32 bone, const F32 time, const Quaternion& rotation);
+
+		/// <summary>
+		/// 拡大のキーを追加する
+		/// </summary>
+		/// <returns>　０：成功\n－１：ボーンの番号が不正、または時刻が直前のキーより前</returns>
+		S32 AddScaleKey(const U32 bone, const F32 time, const Vector3& scale);
+
+		inline U32 GetBoneCount()const { return (U32)m_bones.size(); }
+		inline F32 GetDuration()const { return m_duration; }
+		inline const BoneTrack& GetBoneTrack(const U32 bone)const { return m_bones[bone]; }
+
+	private:
+		ArrayList<BoneTrack> m_bones;
+		F32 m_duration;
+
+		S32 AddKey(AnimationTrack& track, const F32 time, const F32* values, const U32 componentCount);
+	};
+
+
+	/// <summary>
+	/// ボーンごとのローカル姿勢
+	/// </summary>
+	/// <remarks>
+	/// 成分ごとの配列(SoA)で保持する。配列はSIMDで4ボーンずつ処理できるように4の倍数の長さで確保され、
+	/// 余りの要素は初期姿勢で埋められる。
+	/// </remarks>
+	struct DLL Pose
+	{
+		/// <summary> 平行移動(xyz) </summary>
+		ArrayList<F32> translation[3];
+		/// <summary> 回転(xyzw) </summary>
+		ArrayList<F32> rotation[4];
+		/// <summary> 拡大(xyz) </summary>
+		ArrayList<F32> scale[3];
+
+		Pose();
+
+		/// <summary>
+		/// ボーン数を変更し、全てのボーンを初期姿勢にする
+		/// </summary>
+		void Resize(const U32 boneCount);
+
+		/// <summary>
+		/// 全てのボーンを初期姿勢(平行移動0、回転なし、拡大1)にする
+		/// </summary>
+		void SetIdentity();
+
+		inline U32 GetBoneCount()const { return m_boneCount; }
+
+		/// <summary> 4の倍数に切り上げたボーン数(配列の長さ) </summary>
+		inline U32 GetPaddedCount()const { return (U32)translation[0].size(); }
+
+		/// <summary>
+		/// ボーンのローカル変換を取得する
+		/// </summary>
+		void GetLocalTransform(const U32 bone, Affine& dest)const;
+
+		/// <summary>
+		/// 親子関係をたどってモデル空間の変換を求める
+		/// </summary>
+		/// <remarks>
+		/// 親のボーンは子より前に並んでいる必要がある。
+		/// </remarks>
+		/// <param name="parents">ボーンごとの親の番号(ルートは－１)</param>
+		/// <param name="dest">モデル空間の変換の出力先</param>
+		/// <param name="destSize">出力先の要素数</param>
+		/// <returns>　０：成功\n－１：引数が不正、または親が子より後ろにある</returns>
+		S32 ToModelSpace(const S32* parents, Affine* dest, const size_t destSize)const;
+
+	private:
+		U32 m_boneCount;
+	};
+
+
+	/// <summary>
+	/// アニメーションの再生状態
+	/// </summary>
+	/// <remarks>
+	/// トラックごとに前回参照したキーの位置を保持しているため、順方向の再生ではキーの検索がO(1)で済む。
+	/// 巻き戻しやループで大きく時刻が変わった場合は二分探索する。
+	/// 出力は各ボーンのローカル変換で、行ベクトル規約(拡大→回転→平行移動の順)で合成される。
+	/// </remarks>
+	class DLL AnimationInstance
+	{
+	public:
+		AnimationInstance();
+
+		/// <summary>
+		/// 再生するクリップを設定し、時刻を0に戻す
+		/// </summary>
+		/// <returns>　０：成功\n－１：クリップがnullptr</returns>
+		S32 SetClip(const SPtr<AnimationClip>& clip);
+
+		inline const SPtr<AnimationClip>& GetClip()const { return m_clip; }
+
+		/// <summary>
+		/// 再生時刻を設定する
+		/// </summary>
+		void SetTime(const F32 time);
+
+		/// <summary>
+		/// 再生時刻を進める
+		/// </summary>
+		/// <param name="deltaTime">経過時間(秒)</param>
+		void Advance(const F32 deltaTime);
+
+		inline F32 GetTime()const { return m_time; }
+
+		/// <summary>
+		/// ループ再生するか(デフォルトはtrue)
+		/// </summary>
+		inline void SetLoop(const bool loop) { m_loop = loop; }
+		inline bool IsLoop()const { return m_loop; }
+
+		/// <summary>
+		/// 現在の時刻の姿勢を取得する
+		/// </summary>
+		/// <param name="palette">ボーンごとの変換の出力先</param>
+		/// <param name="paletteSize">出力先の要素数</param>
+		/// <returns>　０：成功\n－１：クリップが設定されていない、または出力先が足りない</returns>
+		S32 Sample(Affine* palette, const size_t paletteSize);
+
+		/// <summary>
+		/// 現在の時刻の姿勢を取得する
+		/// </summary>
+		/// <param name="palette">ボーンごとの変換の出力先</param>
+		/// <param name="paletteSize">出力先の要素数</param>
+		/// <returns>　０：成功\n－１：クリップが設定されていない、または出力先が足りない</returns>
+		S32 Sample(Matrix* palette, const size_t paletteSize);
+
+		/// <summary>
+		/// 現在の時刻の姿勢をSoAの姿勢として取得する
+		/// </summary>
+		/// <param name="pose">出力先。ボーン数が異なる場合はリサイズされる</param>
+		/// <returns>　０：成功\n－１：クリップが設定されていない</returns>
+		S32 Sample(Pose& pose);
+
+		/// <summary>
+		/// 複数のインスタンスの姿勢を並列に取得する
+		/// </summary>
+		/// <remarks>
+		/// palettes[i]にはinstances[i]のボーン数以上の要素が必要。
+		/// </remarks>
+		/// <param name="instances">インスタンスの配列</param>
+		/// <param name="palettes">インスタンスごとの出力先の配列</param>
+		/// <param name="count">インスタンスの数</param>
+		static void SampleAll(AnimationInstance* const* instances, Affine* const* palettes, const size_t count);
+
+	private:
+		SPtr<AnimationClip> m_clip;
+		F32 m_time;
+		bool m_loop;
+		// トラックごとに前回参照したキーの位置(ボーンごとに平行移動、回転、拡大の順)
+		ArrayList<U32> m_cursors;
+
+		template<class Output>
+		S32 SampleImpl(Output* palette, const size_t paletteSize);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,136 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "Animation.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 圧縮の許容誤差
+	/// </summary>
+	struct CompressionSettings
+	{
+		/// <summary> 平行移動の許容誤差(距離) </summary>
+		F32 translationTolerance = 0.0005f;
+		/// <summary> 回転の許容誤差(ラジアン) </summary>
+		F32 rotationTolerance = 0.0005f;
+		/// <summary> 拡大の許容誤差(成分ごとの差) </summary>
+		F32 scaleTolerance = 0.0005f;
+	};
+
+
+	/// <summary>
+	/// 圧縮結果のレポート
+	/// </summary>
+	/// <remarks>
+	/// 誤差は元のキーの時刻で圧縮前後の値を比較した最大値で、キーの削減と量子化の両方による誤差を含む。
+	/// </remarks>
+	struct CompressionReport
+	{
+		/// <summary> 圧縮前のキーのデータサイズ(バイト) </summary>
+		size_t rawSize = 0;
+		/// <summary> 圧縮後のデータサイズ(バイト) </summary>
+		size_t compressedSize = 0;
+		/// <summary> 圧縮前のキーの数 </summary>
+		U32 rawKeyCount = 0;
+		/// <summary> 圧縮後のキーの数 </summary>
+		U32 compressedKeyCount = 0;
+		/// <summary> 平行移動の最大誤差(距離) </summary>
+		F32 maxTranslationError = 0;
+		/// <summary> 回転の最大誤差(ラジアン) </summary>
+		F32 maxRotationError = 0;
+		/// <summary> 拡大の最大誤差(成分ごとの差) </summary>
+		F32 maxScaleError = 0;
+	};
+
+
+	/// <summary>
+	/// 圧縮されたトラック
+	/// </summary>
+	struct CompressedTrack
+	{
+		/// <summary> CompressedClipのキー配列での先頭の位置 </summary>
+		U32 firstKey = 0;
+		/// <summary> キーの数 </summary>
+		U32 keyCount = 0;
+		/// <summary> 量子化の範囲の最小値(平行移動と拡大のみ) </summary>
+		F32 minimum[3] = {};
+		/// <summary> 量子化の範囲の幅(平行移動と拡大のみ) </summary>
+		F32 extent[3] = {};
+	};
+
+
+	/// <summary>
+	/// 圧縮されたキーフレームアニメーション
+	/// </summary>
+	/// <remarks>
+	/// キーは1つあたり16bitの時刻と16bit×3の値で保持する。
+	/// 回転は最大成分を除いた3成分を15bitずつ(smallest three)、平行移動と拡大はトラックごとの範囲で正規化した16bitで量子化する。
+	/// 展開せずにそのままサンプリングでき、サンプリング時は補間に使う2つのキーだけを復元する。
+	/// 時刻は長さを65535等分した単位に丸められるため、値の変化が速いトラックではその分の誤差が加わる。
+	/// </remarks>
+	class DLL CompressedClip
+	{
+	public:
+		CompressedClip();
+
+		inline U32 GetBoneCount()const { return m_boneCount; }
+		inline F32 GetDuration()const { return m_duration; }
+
+		/// <summary>
+		/// サンプリングに必要なカーソルの数(ボーン数×3)
+		/// </summary>
+		inline U32 GetCursorCount()const { return m_boneCount * 3; }
+
+		/// <summary>
+		/// 圧縮後のデータサイズ(バイト)
+		/// </summary>
+		size_t GetMemorySize()const;
+
+		/// <summary>
+		/// 指定した時刻の姿勢を取得する
+		/// </summary>
+		/// <remarks>
+		/// カーソルは前回参照したキーの位置で、AnimationInstanceと同様に順方向の再生ではキーの検索がO(1)で済む。
+		/// </remarks>
+		/// <param name="time">時刻(秒)。0〜長さの範囲に丸められる</param>
+		/// <param name="cursors">トラックごとのカーソル(GetCursorCount()個、初期値は0)</param>
+		/// <param name="pose">出力先。ボーン数が異なる場合はリサイズされる</param>
+		/// <returns>　０：成功\n－１：cursorsがnullptr</returns>
+		S32 Sample(const F32 time, U32* cursors, Pose& pose)const;
+
+	private:
+		friend class AnimationCompressor;
+
+		U32 m_boneCount;
+		F32 m_duration;
+		// ボーンごとに平行移動、回転、拡大の順
+		ArrayList<CompressedTrack> m_tracks;
+		// 長さを65535等分した時刻
+		ArrayList<U16> m_times;
+		// キーごとに3要素
+		ArrayList<U16> m_values;
+	};
+
+
+	/// <summary>
+	/// キーフレームアニメーションを圧縮するクラス(オフライン処理用)
+	/// </summary>
+	/// <remarks>
+	/// トラックごとに、前後のキーからの補間で許容誤差内に再現できるキーを取り除いてから量子化する。
+	/// 値が一定のトラックはキー1つに、初期値のまま一定のトラックはキー無しになる。
+	/// </remarks>
+	class DLL AnimationCompressor
+	{
+	public:
+		/// <summary>
+		/// クリップを圧縮する
+		/// </summary>
+		/// <param name="clip">圧縮するクリップ</param>
+		/// <param name="settings">許容誤差</param>
+		/// <param name="dest">出力先</param>
+		/// <param name="report">結果のレポートの出力先(nullptrの場合は出力しない)</param>
+		/// <returns>　０：成功\n－１：キーの時刻が長さの範囲外</returns>
+		static S32 Compress(const AnimationClip& clip, const CompressionSettings& settings, CompressedClip& dest, CompressionReport* report = nullptr);
+	};
+}
\ No newline at end of file
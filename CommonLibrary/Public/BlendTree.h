@@ -0,0 +1,253 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "Animation.h"
+
+namespace CommonLibrary
+{
+	class BlendTree;
+
+	/// <summary>
+	/// ブレンドツリーのノードの基底クラス
+	/// </summary>
+	/// <remarks>
+	/// 各ノードは自身の出力姿勢を保持しているため、評価中にメモリ確保は発生しない(ボーン数が変わった場合を除く)。
+	/// ブレンドの重みはBlendTreeのパラメーターを番号で参照する。
+	/// </remarks>
+	class DLL BlendNode
+	{
+	public:
+		virtual ~BlendNode() {}
+
+		/// <summary>
+		/// 子孫のクリップの再生時刻を進める
+		/// </summary>
+		virtual void Advance(const F32 deltaTime) = 0;
+
+		/// <summary>
+		/// 姿勢を評価する。結果はGetPoseで取得する。
+		/// </summary>
+		virtual void Evaluate(const BlendTree& tree) = 0;
+
+		inline const Pose& GetPose()const { return m_pose; }
+
+	protected:
+		Pose m_pose;
+	};
+
+
+	/// <summary>
+	/// クリップを再生するノード
+	/// </summary>
+	class DLL ClipNode :public BlendNode
+	{
+	public:
+		ClipNode(const SPtr<AnimationClip>& clip);
+
+		void Advance(const F32 deltaTime)override;
+		void Evaluate(const BlendTree& tree)override;
+
+		inline AnimationInstance& GetInstance() { return m_instance; }
+
+	private:
+		AnimationInstance m_instance;
+	};
+
+
+	/// <summary>
+	/// 2つの姿勢を線形補間するノード
+	/// </summary>
+	class DLL LerpNode :public BlendNode
+	{
+	public:
+		/// <param name="a">重み0のときの姿勢</param>
+		/// <param name="b">重み1のときの姿勢</param>
+		/// <param name="parameter">重みとして使うパラメーターの番号</param>
+		LerpNode(const SPtr<BlendNode>& a, const SPtr<BlendNode>& b, const U32 parameter);
+
+		void Advance(const F32 deltaTime)override;
+		void Evaluate(const BlendTree& tree)override;
+
+	private:
+		SPtr<BlendNode> m_a;
+		SPtr<BlendNode> m_b;
+		U32 m_parameter;
+	};
+
+
+	/// <summary>
+	/// 差分姿勢を加算するノード
+	/// </summary>
+	/// <remarks>
+	/// additiveは基準姿勢からの差分(平行移動は差、回転は差分の回転、拡大は比)を表す姿勢とする。
+	/// </remarks>
+	class DLL AdditiveNode :public BlendNode
+	{
+	public:
+		AdditiveNode(const SPtr<BlendNode>& base, const SPtr<BlendNode>& additive, const U32 parameter);
+
+		void Advance(const F32 deltaTime)override;
+		void Evaluate(const BlendTree& tree)override;
+
+	private:
+		SPtr<BlendNode> m_base;
+		SPtr<BlendNode> m_additive;
+		U32 m_parameter;
+	};
+
+
+	/// <summary>
+	/// ボーンごとのマスクで別の姿勢を上書きするノード
+	/// </summary>
+	class DLL MaskedLayerNode :public BlendNode
+	{
+	public:
+		/// <param name="base">下のレイヤー</param>
+		/// <param name="layer">上に重ねるレイヤー</param>
+		/// <param name="boneMask">ボーンごとのレイヤーの影響度(0〜1)</param>
+		/// <param name="parameter">レイヤー全体の重みとして使うパラメーターの番号</param>
+		MaskedLayerNode(const SPtr<BlendNode>& base, const SPtr<BlendNode>& layer, const ArrayList<F32>& boneMask, const U32 parameter);
+
+		void Advance(const F32 deltaTime)override;
+		void Evaluate(const BlendTree& tree)override;
+
+	private:
+		SPtr<BlendNode> m_base;
+		SPtr<BlendNode> m_layer;
+		// 4の倍数の長さに揃えたマスク
+		ArrayList<F32> m_boneMask;
+		// マスクにレイヤーの重みを掛けたもの
+		ArrayList<F32> m_weights;
+		U32 m_parameter;
+	};
+
+
+	/// <summary>
+	/// 1次元のパラメーターで複数の姿勢をブレンドするノード
+	/// </summary>
+	/// <remarks>
+	/// パラメーターを挟む2つの子を線形補間する。範囲外の場合は端の子の姿勢になる。
+	/// </remarks>
+	class DLL BlendSpace1DNode :public BlendNode
+	{
+	public:
+		BlendSpace1DNode(const U32 parameter);
+
+		/// <summary>
+		/// 子を追加する
+		/// </summary>
+		/// <param name="node">子</param>
+		/// <param name="position">子の配置されるパラメーターの値</param>
+		/// <returns>　０：成功\n－１：nodeがnullptr</returns>
+		S32 AddChild(const SPtr<BlendNode>& node, const F32 position);
+
+		void Advance(const F32 deltaTime)override;
+		void Evaluate(const BlendTree& tree)override;
+
+	private:
+		struct Child
+		{
+			SPtr<BlendNode> node;
+			F32 position;
+		};
+
+		// positionの昇順
+		ArrayList<Child> m_children;
+		U32 m_parameter;
+	};
+
+
+	/// <summary>
+	/// 2次元のパラメーターで複数の姿勢をブレンドするノード
+	/// </summary>
+	/// <remarks>
+	/// 子の位置を基準とした勾配帯(Gradient Band)の重みでブレンドする。
+	/// 子の位置に一致する場合はその子の姿勢になり、他の子より遠い子の重みは0になる。重みが0の子は評価しない。
+	/// </remarks>
+	class DLL BlendSpace2DNode :public BlendNode
+	{
+	public:
+		BlendSpace2DNode(const U32 parameterX, const U32 parameterY);
+
+		/// <summary>
+		/// 子を追加する
+		/// </summary>
+		/// <returns>　０：成功\n－１：nodeがnullptr</returns>
+		S32 AddChild(const SPtr<BlendNode>& node, const F32 x, const F32 y);
+
+		void Advance(const F32 deltaTime)override;
+		void Evaluate(const BlendTree& tree)override;
+
+	private:
+		struct Child
+		{
+			SPtr<BlendNode> node;
+			F32 x;
+			F32 y;
+		};
+
+		ArrayList<Child> m_children;
+		// 評価時に使用する作業領域
+		ArrayList<const Pose*> m_poses;
+		ArrayList<F32> m_weights;
+		U32 m_parameterX;
+		U32 m_parameterY;
+	};
+
+
+	/// <summary>
+	/// ブレンドツリー
+	/// </summary>
+	/// <remarks>
+	/// キャラクターごとに生成する。ノードの姿勢をSoAのまま合成し、最後に親子関係をたどってモデル空間に変換する。
+	/// </remarks>
+	class DLL BlendTree
+	{
+	public:
+		/// <param name="parents">ボーンごとの親の番号(ルートは－１、親は子より前)</param>
+		/// <param name="parameterCount">パラメーターの数</param>
+		BlendTree(const ArrayList<S32>& parents, const U32 parameterCount);
+
+		inline void SetRoot(const SPtr<BlendNode>& root) { m_root = root; }
+		inline const SPtr<BlendNode>& GetRoot()const { return m_root; }
+
+		/// <summary>
+		/// パラメーターを設定する
+		/// </summary>
+		/// <returns>　０：成功\n－１：番号が不正</returns>
+		S32 SetParameter(const U32 index, const F32 value);
+
+		/// <summary>
+		/// パラメーターを取得する。番号が不正な場合は0を返す。
+		/// </summary>
+		F32 GetParameter(const U32 index)const;
+
+		inline U32 GetBoneCount()const { return (U32)m_parents.size(); }
+
+		/// <summary>
+		/// 再生時刻を進める
+		/// </summary>
+		void Advance(const F32 deltaTime);
+
+		/// <summary>
+		/// 姿勢を評価してモデル空間の変換を求める
+		/// </summary>
+		/// <param name="palette">ボーンごとの変換の出力先</param>
+		/// <param name="paletteSize">出力先の要素数</param>
+		/// <returns>　０：成功\n－１：ルートが設定されていない、または出力先が足りない</returns>
+		S32 Evaluate(Affine* palette, const size_t paletteSize);
+
+		/// <summary>
+		/// 複数のキャラクターのブレンドツリーを並列に評価する
+		/// </summary>
+		/// <param name="trees">ブレンドツリーの配列</param>
+		/// <param name="palettes">ブレンドツリーごとの出力先の配列(それぞれボーン数以上の要素が必要)</param>
+		/// <param name="count">ブレンドツリーの数</param>
+		static void EvaluateAll(BlendTree* const* trees, Affine* const* palettes, const size_t count);
+
+	private:
+		SPtr<BlendNode> m_root;
+		ArrayList<S32> m_parents;
+		ArrayList<F32> m_parameters;
+	};
+}
\ No newline at end of file
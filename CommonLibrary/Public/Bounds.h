@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "Vector3.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 軸に平行な境界ボックス(AABB)
+	/// </summary>
+	class Bounds
+	{
+	public:
+		/// <summary> 最小の頂点 </summary>
+		Vector3 min;
+		/// <summary> 最大の頂点 </summary>
+		Vector3 max;
+
+		Bounds() {}
+		Bounds(const Vector3& _min, const Vector3& _max) :min(_min), max(_max) {}
+
+		/// <summary>
+		/// 中心と各軸の半分の大きさから生成する
+		/// </summary>
+		static inline Bounds FromCenter(const Vector3& center, const Vector3& extents)
+		{
+			return Bounds(center - extents, center + extents);
+		}
+
+		inline Vector3 GetCenter()const { return (min + max) * 0.5f; }
+		inline Vector3 GetExtents()const { return (max - min) * 0.5f; }
+		inline Vector3 GetSize()const { return max - min; }
+
+		/// <summary>
+		/// 別の境界ボックスと重なっているか(接している場合を含む)
+		/// </summary>
+		inline bool Intersects(const Bounds& other)const
+		{
+			return min.x <= other.max.x && other.min.x <= max.x &&
+				min.y <= other.max.y && other.min.y <= max.y &&
+				min.z <= other.max.z && other.min.z <= max.z;
+		}
+
+		/// <summary>
+		/// 点が内部にあるか(境界上を含む)
+		/// </summary>
+		inline bool Contains(const Vector3& point)const
+		{
+			return min.x <= point.x && point.x <= max.x &&
+				min.y <= point.y && point.y <= max.y &&
+				min.z <= point.z && point.z <= max.z;
+		}
+
+		/// <summary>
+		/// 点を含むように広げる
+		/// </summary>
+		inline void Encapsulate(const Vector3& point)
+		{
+			min = Vector3(min.x < point.x ? min.x : point.x, min.y < point.y ? min.y : point.y, min.z < point.z ? min.z : point.z);
+			max = Vector3(point.x < max.x ? max.x : point.x, point.y < max.y ? max.y : point.y, point.z < max.z ? max.z : point.z);
+		}
+
+		/// <summary>
+		/// 別の境界ボックスを含むように広げる
+		/// </summary>
+		inline void Encapsulate(const Bounds& other)
+		{
+			Encapsulate(other.min);
+			Encapsulate(other.max);
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,109 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "Bounds.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 重なっているプロキシの組(a < b)
+	/// </summary>
+	struct BroadphasePair
+	{
+		U32 a;
+		U32 b;
+	};
+
+
+	/// <summary>
+	/// Sweep and Pruneによるブロードフェーズ
+	/// </summary>
+	/// <remarks>
+	/// プロキシを1つの軸の最小値で整列した配列を保持し、毎回の更新では前回の順序から挿入ソートで並べ直す。
+	/// 整列した順に走査し、その軸で重なる範囲の候補について残り2軸をSIMDで4つずつ判定する。
+	/// 整列に使う軸はプロキシの中心の分散が最も大きい軸を自動で選ぶ。
+	/// 走査はParallel::Forで分割して行う。重なっている組は更新ごとに前回の組と比較し、追加と削除を通知する。
+	/// </remarks>
+	class DLL Broadphase
+	{
+	public:
+		/// <summary> 無効なプロキシ </summary>
+		static const U32 INVALID_PROXY;
+
+		/// <summary> 1回の呼び出しで1スレッドが走査するプロキシ数 </summary>
+		static const size_t PROXIES_PER_TASK = 1024;
+
+		Broadphase();
+
+		/// <summary>
+		/// プロキシを追加する
+		/// </summary>
+		/// <returns>プロキシの番号</returns>
+		U32 Add(const Bounds& bounds);
+
+		/// <summary>
+		/// プロキシを削除する。番号は次のUpdateの後に再利用される。
+		/// </summary>
+		/// <returns>　０：成功\n－１：番号が無効</returns>
+		S32 Remove(const U32 proxy);
+
+		/// <summary>
+		/// プロキシの境界ボックスを更新する
+		/// </summary>
+		/// <returns>　０：成功\n－１：番号が無効</returns>
+		S32 Move(const U32 proxy, const Bounds& bounds);
+
+		/// <summary>
+		/// 境界ボックスを取得する。番号が無効な場合はnullptrを返す。
+		/// </summary>
+		const Bounds* GetBounds(const U32 proxy)const;
+
+		/// <summary>
+		/// 重なっている組を求め直す
+		/// </summary>
+		void Update();
+
+		/// <summary> 重なっている全ての組(a, bの昇順) </summary>
+		inline const ArrayList<BroadphasePair>& GetPairs()const { return m_pairs; }
+
+		/// <summary> 直前のUpdateで新たに重なった組 </summary>
+		inline const ArrayList<BroadphasePair>& GetAddedPairs()const { return m_addedPairs; }
+
+		/// <summary> 直前のUpdateで重ならなくなった組(削除されたプロキシを含む組を含む) </summary>
+		inline const ArrayList<BroadphasePair>& GetRemovedPairs()const { return m_removedPairs; }
+
+		inline U32 GetProxyCount()const { return (U32)m_order.size(); }
+
+	private:
+		ArrayList<Bounds> m_bounds;
+		ArrayList<U8> m_alive;
+		ArrayList<U32> m_freeProxies;
+		// 次のUpdateの後に再利用する番号
+		ArrayList<U32> m_pendingFree;
+
+		// 整列に使う軸と、その軸の最小値で整列したプロキシ
+		U32 m_axis;
+		ArrayList<U32> m_order;
+		ArrayList<F32> m_keys;
+		// 前回のUpdateの後に追加されたプロキシの数
+		U32 m_insertedCount;
+
+		// 整列した順の境界ボックス(SoA)。0が整列に使う軸、1と2が残りの軸
+		ArrayList<F32> m_min[3];
+		ArrayList<F32> m_max[3];
+
+		// 走査の分割ごとの結果
+		ArrayList<ArrayList<U64>> m_taskPairs;
+		ArrayList<U64> m_keysScratch;
+		ArrayList<U64> m_current;
+		ArrayList<U64> m_previous;
+
+		ArrayList<BroadphasePair> m_pairs;
+		ArrayList<BroadphasePair> m_addedPairs;
+		ArrayList<BroadphasePair> m_removedPairs;
+
+		void SortProxies();
+		void Sweep(const size_t begin, const size_t end, ArrayList<U64>& dest)const;
+		void ChooseAxis();
+	};
+}
\ No newline at end of file
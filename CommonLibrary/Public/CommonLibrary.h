@@ -24,6 +24,24 @@
 #include "Matrix.h"
 #include "Mathf.h"
 #include "Quaternion.h"
+#include "Affine.h"
+#include "Curve.h"
+#include "RadixSort.h"
+#include "Animation.h"
+#include "AnimationCompression.h"
+#include "BlendTree.h"
+#include "Parallel.h"
+#include "Skinning.h"
+#include "TransformHierarchy.h"
+#include "Ecs.h"
+#include "Bounds.h"
+#include "Frustum.h"
+#include "Broadphase.h"
+#include "Physics.h"
+#include "Picking.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "Meshlet.h"
 
 
 #ifndef USE_COMMONLIBRARY_NAMESPACE
@@ -0,0 +1,426 @@
+﻿#pragma once
+#include "Fwd.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 曲線の制御点の与え方
+	/// </summary>
+	enum class CurveType
+	{
+		/// <summary> 3次ベジェ曲線。制御点は(3 * 区間数 + 1)個 </summary>
+		Bezier,
+		/// <summary> Catmull-Romスプライン。制御点は4個以上で、両端の点は通過しない </summary>
+		CatmullRom,
+		/// <summary> エルミート曲線。(位置, 接線)の組を2組以上並べる </summary>
+		Hermite,
+	};
+
+
+	/// <summary>
+	/// 3次曲線を評価するクラス
+	/// </summary>
+	/// <remarks>
+	/// Tには成分がF32のみで構成される型(Vector2, Vector3, Color等)を指定する。
+	/// どの種類の曲線も生成時に区間ごとのベジェ制御点に変換して保持するため、評価時に分岐や仮想関数呼び出しは発生しない。
+	/// パラメーターtは曲線全体を0〜1で表し、範囲外の値は0〜1に丸められる。
+	/// </remarks>
+	template<class T>
+	class Curve
+	{
+		static_assert(std::is_standard_layout<T>::value && sizeof(T) % sizeof(F32) == 0, "Curve requires a type made only of F32 components.");
+
+	public:
+		/// <summary> Tの成分数 </summary>
+		static const size_t COMPONENTS = sizeof(T) / sizeof(F32);
+
+		//===================================================================================//
+		// 1区間の評価
+		//===================================================================================//
+
+		/// <summary>
+		/// 3次ベジェ曲線を評価する
+		/// </summary>
+		static inline T Bezier(const T& p0, const T& p1, const T& p2, const T& p3, const F32 t)
+		{
+			F32 w[4];
+			BezierWeights(t, w);
+			const T* points[] = { &p0, &p1, &p2, &p3 };
+			return Combine(points, w);
+		}
+
+		/// <summary>
+		/// Catmull-Romスプラインのp1からp2の区間を評価する
+		/// </summary>
+		static inline T CatmullRom(const T& p0, const T& p1, const T& p2, const T& p3, const F32 t)
+		{
+			T b[4];
+			CatmullRomToBezier(p0, p1, p2, p3, b);
+			return Bezier(b[0], b[1], b[2], b[3], t);
+		}
+
+		/// <summary>
+		/// エルミート曲線を評価する
+		/// </summary>
+		/// <param name="p0">始点</param>
+		/// <param name="m0">始点の接線</param>
+		/// <param name="p1">終点</param>
+		/// <param name="m1">終点の接線</param>
+		/// <param name="t">パラメーター</param>
+		static inline T Hermite(const T& p0, const T& m0, const T& p1, const T& m1, const F32 t)
+		{
+			T b[4];
+			HermiteToBezier(p0, m0, p1, m1, b);
+			return Bezier(b[0], b[1], b[2], b[3], t);
+		}
+
+		//===================================================================================//
+		// 曲線全体
+		//===================================================================================//
+
+		Curve() {}
+
+		/// <summary>
+		/// 制御点から曲線を生成する
+		/// </summary>
+		/// <param name="type">曲線の種類</param>
+		/// <param name="points">制御点</param>
+		/// <param name="count">制御点の数</param>
+		/// <returns>　０：成功\n－１：制御点の数が不正</returns>
+		S32 Create(const CurveType type, const T* points, const size_t count)
+		{
+			if (points == nullptr)return -1;
+
+			m_segments.clear();
+			m_arcParams.clear();
+			m_arcLengths.clear();
+
+			switch (type)
+			{
+			case CurveType::Bezier:
+				if (count < 4 || (count - 1) % 3 != 0)return -1;
+				for (size_t i = 0; i + 3 < count; i += 3)
+				{
+					AddSegment(points + i);
+				}
+				break;
+			case CurveType::CatmullRom:
+				if (count < 4)return -1;
+				for (size_t i = 0; i + 3 < count; i++)
+				{
+					T b[4];
+					CatmullRomToBezier(points[i], points[i + 1], points[i + 2], points[i + 3], b);
+					AddSegment(b);
+				}
+				break;
+			case CurveType::Hermite:
+				if (count < 4 || count % 2 != 0)return -1;
+				for (size_t i = 0; i + 3 < count; i += 2)
+				{
+					T b[4];
+					HermiteToBezier(points[i], points[i + 1], points[i + 2], points[i + 3], b);
+					AddSegment(b);
+				}
+				break;
+			default:
+				return -1;
+			}
+
+			return 0;
+		}
+
+		/// <summary>
+		/// 区間数を取得する
+		/// </summary>
+		inline size_t GetSegmentCount()const { return m_segments.size() / (COMPONENTS * 4); }
+
+		/// <summary>
+		/// 曲線上の点を取得する
+		/// </summary>
+		/// <param name="t">曲線全体を0〜1で表したパラメーター(範囲外は端、NaNは始点として扱う)</param>
+		T Evaluate(const F32 t)const
+		{
+			T result = T();
+			if (m_segments.empty())return result;
+
+			F32 local;
+			const F32* segment = FindSegment(t, local);
+
+			F32 w[4];
+			BezierWeights(local, w);
+
+			F32* dest = reinterpret_cast<F32*>(&result);
+			for (size_t c = 0; c < COMPONENTS; c++)
+			{
+				dest[c] = segment[c] * w[0] + segment[COMPONENTS + c] * w[1] + segment[COMPONENTS * 2 + c] * w[2] + segment[COMPONENTS * 3 + c] * w[3];
+			}
+			return result;
+		}
+
+		/// <summary>
+		/// 複数のパラメーターでまとめて曲線上の点を取得する
+		/// </summary>
+		/// <remarks>
+		/// 4つのパラメーターごとにSIMDで評価する。
+		/// </remarks>
+		/// <param name="ts">パラメーターの配列</param>
+		/// <param name="count">パラメーターの数</param>
+		/// <param name="dest">結果の出力先(count個)</param>
+		void Evaluate(const F32* ts, const size_t count, T* dest)const
+		{
+			if (ts == nullptr || dest == nullptr)return;
+			if (m_segments.empty())
+			{
+				std::fill(dest, dest + count, T());
+				return;
+			}
+
+			F32* out = reinterpret_cast<F32*>(dest);
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				const F32* segments[4];
+				F32 locals[4];
+				for (size_t lane = 0; lane < 4; lane++)
+				{
+					segments[lane] = FindSegment(ts[i + lane], locals[lane]);
+				}
+
+				// ベルンシュタイン基底
+				F32x4 t = F32x4::Load(locals);
+				F32x4 u = F32x4::Set1(1.0f) - t;
+				F32x4 three = F32x4::Set1(3.0f);
+				F32x4 w0 = u * u * u;
+				F32x4 w1 = three * u * u * t;
+				F32x4 w2 = three * u * t * t;
+				F32x4 w3 = t * t * t;
+
+				for (size_t c = 0; c < COMPONENTS; c++)
+				{
+					F32x4 p0 = Gather(segments, c);
+					F32x4 p1 = Gather(segments, COMPONENTS + c);
+					F32x4 p2 = Gather(segments, COMPONENTS * 2 + c);
+					F32x4 p3 = Gather(segments, COMPONENTS * 3 + c);
+
+					F32 result[4];
+					(w0 * p0 + w1 * p1 + w2 * p2 + w3 * p3).Store(result);
+					for (size_t lane = 0; lane < 4; lane++)
+					{
+						out[(i + lane) * COMPONENTS + c] = result[lane];
+					}
+				}
+			}
+			for (; i < count; i++)
+			{
+				dest[i] = Evaluate(ts[i]);
+			}
+		}
+
+		//===================================================================================//
+		// 弧長による再パラメーター化
+		//===================================================================================//
+
+		/// <summary>
+		/// 弧長とパラメーターの対応表を作成する
+		/// </summary>
+		/// <remarks>
+		/// 制御点の数を変更した場合は作り直す必要がある。
+		/// </remarks>
+		/// <param name="samplesPerSegment">区間ごとのサンプル数</param>
+		/// <returns>　０：成功\n－１：曲線が生成されていない、またはサンプル数が0</returns>
+		S32 BuildArcLengthTable(const U32 samplesPerSegment = 16)
+		{
+			if (m_segments.empty() || samplesPerSegment == 0)return -1;
+
+			size_t sampleCount = GetSegmentCount() * samplesPerSegment;
+			m_arcParams.resize(sampleCount + 1);
+			m_arcLengths.resize(sampleCount + 1);
+
+			for (size_t i = 0; i <= sampleCount; i++)
+			{
+				m_arcParams[i] = (F32)i / (F32)sampleCount;
+			}
+
+			ArrayList<T> points(sampleCount + 1);
+			Evaluate(m_arcParams.data(), m_arcParams.size(), points.data());
+
+			m_arcLengths[0] = 0.0f;
+			for (size_t i = 1; i <= sampleCount; i++)
+			{
+				const F32* a = reinterpret_cast<const F32*>(&points[i - 1]);
+				const F32* b = reinterpret_cast<const F32*>(&points[i]);
+				F32 squared = 0.0f;
+				for (size_t c = 0; c < COMPONENTS; c++)
+				{
+					F32 d = b[c] - a[c];
+					squared += d * d;
+				}
+				m_arcLengths[i] = m_arcLengths[i - 1] + std::sqrt(squared);
+			}
+
+			return 0;
+		}
+
+		/// <summary>
+		/// 曲線の長さを取得する。対応表が作成されていない場合は0を返す。
+		/// </summary>
+		inline F32 GetLength()const { return m_arcLengths.empty() ? 0.0f : m_arcLengths.back(); }
+
+		/// <summary>
+		/// 始点からの距離をパラメーターに変換する
+		/// </summary>
+		/// <remarks>
+		/// BuildArcLengthTableで作成した対応表を線形補間する。対応表が無い場合は距離をそのまま返す。
+		/// </remarks>
+		/// <param name="distance">始点からの距離</param>
+		F32 DistanceToParameter(const F32 distance)const
+		{
+			if (m_arcLengths.size() < 2)return distance;
+			// NaNも始点として扱う
+			if (!(0.0f < distance))return 0.0f;
+			if (GetLength() <= distance)return 1.0f;
+
+			size_t upper = std::upper_bound(m_arcLengths.begin(), m_arcLengths.end(), distance) - m_arcLengths.begin();
+			if (m_arcLengths.size() <= upper)upper = m_arcLengths.size() - 1;
+			size_t lower = upper - 1;
+
+			F32 length = m_arcLengths[upper] - m_arcLengths[lower];
+			F32 rate = 0.0f < length ? (distance - m_arcLengths[lower]) / length : 0.0f;
+			return m_arcParams[lower] + (m_arcParams[upper] - m_arcParams[lower]) * rate;
+		}
+
+		/// <summary>
+		/// 始点からの距離で曲線上の点を取得する
+		/// </summary>
+		inline T EvaluateAtDistance(const F32 distance)const
+		{
+			return Evaluate(DistanceToParameter(distance));
+		}
+
+		/// <summary>
+		/// 始点からの距離でまとめて曲線上の点を取得する
+		/// </summary>
+		/// <param name="distances">距離の配列</param>
+		/// <param name="count">距離の数</param>
+		/// <param name="dest">結果の出力先(count個)</param>
+		void EvaluateAtDistance(const F32* distances, const size_t count, T* dest)const
+		{
+			if (distances == nullptr || dest == nullptr)return;
+
+			const size_t BATCH = 256;
+			F32 ts[BATCH];
+			for (size_t i = 0; i < count; i += BATCH)
+			{
+				size_t batchCount = count - i < BATCH ? count - i : BATCH;
+				for (size_t j = 0; j < batchCount; j++)
+				{
+					ts[j] = DistanceToParameter(distances[i + j]);
+				}
+				Evaluate(ts, batchCount, dest + i);
+			}
+		}
+
+	private:
+		// 区間ごとのベジェ制御点(区間ごとに4点 * COMPONENTS個のF32)
+		ArrayList<F32> m_segments;
+		// 弧長の対応表
+		ArrayList<F32> m_arcParams;
+		ArrayList<F32> m_arcLengths;
+
+		static inline void BezierWeights(const F32 t, F32* w)
+		{
+			F32 u = 1.0f - t;
+			w[0] = u * u * u;
+			w[1] = 3.0f * u * u * t;
+			w[2] = 3.0f * u * t * t;
+			w[3] = t * t * t;
+		}
+
+		static inline T Combine(const T* const* points, const F32* w)
+		{
+			T result = T();
+			F32* dest = reinterpret_cast<F32*>(&result);
+			for (size_t c = 0; c < COMPONENTS; c++)
+			{
+				F32 sum = 0.0f;
+				for (size_t i = 0; i < 4; i++)
+				{
+					sum += reinterpret_cast<const F32*>(points[i])[c] * w[i];
+				}
+				dest[c] = sum;
+			}
+			return result;
+		}
+
+		// Catmull-Romのp1〜p2区間と同じ形のベジェ制御点を求める
+		static inline void CatmullRomToBezier(const T& p0, const T& p1, const T& p2, const T& p3, T* dest)
+		{
+			const F32* a = reinterpret_cast<const F32*>(&p0);
+			const F32* b = reinterpret_cast<const F32*>(&p1);
+			const F32* c = reinterpret_cast<const F32*>(&p2);
+			const F32* d = reinterpret_cast<const F32*>(&p3);
+			F32* out[4];
+			for (size_t i = 0; i < 4; i++)out[i] = reinterpret_cast<F32*>(&dest[i]);
+
+			for (size_t i = 0; i < COMPONENTS; i++)
+			{
+				out[0][i] = b[i];
+				out[1][i] = b[i] + (c[i] - a[i]) / 6.0f;
+				out[2][i] = c[i] - (d[i] - b[i]) / 6.0f;
+				out[3][i] = c[i];
+			}
+		}
+
+		// エルミート曲線と同じ形のベジェ制御点を求める
+		static inline void HermiteToBezier(const T& p0, const T& m0, const T& p1, const T& m1, T* dest)
+		{
+			const F32* a = reinterpret_cast<const F32*>(&p0);
+			const F32* b = reinterpret_cast<const F32*>(&m0);
+			const F32* c = reinterpret_cast<const F32*>(&p1);
+			const F32* d = reinterpret_cast<const F32*>(&m1);
+			F32* out[4];
+			for (size_t i = 0; i < 4; i++)out[i] = reinterpret_cast<F32*>(&dest[i]);
+
+			for (size_t i = 0; i < COMPONENTS; i++)
+			{
+				out[0][i] = a[i];
+				out[1][i] = a[i] + b[i] / 3.0f;
+				out[2][i] = c[i] - d[i] / 3.0f;
+				out[3][i] = c[i];
+			}
+		}
+
+		void AddSegment(const T* points)
+		{
+			for (size_t i = 0; i < 4; i++)
+			{
+				const F32* p = reinterpret_cast<const F32*>(&points[i]);
+				m_segments.insert(m_segments.end(), p, p + COMPONENTS);
+			}
+		}
+
+		// 曲線全体のパラメーターから区間の先頭と区間内のパラメーターを求める
+		inline const F32* FindSegment(F32 t, F32& local)const
+		{
+			size_t segmentCount = GetSegmentCount();
+			// NaNは比較が全て偽になるため、0より大きいことを先に確かめて始点に寄せる(そのまま整数に変換すると未定義動作)
+			t = 0.0f < t ? (t < 1.0f ? t : 1.0f) : 0.0f;
+
+			F32 scaled = t * (F32)segmentCount;
+			size_t index = (size_t)scaled;
+			if (segmentCount <= index)index = segmentCount - 1;
+
+			local = scaled - (F32)index;
+			return m_segments.data() + index * COMPONENTS * 4;
+		}
+
+		static inline F32x4 Gather(const F32* const* segments, const size_t offset)
+		{
+			return F32x4::Set(segments[0][offset], segments[1][offset], segments[2][offset], segments[3][offset]);
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+﻿#pragma once
+#include "Fwd.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// どの環境でも同じビット列の結果を返す数学関数
+	/// </summary>
+	/// <remarks>
+	/// libmを使用せず、四則演算とsqrtのみで固定のアルゴリズムを実装している。
+	/// IEEE754の四則演算とsqrtは正しく丸められるため、コンパイラやCPUが違っても結果は一致する。
+	/// USE_DETERMINISTIC_MATHを定義するとMathfの関数はこのクラスを経由する。
+	/// 実装ファイルではFMAへの縮約を無効にしているため、呼び出し側のコンパイルオプションに依存しない。
+	/// </remarks>
+	class DLL DeterministicMath
+	{
+	public:
+		//===================================================================================//
+		// 初等関数
+		//===================================================================================//
+
+		static F32 Sin(const F32 f);
+		static F32 Cos(const F32 f);
+		static F32 Tan(const F32 f);
+		static F32 Asin(const F32 f);
+		static F32 Acos(const F32 f);
+		static F32 Atan(const F32 f);
+		static F32 Atan2(const F32 y, const F32 x);
+		static F32 Exp(const F32 f);
+		static F32 Log(const F32 f);
+		static F32 Log10(const F32 f);
+		static F32 Pow(const F32 f, const F32 p);
+		static F32 Sqrt(const F32 f);
+
+		//===================================================================================//
+		// 補間
+		//===================================================================================//
+
+		static F32 Lerp(const F32 a, const F32 b, const F32 t);
+		static F32 LerpAngle(const F32 a, const F32 b, const F32 t);
+		static F32 PingPong(const F32 f);
+
+		//===================================================================================//
+		// 集計
+		//===================================================================================//
+
+		/// <summary>
+		/// 集計を分割するブロックの要素数
+		/// </summary>
+		/// <remarks>
+		/// 並列に集計する場合はこの要素数ごとにPartialSumを求め、CombinePartialSumsで合計すると
+		/// スレッド数に関係なくSumと同じ結果になる。
+		/// </remarks>
+		static const size_t REDUCTION_BLOCK_SIZE = 256;
+
+		/// <summary>
+		/// REDUCTION_BLOCK_SIZE以下の要素を先頭から順に合計する
+		/// </summary>
+		/// <param name="values">合計する値</param>
+		/// <param name="count">要素数</param>
+		/// <returns>部分和</returns>
+		static F64 PartialSum(const F32* values, const size_t count);
+
+		/// <summary>
+		/// REDUCTION_BLOCK_SIZE以下の要素の内積を先頭から順に求める
+		/// </summary>
+		/// <param name="a">ベクトルA</param>
+		/// <param name="b">ベクトルB</param>
+		/// <param name="count">要素数</param>
+		/// <returns>部分和</returns>
+		static F64 PartialDot(const F32* a, const F32* b, const size_t count);
+
+		/// <summary>
+		/// ブロックごとの部分和を固定の二分木の順序で合計する
+		/// </summary>
+		/// <param name="partials">部分和の配列</param>
+		/// <param name="count">部分和の数</param>
+		/// <returns>合計</returns>
+		static F32 CombinePartialSums(const F64* partials, const size_t count);
+
+		/// <summary>
+		/// 配列の合計を求める
+		/// </summary>
+		/// <param name="values">合計する値</param>
+		/// <param name="count">要素数</param>
+		/// <returns>合計</returns>
+		static F32 Sum(const F32* values, const size_t count);
+
+		/// <summary>
+		/// 配列の内積を求める
+		/// </summary>
+		/// <param name="a">ベクトルA</param>
+		/// <param name="b">ベクトルB</param>
+		/// <param name="count">要素数</param>
+		/// <returns>内積</returns>
+		static F32 Dot(const F32* a, const F32* b, const size_t count);
+
+		//===================================================================================//
+		// 検証
+		//===================================================================================//
+
+		/// <summary>
+		/// 各関数の結果をハッシュ化したチェックサムを求める
+		/// </summary>
+		/// <remarks>
+		/// 入力は固定のシードから生成するため、異なる環境で値を比較すれば結果が一致しているかを確認できる。
+		/// </remarks>
+		/// <param name="sampleCount">関数ごとの入力数</param>
+		/// <returns>チェックサム</returns>
+		static U64 Checksum(const U32 sampleCount);
+
+		/// <summary>
+		/// 基準値と比較するときの関数ごとの入力数
+		/// </summary>
+		static const U32 REFERENCE_SAMPLE_COUNT = 4096;
+
+		/// <summary>
+		/// Checksum(REFERENCE_SAMPLE_COUNT)の基準値
+		/// </summary>
+		/// <remarks>
+		/// 実装を変更して結果が変わった場合は、意図した変更であることを確認してから更新する。
+		/// </remarks>
+		static const U64 REFERENCE_CHECKSUM = 0x80CF16A39B258E98ull;
+
+		/// <summary>
+		/// この環境での結果が基準値と一致するかを確認する
+		/// </summary>
+		/// <remarks>
+		/// コンパイラや最適化オプションの変更で結果が変わっていないかを起動時やビルド後に確認するために使う。
+		/// </remarks>
+		/// <returns>　０：一致\n－１：基準値と異なる</returns>
+		static S32 VerifyChecksum();
+
+		/// <summary>
+		/// 異なる環境間で結果を比較するときの関数ごとの入力数
+		/// </summary>
+		static const U32 FULL_SAMPLE_COUNT = 1 << 20;
+
+		/// <summary>
+		/// Checksum(FULL_SAMPLE_COUNT)の基準値
+		/// </summary>
+		static const U64 FULL_REFERENCE_CHECKSUM = 0x3F51E8B462C618F1ull;
+
+		/// <summary>
+		/// 約100万件の入力で、この環境での結果が基準値と一致するかを確認する
+		/// </summary>
+		/// <remarks>
+		/// VerifyChecksumより時間がかかるため、新しいコンパイラやプラットフォームへの移行時に使う。
+		/// </remarks>
+		/// <returns>　０：一致\n－１：基準値と異なる</returns>
+		static S32 VerifyFullChecksum();
+	};
+}
\ No newline at end of file
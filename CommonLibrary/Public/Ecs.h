@@ -0,0 +1,341 @@
+﻿#pragma once
+
+#include "Fwd.h"
+
+#include <bitset>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <typeinfo>
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// エンティティ
+	/// </summary>
+	/// <remarks>
+	/// 番号と世代の組で、破棄されたエンティティを指すものは無効になる。
+	/// </remarks>
+	struct Entity
+	{
+		U32 index = 0;
+		U32 generation = 0;
+
+		inline bool operator==(const Entity& other)const { return index == other.index && generation == other.generation; }
+		inline bool operator!=(const Entity& other)const { return !(*this == other); }
+	};
+
+
+	/// <summary> コンポーネントの種類の最大数 </summary>
+	const U32 MAX_COMPONENT_TYPES = 128;
+
+	/// <summary> コンポーネントの組み合わせ </summary>
+	using ComponentMask = std::bitset<MAX_COMPONENT_TYPES>;
+
+
+	/// <summary>
+	/// コンポーネントの種類の登録
+	/// </summary>
+	/// <remarks>
+	/// コンポーネントはmemcpyで移動するため、トリビアルにコピーできる型に限る。
+	/// 番号は型名で管理されるため、DLLの内外で同じ型は同じ番号になる。
+	/// </remarks>
+	class DLL ComponentType
+	{
+	public:
+		/// <summary>
+		/// コンポーネントの種類を登録する。同じ名前が登録済みの場合はその番号を返す。
+		/// </summary>
+		/// <returns>番号。登録数が上限を超えた場合はMAX_COMPONENT_TYPES</returns>
+		static U32 Register(const char* name, const size_t size, const size_t alignment);
+
+		static size_t GetSize(const U32 id);
+		static size_t GetAlignment(const U32 id);
+
+		template<class T>
+		static U32 GetId()
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "component must be trivially copyable");
+			static const U32 id = Register(typeid(T).name(), sizeof(T), alignof(T));
+			return id;
+		}
+
+		template<class... Ts>
+		static ComponentMask GetMask()
+		{
+			ComponentMask mask;
+			const S32 ids[] = { 0, (Set(mask, GetId<Ts>()), 0)... };
+			(void)ids;
+			return mask;
+		}
+
+	private:
+		static inline void Set(ComponentMask& mask, const U32 id)
+		{
+			if (id < MAX_COMPONENT_TYPES)mask.set(id);
+		}
+	};
+
+
+	/// <summary>
+	/// エンティティの検索条件
+	/// </summary>
+	struct EntityQuery
+	{
+		/// <summary> 全て持っている必要があるコンポーネント </summary>
+		ComponentMask all;
+		/// <summary> 持っていてはいけないコンポーネント </summary>
+		ComponentMask none;
+		/// <summary> いずれかがchangedSinceより後に変更されている必要があるコンポーネント </summary>
+		ComponentMask changed;
+		/// <summary> 変更の判定に使うバージョン(World::GetVersionで取得した値) </summary>
+		U32 changedSince = 0;
+
+		template<class... Ts>
+		EntityQuery& WithAll() { all |= ComponentType::GetMask<Ts...>(); return *this; }
+
+		template<class... Ts>
+		EntityQuery& WithNone() { none |= ComponentType::GetMask<Ts...>(); return *this; }
+
+		/// <summary>
+		/// 指定したコンポーネントがversionより後に変更されたチャンクだけを対象にする
+		/// </summary>
+		/// <remarks>
+		/// 変更はチャンク単位で記録されるため、変更されていないエンティティが含まれる場合がある。
+		/// </remarks>
+		template<class... Ts>
+		EntityQuery& WithChanged(const U32 version) { changed |= ComponentType::GetMask<Ts...>(); changedSince = version; return *this; }
+	};
+
+
+	struct Archetype;
+	struct EntityChunk;
+
+	/// <summary>
+	/// 検索で見つかったチャンク
+	/// </summary>
+	/// <remarks>
+	/// コンポーネントはチャンクごとに種類別の配列(SoA)で並んでいる。
+	/// Writeで取得した配列はチャンクのバージョンが更新され、変更されたものとして扱われる。
+	/// </remarks>
+	class DLL ChunkView
+	{
+	public:
+		ChunkView(Archetype* archetype, EntityChunk* chunk, const U32 version);
+
+		/// <summary> チャンク内のエンティティの数 </summary>
+		U32 GetCount()const;
+
+		const Entity* GetEntities()const;
+
+		bool Has(const U32 componentId)const;
+
+		/// <summary>
+		/// 読み取り用にコンポーネントの配列を取得する。持っていない場合はnullptrを返す。
+		/// </summary>
+		const void* Read(const U32 componentId)const;
+
+		/// <summary>
+		/// 書き込み用にコンポーネントの配列を取得する。持っていない場合はnullptrを返す。
+		/// </summary>
+		void* Write(const U32 componentId);
+
+		/// <summary>
+		/// コンポーネントがversionより後に変更されたか
+		/// </summary>
+		bool IsChanged(const U32 componentId, const U32 version)const;
+
+		template<class T>
+		inline bool Has()const { return Has(ComponentType::GetId<T>()); }
+
+		template<class T>
+		inline const T* Read()const { return static_cast<const T*>(Read(ComponentType::GetId<T>())); }
+
+		template<class T>
+		inline T* Write() { return static_cast<T*>(Write(ComponentType::GetId<T>())); }
+
+	private:
+		Archetype* m_archetype;
+		EntityChunk* m_chunk;
+		U32 m_version;
+	};
+
+
+	/// <summary>
+	/// エンティティとコンポーネントを管理するクラス
+	/// </summary>
+	/// <remarks>
+	/// 同じ組み合わせのコンポーネントを持つエンティティ(アーキタイプ)を16KBのチャンクにまとめて格納する。
+	/// エンティティごとのメモリ確保は行わず、破棄したエンティティの位置にはアーキタイプの末尾のエンティティを移動して詰める。
+	/// 検索中にエンティティの生成、破棄、コンポーネントの追加、削除を行うと配列が移動するため、EntityCommandBufferに記録して後で反映すること。
+	/// </remarks>
+	class DLL World
+	{
+	public:
+		World();
+		~World();
+
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		/// <summary>
+		/// エンティティを生成する。コンポーネントは0で初期化される。
+		/// </summary>
+		/// <returns>生成したエンティティ。コンポーネントが1チャンクに収まらない場合は無効なエンティティ</returns>
+		Entity CreateEntity(const ComponentMask& mask = ComponentMask());
+
+		template<class... Ts>
+		Entity CreateEntity(const Ts&... values)
+		{
+			Entity entity = CreateEntity(ComponentType::GetMask<Ts...>());
+			const S32 results[] = { 0, SetComponent(entity, ComponentType::GetId<Ts>(), &values)... };
+			(void)results;
+			return entity;
+		}
+
+		/// <summary>
+		/// エンティティを破棄する
+		/// </summary>
+		/// <returns>　０：成功\n－１：エンティティが無効</returns>
+		S32 DestroyEntity(const Entity entity);
+
+		bool IsAlive(const Entity entity)const;
+
+		/// <summary>
+		/// コンポーネントを追加する。既に持っている場合は値を上書きする。
+		/// </summary>
+		/// <param name="value">初期値(nullptrの場合は、既に持っていても0で初期化する)</param>
+		/// <returns>　０：成功\n－１：エンティティまたはコンポーネントが無効</returns>
+		S32 AddComponent(const Entity entity, const U32 componentId, const void* value);
+
+		/// <summary>
+		/// コンポーネントを削除する
+		/// </summary>
+		/// <returns>　０：成功\n－１：エンティティが無効、またはコンポーネントを持っていない</returns>
+		S32 RemoveComponent(const Entity entity, const U32 componentId);
+
+		/// <summary>
+		/// コンポーネントの値を設定する
+		/// </summary>
+		/// <returns>　０：成功\n－１：エンティティが無効、またはコンポーネントを持っていない</returns>
+		S32 SetComponent(const Entity entity, const U32 componentId, const void* value);
+
+		bool HasComponent(const Entity entity, const U32 componentId)const;
+
+		/// <summary>
+		/// コンポーネントを取得する。持っていない場合はnullptrを返す。
+		/// </summary>
+		const void* GetComponent(const Entity entity, const U32 componentId)const;
+
+		template<class T>
+		inline S32 AddComponent(const Entity entity, const T& value = T()) { return AddComponent(entity, ComponentType::GetId<T>(), &value); }
+
+		template<class T>
+		inline S32 RemoveComponent(const Entity entity) { return RemoveComponent(entity, ComponentType::GetId<T>()); }
+
+		template<class T>
+		inline S32 SetComponent(const Entity entity, const T& value) { return SetComponent(entity, ComponentType::GetId<T>(), &value); }
+
+		template<class T>
+		inline bool HasComponent(const Entity entity)const { return HasComponent(entity, ComponentType::GetId<T>()); }
+
+		template<class T>
+		inline const T* GetComponent(const Entity entity)const { return static_cast<const T*>(GetComponent(entity, ComponentType::GetId<T>())); }
+
+		/// <summary>
+		/// 条件に合うチャンクを順に処理する
+		/// </summary>
+		void ForEach(const EntityQuery& query, const std::function<void(ChunkView& chunk)>& function);
+
+		/// <summary>
+		/// 条件に合うチャンクをParallel::Forで並列に処理する
+		/// </summary>
+		/// <remarks>
+		/// functionは異なるスレッドから同時に呼ばれる。同じチャンクが同時に渡されることは無い。
+		/// </remarks>
+		void ParallelForEach(const EntityQuery& query, const std::function<void(ChunkView& chunk)>& function);
+
+		/// <summary>
+		/// 条件に合うエンティティの数
+		/// </summary>
+		U32 Count(const EntityQuery& query)const;
+
+		inline U32 GetEntityCount()const { return m_entityCount; }
+
+		/// <summary>
+		/// 変更のバージョン
+		/// </summary>
+		/// <remarks>
+		/// ForEachごとに1つ進む。処理の最後に取得した値をEntityQuery::WithChangedに渡すと、それ以降に変更されたチャンクだけを処理できる。
+		/// </remarks>
+		inline U32 GetVersion()const { return m_version; }
+
+	private:
+		struct EntityRecord
+		{
+			Archetype* archetype = nullptr;
+			U32 chunk = 0;
+			U32 row = 0;
+			U32 generation = 1;
+		};
+
+		ArrayList<EntityRecord> m_records;
+		ArrayList<U32> m_freeRecords;
+		ArrayList<UPtr<Archetype>> m_archetypes;
+		HashMap<ComponentMask, Archetype*> m_archetypeMap;
+		U32 m_entityCount;
+		U32 m_version;
+
+		Archetype* GetArchetype(const ComponentMask& mask);
+		S32 MoveEntity(const Entity entity, Archetype* destination);
+		void RemoveRow(Archetype* archetype, const U32 chunk, const U32 row);
+		void* GetComponentPointer(const Entity entity, const U32 componentId, const bool write);
+		void CollectChunks(const EntityQuery& query, ArrayList<std::pair<Archetype*, EntityChunk*>>& dest)const;
+	};
+
+
+	/// <summary>
+	/// エンティティへの構造的な変更を記録して後でまとめて反映するクラス
+	/// </summary>
+	/// <remarks>
+	/// 記録は内部でロックされるため、ParallelForEachの処理から同時に記録できる。
+	/// CreateEntityで返されるエンティティはPlaybackまで仮のもので、同じバッファへの記録にのみ使用できる。
+	/// </remarks>
+	class DLL EntityCommandBuffer
+	{
+	public:
+		EntityCommandBuffer();
+
+		Entity CreateEntity();
+		void DestroyEntity(const Entity entity);
+		void AddComponent(const Entity entity, const U32 componentId, const void* value);
+		void RemoveComponent(const Entity entity, const U32 componentId);
+		void SetComponent(const Entity entity, const U32 componentId, const void* value);
+
+		template<class T>
+		inline void AddComponent(const Entity entity, const T& value = T()) { AddComponent(entity, ComponentType::GetId<T>(), &value); }
+
+		template<class T>
+		inline void RemoveComponent(const Entity entity) { RemoveComponent(entity, ComponentType::GetId<T>()); }
+
+		template<class T>
+		inline void SetComponent(const Entity entity, const T& value) { SetComponent(entity, ComponentType::GetId<T>(), &value); }
+
+		bool IsEmpty()const;
+
+		void Clear();
+
+		/// <summary>
+		/// 記録した変更を記録した順に反映し、バッファを空にする
+		/// </summary>
+		/// <returns>　０：成功\n－１：反映できなかった変更がある(残りの変更は反映される)</returns>
+		S32 Playback(World& world);
+
+	private:
+		mutable std::mutex m_mutex;
+		ArrayList<Byte> m_commands;
+		U32 m_createdCount;
+
+		void Record(const U8 type, const Entity entity, const U32 componentId, const void* value, const size_t size);
+	};
+}
\ No newline at end of file
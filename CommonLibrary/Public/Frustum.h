@@ -0,0 +1,101 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "Bounds.h"
+#include "Matrix.h"
+#include "Vector3.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 視錐台
+	/// </summary>
+	/// <remarks>
+	/// 6つの平面(左、右、下、上、手前、奥)で表し、法線は内側を向く。
+	/// </remarks>
+	class Frustum
+	{
+	public:
+		enum Plane
+		{
+			LEFT,
+			RIGHT,
+			BOTTOM,
+			TOP,
+			NEAR_PLANE,
+			FAR_PLANE,
+			PLANE_COUNT,
+		};
+
+		/// <summary> 平面の法線(正規化済み) </summary>
+		Vector3 normals[PLANE_COUNT];
+		/// <summary> 平面の原点からの距離。点pは dot(normal, p) + distance が0以上なら内側 </summary>
+		F32 distances[PLANE_COUNT];
+
+		/// <summary>
+		/// ビュー射影行列から生成する
+		/// </summary>
+		/// <remarks>
+		/// 行ベクトル規約で、クリップ空間の深度は0から1とする。
+		/// ワールド行列を掛けた行列を渡すと、オブジェクト空間の視錐台になる。
+		/// </remarks>
+		static inline Frustum FromMatrix(const Matrix& viewProjection)
+		{
+			const auto& m = viewProjection.m;
+			// クリップ座標の各成分は行列の列との内積になる
+			const F32 planes[PLANE_COUNT][4] =
+			{
+				{ m[0][3] + m[0][0], m[1][3] + m[1][0], m[2][3] + m[2][0], m[3][3] + m[3][0] },
+				{ m[0][3] - m[0][0], m[1][3] - m[1][0], m[2][3] - m[2][0], m[3][3] - m[3][0] },
+				{ m[0][3] + m[0][1], m[1][3] + m[1][1], m[2][3] + m[2][1], m[3][3] + m[3][1] },
+				{ m[0][3] - m[0][1], m[1][3] - m[1][1], m[2][3] - m[2][1], m[3][3] - m[3][1] },
+				{ m[0][2], m[1][2], m[2][2], m[3][2] },
+				{ m[0][3] - m[0][2], m[1][3] - m[1][2], m[2][3] - m[2][2], m[3][3] - m[3][2] },
+			};
+
+			Frustum frustum;
+			for (U32 i = 0; i < PLANE_COUNT; i++)
+			{
+				const Vector3 normal(planes[i][0], planes[i][1], planes[i][2]);
+				const F32 length = normal.Length();
+				const F32 scale = 0.0f < length ? 1.0f / length : 0.0f;
+				frustum.normals[i] = normal * scale;
+				frustum.distances[i] = planes[i][3] * scale;
+			}
+			return frustum;
+		}
+
+		/// <summary>
+		/// 球と交差しているか(完全に内側にある場合を含む)
+		/// </summary>
+		inline bool Intersects(const Vector3& center, const F32 radius)const
+		{
+			for (U32 i = 0; i < PLANE_COUNT; i++)
+			{
+				if (Vector3::Dot(normals[i], center) + distances[i] < -radius)return false;
+			}
+			return true;
+		}
+
+		/// <summary>
+		/// 境界ボックスと交差しているか(完全に内側にある場合を含む)
+		/// </summary>
+		/// <remarks>
+		/// 平面ごとに判定するため、視錐台の角の外側にある大きな境界ボックスは交差していると判定されることがある。
+		/// </remarks>
+		inline bool Intersects(const Bounds& bounds)const
+		{
+			for (U32 i = 0; i < PLANE_COUNT; i++)
+			{
+				// 法線の方向に最も進んだ頂点
+				const Vector3& n = normals[i];
+				const Vector3 p(
+					0.0f <= n.x ? bounds.max.x : bounds.min.x,
+					0.0f <= n.y ? bounds.max.y : bounds.min.y,
+					0.0f <= n.z ? bounds.max.z : bounds.min.z);
+				if (Vector3::Dot(n, p) + distances[i] < 0.0f)return false;
+			}
+			return true;
+		}
+	};
+}
\ No newline at end of file
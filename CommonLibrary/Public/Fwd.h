@@ -1,13 +1,32 @@
 ﻿#pragma once
 
+// プラットフォームの判定
+#if defined(_WIN32)
+#define PLATFORM_WINDOWS
+#else
+#define PLATFORM_POSIX
+#endif
+
+// DLLエクスポートマクロ
+#if defined(PLATFORM_WINDOWS)
 #ifdef COMMONLIBRARY_EXPORTS
 #define DLL __declspec(dllexport)
 #else
 #define DLL __declspec(dllimport)
 #endif
+#else
+#define DLL __attribute__((visibility("default")))
+#endif
 
-#ifdef _WIN64
+// 環境に依存しない数学関数を使用する場合はプロジェクト設定で定義する(DeterministicMath.hを参照)
+// #define USE_DETERMINISTIC_MATH
 
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#include <cfloat>
+#include <limits>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -57,6 +76,4 @@ using SPtr = std::shared_ptr<T>;
 template<class T>
 using UPtr = std::unique_ptr<T>;
 template<class T>
-using WPtr = std::weak_ptr<T>;
-
-#endif
\ No newline at end of file
+using WPtr = std::weak_ptr<T>;
\ No newline at end of file
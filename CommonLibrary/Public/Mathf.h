@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "Fwd.h"
+#include "DeterministicMath.h"
 
 namespace CommonLibrary
 {
@@ -13,33 +14,52 @@ namespace CommonLibrary
 		static const F32 NAPIER;
 
 	public:
-		static inline F32 Abs(const F32 f) { return abs(f); }
-		static inline F32 Acos(const F32 f) { return acos(f); }
+		static inline F32 Abs(const F32 f) { return std::abs(f); }
 		static inline bool Approximately(const F32 a, const F32 b) { return Abs(a - b) < EPSILON; }
-		static inline F32 Asin(const F32 f) { return asin(f); }
-		static inline F32 Atan(const F32 f) { return atan(f); }
-		static inline F32 Atan2(const F32 y, const F32 x) { return atan2(y, x); }
 		static inline F32 Ceil(const F32 f) { return ceil(f); }
 		static inline F32 Clamp(const F32 f, const F32 min, const F32 max) { return Mathf::Max(Mathf::Min(f, max), min); }
 		static inline F32 Clamp01(const F32 f) { return Mathf::Max(Mathf::Min(f, 1), 0); }
+		static inline F32 BetweenAngle(const F32 to, const F32 from) { return std::abs(fmod(from - to, TWO_PI)); }
+		static inline F32 Floor(const F32 f) { return floor(f); }
+		static inline F32 InverseLerp(const F32 a, const F32 b, const F32 f) { return (b - a) / (f - a); }
+		static inline F32 Max(const F32 a, const F32 b) { return a < b ? b : a; }
+		static inline F32 Min(const F32 a, const F32 b) { return a < b ? a : b; }
+		static inline F32 Round(const F32 f) { return round(f); }
+		static inline F32 Sign(const F32 f) { if (f == 0.0f)return 0; return f / std::abs(f); }
+
+#if defined(USE_DETERMINISTIC_MATH)
+		static inline F32 Acos(const F32 f) { return DeterministicMath::Acos(f); }
+		static inline F32 Asin(const F32 f) { return DeterministicMath::Asin(f); }
+		static inline F32 Atan(const F32 f) { return DeterministicMath::Atan(f); }
+		static inline F32 Atan2(const F32 y, const F32 x) { return DeterministicMath::Atan2(y, x); }
+		static inline F32 Cos(const F32 f) { return DeterministicMath::Cos(f); }
+		static inline F32 Exp(const F32 f) { return DeterministicMath::Exp(f); }
+		static inline F32 Lerp(const F32 a, const F32 b, const F32 t) { return DeterministicMath::Lerp(a, b, t); }
+		static inline F32 LerpAngle(const F32 a, const F32 b, const F32 t) { return DeterministicMath::LerpAngle(a, b, t); }
+		static inline F32 Log(const F32 f) { return DeterministicMath::Log(f); }
+		static inline F32 Log10(const F32 f) { return DeterministicMath::Log10(f); }
+		static inline F32 PingPong(const F32 f) { return DeterministicMath::PingPong(f); }
+		static inline F32 Pow(const F32 f, const F32 p) { return DeterministicMath::Pow(f, p); }
+		static inline F32 Sin(const F32 f) { return DeterministicMath::Sin(f); }
+		static inline F32 Sqrt(const F32 f) { return DeterministicMath::Sqrt(f); }
+		static inline F32 Tan(const F32 f) { return DeterministicMath::Tan(f); }
+#else
+		static inline F32 Acos(const F32 f) { return acos(f); }
+		static inline F32 Asin(const F32 f) { return asin(f); }
+		static inline F32 Atan(const F32 f) { return atan(f); }
+		static inline F32 Atan2(const F32 y, const F32 x) { return atan2(y, x); }
 		static inline F32 Cos(const F32 f) { return cos(f); }
-		static inline F32 BetweenAngle(const F32 to, const F32 from) { return abs(fmod(from - to, TWO_PI)); }
 		static inline F32 Exp(const F32 f) { return exp(f); }
-		static inline F32 Floor(const F32 f) { return floor(f); }
 		static inline F32 Lerp(const F32 a, const F32 b, const F32 t) { return a * (1 - t) + b * t; }
 		static inline F32 LerpAngle(const F32 a, const F32 b, const F32 t) { return fmod(a + fmod(b - a, TWO_PI) * t, TWO_PI); }
-		static inline F32 InverseLerp(const F32 a, const F32 b, const F32 f) { return (b - a) / (f - a); }
 		static inline F32 Log(const F32 f) { return log(f); }
 		static inline F32 Log10(const F32 f) { return log10(f); }
-		static inline F32 Max(const F32 a, const F32 b) { return a < b ? b : a; }
-		static inline F32 Min(const F32 a, const F32 b) { return a < b ? a : b; }
-		static inline F32 PingPong(const F32 f) { return abs(f * 0.5f - ceil(f * 0.5f) - 0.5f); }
+		static inline F32 PingPong(const F32 f) { return std::abs(f * 0.5f - ceil(f * 0.5f) - 0.5f); }
 		static inline F32 Pow(const F32 f, const F32 p) { return pow(f, p); }
-		static inline F32 Round(const F32 f) { return round(f); }
-		static inline F32 Sign(const F32 f) { if (f == 0.0f)return 0; return f / abs(f); }
 		static inline F32 Sin(const F32 f) { return sin(f); }
 		static inline F32 Sqrt(const F32 f) { return sqrt(f); }
 		static inline F32 Tan(const F32 f) { return tan(f); }
+#endif
 
 		static inline F32 Degrees(const F32 f) { return f * 180.0f / PI; }
 		static inline F32 Radians(const F32 f) { return f * PI / 180.0f; }
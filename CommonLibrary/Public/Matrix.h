@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "Fwd.h"
+#include "Platform.h"
 
 namespace CommonLibrary
 {
@@ -57,6 +58,9 @@ namespace CommonLibrary
 
 
 		F32 Determinant();
+		/// <summary>
+		/// 逆行列を求める。逆行列が存在しない場合は単位行列を返す。
+		/// </summary>
 		Matrix Inverted();
 		Matrix Transpose();
 
@@ -72,7 +76,7 @@ namespace CommonLibrary
 
 		inline Matrix& operator = (const Matrix& other)
 		{
-			memcpy_s(m, sizeof(m), other.m, sizeof(m));
+			Platform::MemoryCopy(m, sizeof(m), other.m, sizeof(m));
 
 			return *this;
 		}
@@ -0,0 +1,172 @@
+﻿#pragma once
+
+#include "Fwd.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 頂点キャッシュの効率
+	/// </summary>
+	struct VertexCacheStatistics
+	{
+		/// <summary> 頂点シェーダーの実行回数(キャッシュミスの回数) </summary>
+		U32 transformedVertexCount = 0;
+		/// <summary> 三角形あたりの頂点シェーダーの実行回数(ACMR)。0.5〜3.0で小さいほど良い </summary>
+		F32 acmr = 0;
+		/// <summary> 使用されている頂点あたりの頂点シェーダーの実行回数(ATVR)。1.0が最良 </summary>
+		F32 atvr = 0;
+	};
+
+
+	/// <summary>
+	/// メッシュの最適化の設定
+	/// </summary>
+	struct MeshOptimizeSettings
+	{
+		/// <summary> 頂点データ内の位置(F32x3)のバイトオフセット。オーバードローの最適化に使う </summary>
+		U32 positionOffset = 0;
+		/// <summary> オーバードローを減らすように三角形の塊を並べ替えるか </summary>
+		bool optimizeOverdraw = true;
+		/// <summary> オーバードローの最適化で許容するACMRの悪化の割合(1.05で5%まで) </summary>
+		F32 overdrawThreshold = 1.05f;
+		/// <summary> 頂点を参照順に並べ替え、使われていない頂点を取り除くか </summary>
+		bool optimizeVertexFetch = true;
+		/// <summary> 統計の計算に使うFIFOキャッシュの大きさ </summary>
+		U32 statisticsCacheSize = 16;
+	};
+
+
+	/// <summary>
+	/// メッシュの最適化の結果
+	/// </summary>
+	struct MeshOptimizeReport
+	{
+		VertexCacheStatistics before;
+		VertexCacheStatistics after;
+		/// <summary> 最適化前の頂点数 </summary>
+		U32 vertexCountBefore = 0;
+		/// <summary> 最適化後の頂点数 </summary>
+		U32 vertexCountAfter = 0;
+	};
+
+
+	/// <summary>
+	/// 頂点の統合の設定
+	/// </summary>
+	/// <remarks>
+	/// 頂点はバイト列として比較する。[quantizeOffset, quantizeOffset + quantizeCount * 4) の範囲はF32として
+	/// epsilon単位に丸めてから比較するため、誤差程度の違いしかない頂点も統合される。
+	/// 丸めの境界をまたぐ値は、差がepsilon未満でも統合されないことがある。
+	/// </remarks>
+	struct VertexWeldSettings
+	{
+		/// <summary> 丸めの単位。0の場合は全てのバイトが一致する頂点のみ統合する </summary>
+		F32 epsilon = 0;
+		/// <summary> 丸めて比較するF32の先頭のバイトオフセット </summary>
+		U32 quantizeOffset = 0;
+		/// <summary> 丸めて比較するF32の要素数 </summary>
+		U32 quantizeCount = 0;
+	};
+
+
+	/// <summary>
+	/// メッシュのインデックスと頂点の並べ替え
+	/// </summary>
+	/// <remarks>
+	/// IShapeのデータに使う場合は、IShape::Optimizeで設定済みの頂点とインデックスをその場で最適化できる。
+	/// インポート時に一度だけ行うことを想定しているが、処理は三角形数に対して線形なので数百万三角形でも実行時に行える。
+	/// 個別の関数を使う場合は、OptimizeVertexCache、OptimizeOverdraw、OptimizeVertexFetchの順に行う。
+	/// インポートしたデータに重複した頂点がある場合は、最初にWeldVerticesで統合しておく。
+	/// </remarks>
+	class DLL MeshOptimizer
+	{
+	public:
+		/// <summary>
+		/// 頂点キャッシュのヒット率が高くなるように三角形を並べ替える
+		/// </summary>
+		/// <remarks>
+		/// Tom Forsythの手法(Linear-Speed Vertex Cache Optimisation)で、キャッシュの大きさに依存せず効果がある。
+		/// destinationとindicesは同じでもよい。
+		/// </remarks>
+		/// <param name="destination">出力先(indexCount個)</param>
+		/// <param name="indices">インデックス</param>
+		/// <param name="indexCount">インデックス数(3の倍数)</param>
+		/// <param name="vertexCount">頂点数</param>
+		/// <returns>　０：成功\n－１：引数が不正、またはインデックスが範囲外</returns>
+		static S32 OptimizeVertexCache(U32* destination, const U32* indices, const U32 indexCount, const U32 vertexCount);
+
+		/// <summary>
+		/// 奥の三角形が先に描画されにくくなるように三角形の塊を並べ替える
+		/// </summary>
+		/// <remarks>
+		/// OptimizeVertexCacheの結果をキャッシュがリセットされる位置で塊に分け、
+		/// 塊の中心がメッシュの中心から外側を向いている塊ほど先に描画する(Sander et al. 2007)。
+		/// ACMRの悪化がthresholdの範囲に収まるように塊を細かく分ける。面の向きは (v1 - v0)×(v2 - v0) を表とする。
+		/// destinationとindicesは同じでもよい。
+		/// </remarks>
+		/// <param name="destination">出力先(indexCount個)</param>
+		/// <param name="indices">OptimizeVertexCacheで並べ替えたインデックス</param>
+		/// <param name="indexCount">インデックス数(3の倍数)</param>
+		/// <param name="vertices">頂点データ</param>
+		/// <param name="vertexCount">頂点数</param>
+		/// <param name="stride">1頂点のバイトサイズ</param>
+		/// <param name="positionOffset">頂点内の位置(F32x3)のバイトオフセット</param>
+		/// <param name="threshold">許容するACMRの悪化の割合</param>
+		/// <returns>　０：成功\n－１：引数が不正、またはインデックスが範囲外</returns>
+		static S32 OptimizeOverdraw(U32* destination, const U32* indices, const U32 indexCount, const Byte* vertices, const U32 vertexCount, const U32 stride, const U32 positionOffset, const F32 threshold);
+
+		/// <summary>
+		/// インデックスで最初に参照される順に頂点を並べ替える。使われていない頂点は取り除かれる。
+		/// </summary>
+		/// <param name="destination">頂点の出力先(vertexCount×strideバイト)。verticesと同じであってはならない</param>
+		/// <param name="indices">インデックス。並べ替えた頂点の番号に書き換えられる</param>
+		/// <param name="indexCount">インデックス数</param>
+		/// <param name="vertices">頂点データ</param>
+		/// <param name="vertexCount">頂点数</param>
+		/// <param name="stride">1頂点のバイトサイズ</param>
+		/// <returns>並べ替え後の頂点数。引数が不正、またはインデックスが範囲外の場合は－１</returns>
+		static S32 OptimizeVertexFetch(Byte* destination, U32* indices, const U32 indexCount, const Byte* vertices, const U32 vertexCount, const U32 stride);
+
+		/// <summary>
+		/// 同じ頂点を同じ番号に対応させる表を作る
+		/// </summary>
+		/// <remarks>
+		/// 頂点のハッシュ値の計算と、ハッシュ値で分けた区画ごとの重複の検出を並列に行う。
+		/// 統合後の頂点は元の頂点の順序で最初に現れたものを残し、その順に番号を振る。
+		/// </remarks>
+		/// <param name="remap">出力先(vertexCount個)。統合後の頂点の番号が書き込まれる</param>
+		/// <param name="vertices">頂点データ</param>
+		/// <param name="vertexCount">頂点数</param>
+		/// <param name="stride">1頂点のバイトサイズ</param>
+		/// <param name="settings">設定</param>
+		/// <returns>統合後の頂点数。引数が不正な場合は－１</returns>
+		static S32 GenerateVertexRemap(U32* remap, const Byte* vertices, const U32 vertexCount, const U32 stride, const VertexWeldSettings& settings = VertexWeldSettings());
+
+		/// <summary>
+		/// 重複した頂点を統合し、頂点データを縮める
+		/// </summary>
+		/// <param name="vertices">頂点データ。統合後の頂点に置き換えられる</param>
+		/// <param name="indices">インデックス。統合後の番号に書き換えられる。空の場合は頂点を3つずつ三角形としたインデックスを生成する</param>
+		/// <param name="stride">1頂点のバイトサイズ</param>
+		/// <param name="settings">設定</param>
+		/// <returns>統合後の頂点数。引数が不正、またはインデックスが範囲外の場合は－１</returns>
+		static S32 WeldVertices(ArrayList<Byte>& vertices, ArrayList<U32>& indices, const U32 stride, const VertexWeldSettings& settings = VertexWeldSettings());
+
+		/// <summary>
+		/// FIFOの頂点キャッシュを模擬して効率を求める
+		/// </summary>
+		/// <param name="cacheSize">キャッシュの大きさ(頂点数)</param>
+		static VertexCacheStatistics AnalyzeVertexCache(const U32* indices, const U32 indexCount, const U32 vertexCount, const U32 cacheSize = 16);
+
+		/// <summary>
+		/// 頂点キャッシュ、オーバードロー、頂点の読み込みの順に最適化する
+		/// </summary>
+		/// <param name="vertices">頂点データ。最適化後の頂点に置き換えられる</param>
+		/// <param name="indices">インデックス。最適化後のインデックスに置き換えられる</param>
+		/// <param name="stride">1頂点のバイトサイズ</param>
+		/// <param name="settings">設定</param>
+		/// <param name="report">結果の出力先(nullptrの場合は出力しない)</param>
+		/// <returns>　０：成功\n－１：引数が不正、またはインデックスが範囲外</returns>
+		static S32 Optimize(ArrayList<Byte>& vertices, ArrayList<U32>& indices, const U32 stride, const MeshOptimizeSettings& settings = MeshOptimizeSettings(), MeshOptimizeReport* report = nullptr);
+	};
+}
\ No newline at end of file
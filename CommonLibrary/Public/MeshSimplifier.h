@@ -0,0 +1,136 @@
+﻿#pragma once
+
+#include "Fwd.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// メッシュの簡略化の設定
+	/// </summary>
+	struct SimplifySettings
+	{
+		/// <summary> 属性の最大数 </summary>
+		static const U32 MAX_ATTRIBUTES = 8;
+
+		/// <summary> 頂点データ内の位置(F32x3)のバイトオフセット </summary>
+		U32 positionOffset = 0;
+		/// <summary> 誤差に含める属性(連続したF32)の先頭のバイトオフセット </summary>
+		U32 attributeOffset = 0;
+		/// <summary> 誤差に含める属性の数(F32の要素数)。0の場合は位置のみで誤差を求める </summary>
+		U32 attributeCount = 0;
+		/// <summary> 属性ごとの誤差の重み。位置の誤差はメッシュの大きさを1とした値なので、それに対する比率で指定する </summary>
+		F32 attributeWeights[MAX_ATTRIBUTES] = { 1, 1, 1, 1, 1, 1, 1, 1 };
+		/// <summary> 穴や縁の頂点を動かさないか </summary>
+		bool lockBorder = false;
+	};
+
+
+	/// <summary>
+	/// LODの1段階
+	/// </summary>
+	struct MeshLod
+	{
+		ArrayList<U32> indices;
+		/// <summary> 元のメッシュからの誤差(オブジェクト空間の距離) </summary>
+		F32 error = 0;
+		/// <summary> LodChainSettings::compactVerticesが有効な場合のみ、このLODで使う頂点だけを並べた頂点データ </summary>
+		ArrayList<Byte> vertices;
+	};
+
+
+	/// <summary>
+	/// LODの生成の設定
+	/// </summary>
+	struct LodChainSettings
+	{
+		SimplifySettings simplify;
+		/// <summary> 1段階ごとの三角形数の比率 </summary>
+		F32 reductionRatio = 0.5f;
+		/// <summary> 元のメッシュを含めたLODの最大数 </summary>
+		U32 maxLodCount = 6;
+		/// <summary> 三角形数がこれを下回るLODは生成しない </summary>
+		U32 minTriangleCount = 32;
+		/// <summary> 許容する誤差の上限(メッシュの大きさに対する比率) </summary>
+		F32 maxRelativeError = 0.1f;
+		/// <summary> LODごとに頂点キャッシュの最適化を行うか </summary>
+		bool optimizeVertexCache = true;
+		/// <summary> LODごとに使う頂点だけの頂点データを作るか。無効な場合は全てのLODが元の頂点データを共有する </summary>
+		bool compactVertices = false;
+	};
+
+
+	/// <summary>
+	/// 二次誤差(Quadric Error Metrics)によるメッシュの簡略化
+	/// </summary>
+	/// <remarks>
+	/// 誤差の小さい辺から順に、辺の一方の頂点をもう一方の頂点に寄せて三角形を減らす(Garland and Heckbert 1997)。
+	/// 頂点は移動せず既存の頂点に統合されるので、結果のインデックスは元の頂点データをそのまま参照できる。
+	/// 属性を指定すると、三角形上の属性の勾配を二次誤差に加え、法線やUVが大きく変わる統合を避ける(Hoppe 1999)。
+	/// 同じ位置に属性の異なる頂点がある継ぎ目と、3つ以上の三角形が共有する辺の頂点は動かさない。
+	/// 縁の頂点は縁に沿ってのみ統合する。
+	/// </remarks>
+	class DLL MeshSimplifier
+	{
+	public:
+		/// <summary>
+		/// インデックスを簡略化する
+		/// </summary>
+		/// <param name="destination">出力先(indexCount個)。indicesと同じでもよい</param>
+		/// <param name="indices">インデックス</param>
+		/// <param name="indexCount">インデックス数(3の倍数)</param>
+		/// <param name="vertices">頂点データ</param>
+		/// <param name="vertexCount">頂点数</param>
+		/// <param name="stride">1頂点のバイトサイズ</param>
+		/// <param name="targetIndexCount">目標のインデックス数</param>
+		/// <param name="targetError">許容する誤差(オブジェクト空間の距離)。誤差がこれを超える統合は行わない</param>
+		/// <param name="settings">設定</param>
+		/// <param name="resultError">結果の誤差(オブジェクト空間の距離)の出力先(nullptrの場合は出力しない)</param>
+		/// <returns>簡略化後のインデックス数。引数が不正、またはインデックスが範囲外の場合は－１</returns>
+		static S32 Simplify(U32* destination, const U32* indices, const U32 indexCount, const Byte* vertices, const U32 vertexCount, const U32 stride, const U32 targetIndexCount, const F32 targetError, const SimplifySettings& settings = SimplifySettings(), F32* resultError = nullptr);
+
+		/// <summary>
+		/// 元のメッシュから順に簡略化したLODを生成する
+		/// </summary>
+		/// <remarks>
+		/// lods[0]は元のメッシュで、以降は直前のLODを簡略化したもの。誤差は段階ごとに累積し、単調に増加する。
+		/// 三角形数が減らなくなるか、誤差が上限に達した時点で終了する。
+		/// </remarks>
+		/// <param name="lods">出力先</param>
+		/// <returns>　０：成功\n－１：引数が不正、またはインデックスが範囲外</returns>
+		static S32 GenerateLods(const Byte* vertices, const U32 vertexCount, const U32 stride, const U32* indices, const U32 indexCount, const LodChainSettings& settings, ArrayList<MeshLod>& lods);
+	};
+
+
+	/// <summary>
+	/// 画面上の誤差によるLODの選択
+	/// </summary>
+	class DLL LodSelector
+	{
+	public:
+		/// <summary>
+		/// 距離1の位置にある長さ1の物体が画面上で何ピクセルになるかを求める
+		/// </summary>
+		/// <param name="screenHeight">画面の高さ(ピクセル)</param>
+		/// <param name="fovY">垂直方向の視野角(ラジアン)</param>
+		static F32 ComputeProjectionScale(const F32 screenHeight, const F32 fovY);
+
+		/// <summary>
+		/// オブジェクト空間の誤差を画面上の誤差(ピクセル)に変換する
+		/// </summary>
+		/// <param name="error">誤差(ワールド空間の距離。拡大されている場合は拡大率を掛けておく)</param>
+		/// <param name="distance">カメラからの距離</param>
+		/// <param name="projectionScale">ComputeProjectionScaleの値</param>
+		static F32 ComputeScreenError(const F32 error, const F32 distance, const F32 projectionScale);
+
+		/// <summary>
+		/// 画面上の誤差が閾値以下になる最も粗いLODを選ぶ
+		/// </summary>
+		/// <param name="lods">GenerateLodsで生成したLOD</param>
+		/// <param name="distance">カメラからの距離</param>
+		/// <param name="projectionScale">ComputeProjectionScaleの値</param>
+		/// <param name="scale">物体の拡大率</param>
+		/// <param name="pixelThreshold">許容する画面上の誤差(ピクセル)</param>
+		/// <returns>LODの番号。lodsが空の場合は0</returns>
+		static U32 Select(const ArrayList<MeshLod>& lods, const F32 distance, const F32 projectionScale, const F32 scale = 1.0f, const F32 pixelThreshold = 1.0f);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "Frustum.h"
+#include "Vector3.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// メッシュレット(頂点と三角形の数を制限した三角形の塊)
+	/// </summary>
+	struct Meshlet
+	{
+		/// <summary> MeshletMesh::GetVerticesでの先頭の位置 </summary>
+		U32 vertexOffset = 0;
+		/// <summary> 先頭の三角形の番号。MeshletMesh::GetTrianglesとGetIndicesでは3倍した位置から始まる </summary>
+		U32 triangleOffset = 0;
+		U32 vertexCount = 0;
+		U32 triangleCount = 0;
+
+		/// <summary> 境界球の中心 </summary>
+		Vector3 center;
+		/// <summary> 境界球の半径 </summary>
+		F32 radius = 0;
+		/// <summary> 法線の円錐の軸 </summary>
+		Vector3 coneAxis;
+		/// <summary> 法線の円錐の開き角の正弦。1の場合は裏面の判定を行わない </summary>
+		F32 coneCutoff = 1;
+	};
+
+
+	/// <summary>
+	/// 描画するインデックスの範囲
+	/// </summary>
+	struct MeshletIndexRange
+	{
+		U32 first = 0;
+		U32 count = 0;
+	};
+
+
+	/// <summary>
+	/// メッシュレットに分割したメッシュ
+	/// </summary>
+	/// <remarks>
+	/// 隣接する三角形を、新しく加わる頂点が少なく中心に近い順に集めて分割する。
+	/// GetIndicesはメッシュレットの順に並べた元の頂点のインデックスで、そのままIShape::Indicesに設定して描画できる。
+	/// Cullで見えるメッシュレットのインデックスの範囲を求め、範囲ごとに描画することで、見えない部分の頂点処理を省ける。
+	/// 面の向きは (v1 - v0)×(v2 - v0) を表とする。
+	/// </remarks>
+	class DLL MeshletMesh
+	{
+	public:
+		/// <summary> メッシュレットの頂点数の既定の上限 </summary>
+		static const U32 MAX_VERTICES = 64;
+		/// <summary> メッシュレットの三角形数の既定の上限 </summary>
+		static const U32 MAX_TRIANGLES = 124;
+
+		MeshletMesh();
+
+		/// <summary>
+		/// メッシュを分割する
+		/// </summary>
+		/// <param name="vertices">頂点データ</param>
+		/// <param name="vertexCount">頂点数</param>
+		/// <param name="stride">1頂点のバイトサイズ</param>
+		/// <param name="positionOffset">頂点内の位置(F32x3)のバイトオフセット</param>
+		/// <param name="indices">インデックス</param>
+		/// <param name="indexCount">インデックス数(3の倍数)</param>
+		/// <param name="maxVertices">メッシュレットの頂点数の上限(3〜256)</param>
+		/// <param name="maxTriangles">メッシュレットの三角形数の上限</param>
+		/// <param name="coneWeight">法線の円錐を狭くすることをどの程度優先するか(0〜1)</param>
+		/// <returns>　０：成功\n－１：引数が不正、またはインデックスが範囲外</returns>
+		S32 Build(const Byte* vertices, const U32 vertexCount, const U32 stride, const U32 positionOffset, const U32* indices, const U32 indexCount,
+			const U32 maxVertices = MAX_VERTICES, const U32 maxTriangles = MAX_TRIANGLES, const F32 coneWeight = 0.25f);
+
+		/// <summary>
+		/// 視錐台の外側にあるメッシュレットと、全ての三角形が裏を向いているメッシュレットを除いたインデックスの範囲を求める
+		/// </summary>
+		/// <remarks>
+		/// 連続するメッシュレットの範囲は1つにまとめる。
+		/// 視錐台とカメラの位置はメッシュと同じ座標系(オブジェクト空間)で指定する。
+		/// </remarks>
+		/// <param name="frustum">視錐台</param>
+		/// <param name="cameraPosition">カメラの位置</param>
+		/// <param name="ranges">GetIndicesでの描画する範囲の出力先</param>
+		/// <returns>見えるメッシュレットの数</returns>
+		U32 Cull(const Frustum& frustum, const Vector3& cameraPosition, ArrayList<MeshletIndexRange>& ranges)const;
+
+		inline const ArrayList<Meshlet>& GetMeshlets()const { return m_meshlets; }
+
+		/// <summary> メッシュレットの頂点から元の頂点の番号への対応 </summary>
+		inline const ArrayList<U32>& GetVertices()const { return m_vertices; }
+
+		/// <summary> メッシュレットの頂点の番号による三角形(3つ組) </summary>
+		inline const ArrayList<U8>& GetTriangles()const { return m_triangles; }
+
+		/// <summary> 元の頂点の番号による三角形(3つ組)。メッシュレットの順に並ぶ </summary>
+		inline const ArrayList<U32>& GetIndices()const { return m_indices; }
+
+	private:
+		ArrayList<Meshlet> m_meshlets;
+		ArrayList<U32> m_vertices;
+		ArrayList<U8> m_triangles;
+		ArrayList<U32> m_indices;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include "Fwd.h"
+
+#include <functional>
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 処理を複数のスレッドに分割して実行するクラス
+	/// </summary>
+	/// <remarks>
+	/// ワーカースレッドは最初にForが呼ばれたときに(論理プロセッサ数 - 1)個生成され、以降は使い回される。
+	/// 呼び出し元のスレッドも処理に参加する。Forの処理の中から呼ばれた場合は呼び出し元のスレッドで順に実行する。
+	/// </remarks>
+	class DLL Parallel
+	{
+	public:
+		/// <summary>
+		/// [0, count)の範囲を分割して並列に処理する
+		/// </summary>
+		/// <remarks>
+		/// 全ての処理が終わるまで戻らない。functionは異なるスレッドから同時に呼ばれる。
+		/// </remarks>
+		/// <param name="count">要素数</param>
+		/// <param name="grainSize">1回の呼び出しで処理する要素数の目安</param>
+		/// <param name="function">[begin, end)の要素を処理する関数</param>
+		static void For(const size_t count, const size_t grainSize, const std::function<void(size_t begin, size_t end)>& function);
+
+		/// <summary>
+		/// ワーカースレッドの数を取得する
+		/// </summary>
+		static U32 GetWorkerCount();
+
+		/// <summary>
+		/// ワーカースレッドを終了する
+		/// </summary>
+		/// <remarks>
+		/// DLLのアンロード中にスレッドの終了を待つことはできないため、終了処理の前に明示的に呼ぶこと。
+		/// </remarks>
+		static void Shutdown();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,270 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "Affine.h"
+#include "Bounds.h"
+#include "Broadphase.h"
+#include "Quaternion.h"
+#include "Vector3.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 剛体の形状の種類
+	/// </summary>
+	enum class CollisionShapeType : U8
+	{
+		Sphere,
+		Box,
+		Capsule,
+	};
+
+
+	/// <summary>
+	/// 剛体の形状
+	/// </summary>
+	struct CollisionShape
+	{
+		CollisionShapeType type = CollisionShapeType::Sphere;
+		/// <summary> 球とカプセルの半径 </summary>
+		F32 radius = 0.5f;
+		/// <summary> 箱の各軸の半分の大きさ </summary>
+		Vector3 halfExtents;
+		/// <summary> カプセルの線分の半分の長さ(ローカルのY軸方向) </summary>
+		F32 halfHeight = 0.0f;
+
+		static inline CollisionShape CreateSphere(const F32 radius)
+		{
+			CollisionShape shape;
+			shape.type = CollisionShapeType::Sphere;
+			shape.radius = radius;
+			return shape;
+		}
+
+		static inline CollisionShape CreateBox(const Vector3& halfExtents)
+		{
+			CollisionShape shape;
+			shape.type = CollisionShapeType::Box;
+			shape.halfExtents = halfExtents;
+			return shape;
+		}
+
+		static inline CollisionShape CreateCapsule(const F32 radius, const F32 halfHeight)
+		{
+			CollisionShape shape;
+			shape.type = CollisionShapeType::Capsule;
+			shape.radius = radius;
+			shape.halfHeight = halfHeight;
+			return shape;
+		}
+	};
+
+
+	/// <summary>
+	/// 剛体の生成パラメータ
+	/// </summary>
+	struct BodyDesc
+	{
+		CollisionShape shape;
+		Vector3 position;
+		Quaternion rotation = Quaternion(0, 0, 0, 1);
+		Vector3 linearVelocity;
+		Vector3 angularVelocity;
+		/// <summary> 質量。0の場合は動かない物体になる </summary>
+		F32 mass = 1.0f;
+		F32 friction = 0.5f;
+		F32 restitution = 0.0f;
+	};
+
+
+	/// <summary>
+	/// 物理シミュレーションの設定
+	/// </summary>
+	struct PhysicsSettings
+	{
+		Vector3 gravity = Vector3(0, -9.81f, 0);
+		/// <summary> 速度の反復回数。10段の箱の山が傾かずに静止するには20回程度必要 </summary>
+		U32 velocityIterations = 20;
+		/// <summary> Simulateで使う固定の時間刻み </summary>
+		F32 fixedTimeStep = 1.0f / 60.0f;
+		/// <summary> Simulateの1回の呼び出しで進める最大ステップ数(超えた分の時間は捨てる) </summary>
+		U32 maxSubSteps = 4;
+		/// <summary> めり込みを速度で補正する割合 </summary>
+		F32 baumgarte = 0.2f;
+		/// <summary> 補正せずに許容するめり込み </summary>
+		F32 linearSlop = 0.005f;
+		/// <summary> 境界ボックスを広げる量。接触の直前から接触点を生成する </summary>
+		F32 contactMargin = 0.02f;
+		F32 linearDamping = 0.0f;
+		F32 angularDamping = 0.05f;
+	};
+
+
+	/// <summary>
+	/// 剛体の物理シミュレーション
+	/// </summary>
+	/// <remarks>
+	/// 剛体の状態は種類別の配列(SoA)で保持し、番号で参照する。
+	/// 1ステップの処理は次の通り。
+	///   1. 重力を速度に加え、Broadphaseで重なっている組を求める
+	///   2. 組ごとに並列で接触点を求め、前回のステップの接触点と位置で対応させて力積を引き継ぐ(ウォームスタート)
+	///   3. 動く物体同士の接触でつながった物体をアイランドにまとめ、アイランドごとに並列で逐次インパルス法で解く
+	///   4. 速度から位置と回転を進める
+	/// 動かない物体はアイランドをつながないため、床に置かれた物体の山は山ごとに別のアイランドになる。
+	/// 処理の順序はスレッド数によらず固定されるため、同じ入力からは常に同じ結果になる。
+	/// 異なる環境で結果を一致させる場合はUSE_DETERMINISTIC_MATHを定義し、Simulateで固定の時間刻みで進めること。
+	/// </remarks>
+	class DLL PhysicsWorld
+	{
+	public:
+		/// <summary> 無効な剛体 </summary>
+		static const U32 INVALID_BODY;
+
+		explicit PhysicsWorld(const PhysicsSettings& settings = PhysicsSettings());
+		~PhysicsWorld();
+
+		PhysicsWorld(const PhysicsWorld&) = delete;
+		PhysicsWorld& operator=(const PhysicsWorld&) = delete;
+
+		/// <summary>
+		/// 剛体を生成する
+		/// </summary>
+		/// <returns>剛体の番号。形状が無効な場合はINVALID_BODY</returns>
+		U32 CreateBody(const BodyDesc& desc);
+
+		/// <summary>
+		/// 剛体を破棄する。番号は次のStepの後に再利用される。
+		/// </summary>
+		/// <returns>　０：成功\n－１：番号が無効</returns>
+		S32 DestroyBody(const U32 body);
+
+		bool IsAlive(const U32 body)const;
+
+		/// <summary>
+		/// 時間を進める
+		/// </summary>
+		void Step(const F32 deltaTime);
+
+		/// <summary>
+		/// 経過時間を蓄積し、固定の時間刻みで進める。端数は次の呼び出しに持ち越す。
+		/// </summary>
+		/// <returns>進めたステップ数</returns>
+		U32 Simulate(const F32 elapsedTime);
+
+		/// <summary>
+		/// 剛体の状態から求めたハッシュ値。複数の環境で結果が一致しているかの確認に使う。
+		/// </summary>
+		U64 ComputeStateHash()const;
+
+		S32 SetPosition(const U32 body, const Vector3& position);
+		S32 SetRotation(const U32 body, const Quaternion& rotation);
+		S32 SetLinearVelocity(const U32 body, const Vector3& velocity);
+		S32 SetAngularVelocity(const U32 body, const Vector3& velocity);
+
+		/// <summary>
+		/// 重心に力積を加える
+		/// </summary>
+		/// <returns>　０：成功\n－１：番号が無効</returns>
+		S32 ApplyImpulse(const U32 body, const Vector3& impulse);
+
+		/// <summary>
+		/// 剛体の姿勢を行列で取得する
+		/// </summary>
+		/// <returns>　０：成功\n－１：番号が無効</returns>
+		S32 GetTransform(const U32 body, Affine& dest)const;
+
+		inline const ArrayList<Vector3>& GetPositions()const { return m_positions; }
+		inline const ArrayList<Quaternion>& GetRotations()const { return m_rotations; }
+		inline const ArrayList<Vector3>& GetLinearVelocities()const { return m_linearVelocities; }
+		inline const ArrayList<Vector3>& GetAngularVelocities()const { return m_angularVelocities; }
+
+		/// <summary> 剛体の配列の大きさ(破棄された番号を含む) </summary>
+		inline U32 GetBodyCapacity()const { return (U32)m_positions.size(); }
+		inline U32 GetBodyCount()const { return m_bodyCount; }
+
+		/// <summary> 直前のStepで解いたアイランドの数 </summary>
+		inline U32 GetIslandCount()const { return (U32)m_islandRanges.size(); }
+
+		/// <summary> 直前のStepで生成した接触点の数 </summary>
+		U32 GetContactCount()const;
+
+		inline const PhysicsSettings& GetSettings()const { return m_settings; }
+		inline void SetSettings(const PhysicsSettings& settings) { m_settings = settings; }
+
+	private:
+		struct Manifold;
+		struct SolverBody;
+
+		PhysicsSettings m_settings;
+		F32 m_accumulator;
+
+		// 剛体の状態(SoA)
+		ArrayList<Vector3> m_positions;
+		ArrayList<Quaternion> m_rotations;
+		ArrayList<Vector3> m_linearVelocities;
+		ArrayList<Vector3> m_angularVelocities;
+		ArrayList<F32> m_inverseMasses;
+		// ローカル座標の慣性テンソルの逆数(対角成分)
+		ArrayList<Vector3> m_inverseInertias;
+		ArrayList<F32> m_frictions;
+		ArrayList<F32> m_restitutions;
+		ArrayList<CollisionShape> m_shapes;
+		ArrayList<U32> m_proxies;
+		ArrayList<U8> m_alive;
+		ArrayList<U32> m_freeBodies;
+		ArrayList<U32> m_pendingFree;
+		U32 m_bodyCount;
+
+		Broadphase m_broadphase;
+		// プロキシ番号から剛体の番号への対応
+		ArrayList<U32> m_proxyBodies;
+
+		// 接触(剛体の組の昇順)
+		ArrayList<Manifold> m_manifolds;
+		ArrayList<Manifold> m_previousManifolds;
+
+		// アイランド。m_islandManifoldsの[first, second)の範囲がアイランドの接触
+		ArrayList<U32> m_islandParents;
+		ArrayList<U32> m_islandManifolds;
+		ArrayList<std::pair<U32, U32>> m_islandRanges;
+
+		ArrayList<SolverBody> m_solverBodies;
+
+		void IntegrateVelocities(const F32 deltaTime);
+		void UpdateBroadphase();
+		void FindContacts();
+		void BuildIslands();
+		void SolveIsland(const U32 island, const F32 deltaTime);
+		void IntegratePositions(const F32 deltaTime);
+		U32 FindIslandRoot(U32 body);
+	};
+
+
+	/// <summary>
+	/// 物理シミュレーションの計測用シーン
+	/// </summary>
+	class DLL PhysicsBenchmark
+	{
+	public:
+		/// <summary>
+		/// 床と、格子状に並べた箱の山を生成する
+		/// </summary>
+		/// <param name="columns">1辺に並べる山の数(山の数はcolumns*columns)</param>
+		/// <param name="height">1つの山に積む箱の数</param>
+		/// <returns>生成した箱の数</returns>
+		static U32 CreateBoxStacks(PhysicsWorld& world, const U32 columns, const U32 height);
+
+		/// <summary>
+		/// 固定の時間刻みでステップを進め、1ステップの平均時間を計測する
+		/// </summary>
+		/// <returns>1ステップの平均時間(ミリ秒)</returns>
+		static F64 Run(PhysicsWorld& world, const U32 stepCount);
+
+		/// <summary>
+		/// 固定の時間刻みでステップを進め、動く物体が開始時の位置から重力と垂直な方向に最も離れた距離を求める。
+		/// 積んだ物体が長時間静止し続けるかの確認に使う。高さだけでは傾きや横滑りを検出できないため水平方向を測る。
+		/// </summary>
+		/// <returns>水平方向の最大の移動距離</returns>
+		static F32 MeasureDrift(PhysicsWorld& world, const U32 stepCount);
+	};
+}
\ No newline at end of file
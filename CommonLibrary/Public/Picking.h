@@ -0,0 +1,217 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "Affine.h"
+#include "Bounds.h"
+#include "Matrix.h"
+#include "Vector3.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 半直線
+	/// </summary>
+	struct Ray
+	{
+		Vector3 origin;
+		/// <summary> 方向(正規化されていること) </summary>
+		Vector3 direction;
+
+		Ray() {}
+		Ray(const Vector3& _origin, const Vector3& _direction) :origin(_origin), direction(_direction) {}
+
+		inline Vector3 GetPoint(const F32 distance)const { return origin + direction * distance; }
+	};
+
+
+	/// <summary>
+	/// レイと三角形の交差結果
+	/// </summary>
+	struct RayHit
+	{
+		/// <summary> レイの始点からの距離 </summary>
+		F32 distance = FLT_MAX;
+		/// <summary> 交点(ワールド座標) </summary>
+		Vector3 point;
+		/// <summary> 重心座標。交点は v0 * (1 - u - v) + v1 * u + v2 * v </summary>
+		F32 u = 0.0f;
+		F32 v = 0.0f;
+		/// <summary> メッシュ内の三角形の番号(インデックス配列の3つ組の番号) </summary>
+		U32 triangle = 0;
+		/// <summary> SceneBvhのインスタンスの番号 </summary>
+		U32 instance = 0;
+	};
+
+
+	/// <summary>
+	/// BVHのノード
+	/// </summary>
+	/// <remarks>
+	/// countが0の場合は内部ノードで、firstとfirst+1が子ノードの番号になる。
+	/// それ以外は葉で、firstから始まるcount個の要素を持つ。
+	/// </remarks>
+	struct BvhNode
+	{
+		Vector3 min;
+		U32 first;
+		Vector3 max;
+		U32 count;
+	};
+
+
+	/// <summary>
+	/// メッシュの三角形に対するBVH
+	/// </summary>
+	/// <remarks>
+	/// SAHで分割した木を構築し、葉の三角形は4つずつSoAでまとめてSIMDで判定する。
+	/// IShapeの形状から構築する場合は、IShape::GetVertices、GetStribeSize、GetVertexCount、GetIndices、GetIndexCountの値をBuildに渡す。
+	/// 構築後は頂点を保持しないため、形状を変更した場合は構築し直すこと。
+	/// </remarks>
+	class DLL MeshBvh
+	{
+	public:
+		/// <summary> 葉が持つ三角形の最大数 </summary>
+		static const U32 MAX_LEAF_TRIANGLES = 8;
+
+		MeshBvh();
+
+		/// <summary>
+		/// 木を構築する
+		/// </summary>
+		/// <param name="vertices">頂点データ</param>
+		/// <param name="stride">1頂点のバイトサイズ</param>
+		/// <param name="vertexCount">頂点数</param>
+		/// <param name="indices">インデックス(nullptrの場合は頂点を3つずつ三角形とする)</param>
+		/// <param name="indexCount">インデックス数</param>
+		/// <param name="positionOffset">頂点内の位置(F32x3)のバイトオフセット</param>
+		/// <returns>　０：成功\n－１：引数が不正、またはインデックスが範囲外</returns>
+		S32 Build(const Byte* vertices, const U32 stride, const U32 vertexCount, const U32* indices, const U32 indexCount, const U32 positionOffset = 0);
+
+		/// <summary>
+		/// 最も近い交点を求める(裏面も判定する)
+		/// </summary>
+		/// <param name="maxDistance">判定する最大距離</param>
+		/// <param name="hit">交差した場合に結果を書き込む。distance, point, u, v, triangleが設定される</param>
+		/// <returns>交差したか</returns>
+		bool Raycast(const Ray& ray, const F32 maxDistance, RayHit& hit)const;
+
+		inline const Bounds& GetBounds()const { return m_bounds; }
+		inline U32 GetTriangleCount()const { return m_triangleCount; }
+		inline U32 GetNodeCount()const { return (U32)m_nodes.size(); }
+
+		/// <summary> 木が使用するメモリのバイト数 </summary>
+		inline size_t GetMemorySize()const { return m_nodes.size() * sizeof(BvhNode) + m_packets.size() * sizeof(TrianglePacket); }
+
+	private:
+		/// <summary>
+		/// 4つの三角形(SoA)。頂点0と2辺を持ち、余りは辺が0の三角形で埋める
+		/// </summary>
+		struct TrianglePacket
+		{
+			F32 v0[3][4];
+			F32 e1[3][4];
+			F32 e2[3][4];
+			U32 triangles[4];
+		};
+
+		ArrayList<BvhNode> m_nodes;
+		ArrayList<TrianglePacket> m_packets;
+		Bounds m_bounds;
+		U32 m_triangleCount;
+	};
+
+
+	/// <summary>
+	/// シーン内のメッシュのインスタンスに対するBVH
+	/// </summary>
+	/// <remarks>
+	/// インスタンスのワールド座標の境界ボックスで上位の木を構築し、レイをインスタンスのローカル座標に変換してMeshBvhで判定する。
+	/// インスタンスの追加、削除、移動の後はUpdateで上位の木を構築し直すまでRaycastに反映されない。
+	/// </remarks>
+	class DLL SceneBvh
+	{
+	public:
+		/// <summary> 無効なインスタンス </summary>
+		static const U32 INVALID_INSTANCE;
+
+		SceneBvh();
+
+		/// <summary>
+		/// インスタンスを追加する
+		/// </summary>
+		/// <param name="transform">ローカル座標からワールド座標への変換(行ベクトル規約)</param>
+		/// <returns>インスタンスの番号。meshがnullptrの場合はINVALID_INSTANCE</returns>
+		U32 AddInstance(const SPtr<const MeshBvh>& mesh, const Affine& transform);
+
+		/// <summary>
+		/// インスタンスを削除する
+		/// </summary>
+		/// <returns>　０：成功\n－１：番号が無効</returns>
+		S32 RemoveInstance(const U32 instance);
+
+		/// <summary>
+		/// インスタンスの変換を変更する
+		/// </summary>
+		/// <returns>　０：成功\n－１：番号が無効</returns>
+		S32 SetTransform(const U32 instance, const Affine& transform);
+
+		/// <summary>
+		/// 変更があれば上位の木を構築し直す
+		/// </summary>
+		void Update();
+
+		/// <summary>
+		/// 最も近い交点を求める
+		/// </summary>
+		/// <returns>交差したか</returns>
+		bool Raycast(const Ray& ray, RayHit& hit, const F32 maxDistance = FLT_MAX)const;
+
+		inline U32 GetInstanceCount()const { return m_instanceCount; }
+
+	private:
+		struct Instance
+		{
+			SPtr<const MeshBvh> mesh;
+			Affine transform;
+			Affine inverse;
+			Bounds bounds;
+		};
+
+		ArrayList<Instance> m_instances;
+		ArrayList<U32> m_freeInstances;
+		U32 m_instanceCount;
+
+		ArrayList<BvhNode> m_nodes;
+		// 葉から参照するインスタンスの番号
+		ArrayList<U32> m_order;
+		bool m_isDirty;
+	};
+
+
+	/// <summary>
+	/// 画面上の位置からの選択
+	/// </summary>
+	class DLL Picking
+	{
+	public:
+		/// <summary>
+		/// スクリーン座標からレイを生成する
+		/// </summary>
+		/// <remarks>
+		/// ビュー射影行列の逆行列でニアクリップ面とファークリップ面の点をワールド座標に戻し、その2点を結ぶ。
+		/// 行ベクトル規約で、クリップ空間の深度は0から1とする。
+		/// </remarks>
+		/// <param name="x">スクリーン座標(左上が原点)</param>
+		/// <param name="y">スクリーン座標(左上が原点)</param>
+		/// <param name="width">画面の幅</param>
+		/// <param name="height">画面の高さ</param>
+		/// <param name="viewProjection">ワールド座標からクリップ空間への変換</param>
+		static Ray ScreenPointToRay(const F32 x, const F32 y, const F32 width, const F32 height, const Matrix& viewProjection);
+
+		/// <summary>
+		/// スクリーン座標にある最も手前の三角形を求める
+		/// </summary>
+		/// <returns>交差したか</returns>
+		static bool Pick(const SceneBvh& scene, const F32 x, const F32 y, const F32 width, const F32 height, const Matrix& viewProjection, RayHit& hit);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,198 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "CustomString.h"
+#include "Path.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// ディレクトリの列挙で取得されるエントリ情報
+	/// </summary>
+	struct FileEntry
+	{
+		/// <summary> ファイル名またはディレクトリ名 </summary>
+		String name;
+		/// <summary> ディレクトリならtrue </summary>
+		bool isDirectory;
+		/// <summary> ファイルサイズ(バイト) </summary>
+		U64 size;
+		/// <summary> 最終更新時刻(UNIX時間の秒) </summary>
+		S64 lastWriteTime;
+	};
+
+
+	/// <summary>
+	/// OSに依存する処理を共通の関数を通して扱えるようにするためのクラス
+	/// </summary>
+	/// <remarks>
+	/// Windowsの実装はPlatformWindows.cpp、Linux等の実装はPlatformPosix.cppにある。
+	/// </remarks>
+	class DLL Platform
+	{
+	public:
+		//===================================================================================//
+		// メモリ操作
+		//===================================================================================//
+
+		/// <summary>
+		/// 書き込み先のサイズを確認してからメモリをコピーする
+		/// </summary>
+		/// <param name="dest">コピー先</param>
+		/// <param name="destSize">コピー先のバイトサイズ</param>
+		/// <param name="src">コピー元</param>
+		/// <param name="count">コピーするバイト数</param>
+		/// <returns>　０：成功\n－１：引数が不正</returns>
+		static inline S32 MemoryCopy(void* dest, const size_t destSize, const void* src, const size_t count)
+		{
+			if (count == 0)return 0;
+			if (dest == nullptr || src == nullptr || destSize < count)return -1;
+			memcpy(dest, src, count);
+			return 0;
+		}
+
+		/// <summary>
+		/// 書き込み先のサイズを確認してからメモリを移動する。領域が重なっていてもよい。
+		/// </summary>
+		/// <param name="dest">移動先</param>
+		/// <param name="destSize">移動先のバイトサイズ</param>
+		/// <param name="src">移動元</param>
+		/// <param name="count">移動するバイト数</param>
+		/// <returns>　０：成功\n－１：引数が不正</returns>
+		static inline S32 MemoryMove(void* dest, const size_t destSize, const void* src, const size_t count)
+		{
+			if (count == 0)return 0;
+			if (dest == nullptr || src == nullptr || destSize < count)return -1;
+			memmove(dest, src, count);
+			return 0;
+		}
+
+		/// <summary>
+		/// 書式付き文字列を書き込む
+		/// </summary>
+		/// <remarks>
+		/// 書き込み先に収まらない場合は切り詰めた上で終端文字を書き込み、エラーを返す。
+		/// </remarks>
+		/// <param name="dest">書き込み先</param>
+		/// <param name="destSize">書き込み先の要素数</param>
+		/// <param name="format">書式文字列</param>
+		/// <returns>－１以外：書き込んだ文字数\n　　－１：エラー</returns>
+		static S32 FormatString(Char* dest, const size_t destSize, const Char* format, ...);
+
+		//===================================================================================//
+		// ファイルシステム
+		//===================================================================================//
+
+		/// <summary>
+		/// ディレクトリ直下のエントリを列挙する
+		/// </summary>
+		/// <remarks>
+		/// "."と".."は含まれない。列挙の順序はOSに依存する。
+		/// </remarks>
+		/// <param name="path">ディレクトリのパス</param>
+		/// <param name="dest">エントリの出力先</param>
+		/// <returns>　０：成功\n－１：ディレクトリを開けなかった</returns>
+		static S32 EnumerateDirectory(const Path& path, ArrayList<FileEntry>& dest);
+
+		/// <summary>
+		/// ファイルが存在するか
+		/// </summary>
+		static bool FileExists(const Path& path);
+
+		/// <summary>
+		/// ディレクトリが存在するか
+		/// </summary>
+		static bool DirectoryExists(const Path& path);
+
+		/// <summary>
+		/// ディレクトリを作成する。すでに存在する場合は成功とする。
+		/// </summary>
+		/// <returns>　０：成功\n－１：エラー</returns>
+		static S32 MakeDirectory(const Path& path);
+
+		/// <summary>
+		/// ファイルを削除する
+		/// </summary>
+		/// <returns>　０：成功\n－１：エラー</returns>
+		static S32 RemoveFile(const Path& path);
+
+		/// <summary>
+		/// ファイルの名前を変更する。移動先が存在する場合は置き換える。
+		/// </summary>
+		/// <remarks>
+		/// 同じボリューム内であれば置き換えはアトミックに行われる。
+		/// </remarks>
+		/// <returns>　０：成功\n－１：エラー</returns>
+		static S32 RenameFile(const Path& from, const Path& to);
+
+		/// <summary>
+		/// ファイルの最終更新時刻を現在の時刻にする。内容は変更しない。
+		/// </summary>
+		/// <returns>　０：成功\n－１：エラー</returns>
+		static S32 TouchFile(const Path& path);
+
+		//===================================================================================//
+		// 時間
+		//===================================================================================//
+
+		/// <summary>
+		/// 高分解能タイマーのカウンタ値を取得する
+		/// </summary>
+		static U64 GetTimeCounter();
+
+		/// <summary>
+		/// 高分解能タイマーの1秒あたりのカウント数を取得する
+		/// </summary>
+		static U64 GetTimeFrequency();
+
+		/// <summary>
+		/// 高分解能タイマーの値を秒で取得する
+		/// </summary>
+		static F64 GetTime();
+
+		/// <summary>
+		/// 現在のスレッドを指定した時間停止する
+		/// </summary>
+		/// <param name="milliseconds">停止する時間(ミリ秒)</param>
+		static void SleepThread(const U32 milliseconds);
+
+		//===================================================================================//
+		// スレッド
+		//===================================================================================//
+
+		/// <summary>
+		/// 論理プロセッサ数を取得する
+		/// </summary>
+		static U32 GetProcessorCount();
+
+		/// <summary>
+		/// 現在のスレッドのIDを取得する
+		/// </summary>
+		static U64 GetCurrentThreadID();
+
+		//===================================================================================//
+		// 動的ライブラリ
+		//===================================================================================//
+
+		/// <summary>
+		/// 動的ライブラリ(dll/so)を読み込む
+		/// </summary>
+		/// <param name="path">ライブラリのパス</param>
+		/// <returns>ライブラリのハンドル。失敗した場合はnullptr</returns>
+		static void* LoadDynamicLibrary(const Path& path);
+
+		/// <summary>
+		/// 動的ライブラリから関数のアドレスを取得する
+		/// </summary>
+		/// <param name="library">ライブラリのハンドル</param>
+		/// <param name="name">関数名</param>
+		/// <returns>関数のアドレス。見つからない場合はnullptr</returns>
+		static void* GetLibraryFunction(void* library, const String& name);
+
+		/// <summary>
+		/// 動的ライブラリを解放する
+		/// </summary>
+		/// <param name="library">ライブラリのハンドル</param>
+		static void FreeDynamicLibrary(void* library);
+	};
+}
\ No newline at end of file
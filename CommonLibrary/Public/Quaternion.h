@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "Fwd.h"
+#include "Mathf.h"
 
 namespace CommonLibrary
 {
@@ -16,12 +17,12 @@ namespace CommonLibrary
 		Quaternion() :Quaternion(0, 0, 0, 0) {};
 		Quaternion(F32 roll, F32 pitch, F32 yaw)
 		{
-			F32 cx = cos(roll * 0.5f);
-			F32 cy = cos(pitch * 0.5f);
-			F32 cz = cos(yaw * 0.5f);
-			F32 sx = sin(roll * 0.5f);
-			F32 sy = sin(pitch * 0.5f);
-			F32 sz = sin(yaw * 0.5f);
+			F32 cx = Mathf::Cos(roll * 0.5f);
+			F32 cy = Mathf::Cos(pitch * 0.5f);
+			F32 cz = Mathf::Cos(yaw * 0.5f);
+			F32 sx = Mathf::Sin(roll * 0.5f);
+			F32 sy = Mathf::Sin(pitch * 0.5f);
+			F32 sz = Mathf::Sin(yaw * 0.5f);
 			*this = Quaternion(sx, 0, 0, cx) * Quaternion(0, sy, 0, cy) * Quaternion(0, 0, sz, cz);
 		}
 
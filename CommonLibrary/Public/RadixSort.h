@@ -0,0 +1,46 @@
+﻿#pragma once
+#include "Fwd.h"
+
+#include <algorithm>
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// U64のキーで要素を整列する安定な基数ソート
+	/// </summary>
+	/// <remarks>
+	/// 8bitずつ下位の桁から整列し、全ての要素で同じになる桁は飛ばす。
+	/// 要素数がthreshold未満の場合は基数ソートの前準備の方が高くつくため、std::stable_sortで整列する。
+	/// </remarks>
+	/// <param name="items">整列する要素</param>
+	/// <param name="scratch">作業用の配列。呼び出し側で使い回すことで確保を避ける</param>
+	/// <param name="getKey">要素からキーを取り出す関数</param>
+	/// <param name="threshold">基数ソートを使う最小の要素数</param>
+	template<class T, class KeyFunc>
+	void RadixSort(ArrayList<T>& items, ArrayList<T>& scratch, KeyFunc getKey, const size_t threshold)
+	{
+		if (items.size() < threshold || items.size() < 2)
+		{
+			std::stable_sort(items.begin(), items.end(), [&](const T& a, const T& b) { return getKey(a) < getKey(b); });
+			return;
+		}
+
+		scratch.resize(items.size());
+		for (U32 shift = 0; shift < 64; shift += 8)
+		{
+			size_t counts[256] = {};
+			for (const auto& item : items)counts[(getKey(item) >> shift) & 0xFF]++;
+			if (counts[(getKey(items[0]) >> shift) & 0xFF] == items.size())continue;
+
+			size_t offset = 0;
+			for (U32 i = 0; i < 256; i++)
+			{
+				size_t count = counts[i];
+				counts[i] = offset;
+				offset += count;
+			}
+			for (const auto& item : items)scratch[counts[(getKey(item) >> shift) & 0xFF]++] = item;
+			items.swap(scratch);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+﻿#pragma once
+#include "Fwd.h"
+
+// SSE2が使用できる環境ではSSE2で実装し、それ以外ではスカラーで実装する
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && 2 <= _M_IX86_FP)
+#define USE_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// 4つのF32をまとめて演算するためのクラス
+	/// </summary>
+	/// <remarks>
+	/// 曲線やスキニング等、同じ計算を大量の要素に行う処理で使用する。
+	/// </remarks>
+	struct F32x4
+	{
+#if defined(USE_SIMD_SSE2)
+		__m128 v;
+
+		F32x4() :v(_mm_setzero_ps()) {}
+		F32x4(const __m128 _v) :v(_v) {}
+
+		/// <summary> 連続した4要素を読み込む(アラインメントは不要) </summary>
+		static inline F32x4 Load(const F32* p) { return _mm_loadu_ps(p); }
+		/// <summary> 全要素を同じ値にする </summary>
+		static inline F32x4 Set1(const F32 f) { return _mm_set1_ps(f); }
+		/// <summary> 要素を個別に設定する </summary>
+		static inline F32x4 Set(const F32 f0, const F32 f1, const F32 f2, const F32 f3) { return _mm_setr_ps(f0, f1, f2, f3); }
+		/// <summary> 連続した4要素に書き込む(アラインメントは不要) </summary>
+		inline void Store(F32* p) const { _mm_storeu_ps(p, v); }
+
+		inline F32x4 operator + (const F32x4& o) const { return _mm_add_ps(v, o.v); }
+		inline F32x4 operator - (const F32x4& o) const { return _mm_sub_ps(v, o.v); }
+		inline F32x4 operator * (const F32x4& o) const { return _mm_mul_ps(v, o.v); }
+		inline F32x4 operator / (const F32x4& o) const { return _mm_div_ps(v, o.v); }
+
+		static inline F32x4 Min(const F32x4& a, const F32x4& b) { return _mm_min_ps(a.v, b.v); }
+		static inline F32x4 Max(const F32x4& a, const F32x4& b) { return _mm_max_ps(a.v, b.v); }
+		static inline F32x4 Sqrt(const F32x4& a) { return _mm_sqrt_ps(a.v); }
+
+		/// <summary> a < bの要素が真のマスクを返す </summary>
+		static inline F32x4 Less(const F32x4& a, const F32x4& b) { return _mm_cmplt_ps(a.v, b.v); }
+		/// <summary> maskが真の要素はa、偽の要素はbを返す </summary>
+		static inline F32x4 Select(const F32x4& mask, const F32x4& a, const F32x4& b) { return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v)); }
+		/// <summary> マスクの論理和 </summary>
+		static inline F32x4 Or(const F32x4& a, const F32x4& b) { return _mm_or_ps(a.v, b.v); }
+		/// <summary> マスクの真の要素をビットで返す(要素0が1ビット目) </summary>
+		inline S32 MoveMask()const { return _mm_movemask_ps(v); }
+#else
+		F32 v[4];
+
+		F32x4() :v{ 0, 0, 0, 0 } {}
+
+		static inline F32x4 Load(const F32* p) { return Set(p[0], p[1], p[2], p[3]); }
+		static inline F32x4 Set1(const F32 f) { return Set(f, f, f, f); }
+		static inline F32x4 Set(const F32 f0, const F32 f1, const F32 f2, const F32 f3) { F32x4 r; r.v[0] = f0; r.v[1] = f1; r.v[2] = f2; r.v[3] = f3; return r; }
+		inline void Store(F32* p) const { p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; p[3] = v[3]; }
+
+		inline F32x4 operator + (const F32x4& o) const { return Set(v[0] + o.v[0], v[1] + o.v[1], v[2] + o.v[2], v[3] + o.v[3]); }
+		inline F32x4 operator - (const F32x4& o) const { return Set(v[0] - o.v[0], v[1] - o.v[1], v[2] - o.v[2], v[3] - o.v[3]); }
+		inline F32x4 operator * (const F32x4& o) const { return Set(v[0] * o.v[0], v[1] * o.v[1], v[2] * o.v[2], v[3] * o.v[3]); }
+		inline F32x4 operator / (const F32x4& o) const { return Set(v[0] / o.v[0], v[1] / o.v[1], v[2] / o.v[2], v[3] / o.v[3]); }
+
+		static inline F32x4 Min(const F32x4& a, const F32x4& b) { return Set(a.v[0] < b.v[0] ? a.v[0] : b.v[0], a.v[1] < b.v[1] ? a.v[1] : b.v[1], a.v[2] < b.v[2] ? a.v[2] : b.v[2], a.v[3] < b.v[3] ? a.v[3] : b.v[3]); }
+		static inline F32x4 Max(const F32x4& a, const F32x4& b) { return Set(a.v[0] < b.v[0] ? b.v[0] : a.v[0], a.v[1] < b.v[1] ? b.v[1] : a.v[1], a.v[2] < b.v[2] ? b.v[2] : a.v[2], a.v[3] < b.v[3] ? b.v[3] : a.v[3]); }
+		static inline F32x4 Sqrt(const F32x4& a) { return Set(std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3])); }
+
+		// スカラー実装のマスクは真を1、偽を0で表す
+		static inline F32x4 Less(const F32x4& a, const F32x4& b) { return Set(a.v[0] < b.v[0] ? 1.0f : 0.0f, a.v[1] < b.v[1] ? 1.0f : 0.0f, a.v[2] < b.v[2] ? 1.0f : 0.0f, a.v[3] < b.v[3] ? 1.0f : 0.0f); }
+		static inline F32x4 Select(const F32x4& mask, const F32x4& a, const F32x4& b) { return Set(mask.v[0] != 0.0f ? a.v[0] : b.v[0], mask.v[1] != 0.0f ? a.v[1] : b.v[1], mask.v[2] != 0.0f ? a.v[2] : b.v[2], mask.v[3] != 0.0f ? a.v[3] : b.v[3]); }
+		static inline F32x4 Or(const F32x4& a, const F32x4& b) { return Set(a.v[0] != 0.0f || b.v[0] != 0.0f ? 1.0f : 0.0f, a.v[1] != 0.0f || b.v[1] != 0.0f ? 1.0f : 0.0f, a.v[2] != 0.0f || b.v[2] != 0.0f ? 1.0f : 0.0f, a.v[3] != 0.0f || b.v[3] != 0.0f ? 1.0f : 0.0f); }
+		inline S32 MoveMask()const { return (v[0] != 0.0f ? 1 : 0) | (v[1] != 0.0f ? 2 : 0) | (v[2] != 0.0f ? 4 : 0) | (v[3] != 0.0f ? 8 : 0); }
+#endif
+
+		inline F32x4& operator += (const F32x4& o) { *this = *this + o; return *this; }
+		inline F32x4& operator -= (const F32x4& o) { *this = *this - o; return *this; }
+		inline F32x4& operator *= (const F32x4& o) { *this = *this * o; return *this; }
+
+		/// <summary> a * b + c </summary>
+		static inline F32x4 MulAdd(const F32x4& a, const F32x4& b, const F32x4& c) { return a * b + c; }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "Affine.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// スキニングの補間方法
+	/// </summary>
+	enum class SkinningMode
+	{
+		/// <summary> 行列の線形ブレンド </summary>
+		LinearBlend,
+		/// <summary> デュアルクォータニオンのブレンド。関節の体積が潰れにくいが、ボーン行列の拡大は無視される </summary>
+		DualQuaternion,
+	};
+
+
+	/// <summary>
+	/// スキニングの入出力
+	/// </summary>
+	/// <remarks>
+	/// 各配列はストライドを指定できるため、インターリーブされた頂点バッファを直接読み書きできる。
+	/// normalsとskinnedNormalsがnullptrの場合は法線を処理しない。
+	/// </remarks>
+	struct SkinningDesc
+	{
+		/// <summary> 頂点数 </summary>
+		U32 vertexCount = 0;
+
+		/// <summary> バインドポーズの位置(xyz) </summary>
+		const Byte* positions = nullptr;
+		U32 positionStride = sizeof(F32) * 3;
+
+		/// <summary> バインドポーズの法線(xyz) </summary>
+		const Byte* normals = nullptr;
+		U32 normalStride = sizeof(F32) * 3;
+
+		/// <summary> 頂点ごとに4つのボーン番号 </summary>
+		const Byte* boneIndices = nullptr;
+		U32 boneIndexStride = sizeof(U8) * 4;
+
+		/// <summary> 頂点ごとに4つのウェイト(合計が1) </summary>
+		const Byte* boneWeights = nullptr;
+		U32 boneWeightStride = sizeof(F32) * 4;
+
+		/// <summary> 変形後の位置の出力先(xyz) </summary>
+		Byte* skinnedPositions = nullptr;
+		U32 skinnedPositionStride = sizeof(F32) * 3;
+
+		/// <summary> 変形後の法線の出力先(xyz) </summary>
+		Byte* skinnedNormals = nullptr;
+		U32 skinnedNormalStride = sizeof(F32) * 3;
+	};
+
+
+	/// <summary>
+	/// CPUでスキニングを行うクラス
+	/// </summary>
+	/// <remarks>
+	/// ボーン行列はバインドポーズの逆行列を掛けた後の行列(行ベクトル規約)を渡す。
+	/// 頂点はParallel::Forで分割して処理する。
+	/// </remarks>
+	class DLL Skinning
+	{
+	public:
+		/// <summary>
+		/// 頂点を変形する
+		/// </summary>
+		/// <param name="desc">入出力</param>
+		/// <param name="palette">ボーン行列</param>
+		/// <param name="boneCount">ボーン行列の数</param>
+		/// <param name="mode">補間方法</param>
+		/// <returns>　０：成功\n－１：引数が不正</returns>
+		static S32 Skin(const SkinningDesc& desc, const Affine* palette, const U32 boneCount, const SkinningMode mode = SkinningMode::LinearBlend);
+
+		/// <summary>
+		/// 1回の呼び出しで1スレッドが処理する頂点数
+		/// </summary>
+		static const U32 VERTICES_PER_TASK = 1024;
+	};
+
+
+	/// <summary>
+	/// スキニングの計測用データ
+	/// </summary>
+	class DLL SkinningBenchmark
+	{
+	public:
+		/// <summary>
+		/// 円柱状に並べた頂点を連続する4本のボーンで変形し、1回のスキニングの平均時間を計測する
+		/// </summary>
+		/// <remarks>
+		/// 同じ頂点数とボーン数でLinearBlendとDualQuaternionを計測して比べる。
+		/// 最初の1回はワーカースレッドの起動や出力先の確保の影響を受けるため計測に含めない。
+		/// </remarks>
+		/// <param name="vertexCount">頂点数</param>
+		/// <param name="boneCount">ボーン数(ボーン番号がU8のため256以下)</param>
+		/// <param name="mode">補間方法</param>
+		/// <param name="iterationCount">計測する回数</param>
+		/// <returns>1回の平均時間(ミリ秒)。引数が不正な場合は0</returns>
+		static F64 Run(const U32 vertexCount, const U32 boneCount, const SkinningMode mode, const U32 iterationCount);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+﻿#pragma once
+
+#include "Fwd.h"
+
+#include <functional>
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// OSのスレッドを扱うクラス
+	/// </summary>
+	/// <remarks>
+	/// Startで処理を開始し、破棄する前に必ずJoinで終了を待つこと。Joinされずに破棄された場合はデストラクタで終了を待つ。
+	/// </remarks>
+	class DLL Thread
+	{
+		friend struct ThreadLauncher;
+	public:
+		Thread();
+		~Thread();
+
+		/// <summary>
+		/// 新しいスレッドで処理を開始する
+		/// </summary>
+		/// <param name="function">スレッドで実行する処理</param>
+		/// <returns>　０：成功\n－１：すでに実行中、またはスレッドの生成に失敗</returns>
+		S32 Start(const std::function<void()>& function);
+
+		/// <summary>
+		/// スレッドの終了を待つ
+		/// </summary>
+		/// <returns>　０：成功\n－１：スレッドが開始されていない</returns>
+		S32 Join();
+
+		/// <summary>
+		/// スレッドが開始されていて、まだJoinされていないか
+		/// </summary>
+		inline bool IsJoinable()const { return m_handle != nullptr; }
+
+	private:
+		// OSのスレッドハンドル
+		void* m_handle;
+		std::function<void()> m_function;
+
+		Thread(const Thread&) = delete;
+		Thread& operator=(const Thread&) = delete;
+	};
+}
\ No newline at end of file
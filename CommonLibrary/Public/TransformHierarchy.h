@@ -0,0 +1,146 @@
+﻿#pragma once
+
+#include "Fwd.h"
+#include "Affine.h"
+
+namespace CommonLibrary
+{
+	/// <summary>
+	/// TransformHierarchyのノードを指すハンドル
+	/// </summary>
+	/// <remarks>
+	/// 下位24bitがスロット番号、上位8bitが世代で、破棄されたノードのハンドルは無効になる。
+	/// </remarks>
+	using TransformHandle = U32;
+
+
+	/// <summary>
+	/// 親子関係を持つ変換をまとめて管理するクラス
+	/// </summary>
+	/// <remarks>
+	/// ローカル変換とワールド変換を階層の深さ順に並べた配列(SoA)で保持し、ポインタの木をたどらずに更新する。
+	/// Updateでは深さごとに、ローカル変換が変更されたノードと親のワールド変換が更新されたノードだけを再計算する。
+	/// 同じ深さのノードは互いに依存しないため、Parallel::Forで並列に処理する。
+	/// 生成、破棄、親の変更は配列の並べ替えが必要になるため、次のUpdateでまとめて反映される。
+	/// </remarks>
+	class DLL TransformHierarchy
+	{
+	public:
+		/// <summary> 無効なハンドル </summary>
+		static const TransformHandle INVALID_HANDLE;
+
+		/// <summary> 1回の呼び出しで1スレッドが処理するノード数 </summary>
+		static const size_t NODES_PER_TASK = 1024;
+
+		TransformHierarchy();
+
+		/// <summary>
+		/// ノードを生成する。ローカル変換は単位行列になる。
+		/// </summary>
+		/// <param name="parent">親(INVALID_HANDLEの場合はルート)</param>
+		/// <returns>生成したノード。親が無効な場合はINVALID_HANDLE</returns>
+		TransformHandle Create(const TransformHandle parent = INVALID_HANDLE);
+
+		/// <summary>
+		/// ノードを破棄する
+		/// </summary>
+		/// <remarks>
+		/// 子孫のノードも次のUpdateで破棄される。
+		/// </remarks>
+		/// <returns>　０：成功\n－１：ハンドルが無効</returns>
+		S32 Destroy(const TransformHandle handle);
+
+		/// <summary>
+		/// 親を変更する。ワールド変換は次のUpdateで新しい親を基準に再計算される。
+		/// </summary>
+		/// <param name="parent">新しい親(INVALID_HANDLEの場合はルートにする)</param>
+		/// <returns>　０：成功\n－１：ハンドルが無効、または親子関係が循環する</returns>
+		S32 SetParent(const TransformHandle handle, const TransformHandle parent);
+
+		/// <summary>
+		/// 親を取得する。ルートまたはハンドルが無効な場合はINVALID_HANDLEを返す。
+		/// </summary>
+		TransformHandle GetParent(const TransformHandle handle)const;
+
+		/// <summary>
+		/// ハンドルが有効か
+		/// </summary>
+		bool IsValid(const TransformHandle handle)const;
+
+		/// <summary>
+		/// ローカル変換を設定する
+		/// </summary>
+		/// <returns>　０：成功\n－１：ハンドルが無効</returns>
+		S32 SetLocal(const TransformHandle handle, const Affine& local);
+
+		/// <summary>
+		/// ローカル変換を取得する
+		/// </summary>
+		/// <returns>　０：成功\n－１：ハンドルが無効</returns>
+		S32 GetLocal(const TransformHandle handle, Affine& dest)const;
+
+		/// <summary>
+		/// 直前のUpdateで求めたワールド変換を取得する
+		/// </summary>
+		/// <returns>　０：成功\n－１：ハンドルが無効</returns>
+		S32 GetWorld(const TransformHandle handle, Affine& dest)const;
+
+		/// <summary>
+		/// 直前のUpdateでワールド変換が更新されたか
+		/// </summary>
+		bool IsWorldChanged(const TransformHandle handle)const;
+
+		/// <summary>
+		/// ワールド変換を更新する
+		/// </summary>
+		void Update();
+
+		/// <summary>
+		/// 破棄されていないノードの数(Update前に破棄されたノードの子孫を含む)
+		/// </summary>
+		inline U32 GetCount()const { return m_count; }
+
+		/// <summary>
+		/// 深さ順に並んだワールド変換の配列
+		/// </summary>
+		/// <remarks>
+		/// 描画などでまとめて読む場合に使う。添字はGetIndexで求め、Updateの後に変わる場合がある。
+		/// </remarks>
+		inline const ArrayList<Affine>& GetWorldTransforms()const { return m_world; }
+
+		/// <summary>
+		/// ハンドルに対応するGetWorldTransformsの添字を取得する。ハンドルが無効な場合は－１を返す。
+		/// </summary>
+		S32 GetIndex(const TransformHandle handle)const;
+
+	private:
+		// 以下は深さ順に並んだノードごとの配列
+		ArrayList<Affine> m_local;
+		ArrayList<Affine> m_world;
+		// 親の添字(ルートは－１)
+		ArrayList<S32> m_parents;
+		ArrayList<U32> m_depths;
+		// ワールド変換を更新したUpdateの番号
+		ArrayList<U32> m_versions;
+		ArrayList<U8> m_flags;
+		ArrayList<TransformHandle> m_handles;
+
+		// 深さごとの先頭の添字(末尾に総数)
+		ArrayList<U32> m_levels;
+		// 深さごとにローカル変換が変更されたノードがあるか
+		ArrayList<U8> m_levelDirty;
+
+		// スロットごとのノードの添字(空きスロットは－１)と世代
+		ArrayList<S32> m_slots;
+		ArrayList<U8> m_generations;
+		ArrayList<U32> m_freeSlots;
+
+		U32 m_count;
+		U32 m_version;
+		bool m_needsRebuild;
+
+		S32 Find(const TransformHandle handle)const;
+		void MarkDirty(const U32 index);
+		void Rebuild();
+	};
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+﻿#include "pch.h"
+#include "D3DShaderCompiler.h"
+
+#include <d3dcompiler.h>
+#include <winver.h>
+#pragma comment(lib, "d3dcompiler.lib")
+#pragma comment(lib, "version.lib")
+
+#include "DXHelper.h"
+
+namespace og
+{
+	String D3DShaderCompiler::GetVersion()const
+	{
+		const String version = String(TC("d3dcompiler_")) + std::to_string(D3D_COMPILER_VERSION);
+
+		// D3D_COMPILER_VERSIONはビルド時の値のため、実際に読み込まれたDLLのファイルバージョンも加える
+		HMODULE module = GetModuleHandleA(D3DCOMPILER_DLL_A);
+		if (module == nullptr)return version;
+
+		char path[MAX_PATH];
+		const DWORD length = GetModuleFileNameA(module, path, MAX_PATH);
+		if (length == 0 || length == MAX_PATH)return version;
+
+		DWORD handle = 0;
+		const DWORD infoSize = GetFileVersionInfoSizeA(path, &handle);
+		if (infoSize == 0)return version;
+
+		ArrayList<Byte> info(infoSize);
+		VS_FIXEDFILEINFO* fileInfo = nullptr;
+		UINT fileInfoSize = 0;
+		if (!GetFileVersionInfoA(path, 0, infoSize, info.data())
+			|| !VerQueryValueA(info.data(), "\\", (LPVOID*)&fileInfo, &fileInfoSize) || fileInfo == nullptr)return version;
+
+		char fileVersion[64];
+		sprintf_s(fileVersion, "_%u.%u.%u.%u",
+				  HIWORD(fileInfo->dwFileVersionMS), LOWORD(fileInfo->dwFileVersionMS),
+				  HIWORD(fileInfo->dwFileVersionLS), LOWORD(fileInfo->dwFileVersionLS));
+		return version + fileVersion;
+	}
+
+	//===================================================================================//
+
+	S32 D3DShaderCompiler::Compile(const ShaderCompileDesc& desc, ArrayList<Byte>& dest, String& errorDest)
+	{
+		// 末尾はnullptrの組で終端する
+		ArrayList<D3D_SHADER_MACRO> macros;
+		macros.reserve(desc.defines.size() + 1);
+		for (auto& define : desc.defines)
+		{
+			macros.push_back({ define.first.c_str(), define.second.c_str() });
+		}
+		macros.push_back({ nullptr, nullptr });
+
+		ComPtr<ID3DBlob> shaderBlob = nullptr;
+		ComPtr<ID3DBlob> errorBlob = nullptr;
+		auto result = D3DCompile(desc.source.c_str(), desc.source.size(), NULL, macros.data(), NULL,
+								 desc.entryPoint.c_str(), desc.target.c_str(),
+								 desc.flags, 0, shaderBlob.ReleaseAndGetAddressOf(), errorBlob.ReleaseAndGetAddressOf());
+
+		if (FAILED(result))
+		{
+			if (errorBlob)
+			{
+				errorDest.resize(errorBlob->GetBufferSize());
+				std::copy_n((char*)errorBlob->GetBufferPointer(), errorBlob->GetBufferSize(), errorDest.begin());
+			}
+			return -1;
+		}
+
+		const Byte* bytes = (const Byte*)shaderBlob->GetBufferPointer();
+		dest.assign(bytes, bytes + shaderBlob->GetBufferSize());
+		return 0;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+﻿#pragma once
+
+#include "IShaderCompiler.h"
+
+namespace og
+{
+	/// <summary>
+	/// D3DCompileでシェーダをコンパイルする
+	/// </summary>
+	class D3DShaderCompiler :public IShaderCompiler
+	{
+	public:
+		String GetVersion()const override;
+		S32 Compile(const ShaderCompileDesc& desc, ArrayList<Byte>& dest, String& errorDest)override;
+	};
+}
\ No newline at end of file
@@ -17,6 +17,7 @@
 #include "DefaultAsset.h"
 
 #include "Shader.h"
+#include "D3DShaderCompiler.h"
 #include "GraphicPipeline.h"
 #include "RenderTexture.h"
 #include "Material.h"
@@ -26,6 +27,11 @@
 #include<DirectXMath.h>
 namespace
 {
+	/// <summary>
+	/// シェーダキャッシュのディレクトリの容量
+	/// </summary>
+	const U64 SHADER_CACHE_MAX_BYTES = 64ull * 1024 * 1024;
+
 	LRESULT WindowProcedure(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam)
 	{
 		if (msg == WM_DESTROY)
@@ -84,6 +90,12 @@ namespace og
 		{
 			return -1;
 		}
+		// パイプラインキャッシュの作成。PSOライブラリが使えなくてもパイプラインの共有は行う
+		m_pipelineCache = MUPtr<PipelineCache>();
+		m_pipelineCache->Load(Path(TC("PipelineLibrary.bin")));
+		// シェーダキャッシュの作成。ディレクトリを作れない場合は毎回コンパイルする
+		m_shaderCache = MUPtr<ShaderCache>(MSPtr<D3DShaderCompiler>(), Path(TC("ShaderCache")), SHADER_CACHE_MAX_BYTES);
+		m_shaderCompileQueue = MUPtr<ShaderCompileQueue>(m_shaderCache.get());
 
 		ShowWindow(m_hwnd, SW_SHOW);
 
@@ -442,6 +454,14 @@ namespace og
 
 			m_material = CreateMaterial(m_graphicPipeline, -1, -1);
 
+			// 作成前のパイプラインの代わりに使う。テクスチャは白テクスチャのままにする
+			DefaultAsset::Instance()->fallbackPipeline = m_graphicPipeline;
+			DefaultAsset::Instance()->fallbackMaterial = CreateMaterial(m_graphicPipeline, -1, -1);
+			if (DefaultAsset::Instance()->fallbackMaterial == nullptr)
+			{
+				return -1;
+			}
+
 
 			// 描画用シェイプの作成
 			m_shape = CreateShape(sizeof(F32) * 5);
@@ -9,6 +9,9 @@
 
 #include "DefaultAsset.h"
 #include "DXHelper.h"
+#include "PipelineCache.h"
+#include "ShaderCache.h"
+#include "ShaderCompileQueue.h"
 
 
 namespace og
@@ -20,6 +23,10 @@ namespace og
 		~DX12Wrapper()
 		{
 			DefaultAsset::ResetSingleton();
+			// ワーカースレッドがパイプラインを作成し終えてから保存する
+			m_shaderCompileQueue.reset();
+			if (m_pipelineCache)m_pipelineCache->Save();
+			m_pipelineCache.reset();
 			ms_device->Release();
 			ms_device = nullptr;
 
@@ -41,6 +48,7 @@ namespace og
 
 		SPtr<IShader> LoadShader(const String& path, ShaderType type, String& errorDest) override;
 		SPtr<IShader> CreateShader(const String& path, ShaderType type, String& errorDest) override;
+		SPtr<IShader> CreateShaderAsync(const String& src, ShaderType type, String& errorDest) override;
 
 		//===================================================================================//
 
@@ -95,6 +103,13 @@ namespace og
 		UINT64 m_fenceVal = 0;
 
 
+		// パイプラインの共有とPSOライブラリ
+		UPtr<PipelineCache> m_pipelineCache;
+		// コンパイル済みシェーダのディスクキャッシュ
+		UPtr<ShaderCache> m_shaderCache;
+		// 非同期コンパイルのワーカースレッド
+		UPtr<ShaderCompileQueue> m_shaderCompileQueue;
+
 		// 描画用リソース
 		SPtr<IGraphicPipeline> m_graphicPipeline;
 		SPtr<IShape> m_shape;
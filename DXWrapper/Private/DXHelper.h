@@ -31,5 +31,25 @@ namespace
 	}
 
 
+	/// <summary>
+	/// FNV-1aハッシュの初期値
+	/// </summary>
+	const U64 HASH_OFFSET_BASIS = 14695981039346656037ull;
+
+	/// <summary>
+	/// バイト列をFNV-1aでハッシュに加える
+	/// </summary>
+	inline U64 HashBytes(U64 hash, const void* data, const size_t size)
+	{
+		const Byte* bytes = static_cast<const Byte*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+
 
 }
\ No newline at end of file
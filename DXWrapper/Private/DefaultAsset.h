@@ -3,6 +3,8 @@
 #include <d3d12.h>
 #include <wrl.h>
 #include <Texture.h>
+#include "IGraphicPipeline.h"
+#include "IMaterial.h"
 
 #include "DXHelper.h"
 
@@ -13,5 +15,9 @@ namespace og
 		friend class Singleton<DefaultAsset>;
 	public:
 		SPtr<Texture> whiteTex;
+
+		// シェーダーのコンパイルを待っているパイプラインの代わりに描画に使う
+		SPtr<IGraphicPipeline> fallbackPipeline;
+		SPtr<IMaterial> fallbackMaterial;
 	};
 }
\ No newline at end of file
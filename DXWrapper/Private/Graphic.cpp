@@ -8,6 +8,7 @@
 #include "GraphicPipeline.h"
 #include "Material.h"
 #include "Shape.h"
+#include "PipelineCache.h"
 
 
 
@@ -44,7 +45,7 @@ namespace og
 
 	SPtr<IShader> DX12Wrapper::LoadShader(const String& path, ShaderType type, String& errorDest)
 	{
-		auto shader = Shader::LoadFromFile(path, type, errorDest);
+		auto shader = Shader::LoadFromFile(path, type, errorDest, m_shaderCache.get());
 
 		if (shader->IsValid() == false)return nullptr;
 
@@ -53,17 +54,24 @@ namespace og
 
 	SPtr<IShader>  DX12Wrapper::CreateShader(const String& src, ShaderType type, String& errorDest)
 	{
-		auto shader = MSPtr<Shader>(src, type, errorDest);
+		auto shader = MSPtr<Shader>(src, type, errorDest, m_shaderCache.get());
 		if (shader->IsValid() == false)return nullptr;
 		return shader;
 	}
 
-	SPtr<IGraphicPipeline> DX12Wrapper::CreateGraphicPipeline(const GraphicPipelineDesc& desc)
+	SPtr<IShader> DX12Wrapper::CreateShaderAsync(const String& src, ShaderType type, String& errorDest)
 	{
-		auto gpipeline = MSPtr<GraphicPipeline>(desc);
-		if (gpipeline->IsValid() == false)return nullptr;
+		// コンパイルはワーカースレッドで行い、完成はIShader::GetStatusで確認する。エラーログはIShader::GetErrorLogで返す
+		errorDest.clear();
+		auto shader = MSPtr<Shader>();
+		m_shaderCompileQueue->Push(shader, Shader::MakeCompileDesc(src, type));
+		return shader;
+	}
 
-		return gpipeline;
+	SPtr<IGraphicPipeline> DX12Wrapper::CreateGraphicPipeline(const GraphicPipelineDesc& desc)
+	{
+		// 同じ定義のパイプラインは作り直さずに共有する
+		return m_pipelineCache->GetOrCreate(desc);
 	}
 
 
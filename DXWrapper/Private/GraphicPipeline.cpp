@@ -10,6 +10,7 @@
 #include "DX12Wrapper.h"
 #include "Shader.h"
 #include "Material.h"
+#include "PipelineCache.h"
 
 
 #define OUT_OF_RANGE(container,index) (index<0||container.size()<=index)
@@ -18,7 +19,81 @@
 
 namespace og
 {
-	GraphicPipeline::GraphicPipeline(const GraphicPipelineDesc& desc)
+	GraphicPipeline::GraphicPipeline(const GraphicPipelineDesc& desc, PipelineCache* cache)
+		:m_status(ShaderStatus::FAILED), m_cache(nullptr), m_pendingShaderCount(0)
+	{
+		if (Build(desc, cache) == -1)return;
+		m_status.store(ShaderStatus::READY, std::memory_order_release);
+	}
+
+	GraphicPipeline::GraphicPipeline()
+		:m_status(ShaderStatus::COMPILING), m_cache(nullptr), m_pendingShaderCount(0)
+	{
+	}
+
+
+	SPtr<GraphicPipeline> GraphicPipeline::CreateAsync(const GraphicPipelineDesc& desc, PipelineCache* cache)
+	{
+		auto pipeline = MSPtr<GraphicPipeline>();
+		pipeline->m_pendingDesc = desc;
+		pipeline->m_cache = cache;
+
+		const SPtr<IShader>* shaders[] = { &desc.vs, &desc.ps, &desc.gs, &desc.hs, &desc.ds };
+
+		// 登録中に全てのシェーダーが終わっても作成が始まらないように、1つ余分に数えておく
+		S32 count = 1;
+		for (auto shader : shaders)
+		{
+			if (*shader != nullptr)count++;
+		}
+		pipeline->m_pendingShaderCount.store(count);
+
+		// パイプラインは定義を通してシェーダーを参照しているため、コールバックは弱参照で持って循環参照にしない。
+		// 完成前に破棄された場合は作成しない
+		WPtr<GraphicPipeline> weak = pipeline;
+		for (auto shader : shaders)
+		{
+			if (*shader == nullptr)continue;
+			reinterpret_cast<Shader*>(shader->get())->OnFinished([weak]()
+				{
+					if (auto pipeline = weak.lock())OnShaderFinished(pipeline);
+				});
+		}
+		OnShaderFinished(pipeline);
+
+		return pipeline;
+	}
+
+	void GraphicPipeline::OnShaderFinished(const SPtr<GraphicPipeline>& pipeline)
+	{
+		if (--pipeline->m_pendingShaderCount != 0)return;
+
+		// 定義の持つシェーダーの参照は手放す。Buildに成功した場合はメンバが持ち続ける
+		GraphicPipelineDesc desc = pipeline->m_pendingDesc;
+		pipeline->m_pendingDesc = GraphicPipelineDesc();
+
+		if (pipeline->Build(desc, pipeline->m_cache) != 0)
+		{
+			pipeline->m_status.store(ShaderStatus::FAILED, std::memory_order_release);
+			return;
+		}
+
+		// 以降の同じ定義の作成で共有されるように登録する。登録した時点で他のスレッドに返されることがあるため、先に作成済みにする
+		pipeline->m_status.store(ShaderStatus::READY, std::memory_order_release);
+		if (pipeline->m_cache)pipeline->m_cache->Register(desc, pipeline);
+	}
+
+	bool GraphicPipeline::HasCompilingShader(const GraphicPipelineDesc& desc)
+	{
+		for (auto shader : { desc.vs.get(), desc.ps.get(), desc.gs.get(), desc.hs.get(), desc.ds.get() })
+		{
+			if (shader != nullptr && shader->GetStatus() == ShaderStatus::COMPILING)return true;
+		}
+		return false;
+	}
+
+
+	S32 GraphicPipeline::Build(const GraphicPipelineDesc& desc, PipelineCache* cache)
 	{
 		auto vs = reinterpret_cast<Shader*>(desc.vs.get());
 		auto ps = reinterpret_cast<Shader*>(desc.ps.get());
@@ -26,7 +101,11 @@ namespace og
 		auto ds = reinterpret_cast<Shader*>(desc.ds.get());
 		auto hs = reinterpret_cast<Shader*>(desc.hs.get());
 
-		if (CheckArgs(vs != nullptr, ps != nullptr))return;
+		if (CheckArgs(vs != nullptr, ps != nullptr))return -1;
+		for (auto shader : { vs, ps, gs, ds, hs })
+		{
+			if (shader != nullptr && !shader->IsValid())return -1;
+		}
 
 
 		for (U32 i = 0; i < MAX_REGISTER; i++)
@@ -39,12 +118,12 @@ namespace og
 
 
 		// 頂点レイアウトを取得
-		if (ReflectInputLayout(vs->GetShaderBolb()) == -1)return;
-		//if (ReflectOutputLayout(ps->GetShaderBolb()) == -1)return;
+		if (ReflectInputLayout(vs->GetShaderBolb()) == -1)return -1;
+		//if (ReflectOutputLayout(ps->GetShaderBolb()) == -1)return -1;
 
 		// 定数バッファのリフレクション
-		if (desc.vs != nullptr)ReflectShader(vs->GetShaderBolb()); else return;
-		if (desc.ps != nullptr)ReflectShader(ps->GetShaderBolb()); else return;
+		if (desc.vs != nullptr)ReflectShader(vs->GetShaderBolb()); else return -1;
+		if (desc.ps != nullptr)ReflectShader(ps->GetShaderBolb()); else return -1;
 		if (desc.gs != nullptr)ReflectShader(gs->GetShaderBolb());
 		if (desc.ds != nullptr)ReflectShader(ds->GetShaderBolb());
 		if (desc.hs != nullptr)ReflectShader(hs->GetShaderBolb());
@@ -96,23 +175,19 @@ namespace og
 		rootSignatureDesc.Init((UINT)descriptorRanges.size(), rootParams, 1, samplerDescs, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
 
-		// バイナリデータの作成
-		ComPtr<ID3DBlob> rootSigBlob = nullptr;
-		ComPtr<ID3DBlob> errorBlob = nullptr;
-
-		auto result = D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1_0, &rootSigBlob, &errorBlob);
-		if (FAILED(result))
+		// ルートシグネチャの作成。キャッシュがあればレジスタ構成が同じパイプラインと共有する
+		HRESULT result;
+		if (cache)
 		{
-			return;
+			result = cache->CreateRootSignature(m_cBufDataSizes, m_texNums, rootSignatureDesc, m_rootSignature);
+		}
+		else
+		{
+			result = CreateRootSignature(rootSignatureDesc, m_rootSignature);
 		}
-
-		// ルートシグネチャの作成
-		result = DX12Wrapper::ms_device->CreateRootSignature(0,
-			rootSigBlob->GetBufferPointer(), rootSigBlob->GetBufferSize(),
-			IID_PPV_ARGS(m_rootSignature.ReleaseAndGetAddressOf()));
 		if (FAILED(result))
 		{
-			return;
+			return -1;
 		}
 
 
@@ -180,10 +255,17 @@ namespace og
 
 		// グラフィックパイプラインの生成
 		ComPtr<ID3D12PipelineState> pipelineState;
-		result = DX12Wrapper::ms_device->CreateGraphicsPipelineState(&pipelineStateDesc, IID_PPV_ARGS(pipelineState.ReleaseAndGetAddressOf()));
+		if (cache)
+		{
+			result = cache->CreatePipelineState(PipelineCache::ComputeHash(desc), pipelineStateDesc, pipelineState);
+		}
+		else
+		{
+			result = DX12Wrapper::ms_device->CreateGraphicsPipelineState(&pipelineStateDesc, IID_PPV_ARGS(pipelineState.ReleaseAndGetAddressOf()));
+		}
 		if (FAILED(result))
 		{
-			return;
+			return -1;
 		}
 
 
@@ -194,19 +276,43 @@ namespace og
 		m_gs = desc.gs;
 		m_hs = desc.hs;
 		m_ds = desc.ds;
+		return 0;
 	}
 
 
-	S32 GraphicPipeline::SetGraphicPipeline(ComPtr<ID3D12GraphicsCommandList>& commandList)const
+	S32 GraphicPipeline::SetGraphicPipeline(ComPtr<ID3D12GraphicsCommandList>& commandList, ID3D12RootSignature** boundRootSignature)const
 	{
 		if (!IsValid())return -1;
 		if (!commandList)return -1;
 		commandList->SetPipelineState(m_pipelineState.Get());
+
+		// 同じルートシグネチャを設定し直すとルート引数の再設定が必要になるため省略する
+		if (boundRootSignature != nullptr && *boundRootSignature == m_rootSignature.Get())return 0;
 		commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+		if (boundRootSignature != nullptr)*boundRootSignature = m_rootSignature.Get();
 		return 0;
 	}
 
 
+	HRESULT GraphicPipeline::CreateRootSignature(const D3D12_ROOT_SIGNATURE_DESC& desc, ComPtr<ID3D12RootSignature>& dest)
+	{
+		// バイナリデータの作成
+		ComPtr<ID3DBlob> rootSigBlob = nullptr;
+		ComPtr<ID3DBlob> errorBlob = nullptr;
+
+		auto result = D3D12SerializeRootSignature(&desc, D3D_ROOT_SIGNATURE_VERSION_1_0, &rootSigBlob, &errorBlob);
+		if (FAILED(result))
+		{
+			return result;
+		}
+
+		// ルートシグネチャの作成
+		return DX12Wrapper::ms_device->CreateRootSignature(0,
+			rootSigBlob->GetBufferPointer(), rootSigBlob->GetBufferSize(),
+			IID_PPV_ARGS(dest.ReleaseAndGetAddressOf()));
+	}
+
+
 	S32 GraphicPipeline::GetConstantBufferSize(const U32 resister)const
 	{
 		if (resister < 0 || MAX_REGISTER <= resister)return -1;
@@ -297,6 +403,14 @@ namespace og
 			elementDesc.InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA;
 			elementDesc.InstanceDataStepRate = 0;
 
+			// INSTANCEで始まるセマンティクスはインスタンスごとのデータとしてスロット1から読む
+			if (m_inputLayoutNames[i].compare(0, 8, "INSTANCE") == 0)
+			{
+				elementDesc.InputSlot = 1;
+				elementDesc.InputSlotClass = D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA;
+				elementDesc.InstanceDataStepRate = 1;
+			}
+
 			if (paramDesc.Mask == 1)
 			{
 				if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32) elementDesc.Format = DXGI_FORMAT_R32_UINT;
@@ -1,5 +1,6 @@
 ﻿#pragma once
 
+#include <atomic>
 #include <d3d12.h>
 #include "IGraphicPipeline.h"
 #include "GraphicPipelineDesc.h"
@@ -9,6 +10,8 @@
 struct ID3D12ShaderReflection;
 namespace og
 {
+	class PipelineCache;
+
 	/// <summary>
 	/// 描画に使用する情報をひとまとめにする
 	/// </summary>
@@ -17,6 +20,14 @@ namespace og
 	public:
 		static const S32 MAX_REGISTER = 32;
 	private:
+		// 作成の状態。コンパイル中のシェーダーを待つ間はCOMPILINGになる
+		std::atomic<ShaderStatus> m_status;
+
+		// シェーダーの完成を待って作成するための定義
+		GraphicPipelineDesc m_pendingDesc;
+		PipelineCache* m_cache;
+		std::atomic<S32> m_pendingShaderCount;
+
 		// メインリソース
 		ComPtr<ID3D12PipelineState> m_pipelineState;
 		ComPtr<ID3D12RootSignature> m_rootSignature;
@@ -50,15 +61,43 @@ namespace og
 		S32 m_targetNum;
 
 	public:
-		GraphicPipeline(const GraphicPipelineDesc& desc);
+		/// <summary>
+		/// シェーダをリフレクションしてルートシグネチャとPSOを作成する
+		/// </summary>
+		/// <param name="desc">グラフィックパイプラインの定義</param>
+		/// <param name="cache">PSOを作成するキャッシュ。nullptrの場合はキャッシュを使わずに作成する</param>
+		GraphicPipeline(const GraphicPipelineDesc& desc, PipelineCache* cache = nullptr);
+
+		/// <summary>
+		/// シェーダーの完成を待つ作成前のパイプラインを生成。CreateAsyncから使う
+		/// </summary>
+		GraphicPipeline();
+
+		/// <summary>
+		/// コンパイル中のシェーダーを含む定義から、シェーダーの完成後に作成されるパイプラインを生成する
+		/// </summary>
+		/// <remarks>
+		/// 最後のシェーダーが完成したスレッドでルートシグネチャとPSOを作成する。それまではIsPendingがtrueを返す。
+		/// 作成に成功した場合はcacheに登録し、以降の同じ定義の作成で共有する。完成前に破棄された場合は作成しない。
+		/// </remarks>
+		/// <param name="desc">グラフィックパイプラインの定義</param>
+		/// <param name="cache">PSOを作成するキャッシュ。nullptrの場合はキャッシュを使わずに作成する</param>
+		/// <returns>作成前のパイプライン</returns>
+		static SPtr<GraphicPipeline> CreateAsync(const GraphicPipelineDesc& desc, PipelineCache* cache);
+
+		/// <summary>
+		/// 定義にコンパイル中のシェーダーが含まれているか
+		/// </summary>
+		static bool HasCompilingShader(const GraphicPipelineDesc& desc);
 
 
 		/// <summary>
 		/// コマンドリストにこのグラフィックパイプラインを設定する
 		/// </summary>
 		/// <param name="commandList">グラフィックコマンドリスト</param>
+		/// <param name="boundRootSignature">コマンドリストに設定中のルートシグネチャ。同じ場合は設定を省略し、変えた場合は更新する。nullptrの場合は常に設定する</param>
 		/// <returns>　０：成功\n－１：失敗</returns>
-		S32 SetGraphicPipeline(ComPtr<ID3D12GraphicsCommandList>& commandList)const;
+		S32 SetGraphicPipeline(ComPtr<ID3D12GraphicsCommandList>& commandList, ID3D12RootSignature** boundRootSignature = nullptr)const;
 
 		/// <summary>
 		/// 指定したレジスタの定数バッファのサイズを取得
@@ -107,9 +146,29 @@ namespace og
 		/// インスタンスの生成に成功しているか
 		/// </summary>
 		/// <returns></returns>
-		inline bool IsValid()const { return m_pipelineState != nullptr; }
+		inline bool IsValid()const { return GetStatus() == ShaderStatus::READY; }
+
+		/// <summary>
+		/// シェーダーの完成を待っていて、まだ作成されていないか
+		/// </summary>
+		inline bool IsPending()const { return GetStatus() == ShaderStatus::COMPILING; }
+
+		/// <summary>
+		/// 作成の状態を取得する
+		/// </summary>
+		inline ShaderStatus GetStatus()const { return m_status.load(std::memory_order_acquire); }
+
+		/// <summary>
+		/// ルートシグネチャをシリアライズして作成する
+		/// </summary>
+		/// <param name="desc">ルートシグネチャの定義</param>
+		/// <param name="dest">ルートシグネチャの出力先</param>
+		static HRESULT CreateRootSignature(const D3D12_ROOT_SIGNATURE_DESC& desc, ComPtr<ID3D12RootSignature>& dest);
 
 	private:
+		S32 Build(const GraphicPipelineDesc& desc, PipelineCache* cache);
+		static void OnShaderFinished(const SPtr<GraphicPipeline>& pipeline);
+
 		S32 ReflectShader(const ComPtr<ID3DBlob>& vsInstance);
 		S32 ReflectInputLayout(const ComPtr<ID3DBlob>& vsInstance);
 		S32 ReflectConstantBuffer(const ComPtr<ID3D12ShaderReflection>& reflection);
@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include <utility>
+
+namespace og
+{
+	/// <summary>
+	/// シェーダのコンパイル条件
+	/// </summary>
+	struct ShaderCompileDesc
+	{
+		/// <summary> シェーダのソースコード </summary>
+		String source;
+		/// <summary> エントリポイントの関数名 </summary>
+		String entryPoint;
+		/// <summary> シェーダモデル(vs_5_0など) </summary>
+		String target;
+		/// <summary> マクロ名と値の組 </summary>
+		ArrayList<std::pair<String, String>> defines;
+		/// <summary> コンパイラに渡すフラグ </summary>
+		U32 flags = 0;
+	};
+
+
+	/// <summary>
+	/// シェーダのソースコードをバイトコードに変換する
+	/// </summary>
+	/// <remarks>
+	/// ShaderCacheからコンパイラを切り離すためのインターフェース。
+	/// </remarks>
+	class IShaderCompiler
+	{
+	public:
+		virtual ~IShaderCompiler() {}
+
+		/// <summary>
+		/// コンパイラを識別する文字列。コンパイラが更新された場合にキャッシュを使わないよう、キャッシュのキーに含める
+		/// </summary>
+		virtual String GetVersion()const = 0;
+
+		/// <summary>
+		/// シェーダをコンパイルする
+		/// </summary>
+		/// <remarks>
+		/// 複数のスレッドから同時に呼び出せるように実装する。
+		/// </remarks>
+		/// <param name="desc">コンパイル条件</param>
+		/// <param name="dest">バイトコードの出力先</param>
+		/// <param name="errorDest">エラー出力先文字列</param>
+		/// <returns>　０：成功\n－１：コンパイルエラー</returns>
+		virtual S32 Compile(const ShaderCompileDesc& desc, ArrayList<Byte>& dest, String& errorDest) = 0;
+	};
+}
\ No newline at end of file
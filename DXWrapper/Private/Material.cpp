@@ -16,11 +16,29 @@ namespace og
 	Material::Material(const SPtr<IGraphicPipeline>& gpipeline, const S32 cBufferMask, const S32 texMask)
 		:m_cBufferMask(cBufferMask), m_texMask(texMask)
 	{
-		if (CheckArgs(!!gpipeline))return;
-		auto pipelinePtr = reinterpret_cast<GraphicPipeline*>(gpipeline.get());
-
 		m_isChanged = true;
 		m_isLocked = false;
+		m_isInitialized = false;
+		m_dataSize = 0;
+		m_data = nullptr;
+
+		if (CheckArgs(!!gpipeline))return;
+		m_graphicPipeline = gpipeline;
+
+		// シェーダーのコンパイル中はリフレクション結果がないため、パイプラインの作成後に初期化する
+		if (reinterpret_cast<GraphicPipeline*>(gpipeline.get())->IsPending())return;
+		Initialize();
+	}
+
+
+	void Material::Initialize()
+	{
+		auto pipelinePtr = reinterpret_cast<GraphicPipeline*>(m_graphicPipeline.get());
+		if (!pipelinePtr->IsValid())
+		{
+			m_graphicPipeline.reset();
+			return;
+		}
 
 		// 確保する定数バッファのサイズを計算
 		m_dataSize = 0;
@@ -64,14 +82,30 @@ namespace og
 		m_textureListBuffer.resize(texNum);
 
 
-		m_graphicPipeline = gpipeline;
-
-
 		if (CreateResource() == -1)
 		{
 			m_graphicPipeline.reset();
 			return;
 		}
+		m_isInitialized = true;
+
+
+		// パイプラインの作成前に呼ばれた設定を反映
+		HashMap<String, std::function<S32()>> setters;
+		setters.swap(m_deferredSetters);
+		for (auto& setter : setters)setter.second();
+	}
+
+
+	bool Material::IsReady()
+	{
+		if (m_isInitialized)return true;
+		if (!IsValid())return false;
+		if (reinterpret_cast<GraphicPipeline*>(m_graphicPipeline.get())->IsPending())return false;
+
+		Initialize();
+		if (!m_isInitialized)m_deferredSetters.clear();
+		return m_isInitialized;
 	}
 
 
@@ -156,7 +190,7 @@ namespace og
 
 	S32 Material::SetMaterial(ComPtr<ID3D12GraphicsCommandList>& commandList)
 	{
-		if (!IsValid())return -1;
+		if (!IsReady())return -1;
 		if (CheckArgs(commandList))return -1;
 
 		// 変更があればでスクリプタヒープの再生成
@@ -201,6 +235,12 @@ namespace og
 		if (!IsValid())return -1;
 		if (CheckArgs(!!texture))return -1;
 		if (m_isLocked)return -1;
+		if (!IsReady())
+		{
+			if (!IsValid())return -1;
+			m_deferredSetters[name] = [this, name, texture, target]() { return SetTexture(name, texture, target); };
+			return 0;
+		}
 
 		auto varData = reinterpret_cast<GraphicPipeline*>(m_graphicPipeline.get())->GetVariableData(name);
 
@@ -224,6 +264,12 @@ namespace og
 	{
 		if (!IsValid())return -1;
 		if (m_isLocked)return -1;
+		if (!IsReady())
+		{
+			if (!IsValid())return -1;
+			m_deferredSetters[name] = [this, name, value]() { return SetFloat4Param(name, value); };
+			return 0;
+		}
 
 		auto varData = reinterpret_cast<GraphicPipeline*>(m_graphicPipeline.get())->GetVariableData(name);
 
@@ -240,6 +286,12 @@ namespace og
 	{
 		if (!IsValid())return -1;
 		if (m_isLocked)return -1;
+		if (!IsReady())
+		{
+			if (!IsValid())return -1;
+			m_deferredSetters[name] = [this, name, value]() { return SetMatrixParam(name, value); };
+			return 0;
+		}
 
 		auto varData = reinterpret_cast<GraphicPipeline*>(m_graphicPipeline.get())->GetVariableData(name);
 
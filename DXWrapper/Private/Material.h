@@ -2,6 +2,7 @@
 
 #include "IMaterial.h"
 
+#include <functional>
 #include <d3d12.h>
 #include "DXHelper.h"
 
@@ -35,6 +36,10 @@ namespace og
 		bool m_isChanged;
 		bool m_isLocked;
 
+		// パイプラインの作成を待っている間は初期化せず、変数名ごとに最後の設定を記録しておく
+		bool m_isInitialized;
+		HashMap<String, std::function<S32()>> m_deferredSetters;
+
 		const S32 m_cBufferMask;
 		const S32 m_texMask;
 
@@ -56,7 +61,16 @@ namespace og
 
 
 		inline bool IsValid()const { return m_graphicPipeline != nullptr; };
+
+		/// <summary>
+		/// パイプラインが作成済みで、コマンドリストに設定できる状態か
+		/// </summary>
+		/// <remarks>
+		/// パイプラインの作成が終わっていれば初期化し、記録していた設定値を反映する。作成に失敗していた場合は無効になる。
+		/// </remarks>
+		bool IsReady();
 	private:
+		void Initialize();
 		S32 CreateResource();
 		S32 CreateDescriptorHeap();
 	};
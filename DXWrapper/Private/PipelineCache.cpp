@@ -0,0 +1,245 @@
+﻿#include "pch.h"
+#include "PipelineCache.h"
+
+#include <fstream>
+#include <iterator>
+
+#include "DX12Wrapper.h"
+#include "GraphicPipeline.h"
+#include "Shader.h"
+
+namespace
+{
+	/// <summary>
+	/// PSOの組み立て方を変えた場合は値を変えて、保存済みのライブラリのPSOを使わないようにする
+	/// </summary>
+	const U32 PIPELINE_CACHE_VERSION = 1;
+
+	/// <summary>
+	/// この数を超えたら破棄済みのパイプラインを取り除く
+	/// </summary>
+	const size_t MIN_PRUNE_SIZE = 64;
+}
+
+namespace og
+{
+	PipelineCache::PipelineCache() :m_pruneSize(MIN_PRUNE_SIZE), m_isLibraryChanged(false)
+	{
+	}
+
+	//===================================================================================//
+
+	SPtr<IGraphicPipeline> PipelineCache::GetOrCreate(const GraphicPipelineDesc& desc)
+	{
+		if (CheckArgs(desc.vs != nullptr, desc.ps != nullptr))return nullptr;
+
+		// バイトコードが決まるまでキーを作れないため、コンパイル中のシェーダーを含むものは共有しない
+		if (GraphicPipeline::HasCompilingShader(desc))return GraphicPipeline::CreateAsync(desc, this);
+
+		const PipelineKey key = MakeKey(desc);
+		const U64 hash = HashBytes(HASH_OFFSET_BASIS, &key, sizeof(key));
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			auto found = m_pipelines.find(hash);
+			if (found != m_pipelines.end() && memcmp(&found->second.key, &key, sizeof(key)) == 0)
+			{
+				if (auto pipeline = found->second.pipeline.lock())return pipeline;
+			}
+		}
+
+		// PSOの作成は時間がかかるためロックの外で行う
+		auto pipeline = MSPtr<GraphicPipeline>(desc, this);
+		if (pipeline->IsValid() == false)return nullptr;
+
+		return Register(key, hash, pipeline);
+	}
+
+	SPtr<IGraphicPipeline> PipelineCache::Register(const GraphicPipelineDesc& desc, const SPtr<IGraphicPipeline>& pipeline)
+	{
+		if (CheckArgs(pipeline != nullptr))return nullptr;
+
+		const PipelineKey key = MakeKey(desc);
+		return Register(key, HashBytes(HASH_OFFSET_BASIS, &key, sizeof(key)), pipeline);
+	}
+
+	SPtr<IGraphicPipeline> PipelineCache::Register(const PipelineKey& key, const U64 hash, const SPtr<IGraphicPipeline>& pipeline)
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto& entry = m_pipelines[hash];
+		if (memcmp(&entry.key, &key, sizeof(key)) == 0)
+		{
+			// 他のスレッドが先に同じパイプラインを作成していればそちらを使う
+			if (auto existing = entry.pipeline.lock())return existing;
+		}
+		entry.key = key;
+		entry.pipeline = pipeline;
+
+		if (m_pruneSize <= m_pipelines.size())PruneExpired();
+		return pipeline;
+	}
+
+	//===================================================================================//
+
+	HRESULT PipelineCache::CreateRootSignature(const U32(&cBufDataSizes)[GraphicPipeline::MAX_REGISTER], const U32(&texNums)[GraphicPipeline::MAX_REGISTER],
+											   const D3D12_ROOT_SIGNATURE_DESC& desc, ComPtr<ID3D12RootSignature>& dest)
+	{
+		RootSignatureKey key;
+		memset(&key, 0, sizeof(key));
+		for (S32 i = 0; i < GraphicPipeline::MAX_REGISTER; i++)
+		{
+			if (cBufDataSizes[i] != 0)key.cBufferMask |= 1u << i;
+			key.texNums[i] = texNums[i];
+		}
+		const U64 hash = HashBytes(HASH_OFFSET_BASIS, &key, sizeof(key));
+
+		// ルートシグネチャの作成は軽いためロックしたまま行う
+		std::lock_guard<std::mutex> lock(m_rootSignatureMutex);
+		auto found = m_rootSignatures.find(hash);
+		if (found != m_rootSignatures.end() && memcmp(&found->second.key, &key, sizeof(key)) == 0)
+		{
+			dest = found->second.rootSignature;
+			return S_OK;
+		}
+
+		auto result = GraphicPipeline::CreateRootSignature(desc, dest);
+		if (FAILED(result))return result;
+
+		auto& entry = m_rootSignatures[hash];
+		entry.key = key;
+		entry.rootSignature = dest;
+		return S_OK;
+	}
+
+	//===================================================================================//
+
+	HRESULT PipelineCache::CreatePipelineState(const U64 hash, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& dest)
+	{
+		WCHAR name[32];
+		swprintf_s(name, L"%016llX", hash);
+
+		{
+			std::lock_guard<std::mutex> lock(m_libraryMutex);
+			if (m_library && SUCCEEDED(m_library->LoadGraphicsPipeline(name, &desc, IID_PPV_ARGS(dest.ReleaseAndGetAddressOf()))))
+			{
+				return S_OK;
+			}
+		}
+
+		auto result = DX12Wrapper::ms_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(dest.ReleaseAndGetAddressOf()));
+		if (FAILED(result))return result;
+
+		std::lock_guard<std::mutex> lock(m_libraryMutex);
+		if (m_library && SUCCEEDED(m_library->StorePipeline(name, dest.Get())))
+		{
+			m_isLibraryChanged = true;
+		}
+		return S_OK;
+	}
+
+	//===================================================================================//
+
+	S32 PipelineCache::Load(const Path& path)
+	{
+		ComPtr<ID3D12Device1> device;
+		if (FAILED(DX12Wrapper::ms_device->QueryInterface(IID_PPV_ARGS(device.ReleaseAndGetAddressOf()))))return -1;
+
+		std::lock_guard<std::mutex> lock(m_libraryMutex);
+		m_library.Reset();
+		m_libraryPath = path;
+		m_isLibraryChanged = false;
+
+		std::ifstream stream(path.ToString().c_str(), std::ios::binary);
+		if (stream)
+		{
+			m_libraryData.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		}
+		else
+		{
+			m_libraryData.clear();
+		}
+
+		HRESULT result = E_FAIL;
+		if (!m_libraryData.empty())
+		{
+			result = device->CreatePipelineLibrary(m_libraryData.data(), m_libraryData.size(), IID_PPV_ARGS(m_library.ReleaseAndGetAddressOf()));
+		}
+		if (FAILED(result))
+		{
+			// ファイルの破損やドライバの更新で読み込めない場合は作り直す
+			m_libraryData.clear();
+			result = device->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(m_library.ReleaseAndGetAddressOf()));
+		}
+		if (FAILED(result))
+		{
+			m_library.Reset();
+			return -1;
+		}
+		return 0;
+	}
+
+	//===================================================================================//
+
+	S32 PipelineCache::Save()
+	{
+		std::lock_guard<std::mutex> lock(m_libraryMutex);
+		if (!m_library || !m_isLibraryChanged)return 0;
+
+		ArrayList<Byte> data(m_library->GetSerializedSize());
+		if (FAILED(m_library->Serialize(data.data(), data.size())))return -1;
+
+		std::ofstream stream(m_libraryPath.ToString().c_str(), std::ios::binary | std::ios::trunc);
+		if (!stream)return -1;
+		stream.write((const char*)data.data(), data.size());
+		if (!stream)return -1;
+
+		m_isLibraryChanged = false;
+		return 0;
+	}
+
+	//===================================================================================//
+
+	U64 PipelineCache::ComputeHash(const GraphicPipelineDesc& desc)
+	{
+		const PipelineKey key = MakeKey(desc);
+		return HashBytes(HASH_OFFSET_BASIS, &key, sizeof(key));
+	}
+
+	//===================================================================================//
+
+	PipelineCache::PipelineKey PipelineCache::MakeKey(const GraphicPipelineDesc& desc)
+	{
+		PipelineKey key;
+		memset(&key, 0, sizeof(key));
+
+		const SPtr<IShader>* shaders[] = { &desc.vs, &desc.ps, &desc.gs, &desc.hs, &desc.ds };
+		for (S32 i = 0; i < 5; i++)
+		{
+			auto shader = reinterpret_cast<Shader*>(shaders[i]->get());
+			if (shader != nullptr)key.shaderHashes[i] = shader->GetBytecodeHash();
+		}
+		key.shaderHashes[0] ^= PIPELINE_CACHE_VERSION;
+
+		key.numRenderTargets = desc.numRenderTargets;
+		for (S32 i = 0; i < 8; i++)key.blendMode[i] = desc.blendMode[i];
+		key.cullMode = (U8)desc.cullMode;
+		key.primitiveTopologyType = (U8)desc.primitiveTopologyType;
+		key.useWireframe = desc.useWireframe;
+		key.useMultisample = desc.useMultisample;
+		key.useDepth = desc.useDepth;
+		key.useStencil = desc.useStencil;
+		return key;
+	}
+
+	//===================================================================================//
+
+	void PipelineCache::PruneExpired()
+	{
+		for (auto itr = m_pipelines.begin(); itr != m_pipelines.end();)
+		{
+			if (itr->second.pipeline.expired())itr = m_pipelines.erase(itr);
+			else ++itr;
+		}
+		m_pruneSize = MIN_PRUNE_SIZE < m_pipelines.size() * 2 ? m_pipelines.size() * 2 : MIN_PRUNE_SIZE;
+	}
+}
\ No newline at end of file
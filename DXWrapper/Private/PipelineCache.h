@@ -0,0 +1,146 @@
+﻿#pragma once
+
+#include <mutex>
+#include <d3d12.h>
+
+#include "IGraphicPipeline.h"
+#include "GraphicPipelineDesc.h"
+#include "GraphicPipeline.h"
+
+#include "DXHelper.h"
+
+namespace og
+{
+	/// <summary>
+	/// グラフィックパイプラインの共有とPSOライブラリのキャッシュ
+	/// </summary>
+	/// <remarks>
+	/// シェーダのバイトコードとステートが同じGraphicPipelineDescには同じIGraphicPipelineを返す。
+	/// パイプラインは弱参照で保持するため、どこからも参照されなくなったものは破棄される。
+	/// ルートシグネチャはリフレクションしたレジスタ構成ごとに1つだけ作成し、構成が同じパイプライン全てで共有する。
+	/// 作成したPSOはID3D12PipelineLibraryにも格納し、ファイルに保存しておくことで次回起動時のコンパイルを省略する。
+	/// コンパイル中のシェーダーを含む定義はシェーダーの完成後に作成されるパイプラインを返し、作成できた時点で登録して共有する。
+	/// 複数のスレッドから同時に呼び出せる。
+	/// </remarks>
+	class PipelineCache
+	{
+	private:
+		/// <summary>
+		/// パイプラインを識別するキー。パディングも0で埋めてバイト列で比較する
+		/// </summary>
+		struct PipelineKey
+		{
+			U64 shaderHashes[5];
+			S32 numRenderTargets;
+			BlendMode blendMode[8];
+			U8 cullMode;
+			U8 primitiveTopologyType;
+			U8 useWireframe;
+			U8 useMultisample;
+			U8 useDepth;
+			U8 useStencil;
+		};
+
+		struct Entry
+		{
+			PipelineKey key;
+			WPtr<IGraphicPipeline> pipeline;
+		};
+
+		/// <summary>
+		/// ルートシグネチャを識別するキー。定数バッファはレジスタごとに1つなので有無だけを持つ
+		/// </summary>
+		struct RootSignatureKey
+		{
+			U32 cBufferMask;
+			U32 texNums[GraphicPipeline::MAX_REGISTER];
+		};
+
+		struct RootSignatureEntry
+		{
+			RootSignatureKey key;
+			ComPtr<ID3D12RootSignature> rootSignature;
+		};
+
+	private:
+		std::mutex m_mutex;
+		HashMap<U64, Entry> m_pipelines;
+		size_t m_pruneSize;
+
+		// ルートシグネチャは数が少ないため破棄せずに持ち続ける
+		std::mutex m_rootSignatureMutex;
+		HashMap<U64, RootSignatureEntry> m_rootSignatures;
+
+		// ライブラリはシリアライズされたデータを参照し続けるため、データより後に宣言する
+		std::mutex m_libraryMutex;
+		ArrayList<Byte> m_libraryData;
+		ComPtr<ID3D12PipelineLibrary> m_library;
+		Path m_libraryPath;
+		bool m_isLibraryChanged;
+
+	public:
+		PipelineCache();
+
+		/// <summary>
+		/// 同じ定義のパイプラインがあればそれを返し、なければ作成する
+		/// </summary>
+		/// <param name="desc">グラフィックパイプラインの定義</param>
+		/// <returns>パイプライン。作成に失敗した場合はnullptr。コンパイル中のシェーダーを含む場合は作成前のパイプライン</returns>
+		SPtr<IGraphicPipeline> GetOrCreate(const GraphicPipelineDesc& desc);
+
+		/// <summary>
+		/// 作成済みのパイプラインを登録し、以降の同じ定義のGetOrCreateで返されるようにする
+		/// </summary>
+		/// <remarks>
+		/// シェーダーの完成を待って作成したパイプラインを共有するために使う。
+		/// </remarks>
+		/// <param name="desc">グラフィックパイプラインの定義。シェーダーは全て完成している必要がある</param>
+		/// <param name="pipeline">登録するパイプライン</param>
+		/// <returns>登録されたパイプライン。同じ定義のパイプラインが既にあればそちら</returns>
+		SPtr<IGraphicPipeline> Register(const GraphicPipelineDesc& desc, const SPtr<IGraphicPipeline>& pipeline);
+
+		/// <summary>
+		/// レジスタ構成が同じルートシグネチャがあればそれを返し、なければ作成する
+		/// </summary>
+		/// <param name="cBufDataSizes">定数バッファのレジスタごとのサイズ</param>
+		/// <param name="texNums">テクスチャのレジスタごとの枚数</param>
+		/// <param name="desc">レジスタ構成から作ったルートシグネチャの定義。作成時のみ使う</param>
+		/// <param name="dest">ルートシグネチャの出力先</param>
+		HRESULT CreateRootSignature(const U32(&cBufDataSizes)[GraphicPipeline::MAX_REGISTER], const U32(&texNums)[GraphicPipeline::MAX_REGISTER],
+									const D3D12_ROOT_SIGNATURE_DESC& desc, ComPtr<ID3D12RootSignature>& dest);
+
+		/// <summary>
+		/// PSOライブラリにあればそこから読み込み、なければ作成してライブラリに格納する
+		/// </summary>
+		/// <param name="hash">ComputeHashで求めたパイプラインのハッシュ</param>
+		/// <param name="desc">PSOの定義</param>
+		/// <param name="dest">PSOの出力先</param>
+		HRESULT CreatePipelineState(const U64 hash, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, ComPtr<ID3D12PipelineState>& dest);
+
+		/// <summary>
+		/// 保存したPSOライブラリを読み込む
+		/// </summary>
+		/// <remarks>
+		/// ファイルがない場合、ドライバやGPUが変わって使えない場合は空のライブラリから始める。
+		/// </remarks>
+		/// <param name="path">ライブラリのファイルパス。Saveでの保存先にもなる</param>
+		/// <returns>　０：成功\n－１：PSOライブラリに対応していない</returns>
+		S32 Load(const Path& path);
+
+		/// <summary>
+		/// Load以降に追加されたPSOがあればライブラリをファイルに保存する
+		/// </summary>
+		/// <returns>　０：成功\n－１：保存に失敗</returns>
+		S32 Save();
+
+		/// <summary>
+		/// パイプラインのハッシュを求める。シェーダはバイトコードの内容で区別する
+		/// </summary>
+		static U64 ComputeHash(const GraphicPipelineDesc& desc);
+
+	private:
+		static PipelineKey MakeKey(const GraphicPipelineDesc& desc);
+		SPtr<IGraphicPipeline> Register(const PipelineKey& key, const U64 hash, const SPtr<IGraphicPipeline>& pipeline);
+		void PruneExpired();
+	};
+}
\ No newline at end of file
@@ -254,6 +254,8 @@ namespace og
 	{
 		m_cmdAllocator->Reset();
 		m_cmdList->Reset(m_cmdAllocator.Get(), nullptr);
+		m_boundRootSignature = nullptr;
+		m_useFallback = false;
 	}
 
 
@@ -317,17 +319,27 @@ namespace og
 	{
 		if (CheckArgs(!!pipeline))return -1;
 		auto ptr = reinterpret_cast<GraphicPipeline*>(pipeline.get());
-		ptr->SetGraphicPipeline(m_cmdList);
 
-		return 0;
+		// シェーダーのコンパイル中や作成に失敗した場合は、デフォルトのパイプラインとマテリアルで描画する
+		m_useFallback = !ptr->IsValid();
+		if (m_useFallback)
+		{
+			auto asset = DefaultAsset::Instance();
+			reinterpret_cast<GraphicPipeline*>(asset->fallbackPipeline.get())->SetGraphicPipeline(m_cmdList, &m_boundRootSignature);
+			reinterpret_cast<Material*>(asset->fallbackMaterial.get())->SetMaterial(m_cmdList);
+			return 0;
+		}
+
+		return ptr->SetGraphicPipeline(m_cmdList, &m_boundRootSignature);
 	}
 
 	S32 RenderTexture::SetMaterial(SPtr<IMaterial> material)
 	{
 		if (CheckArgs(!!material))return -1;
+		// 代わりのパイプラインにはマテリアルのレジスタ構成が合わないため設定しない
+		if (m_useFallback)return 0;
 		auto ptr = reinterpret_cast<Material*>(material.get());
-		ptr->SetMaterial(m_cmdList);
-		return 0;
+		return ptr->SetMaterial(m_cmdList);
 	}
 
 
@@ -340,6 +352,18 @@ namespace og
 		return 0;
 	}
 
+	S32 RenderTexture::DrawInstanced(SPtr<IShape>& shape, SPtr<IShape>& instances, const U32 firstInstance, const U32 count)
+	{
+		if (CheckArgs(!!shape, !!instances))return -1;
+		if ((U32)instances->GetVertexCount() < firstInstance + count)return -1;
+
+		auto instancesPtr = reinterpret_cast<Shape*>(instances.get());
+		if (instancesPtr->SetInstanceBuffer(m_cmdList) == -1)return -1;
+
+		auto ptr = reinterpret_cast<Shape*>(shape.get());
+		return ptr->Draw(m_cmdList, count, firstInstance);
+	}
+
 
 
 
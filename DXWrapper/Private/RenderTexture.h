@@ -29,6 +29,11 @@ namespace og
 
 		Color m_clearColor;
 
+		// コマンドリストに設定中のルートシグネチャ
+		ID3D12RootSignature* m_boundRootSignature = nullptr;
+		// 作成前や作成に失敗したパイプラインの代わりにデフォルトのパイプラインを設定中か
+		bool m_useFallback = false;
+
 	public:
 		RenderTexture(const ArrayList<TextureFormat>& formats, const U32 width, const U32 height, const bool useDepht = true);
 
@@ -47,6 +52,7 @@ namespace og
 		S32 SetMaterial(SPtr<IMaterial> material)override;
 
 		S32 DrawInstanced(SPtr<IShape>& shape, const U32 count = 1)override;
+		S32 DrawInstanced(SPtr<IShape>& shape, SPtr<IShape>& instances, const U32 firstInstance, const U32 count)override;
 
 
 		Vector3 GetSize()override;
@@ -1,5 +1,7 @@
 ﻿#include "pch.h"
 #include "Shader.h"
+#include "ShaderCache.h"
+#include "D3DShaderCompiler.h"
 
 
 #include <fstream>
@@ -25,26 +27,113 @@ namespace
 
 namespace og
 {
-	Shader::Shader(const String& src, const ShaderType type, String& errorDest)
+	Shader::Shader(const String& src, const ShaderType type, String& errorDest, ShaderCache* cache)
+		:m_status(ShaderStatus::COMPILING)
 	{
-		ComPtr<ID3DBlob> errorBlob = nullptr;
-		auto result = D3DCompile(src.c_str(), src.size(), NULL, NULL, NULL,
-								 shaderEntryPoints[(U32)type], shaderTargets[(U32)type],
-								 D3DCOMPILE_PREFER_FLOW_CONTROL, 0, m_shaderBolb.ReleaseAndGetAddressOf(), errorBlob.ReleaseAndGetAddressOf());
-
-		if (FAILED(result))
+		ArrayList<Byte> bytecode;
+		if (Compile(MakeCompileDesc(src, type), bytecode, errorDest, cache) == -1)
 		{
-			errorDest.resize(errorBlob->GetBufferSize());
-			std::copy_n((char*)errorBlob->GetBufferPointer(), errorBlob->GetBufferSize(), errorDest.begin());
+			Fail(errorDest);
 			return;
 		}
+		Complete(bytecode);
 	}
 
 	Shader::Shader(ComPtr<ID3DBlob>& bolb)
+		:m_status(ShaderStatus::FAILED)
 	{
 		if (!bolb)return;
 
 		m_shaderBolb = bolb;
+		m_bytecodeHash = HashBytes(HASH_OFFSET_BASIS, m_shaderBolb->GetBufferPointer(), m_shaderBolb->GetBufferSize());
+		m_status.store(ShaderStatus::READY, std::memory_order_release);
+	}
+
+	Shader::Shader()
+		:m_status(ShaderStatus::COMPILING)
+	{
+	}
+
+
+
+	ShaderStatus Shader::Wait()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this]() { return m_status.load(std::memory_order_acquire) != ShaderStatus::COMPILING; });
+		return m_status.load(std::memory_order_acquire);
+	}
+
+	String Shader::GetErrorLog()const
+	{
+		// エラーログはコンパイルが終わるまで書き換わる
+		if (GetStatus() == ShaderStatus::COMPILING)return String();
+		return m_errorLog;
+	}
+
+	void Shader::Complete(const ArrayList<Byte>& bytecode)
+	{
+		if (FAILED(D3DCreateBlob(bytecode.size(), m_shaderBolb.ReleaseAndGetAddressOf())))
+		{
+			Fail(TC("D3DCreateBlob failed"));
+			return;
+		}
+		memcpy(m_shaderBolb->GetBufferPointer(), bytecode.data(), bytecode.size());
+		m_bytecodeHash = HashBytes(HASH_OFFSET_BASIS, m_shaderBolb->GetBufferPointer(), m_shaderBolb->GetBufferSize());
+		Finish(ShaderStatus::READY);
+	}
+
+	void Shader::Fail(const String& errorLog)
+	{
+		m_shaderBolb.Reset();
+		m_errorLog = errorLog;
+		Finish(ShaderStatus::FAILED);
+	}
+
+	void Shader::OnFinished(const std::function<void()>& callback)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_status.load(std::memory_order_acquire) == ShaderStatus::COMPILING)
+			{
+				m_callbacks.push_back(callback);
+				return;
+			}
+		}
+		callback();
+	}
+
+	void Shader::Finish(const ShaderStatus status)
+	{
+		ArrayList<std::function<void()>> callbacks;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_status.store(status, std::memory_order_release);
+			callbacks.swap(m_callbacks);
+		}
+		m_condition.notify_all();
+
+		// 登録した側がシェーダーを参照していることがあるため、ロックの外で呼ぶ
+		for (auto& callback : callbacks)callback();
+	}
+
+
+
+	ShaderCompileDesc Shader::MakeCompileDesc(const String& src, const ShaderType type)
+	{
+		ShaderCompileDesc desc;
+		desc.source = src;
+		desc.entryPoint = shaderEntryPoints[(U32)type];
+		desc.target = shaderTargets[(U32)type];
+		desc.flags = D3DCOMPILE_PREFER_FLOW_CONTROL;
+		return desc;
+	}
+
+	S32 Shader::Compile(const ShaderCompileDesc& desc, ArrayList<Byte>& dest, String& errorDest, ShaderCache* cache)
+	{
+		if (cache)return cache->Compile(desc, dest, errorDest);
+
+		D3DShaderCompiler compiler;
+		return compiler.Compile(desc, dest, errorDest);
 	}
 
 
@@ -79,7 +168,7 @@ namespace og
 		return id == 0x43425844;
 	}
 
-	UPtr<Shader> Shader::LoadFromFile(const String& path, ShaderType type, String& errorDest)
+	UPtr<Shader> Shader::LoadFromFile(const String& path, ShaderType type, String& errorDest, ShaderCache* cache)
 	{
 		if (IsCompiledShader(path))
 		{
@@ -100,7 +189,7 @@ namespace og
 
 		std::ifstream ifs(path);
 		std::string str((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-		return MUPtr<Shader>(str, type, errorDest);
+		return MUPtr<Shader>(str, type, errorDest, cache);
 	}
 
 }
\ No newline at end of file
@@ -3,6 +3,10 @@
 #include "IShader.h"
 #include "GraphicPipelineDesc.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <d3d12.h>
 
 #include "IGraphicWrapper.h"
@@ -11,10 +15,23 @@
 
 namespace og
 {
+	class ShaderCache;
+	struct ShaderCompileDesc;
+
 	class Shader :public IShader
 	{
 	private:
 		ComPtr<ID3DBlob> m_shaderBolb;
+		U64 m_bytecodeHash = 0;
+
+		// コンパイルの状態。バイトコードとエラーログはREADYかFAILEDになるまで書き換わる
+		std::atomic<ShaderStatus> m_status;
+		String m_errorLog;
+
+		// コンパイルの完了待ち
+		mutable std::mutex m_mutex;
+		std::condition_variable m_condition;
+		ArrayList<std::function<void()>> m_callbacks;
 
 		ArrayList<D3D12_INPUT_ELEMENT_DESC> m_inputLayoutDesc;
 		ArrayList<D3D12_INPUT_ELEMENT_DESC> m_textureDesc;
@@ -30,13 +47,27 @@ namespace og
 		/// <param name="src">シェーダー文字列</param>
 		/// <param name="type">シェーダーステージ</param>
 		/// <param name="errorDest">エラー出力先文字列</param>
-		Shader(const String& src, const ShaderType type, String& errorDest);
+		/// <param name="cache">コンパイル結果のキャッシュ。nullptrの場合は毎回コンパイルする</param>
+		Shader(const String& src, const ShaderType type, String& errorDest, ShaderCache* cache = nullptr);
 
 		Shader(ComPtr<ID3DBlob>& bolb);
 
+		/// <summary>
+		/// コンパイル中のシェーダーオブジェクトを生成
+		/// </summary>
+		/// <remarks>
+		/// 非同期のコンパイルに使う。コンパイルが終わったらCompleteかFailを呼ぶ。
+		/// </remarks>
+		Shader();
+
 
 		const ComPtr<ID3DBlob>& GetShaderBolb() { return m_shaderBolb; }
 
+		/// <summary>
+		/// バイトコードのハッシュ。同じ内容のシェーダーは同じ値になる
+		/// </summary>
+		inline U64 GetBytecodeHash()const { return m_bytecodeHash; }
+
 
 		/// <summary>
 		/// シェーダーオブジェクトが有効な状態かどうか
@@ -44,9 +75,45 @@ namespace og
 		/// <remarks>
 		/// シェーダーの生成を行った場合はこの関数を用いて生成に成功したかを判定できる。
 		/// </remarks>
-		inline bool IsValid()const { return m_shaderBolb; };
+		inline bool IsValid()const { return GetStatus() == ShaderStatus::READY; };
+
+		ShaderStatus GetStatus()const override { return m_status.load(std::memory_order_acquire); }
+		ShaderStatus Wait()override;
+		String GetErrorLog()const override;
+
+		/// <summary>
+		/// コンパイル中のシェーダーにバイトコードを設定して完成させる
+		/// </summary>
+		void Complete(const ArrayList<Byte>& bytecode);
+
+		/// <summary>
+		/// コンパイル中のシェーダーを失敗にする
+		/// </summary>
+		void Fail(const String& errorLog);
+
+		/// <summary>
+		/// コンパイルが終わったときに呼ばれる関数を登録する
+		/// </summary>
+		/// <remarks>
+		/// すでに終わっている場合はその場で呼ぶ。そうでなければCompleteかFailを呼んだスレッドで呼ばれる。
+		/// </remarks>
+		void OnFinished(const std::function<void()>& callback);
+
+	private:
+		void Finish(const ShaderStatus status);
 
 	public:
+		/// <summary>
+		/// シェーダーステージのエントリポイントとターゲットでコンパイル条件を作る
+		/// </summary>
+		static ShaderCompileDesc MakeCompileDesc(const String& src, const ShaderType type);
+
+		/// <summary>
+		/// キャッシュがあればキャッシュを通してコンパイルする
+		/// </summary>
+		/// <returns>　０：成功\n－１：コンパイルエラー</returns>
+		static S32 Compile(const ShaderCompileDesc& desc, ArrayList<Byte>& dest, String& errorDest, ShaderCache* cache);
+
 		/// <summary>
 		/// シェーダーで使用される変数の型ごとの使用メモリサイズを調べる
 		/// </summary>
@@ -67,7 +134,8 @@ namespace og
 		/// <param name="path">ファイルパス</param>
 		/// <param name="type">シェーダーステージ</param>
 		/// <param name="errorDest">エラー出力先文字列</param>
+		/// <param name="cache">コンパイル結果のキャッシュ。コンパイル済みのファイルには使わない</param>
 		/// <returns>シェーダーオブジェクトのスマートポインタ</returns>
-		static UPtr<Shader> LoadFromFile(const String& path, const ShaderType type, String& errorDest);
+		static UPtr<Shader> LoadFromFile(const String& path, const ShaderType type, String& errorDest, ShaderCache* cache = nullptr);
 	};
 }
\ No newline at end of file
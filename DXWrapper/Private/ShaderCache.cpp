@@ -0,0 +1,305 @@
+﻿#include "pch.h"
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+
+#include "Platform.h"
+#include "DXHelper.h"
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	/// <summary>
+	/// キャッシュファイルの先頭に置くヘッダ
+	/// </summary>
+	struct CacheFileHeader
+	{
+		U32 magic;
+		U32 version;
+		U64 dataSize;
+		U64 dataHash;
+	};
+
+	const U32 CACHE_FILE_MAGIC = 0x4353474F;	// "OGSC"
+	const U32 CACHE_FILE_VERSION = 1;
+
+	/// <summary>
+	/// 拡張子を除いたファイル名の長さ(64bitの16進数)
+	/// </summary>
+	const size_t KEY_NAME_LENGTH = 16;
+
+	/// <summary>
+	/// 長さを先頭に付けて文字列をハッシュに加える。区切りの位置が違う組み合わせを区別するため
+	/// </summary>
+	inline U64 HashString(U64 hash, const String& str)
+	{
+		const U64 size = str.size();
+		hash = HashBytes(hash, &size, sizeof(size));
+		return HashBytes(hash, str.data(), str.size());
+	}
+
+	/// <summary>
+	/// "<16桁の16進数>.cso"のファイル名からキーを取り出す
+	/// </summary>
+	/// <returns>　０：成功\n－１：キャッシュファイルの名前ではない</returns>
+	S32 ParseFileName(const String& name, U64& key)
+	{
+		if (name.size() != KEY_NAME_LENGTH + 4 || name.compare(KEY_NAME_LENGTH, 4, TC(".cso")) != 0)return -1;
+
+		key = 0;
+		for (size_t i = 0; i < KEY_NAME_LENGTH; i++)
+		{
+			const Char c = name[i];
+			U64 digit;
+			if ('0' <= c && c <= '9')digit = c - '0';
+			else if ('a' <= c && c <= 'f')digit = c - 'a' + 10;
+			else return -1;
+			key = (key << 4) | digit;
+		}
+		return 0;
+	}
+
+	inline bool IsTemporaryFile(const String& name)
+	{
+		return 4 <= name.size() && name.compare(name.size() - 4, 4, TC(".tmp")) == 0;
+	}
+}
+
+namespace og
+{
+	ShaderCache::ShaderCache(const SPtr<IShaderCompiler>& compiler, const Path& directory, const U64 maxBytes)
+		:m_compiler(compiler), m_directory(directory.ToString()), m_maxBytes(maxBytes), m_isEnabled(false)
+	{
+		if (m_compiler == nullptr)return;
+		m_compilerVersion = m_compiler->GetVersion();
+
+		// ファイル名を連結するため末尾の区切り文字を除く
+		while (!m_directory.empty() && m_directory.back() == '/')m_directory.pop_back();
+
+		if (directory.IsValid() == false || Platform::MakeDirectory(directory) == -1)return;
+		m_isEnabled = true;
+
+		ArrayList<FileEntry> entries;
+		Platform::EnumerateDirectory(directory, entries);
+		for (auto& entry : entries)
+		{
+			if (entry.isDirectory)continue;
+
+			// 書き込み中に終了した一時ファイルを消す
+			if (IsTemporaryFile(entry.name))
+			{
+				Platform::RemoveFile(Path(m_directory + TC("/") + entry.name));
+				continue;
+			}
+
+			U64 key;
+			if (ParseFileName(entry.name, key) == -1)continue;
+
+			FileInfo info;
+			info.size = entry.size;
+			info.lastUse = entry.lastWriteTime;
+			m_files[key] = info;
+			m_statistics.totalBytes += entry.size;
+		}
+
+		if (m_maxBytes < m_statistics.totalBytes)Evict(0);
+	}
+
+	//===================================================================================//
+
+	S32 ShaderCache::Compile(const ShaderCompileDesc& desc, ArrayList<Byte>& dest, String& errorDest)
+	{
+		if (m_compiler == nullptr)return -1;
+		if (m_isEnabled == false)return m_compiler->Compile(desc, dest, errorDest);
+
+		const U64 key = ComputeKey(desc);
+		if (ReadFile(key, dest) == 0)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_statistics.hits++;
+			return 0;
+		}
+
+		if (m_compiler->Compile(desc, dest, errorDest) == -1)return -1;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_statistics.misses++;
+		}
+
+		// 保存に失敗してもコンパイル結果は使える
+		WriteFile(key, dest);
+		return 0;
+	}
+
+	//===================================================================================//
+
+	U64 ShaderCache::ComputeKey(const ShaderCompileDesc& desc)const
+	{
+		U64 hash = HASH_OFFSET_BASIS;
+		hash = HashString(hash, m_compilerVersion);
+		hash = HashString(hash, desc.entryPoint);
+		hash = HashString(hash, desc.target);
+		hash = HashBytes(hash, &desc.flags, sizeof(desc.flags));
+
+		const U64 defineCount = desc.defines.size();
+		hash = HashBytes(hash, &defineCount, sizeof(defineCount));
+		for (auto& define : desc.defines)
+		{
+			hash = HashString(hash, define.first);
+			hash = HashString(hash, define.second);
+		}
+		return HashString(hash, desc.source);
+	}
+
+	//===================================================================================//
+
+	ShaderCacheStatistics ShaderCache::GetStatistics()const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_statistics;
+	}
+
+	//===================================================================================//
+
+	String ShaderCache::GetFilePath(const U64 key)const
+	{
+		Char name[32];
+		Platform::FormatString(name, 32, TC("/%016llx.cso"), (unsigned long long)key);
+		return m_directory + name;
+	}
+
+	//===================================================================================//
+
+	S32 ShaderCache::ReadFile(const U64 key, ArrayList<Byte>& dest)
+	{
+		const String path = GetFilePath(key);
+
+		std::ifstream stream(path.c_str(), std::ios::binary);
+		if (!stream)return -1;
+
+		stream.seekg(0, std::ios::end);
+		const U64 fileSize = (U64)stream.tellg();
+		stream.seekg(0, std::ios::beg);
+
+		// 途中で切れたファイルや別の形式のファイルは使わない
+		CacheFileHeader header;
+		bool isValid = false;
+		if (sizeof(header) <= fileSize && stream.read((char*)&header, sizeof(header))
+			&& header.magic == CACHE_FILE_MAGIC && header.version == CACHE_FILE_VERSION && header.dataSize == fileSize - sizeof(header))
+		{
+			dest.resize((size_t)header.dataSize);
+			isValid = stream.read((char*)dest.data(), dest.size())
+				&& HashBytes(HASH_OFFSET_BASIS, dest.data(), dest.size()) == header.dataHash;
+		}
+		stream.close();
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto found = m_files.find(key);
+		if (isValid == false)
+		{
+			// 壊れたファイルは消してコンパイルし直す
+			Platform::RemoveFile(Path(path));
+			if (found != m_files.end())
+			{
+				m_statistics.totalBytes -= found->second.size;
+				m_files.erase(found);
+			}
+			dest.clear();
+			return -1;
+		}
+
+		// 使用順を次回以降にも引き継ぐため更新時刻も更新する
+		const S64 now = (S64)std::time(nullptr);
+		Platform::TouchFile(Path(path));
+		if (found != m_files.end())
+		{
+			found->second.lastUse = now;
+		}
+		else
+		{
+			// 他のプロセスが書き込んだファイル
+			FileInfo info;
+			info.size = sizeof(header) + dest.size();
+			info.lastUse = now;
+			m_files[key] = info;
+			m_statistics.totalBytes += info.size;
+		}
+		return 0;
+	}
+
+	//===================================================================================//
+
+	S32 ShaderCache::WriteFile(const U64 key, const ArrayList<Byte>& data)
+	{
+		const String path = GetFilePath(key);
+
+		// 同じシェーダを同時に書き込むスレッドと重ならないよう、スレッドごとに別の一時ファイルに書く
+		Char suffix[32];
+		Platform::FormatString(suffix, 32, TC(".%llu.tmp"), (unsigned long long)Platform::GetCurrentThreadID());
+		const String temporaryPath = path + suffix;
+
+		CacheFileHeader header;
+		header.magic = CACHE_FILE_MAGIC;
+		header.version = CACHE_FILE_VERSION;
+		header.dataSize = data.size();
+		header.dataHash = HashBytes(HASH_OFFSET_BASIS, data.data(), data.size());
+
+		{
+			std::ofstream stream(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+			if (!stream)return -1;
+			stream.write((const char*)&header, sizeof(header));
+			stream.write((const char*)data.data(), data.size());
+			stream.close();
+			if (!stream)
+			{
+				Platform::RemoveFile(Path(temporaryPath));
+				return -1;
+			}
+		}
+
+		if (Platform::RenameFile(Path(temporaryPath), Path(path)) == -1)
+		{
+			Platform::RemoveFile(Path(temporaryPath));
+			return -1;
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto& info = m_files[key];
+		m_statistics.totalBytes -= info.size;
+		info.size = sizeof(header) + data.size();
+		info.lastUse = (S64)std::time(nullptr);
+		m_statistics.totalBytes += info.size;
+
+		if (m_maxBytes < m_statistics.totalBytes)Evict(key);
+		return 0;
+	}
+
+	//===================================================================================//
+
+	void ShaderCache::Evict(const U64 keep)
+	{
+		// 上限ちょうどまでしか消さないと毎回削除が起きるため、上限の3/4まで減らす
+		const U64 targetBytes = m_maxBytes - m_maxBytes / 4;
+
+		ArrayList<std::pair<S64, U64>> order;
+		order.reserve(m_files.size());
+		for (auto& file : m_files)order.emplace_back(file.second.lastUse, file.first);
+		std::sort(order.begin(), order.end());
+
+		for (auto& item : order)
+		{
+			if (m_statistics.totalBytes <= targetBytes)break;
+			if (item.second == keep)continue;
+
+			Platform::RemoveFile(Path(GetFilePath(item.second)));
+			auto found = m_files.find(item.second);
+			m_statistics.totalBytes -= found->second.size;
+			m_files.erase(found);
+			m_statistics.evictions++;
+		}
+	}
+}
\ No newline at end of file
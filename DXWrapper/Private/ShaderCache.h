@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include <mutex>
+
+#include "IShaderCompiler.h"
+
+namespace og
+{
+	/// <summary>
+	/// シェーダキャッシュの集計
+	/// </summary>
+	struct ShaderCacheStatistics
+	{
+		/// <summary> キャッシュから読み込んだ回数 </summary>
+		U64 hits = 0;
+		/// <summary> コンパイルした回数。コンパイルエラーは含まない </summary>
+		U64 misses = 0;
+		/// <summary> 容量を超えたため削除したファイルの数 </summary>
+		U64 evictions = 0;
+		/// <summary> キャッシュディレクトリのファイルの合計バイト数 </summary>
+		U64 totalBytes = 0;
+	};
+
+
+	/// <summary>
+	/// コンパイル済みシェーダのディスクキャッシュ
+	/// </summary>
+	/// <remarks>
+	/// ソースコード、エントリポイント、ターゲット、マクロ、フラグ、コンパイラのバージョンのハッシュをキーとして、
+	/// バイトコードをキャッシュディレクトリに1ファイルずつ保存する。内容が同じシェーダはファイルパスに関わらず同じキーになる。
+	/// 書き込みは一時ファイルに書いてから名前を変更するため、途中で終了しても壊れたファイルは残らない。
+	/// 合計サイズが上限を超えると最も長く使われていないファイルから削除する。使用順はファイルの更新時刻で次回以降にも引き継ぐ。
+	/// 複数のスレッドから同時に呼び出せる。
+	/// </remarks>
+	class ShaderCache
+	{
+	private:
+		struct FileInfo
+		{
+			U64 size;
+			S64 lastUse;
+		};
+
+	private:
+		SPtr<IShaderCompiler> m_compiler;
+		String m_compilerVersion;
+		String m_directory;
+		U64 m_maxBytes;
+		bool m_isEnabled;
+
+		mutable std::mutex m_mutex;
+		HashMap<U64, FileInfo> m_files;
+		ShaderCacheStatistics m_statistics;
+
+	public:
+		/// <summary>
+		/// キャッシュディレクトリを開く。ディレクトリがなければ作成する
+		/// </summary>
+		/// <remarks>
+		/// ディレクトリを作成できない場合はキャッシュを使わずに毎回コンパイルする。
+		/// </remarks>
+		/// <param name="compiler">キャッシュにない場合に使うコンパイラ</param>
+		/// <param name="directory">キャッシュディレクトリ</param>
+		/// <param name="maxBytes">キャッシュディレクトリの合計サイズの上限</param>
+		ShaderCache(const SPtr<IShaderCompiler>& compiler, const Path& directory, const U64 maxBytes);
+
+		/// <summary>
+		/// キャッシュにあれば読み込み、なければコンパイルしてキャッシュに保存する
+		/// </summary>
+		/// <param name="desc">コンパイル条件</param>
+		/// <param name="dest">バイトコードの出力先</param>
+		/// <param name="errorDest">エラー出力先文字列</param>
+		/// <returns>　０：成功\n－１：コンパイルエラー</returns>
+		S32 Compile(const ShaderCompileDesc& desc, ArrayList<Byte>& dest, String& errorDest);
+
+		/// <summary>
+		/// コンパイル条件からキャッシュのキーを求める
+		/// </summary>
+		U64 ComputeKey(const ShaderCompileDesc& desc)const;
+
+		ShaderCacheStatistics GetStatistics()const;
+
+	private:
+		String GetFilePath(const U64 key)const;
+		S32 ReadFile(const U64 key, ArrayList<Byte>& dest);
+		S32 WriteFile(const U64 key, const ArrayList<Byte>& data);
+		void Evict(const U64 keep);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+﻿#include "pch.h"
+#include "ShaderCompileQueue.h"
+#include "Shader.h"
+
+#include "Platform.h"
+
+namespace og
+{
+	ShaderCompileQueue::ShaderCompileQueue(ShaderCache* cache)
+		:m_cache(cache), m_exit(false)
+	{
+		U32 processorCount = Platform::GetProcessorCount();
+		U32 workerCount = 1 < processorCount ? processorCount - 1 : 1;
+
+		for (U32 i = 0; i < workerCount; i++)
+		{
+			auto thread = MUPtr<Thread>();
+			if (thread->Start([this]() { WorkerMain(); }) != 0)break;
+			m_threads.push_back(std::move(thread));
+		}
+	}
+
+	ShaderCompileQueue::~ShaderCompileQueue()
+	{
+		std::deque<Job> jobs;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_exit = true;
+			jobs.swap(m_jobs);
+		}
+		m_wake.notify_all();
+		for (auto& thread : m_threads)thread->Join();
+
+		// 待っている側が止まらないように、残りは失敗で終わらせる
+		for (auto& job : jobs)job.shader->Fail(TC("shader compile queue was destroyed"));
+	}
+
+	//===================================================================================//
+
+	void ShaderCompileQueue::Push(const SPtr<Shader>& shader, const ShaderCompileDesc& desc)
+	{
+		Job job = { shader, desc };
+		if (m_threads.empty())
+		{
+			Run(job);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_jobs.push_back(std::move(job));
+		}
+		m_wake.notify_one();
+	}
+
+	//===================================================================================//
+
+	void ShaderCompileQueue::WorkerMain()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (true)
+		{
+			m_wake.wait(lock, [&]() { return m_exit || !m_jobs.empty(); });
+			if (m_exit)break;
+
+			Job job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+
+			lock.unlock();
+			Run(job);
+			lock.lock();
+		}
+	}
+
+	void ShaderCompileQueue::Run(Job& job)
+	{
+		ArrayList<Byte> bytecode;
+		String errorLog;
+		if (Shader::Compile(job.desc, bytecode, errorLog, m_cache) == -1)
+		{
+			job.shader->Fail(errorLog);
+			return;
+		}
+		job.shader->Complete(bytecode);
+	}
+}
\ No newline at end of file
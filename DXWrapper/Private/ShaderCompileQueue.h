@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include "IShaderCompiler.h"
+#include "Thread.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace og
+{
+	class Shader;
+	class ShaderCache;
+
+	/// <summary>
+	/// シェーダーをワーカースレッドでコンパイルするキュー
+	/// </summary>
+	/// <remarks>
+	/// ワーカースレッドは(論理プロセッサ数 - 1)個、最低1個生成される。
+	/// コンパイルが終わるとワーカースレッドでShader::CompleteかShader::Failが呼ばれる。
+	/// 破棄したときに残っているコンパイルは失敗になる。
+	/// </remarks>
+	class ShaderCompileQueue
+	{
+	public:
+		/// <param name="cache">コンパイル結果のキャッシュ。nullptrの場合は毎回コンパイルする</param>
+		ShaderCompileQueue(ShaderCache* cache);
+		~ShaderCompileQueue();
+
+		/// <summary>
+		/// コンパイル中のシェーダーをキューに追加する
+		/// </summary>
+		/// <remarks>
+		/// ワーカースレッドを生成できなかった場合はその場でコンパイルする。
+		/// </remarks>
+		void Push(const SPtr<Shader>& shader, const ShaderCompileDesc& desc);
+
+	private:
+		struct Job
+		{
+			SPtr<Shader> shader;
+			ShaderCompileDesc desc;
+		};
+
+		ShaderCache* m_cache;
+
+		ArrayList<UPtr<Thread>> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::deque<Job> m_jobs;
+		bool m_exit;
+
+		void WorkerMain();
+		void Run(Job& job);
+
+		ShaderCompileQueue(const ShaderCompileQueue&) = delete;
+		ShaderCompileQueue& operator=(const ShaderCompileQueue&) = delete;
+	};
+}
\ No newline at end of file
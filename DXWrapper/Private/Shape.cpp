@@ -7,20 +7,21 @@
 
 namespace og
 {
-	Shape::Shape(const U32 stribeSize) :ms_stribeSize(stribeSize), m_isChanged(false)
+	Shape::Shape(const U32 stribeSize) :ms_stribeSize(stribeSize), m_vertexBufferSize(0), m_indexBufferSize(0), m_isChanged(false), m_isIndexChanged(false)
 	{
 		assert(0 < stribeSize);
 	}
 
 
-	S32 Shape::Draw(ComPtr<ID3D12GraphicsCommandList>& commandList, const U32 count)
+	S32 Shape::Draw(ComPtr<ID3D12GraphicsCommandList>& commandList, const U32 count, const U32 firstInstance)
 	{
 		if (CheckArgs(commandList))return -1;
 
-		if (m_isChanged)
+		if (m_isChanged || m_isIndexChanged)
 		{
 			CreateResource();
 			m_isChanged = false;
+			m_isIndexChanged = false;
 		}
 
 		if (IsValid() == false) return -1;
@@ -32,11 +33,11 @@ namespace og
 		if (m_indexBuffer)
 		{
 			commandList->IASetIndexBuffer(&m_indexBufferView);
-			commandList->DrawIndexedInstanced((UINT)m_indices.size(), count, 0, 0, 0);
+			commandList->DrawIndexedInstanced((UINT)m_indices.size(), count, 0, 0, firstInstance);
 		}
 		else
 		{
-			commandList->DrawInstanced((UINT)m_indices.size(), 1, 0, 0);
+			commandList->DrawInstanced((UINT)GetVertexCount(), count, 0, firstInstance);
 		}
 
 
@@ -44,6 +45,23 @@ namespace og
 		return 0;
 	}
 
+	S32 Shape::SetInstanceBuffer(ComPtr<ID3D12GraphicsCommandList>& commandList)
+	{
+		if (CheckArgs(commandList))return -1;
+
+		if (m_isChanged || m_isIndexChanged)
+		{
+			CreateResource();
+			m_isChanged = false;
+			m_isIndexChanged = false;
+		}
+
+		if (IsValid() == false) return -1;
+
+		commandList->IASetVertexBuffers(1, 1, &m_vertexBufferView);
+		return 0;
+	}
+
 
 
 	S32 Shape::Vertex(const Byte* bytes, const U32 size)
@@ -62,7 +80,7 @@ namespace og
 		m_indices.push_back(index1);
 		m_indices.push_back(index2);
 		m_indices.push_back(index3);
-		m_isChanged = true;
+		m_isIndexChanged = true;
 		return 0;
 	}
 	S32 Shape::Indices(const U32* indices, const U32 count)
@@ -71,6 +89,18 @@ namespace og
 		U32 currentSize = (U32)m_indices.size();
 		m_indices.resize(currentSize + count);
 		memcpy_s(m_indices.data() + currentSize, sizeof(U32) * count, indices, sizeof(U32) * count);
+		m_isIndexChanged = true;
+		return 0;
+	}
+
+	Byte* Shape::LockVertices()
+	{
+		if (m_data.empty())return nullptr;
+		return m_data.data();
+	}
+
+	S32 Shape::UnlockVertices()
+	{
 		m_isChanged = true;
 		return 0;
 	}
@@ -87,86 +117,95 @@ namespace og
 	{
 		return (S32)m_indices.size();
 	}
+	const Byte* Shape::GetVertices()
+	{
+		return m_data.empty() ? nullptr : m_data.data();
+	}
+	const U32* Shape::GetIndices()
+	{
+		return m_indices.empty() ? nullptr : m_indices.data();
+	}
+	S32 Shape::Optimize(const MeshOptimizeSettings& settings, MeshOptimizeReport* report)
+	{
+		if (MeshOptimizer::Optimize(m_data, m_indices, ms_stribeSize, settings, report))return -1;
+		m_isChanged = true;
+		m_isIndexChanged = true;
+		return 0;
+	}
 
 
 
 	S32 Shape::CreateResource()
 	{
-		D3D12_HEAP_PROPERTIES heapprop = {};
-		heapprop.Type = D3D12_HEAP_TYPE_UPLOAD;
-		heapprop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-		heapprop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-
-		D3D12_RESOURCE_DESC resdesc = {};
-		resdesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-		resdesc.Width = m_data.size();
-		resdesc.Height = 1;
-		resdesc.DepthOrArraySize = 1;
-		resdesc.MipLevels = 1;
-		resdesc.Format = DXGI_FORMAT_UNKNOWN;
-		resdesc.SampleDesc.Count = 1;
-		resdesc.Flags = D3D12_RESOURCE_FLAG_NONE;
-		resdesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-
-
-		ComPtr<ID3D12Resource> vertexBuffer;
-
-		//UPLOAD(確保は可能)
-		auto result = DX12Wrapper::ms_device->CreateCommittedResource(
-			&heapprop,
-			D3D12_HEAP_FLAG_NONE,
-			&resdesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(vertexBuffer.ReleaseAndGetAddressOf()));
-
-		if (FAILED(result))
+		if (m_isChanged)
 		{
-			return -1;
-		}
+			if (UploadBuffer(m_vertexBuffer, m_vertexBufferSize, m_data.data(), m_data.size()))return -1;
 
+			m_vertexBufferView.BufferLocation = m_vertexBuffer->GetGPUVirtualAddress();//バッファの仮想アドレス
+			m_vertexBufferView.SizeInBytes = (UINT)m_data.size();//全バイト数
+			m_vertexBufferView.StrideInBytes = ms_stribeSize;//1頂点あたりのバイト数
+		}
 
-		Byte* vertMap = nullptr;
-		result = vertexBuffer->Map(0, nullptr, (void**)&vertMap);
+		// インデックス指定がある場合
+		if (m_isIndexChanged && !m_indices.empty())
+		{
+			if (UploadBuffer(m_indexBuffer, m_indexBufferSize, m_indices.data(), sizeof(U32) * m_indices.size()))return -1;
 
-		memcpy_s(vertMap, m_data.size(), m_data.data(), m_data.size());
+			//インデックスバッファビューを作成
+			m_indexBufferView.BufferLocation = m_indexBuffer->GetGPUVirtualAddress();
+			m_indexBufferView.Format = DXGI_FORMAT_R32_UINT;
+			m_indexBufferView.SizeInBytes = sizeof(U32) * (U32)m_indices.size();
+		}
 
-		vertexBuffer->Unmap(0, nullptr);
+		return 0;
+	}
 
-		m_vertexBufferView.BufferLocation = vertexBuffer->GetGPUVirtualAddress();//バッファの仮想アドレス
-		m_vertexBufferView.SizeInBytes = (UINT)m_data.size();//全バイト数
-		m_vertexBufferView.StrideInBytes = ms_stribeSize;//1頂点あたりのバイト数
+	S32 Shape::UploadBuffer(ComPtr<ID3D12Resource>& buffer, U64& bufferSize, const void* data, const U64 size)
+	{
+		if (size == 0)return -1;
 
-		if (m_indices.empty())
+		// 同じサイズのバッファがあれば内容だけ書き換える。
+		// フレームの終わりでGPUの完了を待っているため、描画中のバッファを上書きすることはない。
+		if (buffer == nullptr || bufferSize != size)
 		{
-			m_vertexBuffer = vertexBuffer;
-			return 0;
+			D3D12_HEAP_PROPERTIES heapprop = {};
+			heapprop.Type = D3D12_HEAP_TYPE_UPLOAD;
+			heapprop.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+			heapprop.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+
+			D3D12_RESOURCE_DESC resdesc = {};
+			resdesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+			resdesc.Width = size;
+			resdesc.Height = 1;
+			resdesc.DepthOrArraySize = 1;
+			resdesc.MipLevels = 1;
+			resdesc.Format = DXGI_FORMAT_UNKNOWN;
+			resdesc.SampleDesc.Count = 1;
+			resdesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+			resdesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+
+			//UPLOAD(確保は可能)
+			auto result = DX12Wrapper::ms_device->CreateCommittedResource(
+				&heapprop,
+				D3D12_HEAP_FLAG_NONE,
+				&resdesc,
+				D3D12_RESOURCE_STATE_GENERIC_READ,
+				nullptr,
+				IID_PPV_ARGS(buffer.ReleaseAndGetAddressOf()));
+
+			if (FAILED(result))
+			{
+				bufferSize = 0;
+				return -1;
+			}
+			bufferSize = size;
 		}
-		// インデックス指定がある場合
-
-		resdesc.Width = sizeof(U32) * m_indices.size();
-		result = DX12Wrapper::ms_device->CreateCommittedResource(
-			&heapprop,
-			D3D12_HEAP_FLAG_NONE,
-			&resdesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(m_indexBuffer.ReleaseAndGetAddressOf()));
-
-		//作ったバッファにインデックスデータをコピー
-		U32* mappedIdx = nullptr;
-		m_indexBuffer->Map(0, nullptr, (void**)&mappedIdx);
-		memcpy_s(mappedIdx, sizeof(U32) * m_indices.size(), m_indices.data(), sizeof(U32) * m_indices.size());
-
-		m_indexBuffer->Unmap(0, nullptr);
-
-		//インデックスバッファビューを作成
-		m_indexBufferView.BufferLocation = m_indexBuffer->GetGPUVirtualAddress();
-		m_indexBufferView.Format = DXGI_FORMAT_R32_UINT;
-		m_indexBufferView.SizeInBytes = sizeof(U32) * (U32)m_indices.size();
 
+		Byte* mapped = nullptr;
+		if (FAILED(buffer->Map(0, nullptr, (void**)&mapped)))return -1;
+		memcpy_s(mapped, (size_t)size, data, (size_t)size);
+		buffer->Unmap(0, nullptr);
 
-		m_vertexBuffer = vertexBuffer;
 		return 0;
 	}
 }
\ No newline at end of file
@@ -21,12 +21,22 @@ namespace og
 		ArrayList<Byte> m_data;
 		ArrayList<U32> m_indices;
 
+		// GPUバッファの作成時のサイズ(同じサイズなら再利用する)
+		U64 m_vertexBufferSize;
+		U64 m_indexBufferSize;
+
 		bool m_isChanged;
+		bool m_isIndexChanged;
 
 	public:
 		Shape(const U32 stribeSize);
 
-		S32 Draw(ComPtr<ID3D12GraphicsCommandList>& commandList, const U32 count = 1);
+		S32 Draw(ComPtr<ID3D12GraphicsCommandList>& commandList, const U32 count = 1, const U32 firstInstance = 0);
+
+		/// <summary>
+		/// 頂点データをインスタンスごとのデータとしてスロット1に設定する
+		/// </summary>
+		S32 SetInstanceBuffer(ComPtr<ID3D12GraphicsCommandList>& commandList);
 
 		inline bool IsValid()const { return m_vertexBuffer != nullptr; }
 
@@ -35,11 +45,18 @@ namespace og
 		S32 Indices(const U32 index1, const U32 index2, const U32 index3)override;
 		S32 Indices(const U32* indices, const U32 count)override;
 
+		Byte* LockVertices()override;
+		S32 UnlockVertices()override;
+
 		S32 GetStribeSize()override;
 		S32 GetVertexCount()override;
 		S32 GetIndexCount()override;
+		const Byte* GetVertices()override;
+		const U32* GetIndices()override;
+		S32 Optimize(const MeshOptimizeSettings& settings, MeshOptimizeReport* report)override;
 	private:
 		S32 CreateResource();
+		S32 UploadBuffer(ComPtr<ID3D12Resource>& buffer, U64& bufferSize, const void* data, const U64 size);
 
 	};
 }
\ No newline at end of file
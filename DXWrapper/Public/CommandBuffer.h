@@ -0,0 +1,498 @@
+﻿#pragma once
+#include "ICommandBuffer.h"
+
+#include <algorithm>
+
+#include "IGraphicWrapper.h"
+
+namespace og
+{
+	/// <summary>
+	/// コマンドを連続したメモリに記録するコマンドバッファ
+	/// </summary>
+	/// <remarks>
+	/// グラフィックAPIに依存しないため、どのラッパーで作成したリソースにも使える。
+	/// Resetしてもメモリは解放しないため、毎フレーム同じコマンドバッファを使い回すと確保が発生しない。
+	/// DrawInstanceを使う場合は、インスタンスのバッファを作成するためにラッパーを指定して生成する。
+	/// インスタンスのバッファはExecuteごとにINSTANCE_BUFFER_COUNT個を順に使うため、GPUが描画を終えるまでに
+	/// 同じコマンドバッファをExecuteできるのはINSTANCE_BUFFER_COUNT回まで。それを超えると描画前のインスタンスのデータが上書きされる。
+	/// </remarks>
+	class CommandBuffer :public ICommandBuffer
+	{
+	public:
+		/// <summary> コマンドのバイトサイズはこの倍数に揃える </summary>
+		static const U32 COMMAND_ALIGNMENT = 8;
+		/// <summary> これより少ない描画は基数ソートではなくstd::stable_sortで整列する </summary>
+		static const size_t RADIX_SORT_THRESHOLD = 64;
+		/// <summary> インスタンスのバッファを順に使い回す数。GPUが描画を終えるまでにExecuteできる回数 </summary>
+		static const U32 INSTANCE_BUFFER_COUNT = 3;
+	private:
+		struct SortItem
+		{
+			U64 key;
+			U32 index;
+		};
+
+		/// <summary>
+		/// 1回のインスタンス描画にまとめる描画
+		/// </summary>
+		struct InstanceGroup
+		{
+			U32 instanceSize;
+			U32 firstInstance;
+			U32 instanceCount;
+			/// <summary> まとめた描画コマンドの数 </summary>
+			U32 drawCount;
+		};
+
+		/// <summary>
+		/// 1インスタンスのサイズごとのインスタンスのバッファ
+		/// </summary>
+		struct InstanceBuffer
+		{
+			ArrayList<Byte> data;
+			SPtr<IShape> shapes[INSTANCE_BUFFER_COUNT];
+		};
+
+		/// <summary>
+		/// コマンドから番号で参照するリソースの表
+		/// </summary>
+		template<class T>
+		class ResourceTable
+		{
+		private:
+			ArrayList<SPtr<T>> m_resources;
+			HashMap<const T*, U32> m_indices;
+
+		public:
+			/// <summary>
+			/// リソースを表に追加する。追加済みの場合は同じ番号を返す
+			/// </summary>
+			U32 Add(const SPtr<T>& resource)
+			{
+				auto itr = m_indices.find(resource.get());
+				if (itr != m_indices.end())return itr->second;
+
+				const U32 index = (U32)m_resources.size();
+				m_resources.push_back(resource);
+				m_indices[resource.get()] = index;
+				return index;
+			}
+
+			inline SPtr<T>& Get(const U32 index) { return m_resources[index]; }
+
+			void Clear()
+			{
+				m_resources.clear();
+				m_indices.clear();
+			}
+		};
+
+		IGraphicWrapper* m_wrapper;
+
+		ArrayList<Byte> m_data;
+		U32 m_commandCount;
+		// DrawInstanceで記録したインスタンスのデータ
+		ArrayList<Byte> m_instanceData;
+
+		ResourceTable<IRenderTexture> m_targets;
+		ResourceTable<IGraphicPipeline> m_pipelines;
+		ResourceTable<IMaterial> m_materials;
+		ResourceTable<IShape> m_shapes;
+
+		// 記録中の状態
+		U32 m_target;
+		U32 m_pipeline;
+		U32 m_material;
+		U32 m_pass;
+		bool m_backToFront;
+
+		// 自動インスタンシング
+		bool m_useAutoInstancing;
+		ArrayList<InstanceGroup> m_instanceGroups;
+		HashMap<U32, InstanceBuffer> m_instanceBuffers;
+		// 今回のExecuteで使うインスタンスのバッファの番号
+		U32 m_instanceBufferIndex;
+
+		// 並べ替えの作業領域
+		ArrayList<DrawCommand> m_sortDraws;
+		ArrayList<DrawCommand> m_sortDrawsScratch;
+		ArrayList<U32> m_sortOffsets;
+		ArrayList<SortItem> m_sortItems;
+		ArrayList<SortItem> m_sortScratch;
+
+	public:
+		/// <param name="wrapper">インスタンスのバッファの作成に使うラッパー。DrawInstanceを使わない場合はnullptrでよい</param>
+		explicit CommandBuffer(IGraphicWrapper* wrapper = nullptr)
+			:m_wrapper(wrapper), m_commandCount(0), m_target(INVALID_COMMAND_RESOURCE), m_pipeline(INVALID_COMMAND_RESOURCE), m_material(INVALID_COMMAND_RESOURCE),
+			m_pass(0), m_backToFront(false), m_useAutoInstancing(true), m_instanceBufferIndex(0) {}
+
+		S32 BeginDraw(const SPtr<IRenderTexture>& target)override
+		{
+			if (CheckArgs(!!target))return -1;
+			if (m_target != INVALID_COMMAND_RESOURCE)return -1;
+
+			m_target = m_targets.Add(target);
+			m_pipeline = INVALID_COMMAND_RESOURCE;
+			m_material = INVALID_COMMAND_RESOURCE;
+			m_pass = 0;
+			m_backToFront = false;
+
+			auto& command = Allocate<BeginDrawCommand>(CommandType::BEGIN_DRAW);
+			command.target = m_target;
+			return 0;
+		}
+
+		S32 EndDraw()override
+		{
+			if (m_target == INVALID_COMMAND_RESOURCE)return -1;
+
+			auto& command = Allocate<EndDrawCommand>(CommandType::END_DRAW);
+			command.target = m_target;
+			m_target = INVALID_COMMAND_RESOURCE;
+			return 0;
+		}
+
+		S32 SetClearColor(const SPtr<IRenderTexture>& target, const Color& color)override
+		{
+			if (CheckArgs(!!target))return -1;
+
+			auto& command = Allocate<SetClearColorCommand>(CommandType::SET_CLEAR_COLOR);
+			command.target = m_targets.Add(target);
+			command.color[0] = color.r;
+			command.color[1] = color.g;
+			command.color[2] = color.b;
+			command.color[3] = color.a;
+			return 0;
+		}
+
+		S32 SetGraphicPipeline(const SPtr<IGraphicPipeline>& pipeline)override
+		{
+			if (CheckArgs(!!pipeline))return -1;
+			m_pipeline = m_pipelines.Add(pipeline);
+			return 0;
+		}
+
+		S32 SetMaterial(const SPtr<IMaterial>& material)override
+		{
+			if (CheckArgs(!!material))return -1;
+			m_material = m_materials.Add(material);
+			return 0;
+		}
+
+		S32 SetPass(const U32 pass, const bool backToFront = false)override
+		{
+			if (0xFF < pass)return -1;
+			m_pass = pass;
+			m_backToFront = backToFront;
+			return 0;
+		}
+
+		S32 DrawInstanced(const SPtr<IShape>& shape, const U32 count = 1, const F32 depth = 0.0f)override
+		{
+			if (CheckArgs(!!shape))return -1;
+			if (m_target == INVALID_COMMAND_RESOURCE || m_pipeline == INVALID_COMMAND_RESOURCE)return -1;
+
+			auto& command = Allocate<DrawCommand>(CommandType::DRAW);
+			command.target = m_target;
+			command.pipeline = m_pipeline;
+			command.material = m_material;
+			command.shape = m_shapes.Add(shape);
+			command.instanceCount = count;
+			command.instanceOffset = 0;
+			command.instanceSize = 0;
+			command.sortKey = DrawSortKey::Make(m_target, m_pass, m_pipeline, m_material, command.shape, depth, m_backToFront);
+			return 0;
+		}
+
+		S32 DrawInstance(const SPtr<IShape>& shape, const void* instanceData, const U32 instanceSize, const F32 depth = 0.0f)override
+		{
+			if (CheckArgs(!!shape, instanceData, 0 < instanceSize, m_wrapper))return -1;
+			if (m_target == INVALID_COMMAND_RESOURCE || m_pipeline == INVALID_COMMAND_RESOURCE)return -1;
+
+			auto& command = Allocate<DrawCommand>(CommandType::DRAW);
+			command.target = m_target;
+			command.pipeline = m_pipeline;
+			command.material = m_material;
+			command.shape = m_shapes.Add(shape);
+			command.instanceCount = 1;
+			command.instanceOffset = (U32)m_instanceData.size();
+			command.instanceSize = instanceSize;
+			command.sortKey = DrawSortKey::Make(m_target, m_pass, m_pipeline, m_material, command.shape, depth, m_backToFront);
+
+			auto bytes = reinterpret_cast<const Byte*>(instanceData);
+			m_instanceData.insert(m_instanceData.end(), bytes, bytes + instanceSize);
+			return 0;
+		}
+
+		inline void SetAutoInstancing(const bool enable)override { m_useAutoInstancing = enable; }
+
+		//===================================================================================//
+
+		S32 Execute(CommandBufferStatistics* statistics = nullptr)override
+		{
+			if (m_target != INVALID_COMMAND_RESOURCE)return -1;
+			if (PrepareInstances() == -1)return -1;
+
+			CommandBufferStatistics result;
+			U32 pipeline = INVALID_COMMAND_RESOURCE;
+			U32 material = INVALID_COMMAND_RESOURCE;
+			size_t group = 0;
+			S32 error = 0;
+
+			for (U32 offset = 0; offset < m_data.size() && error == 0;)
+			{
+				auto header = reinterpret_cast<const CommandHeader*>(m_data.data() + offset);
+				switch (header->type)
+				{
+				case CommandType::BEGIN_DRAW:
+				{
+					auto command = reinterpret_cast<const BeginDrawCommand*>(header);
+					error = m_targets.Get(command->target)->BeginDraw();
+					// 描画の開始で状態はリセットされる
+					pipeline = INVALID_COMMAND_RESOURCE;
+					material = INVALID_COMMAND_RESOURCE;
+					break;
+				}
+				case CommandType::END_DRAW:
+				{
+					auto command = reinterpret_cast<const EndDrawCommand*>(header);
+					error = m_targets.Get(command->target)->EndDraw();
+					break;
+				}
+				case CommandType::SET_CLEAR_COLOR:
+				{
+					auto command = reinterpret_cast<const SetClearColorCommand*>(header);
+					Color color;
+					color.Set(command->color[0], command->color[1], command->color[2], command->color[3]);
+					m_targets.Get(command->target)->SetClearColor(color);
+					break;
+				}
+				case CommandType::DRAW:
+				{
+					auto command = reinterpret_cast<const DrawCommand*>(header);
+					auto& target = m_targets.Get(command->target);
+					if (command->pipeline != pipeline)
+					{
+						pipeline = command->pipeline;
+						if (target->SetGraphicPipeline(m_pipelines.Get(pipeline)) == -1)error = -1;
+						result.pipelineChanges++;
+					}
+					if (command->material != material && command->material != INVALID_COMMAND_RESOURCE)
+					{
+						material = command->material;
+						if (target->SetMaterial(m_materials.Get(material)) == -1)error = -1;
+						result.materialChanges++;
+					}
+					result.drawCount++;
+
+					if (command->instanceSize == 0)
+					{
+						if (target->DrawInstanced(m_shapes.Get(command->shape), command->instanceCount) == -1)error = -1;
+						break;
+					}
+
+					// まとめた描画はグループの先頭でまとめて描画し、残りは飛ばす
+					const auto& instanceGroup = m_instanceGroups[group++];
+					auto& instances = m_instanceBuffers[instanceGroup.instanceSize].shapes[m_instanceBufferIndex];
+					if (target->DrawInstanced(m_shapes.Get(command->shape), instances, instanceGroup.firstInstance, instanceGroup.instanceCount) == -1)error = -1;
+					for (U32 i = 1; i < instanceGroup.drawCount; i++)
+					{
+						offset += header->size;
+						header = reinterpret_cast<const CommandHeader*>(m_data.data() + offset);
+					}
+					result.mergedDraws += instanceGroup.drawCount - 1;
+					break;
+				}
+				}
+				offset += header->size;
+			}
+
+			if (statistics)*statistics = result;
+			return error;
+		}
+
+		void SortDraws(const std::function<bool(const DrawCommand& a, const DrawCommand& b)>& less)override
+		{
+			ForEachDrawRange([&](ArrayList<DrawCommand>& draws)
+			{
+				std::stable_sort(draws.begin(), draws.end(), less);
+			});
+		}
+
+		void SortDrawsByKey()override
+		{
+			ForEachDrawRange([&](ArrayList<DrawCommand>& draws)
+			{
+				m_sortItems.resize(draws.size());
+				for (size_t i = 0; i < draws.size(); i++)
+				{
+					m_sortItems[i].key = draws[i].sortKey;
+					m_sortItems[i].index = (U32)i;
+				}
+				RadixSort(m_sortItems, m_sortScratch, [](const SortItem& item) { return item.key; }, RADIX_SORT_THRESHOLD);
+
+				// 並べ替えた順に描画コマンドを集める
+				m_sortDrawsScratch.resize(draws.size());
+				for (size_t i = 0; i < draws.size(); i++)m_sortDrawsScratch[i] = draws[m_sortItems[i].index];
+				draws.swap(m_sortDrawsScratch);
+			});
+		}
+
+		void Reset()override
+		{
+			m_data.clear();
+			m_commandCount = 0;
+			m_instanceData.clear();
+			m_targets.Clear();
+			m_pipelines.Clear();
+			m_materials.Clear();
+			m_shapes.Clear();
+			m_target = INVALID_COMMAND_RESOURCE;
+			m_pipeline = INVALID_COMMAND_RESOURCE;
+			m_material = INVALID_COMMAND_RESOURCE;
+		}
+
+		inline U32 GetCommandCount()const override { return m_commandCount; }
+		inline const Byte* GetData()const override { return m_data.empty() ? nullptr : m_data.data(); }
+		inline U32 GetDataSize()const override { return (U32)m_data.size(); }
+
+	private:
+		/// <summary>
+		/// 描画コマンドをまとめられるか
+		/// </summary>
+		static inline bool CanMerge(const DrawCommand& a, const DrawCommand& b)
+		{
+			return a.target == b.target && a.pipeline == b.pipeline && a.material == b.material && a.shape == b.shape && a.instanceSize == b.instanceSize;
+		}
+
+		/// <summary>
+		/// DrawInstanceで記録した描画をまとめ、インスタンスのデータを描画順にバッファへ詰めて転送する
+		/// </summary>
+		/// <remarks>
+		/// 前回までのExecuteのデータをGPUが読み終えていない可能性があるため、前回とは別のバッファに書き込む。
+		/// </remarks>
+		/// <returns>　０：成功\n－１：インスタンスのバッファを作成できない</returns>
+		S32 PrepareInstances()
+		{
+			m_instanceGroups.clear();
+			for (auto& pair : m_instanceBuffers)pair.second.data.clear();
+			m_instanceBufferIndex = (m_instanceBufferIndex + 1) % INSTANCE_BUFFER_COUNT;
+
+			const DrawCommand* previous = nullptr;
+			for (U32 offset = 0; offset < m_data.size();)
+			{
+				auto header = reinterpret_cast<const CommandHeader*>(m_data.data() + offset);
+				offset += header->size;
+
+				auto command = reinterpret_cast<const DrawCommand*>(header);
+				if (header->type != CommandType::DRAW || command->instanceSize == 0)
+				{
+					previous = nullptr;
+					continue;
+				}
+
+				auto& buffer = m_instanceBuffers[command->instanceSize];
+				if (m_useAutoInstancing && previous && CanMerge(*previous, *command))
+				{
+					m_instanceGroups.back().drawCount++;
+				}
+				else
+				{
+					InstanceGroup instanceGroup;
+					instanceGroup.instanceSize = command->instanceSize;
+					instanceGroup.firstInstance = (U32)(buffer.data.size() / command->instanceSize);
+					instanceGroup.instanceCount = 0;
+					instanceGroup.drawCount = 1;
+					m_instanceGroups.push_back(instanceGroup);
+				}
+				m_instanceGroups.back().instanceCount += command->instanceCount;
+
+				auto begin = m_instanceData.begin() + command->instanceOffset;
+				buffer.data.insert(buffer.data.end(), begin, begin + (size_t)command->instanceCount * command->instanceSize);
+				previous = command;
+			}
+
+			// 要素数が変わらなければバッファを使い回す
+			for (auto& pair : m_instanceBuffers)
+			{
+				auto& buffer = pair.second;
+				if (buffer.data.empty())continue;
+
+				const U32 count = (U32)(buffer.data.size() / pair.first);
+				auto& shape = buffer.shapes[m_instanceBufferIndex];
+				if (shape && (U32)shape->GetVertexCount() == count)
+				{
+					Byte* ptr = shape->LockVertices();
+					if (ptr == nullptr)return -1;
+					memcpy(ptr, buffer.data.data(), buffer.data.size());
+					shape->UnlockVertices();
+				}
+				else
+				{
+					if (m_wrapper == nullptr)return -1;
+					shape = m_wrapper->CreateShape(pair.first);
+					if (!shape || shape->Vertex(buffer.data.data(), count) == -1)return -1;
+				}
+			}
+			return 0;
+		}
+
+		/// <summary>
+		/// 連続した描画コマンドごとにsortRangeで並べ替え、元の位置に書き戻す
+		/// </summary>
+		template<class F>
+		void ForEachDrawRange(F sortRange)
+		{
+			m_sortDraws.clear();
+			m_sortOffsets.clear();
+
+			auto flush = [&]()
+			{
+				if (1 < m_sortDraws.size())
+				{
+					sortRange(m_sortDraws);
+					for (size_t i = 0; i < m_sortDraws.size(); i++)
+					{
+						*reinterpret_cast<DrawCommand*>(m_data.data() + m_sortOffsets[i]) = m_sortDraws[i];
+					}
+				}
+				m_sortDraws.clear();
+				m_sortOffsets.clear();
+			};
+
+			for (U32 offset = 0; offset < m_data.size();)
+			{
+				auto header = reinterpret_cast<const CommandHeader*>(m_data.data() + offset);
+				if (header->type == CommandType::DRAW)
+				{
+					m_sortDraws.push_back(*reinterpret_cast<const DrawCommand*>(header));
+					m_sortOffsets.push_back(offset);
+				}
+				else
+				{
+					flush();
+				}
+				offset += header->size;
+			}
+			flush();
+		}
+
+		/// <summary>
+		/// コマンドの領域を末尾に確保し、ヘッダーを書き込む
+		/// </summary>
+		template<class T>
+		T& Allocate(const CommandType type)
+		{
+			const U32 size = (sizeof(T) + COMMAND_ALIGNMENT - 1) / COMMAND_ALIGNMENT * COMMAND_ALIGNMENT;
+			const size_t offset = m_data.size();
+			m_data.resize(offset + size);
+			m_commandCount++;
+
+			auto& command = *reinterpret_cast<T*>(m_data.data() + offset);
+			command.header.type = type;
+			command.header.size = (U16)size;
+			return command;
+		}
+	};
+}
\ No newline at end of file
@@ -82,7 +82,7 @@ namespace og
 
 		// レンダ―ターゲット
 		S32 numRenderTargets = 1;
-		BlendMode blendMode[8];
+		BlendMode blendMode[8] = {};
 	};
 
 
@@ -1,9 +1,255 @@
 ﻿#pragma once
+#include "IDeletable.h"
+
+#include <cstring>
+#include <functional>
 
 namespace og
 {
-	class Class
+	class IGraphicPipeline;
+	class IMaterial;
+	class IRenderTexture;
+	class IShape;
+
+
+	/// <summary>
+	/// コマンドの種類
+	/// </summary>
+	enum class CommandType :U16
+	{
+		BEGIN_DRAW,
+		END_DRAW,
+		SET_CLEAR_COLOR,
+		DRAW,
+	};
+
+
+	/// <summary>
+	/// リソースが指定されていないことを表す番号
+	/// </summary>
+	const U32 INVALID_COMMAND_RESOURCE = 0xFFFFFFFF;
+
+
+	/// <summary>
+	/// 全てのコマンドの先頭
+	/// </summary>
+	struct CommandHeader
+	{
+		CommandType type;
+		/// <summary> ヘッダーを含むコマンドのバイトサイズ </summary>
+		U16 size;
+	};
+
+	// コマンドはポインタを持たないPOD。リソースはコマンドバッファごとのリソース表の番号で参照する
+
+	struct BeginDrawCommand
 	{
+		CommandHeader header;
+		U32 target;
+	};
+
+	struct EndDrawCommand
+	{
+		CommandHeader header;
+		U32 target;
+	};
+
+	struct SetClearColorCommand
+	{
+		CommandHeader header;
+		U32 target;
+		F32 color[4];
+	};
+
+	/// <summary>
+	/// 描画に必要な状態を全て持つため、BeginDrawとEndDrawの間で自由に並べ替えられる
+	/// </summary>
+	struct DrawCommand
+	{
+		CommandHeader header;
+		U32 target;
+		U32 pipeline;
+		/// <summary> マテリアルを設定していない場合はINVALID_COMMAND_RESOURCE </summary>
+		U32 material;
+		U32 shape;
+		U32 instanceCount;
+		/// <summary> インスタンスごとのデータのコマンドバッファ内での位置 </summary>
+		U32 instanceOffset;
+		/// <summary> 1インスタンスのデータのバイトサイズ。インスタンスごとのデータが無い場合は0 </summary>
+		U32 instanceSize;
+		/// <summary> SortDrawsByKeyで使う並べ替えのキー(DrawSortKey) </summary>
+		U64 sortKey;
+	};
+
+
+	/// <summary>
+	/// 描画の並べ替えに使う64bitのキー
+	/// </summary>
+	/// <remarks>
+	/// 上位からレンダーテクスチャ(8bit)、パス(8bit)の順に並び、残りの48bitはパスの並べ替え方で変わる。
+	/// 手前から描画するパスではグラフィックパイプライン(12bit)、マテリアル(14bit)、形状(12bit)、深度(10bit)の順にして
+	/// 状態の切り替えを減らし、同じ形状の描画を隣り合わせて自動インスタンシングでまとめられるようにする。
+	/// 奥から描画するパス(半透明など)では深度の反転(16bit)、グラフィックパイプライン(12bit)、マテリアル(12bit)、形状(8bit)の順にして描画順を守る。
+	/// 各値は範囲を超えると最大値に丸められ、キーが同じ描画は記録した順に残る。
+	/// </remarks>
+	struct DrawSortKey
+	{
+		/// <summary>
+		/// 深度をbitsビットに丸める。大小関係を保つようにF32のビット列の符号を除いた上位bitsビットを使う
+		/// </summary>
+		/// <param name="depth">カメラからの距離。負の値は0として扱う</param>
+		static inline U64 QuantizeDepth(const F32 depth, const U32 bits)
+		{
+			if (!(0.0f < depth))return 0;
+			U32 value;
+			memcpy(&value, &depth, sizeof(value));
+			return value >> (31 - bits);
+		}
+
+		static inline U64 Make(const U32 target, const U32 pass, const U32 pipeline, const U32 material, const U32 shape, const F32 depth, const bool backToFront)
+		{
+			auto clamp = [](const U32 value, const U32 bits) { const U32 max = (1u << bits) - 1; return (U64)(value < max ? value : max); };
+			const U64 head = (clamp(target, 8) << 56) | (clamp(pass, 8) << 48);
+			if (backToFront)
+			{
+				return head | ((0xFFFF - QuantizeDepth(depth, 16)) << 32) | (clamp(pipeline, 12) << 20) | (clamp(material, 12) << 8) | clamp(shape, 8);
+			}
+			return head | (clamp(pipeline, 12) << 36) | (clamp(material, 14) << 22) | (clamp(shape, 12) << 10) | QuantizeDepth(depth, 10);
+		}
+	};
+
+
+	/// <summary>
+	/// コマンドバッファの実行結果
+	/// </summary>
+	struct CommandBufferStatistics
+	{
+		U32 drawCount = 0;
+		/// <summary> SetGraphicPipelineを呼んだ回数 </summary>
+		U32 pipelineChanges = 0;
+		/// <summary> SetMaterialを呼んだ回数 </summary>
+		U32 materialChanges = 0;
+		/// <summary> 自動インスタンシングで前の描画にまとめた描画の数 </summary>
+		U32 mergedDraws = 0;
+	};
+
+
+	/// <summary>
+	/// 描画命令を記録し、後からまとめて実行する
+	/// </summary>
+	/// <remarks>
+	/// IRenderTextureへの呼び出しをそのまま記録し、Executeで同じ順に再生する。記録はグラフィックAPIを呼ばないため、
+	/// 描画スレッド以外で行える。1つのコマンドバッファを複数のスレッドから同時に記録することはできない。
+	/// </remarks>
+	class ICommandBuffer :public IDeletable
+	{
+	public:
+		/// <summary>
+		/// レンダーテクスチャへの描画を開始する
+		/// </summary>
+		/// <returns>　０：成功\n－１：引数が不正、または描画中</returns>
+		virtual S32 BeginDraw(const SPtr<IRenderTexture>& target) = 0;
+
+		/// <summary>
+		/// BeginDrawで開始した描画を終了する
+		/// </summary>
+		/// <returns>　０：成功\n－１：描画中ではない</returns>
+		virtual S32 EndDraw() = 0;
+
+		/// <summary>
+		/// レンダーテクスチャのクリア色を設定する。BeginDrawより前に記録する
+		/// </summary>
+		/// <returns>　０：成功\n－１：引数が不正</returns>
+		virtual S32 SetClearColor(const SPtr<IRenderTexture>& target, const Color& color) = 0;
+
+		/// <returns>　０：成功\n－１：引数が不正</returns>
+		virtual S32 SetGraphicPipeline(const SPtr<IGraphicPipeline>& pipeline) = 0;
+
+		/// <returns>　０：成功\n－１：引数が不正</returns>
+		virtual S32 SetMaterial(const SPtr<IMaterial>& material) = 0;
+
+		/// <summary>
+		/// 以降の描画のパスを設定する。パスの番号が小さい描画ほど先に実行される。BeginDrawで0(手前から描画)に戻る
+		/// </summary>
+		/// <param name="pass">パスの番号(0〜255)</param>
+		/// <param name="backToFront">深度の大きい描画から実行するか</param>
+		/// <returns>　０：成功\n－１：引数が不正</returns>
+		virtual S32 SetPass(const U32 pass, const bool backToFront = false) = 0;
+
+		/// <summary>
+		/// 現在のグラフィックパイプラインとマテリアルで描画する
+		/// </summary>
+		/// <param name="depth">並べ替えに使うカメラからの距離</param>
+		/// <returns>　０：成功\n－１：引数が不正、描画中ではない、またはグラフィックパイプラインが設定されていない</returns>
+		virtual S32 DrawInstanced(const SPtr<IShape>& shape, const U32 count = 1, const F32 depth = 0.0f) = 0;
+
+		/// <summary>
+		/// インスタンスごとのデータ(ワールド行列など)を付けて1インスタンスを描画する
+		/// </summary>
+		/// <remarks>
+		/// データは頂点シェーダーのセマンティクスがINSTANCEで始まる入力に渡される(IRenderTexture::DrawInstanced)。
+		/// 自動インスタンシングが有効な場合、連続する描画のレンダーテクスチャ、グラフィックパイプライン、マテリアル、形状、
+		/// データのサイズが全て同じであれば、データを1つのバッファに詰めて1回のインスタンス描画にまとめる。
+		/// </remarks>
+		/// <param name="instanceData">インスタンスのデータ。記録時に複製される</param>
+		/// <param name="instanceSize">データのバイトサイズ</param>
+		/// <param name="depth">並べ替えに使うカメラからの距離</param>
+		/// <returns>　０：成功\n－１：引数が不正、描画中ではない、グラフィックパイプラインが設定されていない、またはインスタンスのバッファを作成できない</returns>
+		virtual S32 DrawInstance(const SPtr<IShape>& shape, const void* instanceData, const U32 instanceSize, const F32 depth = 0.0f) = 0;
+
+		/// <summary>
+		/// DrawInstanceで記録した描画をExecuteでまとめるか(初期値はtrue)
+		/// </summary>
+		/// <remarks>
+		/// まとめられるのは連続した描画のみのため、SortDrawsByKeyで並べ替えてから実行すると効果が大きい。
+		/// </remarks>
+		virtual void SetAutoInstancing(const bool enable) = 0;
+
+		/// <summary>
+		/// 記録したコマンドを実行する
+		/// </summary>
+		/// <remarks>
+		/// 直前と同じグラフィックパイプライン、マテリアルの設定は省略する。コマンドは実行後も残るため、同じ内容を何度でも実行できる。
+		/// </remarks>
+		/// <param name="statistics">実行結果の出力先(nullptrの場合は出力しない)</param>
+		/// <returns>　０：成功\n－１：記録が完了していない、またはレンダーテクスチャがエラーを返した</returns>
+		virtual S32 Execute(CommandBufferStatistics* statistics = nullptr) = 0;
+
+		/// <summary>
+		/// BeginDrawとEndDrawの間の描画コマンドを並べ替える
+		/// </summary>
+		/// <remarks>
+		/// 安定ソートのため、lessで順序が決まらない描画は記録した順に残る。
+		/// </remarks>
+		/// <param name="less">aをbより先に描画する場合にtrueを返す関数</param>
+		virtual void SortDraws(const std::function<bool(const DrawCommand& a, const DrawCommand& b)>& less) = 0;
+
+		/// <summary>
+		/// BeginDrawとEndDrawの間の描画コマンドをDrawCommand::sortKeyの昇順に並べ替える
+		/// </summary>
+		/// <remarks>
+		/// 基数ソートのため描画数に対して線形で、キーが同じ描画は記録した順に残る。Executeの前に呼ぶ。
+		/// </remarks>
+		virtual void SortDrawsByKey() = 0;
+
+		/// <summary>
+		/// 記録したコマンドと参照しているリソースを破棄する
+		/// </summary>
+		virtual void Reset() = 0;
+
+		/// <summary>
+		/// 記録したコマンドの数
+		/// </summary>
+		virtual U32 GetCommandCount()const = 0;
+
+		/// <summary>
+		/// 記録したコマンドの先頭。コマンドはCommandHeader::sizeずつ隙間なく並ぶ
+		/// </summary>
+		virtual const Byte* GetData()const = 0;
 
+		/// <summary>
+		/// 記録したコマンドのバイトサイズ
+		/// </summary>
+		virtual U32 GetDataSize()const = 0;
 	};
 }
\ No newline at end of file
@@ -95,6 +95,24 @@ namespace og
 		/// <returns>　－１　　　:　エラー\n－１以外　:　ID</returns>
 		virtual SPtr<IShader> CreateShader(const String& src, ShaderType type, String& errorDest) = 0;
 
+		/// <summary>
+		/// 文字列からシェーダを非同期に作成。
+		/// </summary>
+		/// <remarks>
+		/// コンパイルはワーカースレッドで行い、すぐにコンパイル中のシェーダを返す。状態はIShader::GetStatusで確認でき、Waitで完了を待てる。
+		/// コンパイル中のシェーダからもグラフィックパイプラインとマテリアルを作成でき、パイプラインはシェーダの完成後に作成される。
+		/// 完成前のパイプラインを使った描画はデフォルトのパイプラインで行われる。
+		/// 非同期に対応していないラッパーではCreateShaderと同様に同期的にコンパイルし、失敗した場合はエラー出力先にエラーログを格納してnullptrを返す。
+		/// </remarks>
+		/// <param name="src">シェーダのソースコード</param>
+		/// <param name="type">シェーダの種類</param>
+		/// <param name="errorDest">同期的にコンパイルした場合のエラー出力先。非同期の場合のエラーログはIShader::GetErrorLogで取得する</param>
+		/// <returns>シェーダ</returns>
+		virtual SPtr<IShader> CreateShaderAsync(const String& src, ShaderType type, String& errorDest)
+		{
+			return CreateShader(src, type, errorDest);
+		}
+
 		//===================================================================================//
 
 		/// <summary>
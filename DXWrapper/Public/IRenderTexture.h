@@ -20,6 +20,20 @@ namespace og
 
 		virtual S32 DrawInstanced(SPtr<IShape>& shape, const U32 count = 1) = 0;
 
+		/// <summary>
+		/// インスタンスごとのデータを使って描画する
+		/// </summary>
+		/// <remarks>
+		/// instancesの頂点データを1インスタンス1要素として、頂点シェーダーのセマンティクスがINSTANCEで始まる入力に渡す。
+		/// firstInstance番目からcount個のインスタンスを描画する。SV_InstanceIDはfirstInstanceを含まない0からの番号となる。
+		/// </remarks>
+		/// <param name="shape">描画する形状</param>
+		/// <param name="instances">インスタンスごとのデータ。ストライブサイズが1インスタンスのバイトサイズとなる</param>
+		/// <param name="firstInstance">instancesの中で最初に使う要素の番号</param>
+		/// <param name="count">描画するインスタンス数</param>
+		/// <returns>　０：成功\n－１：引数が不正</returns>
+		virtual S32 DrawInstanced(SPtr<IShape>& shape, SPtr<IShape>& instances, const U32 firstInstance, const U32 count) = 0;
+
 
 		virtual void SetClearColor(Color color)=0;
 	};
@@ -13,7 +13,34 @@ namespace og
 	};
 
 
+	/// <summary>
+	/// シェーダのコンパイルの状態
+	/// </summary>
+	enum class ShaderStatus
+	{
+		COMPILING,
+		READY,
+		FAILED
+	};
+
+
 	class IShader :public IDeletable
 	{
+	public:
+		/// <summary>
+		/// コンパイルの状態を取得する。CreateShaderAsync以外で作成したシェーダは常にREADYとなる
+		/// </summary>
+		virtual ShaderStatus GetStatus()const { return ShaderStatus::READY; }
+
+		/// <summary>
+		/// コンパイルが終わるまで待つ
+		/// </summary>
+		/// <returns>コンパイル後の状態(READYまたはFAILED)</returns>
+		virtual ShaderStatus Wait() { return GetStatus(); }
+
+		/// <summary>
+		/// 非同期のコンパイルに失敗した場合のエラーログを取得する
+		/// </summary>
+		virtual String GetErrorLog()const { return String(); }
 	};
 }
\ No newline at end of file
@@ -9,8 +9,44 @@ namespace og
 		virtual S32 Indices(const U32 index1, const U32 index2, const U32 index3) = 0;
 		virtual S32 Indices(const U32* indices,const U32 count)=0;
 
+		/// <summary>
+		/// 頂点データを直接書き換えるためのポインタを取得する
+		/// </summary>
+		/// <remarks>
+		/// 書き換えが終わったらUnlockVerticesを呼ぶ。頂点数が変わらない限りGPUバッファは再生成されず、内容のみ更新される。
+		/// 更新はフレーム単位で反映されるため、同じフレーム内で複数回書き換えた場合は最後の内容で全ての描画が行われる。
+		/// </remarks>
+		/// <returns>頂点データの先頭。頂点が無い場合はnullptr</returns>
+		virtual Byte* LockVertices() = 0;
+		virtual S32 UnlockVertices() = 0;
+
 		virtual S32 GetStribeSize() = 0;
 		virtual S32 GetVertexCount() = 0;
 		virtual S32 GetIndexCount() = 0;
+
+		/// <summary>
+		/// 頂点データを読み取り用に取得する(ピッキング等のCPU側の処理用)
+		/// </summary>
+		/// <returns>頂点データの先頭。頂点が無い場合はnullptr</returns>
+		virtual const Byte* GetVertices() = 0;
+
+		/// <summary>
+		/// インデックスを読み取り用に取得する
+		/// </summary>
+		/// <returns>インデックスの先頭。インデックスが無い場合はnullptr</returns>
+		virtual const U32* GetIndices() = 0;
+
+		/// <summary>
+		/// 設定済みの頂点とインデックスをMeshOptimizerで並べ替える
+		/// </summary>
+		/// <remarks>
+		/// 頂点キャッシュ、オーバードロー、頂点の読み込みの順に最適化し、次の描画でGPUバッファに反映する。
+		/// 頂点の読み込みを最適化した場合は頂点の順序と数が変わるため、LockVerticesで得たポインタは使えなくなる。
+		/// インデックスが無い場合は何もしない。
+		/// </remarks>
+		/// <param name="settings">設定</param>
+		/// <param name="report">結果の出力先(nullptrの場合は出力しない)</param>
+		/// <returns>　０：成功\n－１：設定が頂点データと合わない、またはインデックスが範囲外</returns>
+		virtual S32 Optimize(const MeshOptimizeSettings& settings = MeshOptimizeSettings(), MeshOptimizeReport* report = nullptr) = 0;
 	};
 }
\ No newline at end of file
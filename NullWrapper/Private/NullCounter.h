@@ -0,0 +1,117 @@
+﻿#pragma once
+
+#include <atomic>
+
+#include "NullWrapper.h"
+
+namespace og
+{
+	/// <summary>
+	/// 呼び出し回数と描画量の集計
+	/// </summary>
+	/// <remarks>
+	/// ラッパーと作成した全てのリソースで共有する。複数のスレッドから同時に記録できる。
+	/// </remarks>
+	class NullCounter
+	{
+	private:
+		std::atomic<U64> m_calls[CALL_TYPE_COUNT];
+		std::atomic<U64> m_failedCalls;
+		std::atomic<U64> m_instances;
+		std::atomic<U64> m_triangles;
+		std::atomic<U64> m_uploadedBytes;
+		std::atomic<S64> m_liveResources[RESOURCE_TYPE_COUNT];
+
+	public:
+		NullCounter()
+		{
+			for (auto& count : m_liveResources)count.store(0, std::memory_order_relaxed);
+			Reset();
+		}
+
+		/// <summary>
+		/// 関数の呼び出しを記録する
+		/// </summary>
+		inline void Call(const NullCallType type)
+		{
+			m_calls[type].fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/// <summary>
+		/// 直前に記録した呼び出しがエラーになったことを記録する
+		/// </summary>
+		/// <returns>－１</returns>
+		inline S32 Fail()
+		{
+			m_failedCalls.fetch_add(1, std::memory_order_relaxed);
+			return -1;
+		}
+
+		inline void AddDraw(const U64 instances, const U64 triangles)
+		{
+			m_instances.fetch_add(instances, std::memory_order_relaxed);
+			m_triangles.fetch_add(triangles, std::memory_order_relaxed);
+		}
+
+		inline void AddUpload(const U64 bytes)
+		{
+			m_uploadedBytes.fetch_add(bytes, std::memory_order_relaxed);
+		}
+
+		inline void AddResource(const NullResourceType type, const S64 count)
+		{
+			m_liveResources[type].fetch_add(count, std::memory_order_relaxed);
+		}
+
+		NullStatistics GetStatistics()const
+		{
+			NullStatistics statistics;
+			for (S32 i = 0; i < CALL_TYPE_COUNT; i++)statistics.calls[i] = m_calls[i].load(std::memory_order_relaxed);
+			statistics.failedCalls = m_failedCalls.load(std::memory_order_relaxed);
+			statistics.instances = m_instances.load(std::memory_order_relaxed);
+			statistics.triangles = m_triangles.load(std::memory_order_relaxed);
+			statistics.uploadedBytes = m_uploadedBytes.load(std::memory_order_relaxed);
+			for (S32 i = 0; i < RESOURCE_TYPE_COUNT; i++)statistics.liveResources[i] = m_liveResources[i].load(std::memory_order_relaxed);
+			return statistics;
+		}
+
+		/// <summary>
+		/// リソースの生存数以外を0に戻す
+		/// </summary>
+		void Reset()
+		{
+			for (auto& count : m_calls)count.store(0, std::memory_order_relaxed);
+			m_failedCalls.store(0, std::memory_order_relaxed);
+			m_instances.store(0, std::memory_order_relaxed);
+			m_triangles.store(0, std::memory_order_relaxed);
+			m_uploadedBytes.store(0, std::memory_order_relaxed);
+		}
+	};
+
+
+	/// <summary>
+	/// リソースの生存数を記録する。リソースのクラスにメンバとして持たせる
+	/// </summary>
+	class NullResource
+	{
+	private:
+		const SPtr<NullCounter> m_counter;
+		const NullResourceType m_type;
+
+	public:
+		NullResource(const SPtr<NullCounter>& counter, const NullResourceType type) :m_counter(counter), m_type(type)
+		{
+			m_counter->AddResource(m_type, 1);
+		}
+
+		~NullResource()
+		{
+			m_counter->AddResource(m_type, -1);
+		}
+
+		NullResource(const NullResource&) = delete;
+		NullResource& operator=(const NullResource&) = delete;
+
+		inline NullCounter& GetCounter()const { return *m_counter; }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+﻿#include "pch.h"
+#include "NullGraphicPipeline.h"
+
+#include "NullShader.h"
+
+namespace
+{
+	using namespace og;
+
+	/// <summary>
+	/// このラッパーで作成した指定の種類のシェーダーか。未指定(標準のシェーダー)も許可する
+	/// </summary>
+	bool IsValidShader(const SPtr<IShader>& shader, const ShaderType type)
+	{
+		if (!shader)return true;
+		auto nullShader = dynamic_cast<NullShader*>(shader.get());
+		return nullShader != nullptr && nullShader->GetType() == type;
+	}
+}
+
+namespace og
+{
+	NullGraphicPipeline::NullGraphicPipeline(const SPtr<NullCounter>& counter, const GraphicPipelineDesc& desc)
+		:m_resource(counter, RESOURCE_GRAPHIC_PIPELINE), m_isValid(false)
+	{
+		if (desc.numRenderTargets < 1 || MAX_RENDER_TARGETS < desc.numRenderTargets)return;
+		if (!IsValidShader(desc.vs, ShaderType::VERTEX))return;
+		if (!IsValidShader(desc.ps, ShaderType::PIXEL))return;
+
+		// リソースを参照に追加
+		m_desc = desc;
+		m_isValid = true;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+﻿#pragma once
+
+#include "IGraphicPipeline.h"
+#include "GraphicPipelineDesc.h"
+#include "NullCounter.h"
+
+namespace og
+{
+	/// <summary>
+	/// 描画に使用する情報をひとまとめにする
+	/// </summary>
+	/// <remarks>
+	/// パイプラインステートは作成せず、定義の検査と保持のみ行う。
+	/// </remarks>
+	class NullGraphicPipeline :public IGraphicPipeline
+	{
+	public:
+		static const S32 MAX_RENDER_TARGETS = 8;
+	private:
+		NullResource m_resource;
+		GraphicPipelineDesc m_desc;
+
+		bool m_isValid;
+
+	public:
+		NullGraphicPipeline(const SPtr<NullCounter>& counter, const GraphicPipelineDesc& desc);
+
+		inline const GraphicPipelineDesc& GetDesc()const { return m_desc; }
+		inline S32 GetTargetNum()const { return m_desc.numRenderTargets; }
+
+		/// <summary>
+		/// インスタンスの生成に成功しているか
+		/// </summary>
+		inline bool IsValid()const { return m_isValid; }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+﻿#include "pch.h"
+#include "NullGraphicWrapper.h"
+
+#include "Platform.h"
+
+#include "NullGraphicPipeline.h"
+#include "NullMaterial.h"
+#include "NullRenderTexture.h"
+#include "NullShader.h"
+#include "NullShape.h"
+#include "NullTexture.h"
+
+namespace og
+{
+	IGraphicWrapper* CreateGraphicWrapper()
+	{
+		return new NullGraphicWrapper();
+	}
+
+
+
+	NullGraphicWrapper::NullGraphicWrapper() :m_counter(MSPtr<NullCounter>())
+	{
+	}
+
+	NullGraphicWrapper::~NullGraphicWrapper()
+	{
+	}
+
+
+
+	S32 NullGraphicWrapper::Init()
+	{
+		m_counter->Call(CALL_INIT);
+		return 0;
+	}
+
+	// 表示先が無いため、引数の確認のみ行う
+	S32 NullGraphicWrapper::SwapScreen(SPtr<IRenderTexture>& renderTarget)
+	{
+		m_counter->Call(CALL_SWAP_SCREEN);
+		if (CheckArgs(!!renderTarget))return m_counter->Fail();
+		return 0;
+	}
+
+
+
+	SPtr<IRenderTexture> NullGraphicWrapper::CreateRenderTexture(const S32 width, const S32 height, const TextureFormat format)
+	{
+		ArrayList<TextureFormat> formats(1, format);
+		return CreateRenderTexture(width, height, formats);
+	}
+
+	SPtr<IRenderTexture> NullGraphicWrapper::CreateRenderTexture(const S32 width, const S32 height, const ArrayList<TextureFormat>& formats)
+	{
+		m_counter->Call(CALL_CREATE_RENDER_TEXTURE);
+		if (width <= 0 || height <= 0)
+		{
+			m_counter->Fail();
+			return nullptr;
+		}
+		auto texture = MSPtr<NullRenderTexture>(m_counter, formats, width, height);
+		if (texture->IsValid() == false)
+		{
+			m_counter->Fail();
+			return nullptr;
+		}
+		return texture;
+	}
+
+	SPtr<ITexture> NullGraphicWrapper::LoadTexture(const Path& path, const bool async)
+	{
+		m_counter->Call(CALL_LOAD_TEXTURE);
+		if (Platform::FileExists(path) == false)
+		{
+			m_counter->Fail();
+			return nullptr;
+		}
+		return MSPtr<NullTexture>(m_counter, path);
+	}
+
+
+
+	SPtr<IShader> NullGraphicWrapper::LoadShader(const String& path, ShaderType type, String& errorDest)
+	{
+		m_counter->Call(CALL_LOAD_SHADER);
+		if (Platform::FileExists(Path(path)) == false)
+		{
+			errorDest = TC("file not found: ") + path;
+			m_counter->Fail();
+			return nullptr;
+		}
+		return MSPtr<NullShader>(m_counter, type, path);
+	}
+
+	SPtr<IShader> NullGraphicWrapper::CreateShader(const String& src, ShaderType type, String& errorDest)
+	{
+		m_counter->Call(CALL_CREATE_SHADER);
+		return MSPtr<NullShader>(m_counter, type, src);
+	}
+
+
+
+	SPtr<IGraphicPipeline> NullGraphicWrapper::CreateGraphicPipeline(const GraphicPipelineDesc& desc)
+	{
+		m_counter->Call(CALL_CREATE_GRAPHIC_PIPELINE);
+		auto gpipeline = MSPtr<NullGraphicPipeline>(m_counter, desc);
+		if (gpipeline->IsValid() == false)
+		{
+			m_counter->Fail();
+			return nullptr;
+		}
+		return gpipeline;
+	}
+
+
+
+	SPtr<IMaterial> NullGraphicWrapper::CreateMaterial(const SPtr<IGraphicPipeline>& pipeline, const S32 cBufferMask, const S32 texMask)
+	{
+		m_counter->Call(CALL_CREATE_MATERIAL);
+		if (dynamic_cast<NullGraphicPipeline*>(pipeline.get()) == nullptr)
+		{
+			m_counter->Fail();
+			return nullptr;
+		}
+		return MSPtr<NullMaterial>(m_counter, pipeline);
+	}
+
+
+
+	SPtr<IShape> NullGraphicWrapper::CreateShape(const U32 stribeSize)
+	{
+		m_counter->Call(CALL_CREATE_SHAPE);
+		if (stribeSize <= 0)
+		{
+			m_counter->Fail();
+			return nullptr;
+		}
+		return MSPtr<NullShape>(m_counter, stribeSize);
+	}
+
+
+
+	NullStatistics NullGraphicWrapper::GetStatistics()const
+	{
+		return m_counter->GetStatistics();
+	}
+
+	void NullGraphicWrapper::ResetStatistics()
+	{
+		m_counter->Reset();
+	}
+}
\ No newline at end of file
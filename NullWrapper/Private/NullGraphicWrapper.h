@@ -0,0 +1,57 @@
+﻿#pragma once
+
+#include "NullWrapper.h"
+#include "NullCounter.h"
+
+namespace og
+{
+	class NullGraphicWrapper :public INullGraphicWrapper
+	{
+	private:
+		// 作成したリソースと共有する
+		SPtr<NullCounter> m_counter;
+
+	public:
+		NullGraphicWrapper();
+		~NullGraphicWrapper();
+
+#pragma region
+		// IGraphicWrapperの仮想関数の実装
+
+		S32 Init() override;
+		S32 SwapScreen(SPtr<IRenderTexture>& renderTarget) override;
+
+		//===================================================================================//
+
+		SPtr<IRenderTexture> CreateRenderTexture(const S32 width, const S32 height, const TextureFormat format)override;
+		SPtr<IRenderTexture> CreateRenderTexture(const S32 width, const S32 height, const ArrayList<TextureFormat>& formats)override;
+		SPtr<ITexture> LoadTexture(const Path& path, const bool async) override;
+
+		//===================================================================================//
+
+		SPtr<IShader> LoadShader(const String& path, ShaderType type, String& errorDest) override;
+		SPtr<IShader> CreateShader(const String& path, ShaderType type, String& errorDest) override;
+
+		//===================================================================================//
+
+		SPtr<IGraphicPipeline> CreateGraphicPipeline(const GraphicPipelineDesc& desc)override;
+
+		//===================================================================================//
+
+		SPtr<IMaterial> CreateMaterial(const SPtr<IGraphicPipeline>& pipeline, const S32 cBufferMask, const S32 texMask)override;
+
+		//===================================================================================//
+
+		SPtr<IShape> CreateShape(const U32 stribeSize) override;
+
+#pragma endregion
+
+#pragma region
+		// INullGraphicWrapperの仮想関数の実装
+
+		NullStatistics GetStatistics()const override;
+		void ResetStatistics()override;
+
+#pragma endregion
+	};
+}
\ No newline at end of file
@@ -0,0 +1,127 @@
+﻿#include "pch.h"
+#include "NullMaterial.h"
+
+#include "Platform.h"
+
+#include "NullRenderTexture.h"
+#include "NullTexture.h"
+
+namespace og
+{
+	NullMaterial::NullMaterial(const SPtr<NullCounter>& counter, const SPtr<IGraphicPipeline>& gpipeline)
+		:m_resource(counter, RESOURCE_MATERIAL), m_isLocked(false)
+	{
+		if (CheckArgs(!!gpipeline))return;
+		m_graphicPipeline = gpipeline;
+	}
+
+
+
+	S32 NullMaterial::Lock()
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_LOCK_MATERIAL);
+		if (!IsValid())return counter.Fail();
+		return 0;
+	}
+
+
+
+	S32 NullMaterial::SetTexture(const String& name, const SPtr<ITexture>& texture, const S32 target)
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_SET_TEXTURE);
+		if (!IsValid())return counter.Fail();
+		if (CheckArgs(!!texture))return counter.Fail();
+		if (m_isLocked)return counter.Fail();
+
+		// このラッパーで作成したテクスチャのみ使用できる
+		if (dynamic_cast<NullTexture*>(texture.get()))
+		{
+			if (target != 0)return counter.Fail();
+		}
+		else if (auto renderTexture = dynamic_cast<NullRenderTexture*>(texture.get()))
+		{
+			if (target < 0 || renderTexture->GetTargetNum() <= target)return counter.Fail();
+		}
+		else
+		{
+			return counter.Fail();
+		}
+
+		// 変数は最初にテクスチャとして登録する
+		auto itr = m_variables.find(name);
+		if (itr == m_variables.end())
+		{
+			ShaderVariableDesc desc;
+			desc.type = ShaderParamType::TEXTURE2D;
+			desc.offset = -1;
+			desc.elementCount = 1;
+			desc.registerNum = 0;
+			m_variables[name] = desc;
+		}
+		else if (itr->second.type != ShaderParamType::TEXTURE2D)
+		{
+			return counter.Fail();
+		}
+
+		TextureBinding binding;
+		binding.texture = texture;
+		binding.target = target;
+		m_textures[name] = binding;
+		return 0;
+	}
+
+	S32 NullMaterial::SetFloat4Param(const String& name, const Vector4& value)
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_SET_FLOAT4_PARAM);
+		if (!IsValid())return counter.Fail();
+		if (m_isLocked)return counter.Fail();
+
+		Byte* ptr = GetVariable(name, ShaderParamType::FLOAT4, sizeof(Vector4));
+		if (ptr == nullptr)return counter.Fail();
+
+		Platform::MemoryCopy(ptr, sizeof(Vector4), &value, sizeof(Vector4));
+		counter.AddUpload(sizeof(Vector4));
+		return 0;
+	}
+
+	S32 NullMaterial::SetMatrixParam(const String& name, const Matrix& value)
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_SET_MATRIX_PARAM);
+		if (!IsValid())return counter.Fail();
+		if (m_isLocked)return counter.Fail();
+
+		Byte* ptr = GetVariable(name, ShaderParamType::MATRIX, sizeof(Matrix));
+		if (ptr == nullptr)return counter.Fail();
+
+		Platform::MemoryCopy(ptr, sizeof(Matrix), &value, sizeof(Matrix));
+		counter.AddUpload(sizeof(Matrix));
+		return 0;
+	}
+
+
+
+	Byte* NullMaterial::GetVariable(const String& name, const ShaderParamType type, const S32 size)
+	{
+		auto itr = m_variables.find(name);
+		if (itr != m_variables.end())
+		{
+			if (itr->second.type != type)return nullptr;
+			return m_data.data() + itr->second.offset;
+		}
+
+		// 定数バッファと同じく16バイト単位で詰める
+		ShaderVariableDesc desc;
+		desc.type = type;
+		desc.offset = (S32)m_data.size();
+		desc.elementCount = 1;
+		desc.registerNum = 0;
+		m_variables[name] = desc;
+
+		m_data.resize(m_data.size() + ((size + 15) & ~15));
+		return m_data.data() + desc.offset;
+	}
+}
\ No newline at end of file
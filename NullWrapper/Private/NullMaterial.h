@@ -0,0 +1,59 @@
+﻿#pragma once
+
+#include "IMaterial.h"
+#include "GraphicPipelineDesc.h"
+#include "NullCounter.h"
+
+namespace og
+{
+	class IGraphicPipeline;
+	class ITexture;
+
+	/// <summary>
+	/// 定数バッファの内容をCPUメモリ上にのみ保持するマテリアル
+	/// </summary>
+	/// <remarks>
+	/// シェーダーの解析を行わないため、名前は最初に設定された時の型でShaderVariableDescに登録し、
+	/// 以降は他のラッパーのリフレクションと同様に型の一致を検査する。レジスタの指定(cBufferMask、texMask)は使用しない。
+	/// </remarks>
+	class NullMaterial :public IMaterial
+	{
+	private:
+		struct TextureBinding
+		{
+			SPtr<ITexture> texture;
+			S32 target;
+		};
+
+		NullResource m_resource;
+
+		// 依存関係
+		SPtr<IGraphicPipeline> m_graphicPipeline;
+
+		// シェーダデータ
+		HashMap<String, ShaderVariableDesc> m_variables;
+		ArrayList<Byte> m_data;
+		HashMap<String, TextureBinding> m_textures;
+
+		bool m_isLocked;
+
+	public:
+		NullMaterial(const SPtr<NullCounter>& counter, const SPtr<IGraphicPipeline>& gpipeline);
+
+		S32 Lock()override;
+
+		S32 SetTexture(const String& name, const SPtr<ITexture>& texture, const S32 target)override;
+
+		S32 SetFloat4Param(const String& name, const Vector4& value)override;
+		S32 SetMatrixParam(const String& name, const Matrix& value)override;
+
+		inline bool IsValid()const { return m_graphicPipeline != nullptr; };
+
+	private:
+		/// <summary>
+		/// 変数の書き込み先を取得する。初めて使う名前の場合は領域を確保する
+		/// </summary>
+		/// <returns>型が一致しない場合はnullptr</returns>
+		Byte* GetVariable(const String& name, const ShaderParamType type, const S32 size);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+﻿#include "pch.h"
+#include "NullRenderTexture.h"
+
+#include "NullGraphicPipeline.h"
+#include "NullMaterial.h"
+#include "NullShape.h"
+
+namespace og
+{
+	NullRenderTexture::NullRenderTexture(const SPtr<NullCounter>& counter, const ArrayList<TextureFormat>& formats, const U32 width, const U32 height)
+		:m_resource(counter, RESOURCE_RENDER_TEXTURE), m_width(width), m_height(height), m_isDrawing(false)
+	{
+		m_clearColor.Set(0.0f, 0.0f, 0.0f);
+
+		if (formats.empty() || MAX_RENDER_TARGETS < formats.size())return;
+		if (width == 0 || height == 0)return;
+		m_formats = formats;
+	}
+
+
+
+	S32 NullRenderTexture::BeginDraw()
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_BEGIN_DRAW);
+		if (!IsValid())return counter.Fail();
+		if (m_isDrawing)return counter.Fail();
+
+		m_isDrawing = true;
+		return 0;
+	}
+
+	S32 NullRenderTexture::EndDraw()
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_END_DRAW);
+		if (!m_isDrawing)return counter.Fail();
+
+		m_graphicPipeline.reset();
+		m_material.reset();
+		m_isDrawing = false;
+		return 0;
+	}
+
+
+
+	S32 NullRenderTexture::SetGraphicPipeline(SPtr<IGraphicPipeline> pipeline)
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_SET_GRAPHIC_PIPELINE);
+		if (CheckArgs(!!pipeline))return counter.Fail();
+
+		auto ptr = dynamic_cast<NullGraphicPipeline*>(pipeline.get());
+		if (ptr == nullptr || GetTargetNum() < ptr->GetTargetNum())return counter.Fail();
+		m_graphicPipeline = pipeline;
+		return 0;
+	}
+
+	S32 NullRenderTexture::SetMaterial(SPtr<IMaterial> material)
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_SET_MATERIAL);
+		if (CheckArgs(!!material))return counter.Fail();
+		if (dynamic_cast<NullMaterial*>(material.get()) == nullptr)return counter.Fail();
+		m_material = material;
+		return 0;
+	}
+
+
+
+	S32 NullRenderTexture::DrawInstanced(SPtr<IShape>& shape, const U32 count)
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_DRAW_INSTANCED);
+		if (CheckArgs(!!shape, !!m_graphicPipeline))return counter.Fail();
+		if (!m_isDrawing)return counter.Fail();
+
+		auto ptr = dynamic_cast<NullShape*>(shape.get());
+		if (ptr == nullptr)return counter.Fail();
+
+		counter.AddDraw(count, (U64)ptr->GetTriangleCount() * count);
+		return 0;
+	}
+
+	S32 NullRenderTexture::DrawInstanced(SPtr<IShape>& shape, SPtr<IShape>& instances, const U32 firstInstance, const U32 count)
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_DRAW_INSTANCED);
+		if (CheckArgs(!!shape, !!instances, !!m_graphicPipeline))return counter.Fail();
+		if (!m_isDrawing)return counter.Fail();
+
+		auto ptr = dynamic_cast<NullShape*>(shape.get());
+		auto instancesPtr = dynamic_cast<NullShape*>(instances.get());
+		if (ptr == nullptr || instancesPtr == nullptr)return counter.Fail();
+		if (instancesPtr->GetInstanceCount() < firstInstance + count)return counter.Fail();
+
+		counter.AddDraw(count, (U64)ptr->GetTriangleCount() * count);
+		return 0;
+	}
+
+
+
+	Vector3 NullRenderTexture::GetSize()
+	{
+		m_resource.GetCounter().Call(CALL_GET_TEXTURE_INFO);
+		if (!IsValid())return Vector3();
+		return Vector3((F32)m_width, (F32)m_height, 1.0f);
+	}
+
+	S32 NullRenderTexture::GetDimension()
+	{
+		m_resource.GetCounter().Call(CALL_GET_TEXTURE_INFO);
+		if (!IsValid())return 0;
+		// 2次元テクスチャ
+		return 2;
+	}
+
+
+
+	void NullRenderTexture::SetClearColor(Color color)
+	{
+		m_resource.GetCounter().Call(CALL_SET_CLEAR_COLOR);
+		m_clearColor = color;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+﻿#pragma once
+#include "IRenderTexture.h"
+#include "NullCounter.h"
+
+namespace og
+{
+	/// <summary>
+	/// 描画先を持たないレンダーテクスチャ
+	/// </summary>
+	/// <remarks>
+	/// 描画命令の検査と集計のみ行う。描画はBeginDrawからEndDrawの間でのみ受け付ける。
+	/// </remarks>
+	class NullRenderTexture :public IRenderTexture
+	{
+	public:
+		static const S32 MAX_RENDER_TARGETS = 8;
+	private:
+		NullResource m_resource;
+
+		ArrayList<TextureFormat> m_formats;
+		U32 m_width;
+		U32 m_height;
+
+		SPtr<IGraphicPipeline> m_graphicPipeline;
+		SPtr<IMaterial> m_material;
+
+		Color m_clearColor;
+		bool m_isDrawing;
+
+	public:
+		NullRenderTexture(const SPtr<NullCounter>& counter, const ArrayList<TextureFormat>& formats, const U32 width, const U32 height);
+
+		inline bool IsValid()const { return m_formats.empty() == false; }
+
+		inline S32 GetTargetNum()const { return (S32)m_formats.size(); }
+
+
+
+		S32 BeginDraw()override;
+		S32 EndDraw()override;
+
+		S32 SetGraphicPipeline(SPtr<IGraphicPipeline> pipeline)override;
+
+		S32 SetMaterial(SPtr<IMaterial> material)override;
+
+		S32 DrawInstanced(SPtr<IShape>& shape, const U32 count = 1)override;
+		S32 DrawInstanced(SPtr<IShape>& shape, SPtr<IShape>& instances, const U32 firstInstance, const U32 count)override;
+
+
+		Vector3 GetSize()override;
+		S32 GetDimension()override;
+
+
+		void SetClearColor(Color color)override;
+	};
+}
\ No newline at end of file
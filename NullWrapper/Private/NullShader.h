@@ -0,0 +1,28 @@
+﻿#pragma once
+
+#include "IShader.h"
+#include "NullCounter.h"
+
+namespace og
+{
+	/// <summary>
+	/// コンパイルを行わないシェーダー
+	/// </summary>
+	/// <remarks>
+	/// ソースはコンパイルせず、名前(ファイルパスまたはソース)として保持する。
+	/// </remarks>
+	class NullShader :public IShader
+	{
+	private:
+		NullResource m_resource;
+		const ShaderType m_type;
+		const String m_name;
+
+	public:
+		NullShader(const SPtr<NullCounter>& counter, const ShaderType type, const String& name)
+			:m_resource(counter, RESOURCE_SHADER), m_type(type), m_name(name) {}
+
+		inline ShaderType GetType()const { return m_type; }
+		inline const String& GetName()const { return m_name; }
+	};
+}
\ No newline at end of file
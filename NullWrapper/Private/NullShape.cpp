@@ -0,0 +1,122 @@
+﻿#include "pch.h"
+#include "NullShape.h"
+
+#include <cassert>
+
+#include "Platform.h"
+
+namespace og
+{
+	NullShape::NullShape(const SPtr<NullCounter>& counter, const U32 stribeSize)
+		:m_resource(counter, RESOURCE_SHAPE), ms_stribeSize(stribeSize), m_isLocked(false)
+	{
+		assert(0 < stribeSize);
+	}
+
+
+
+	S32 NullShape::Vertex(const Byte* bytes, const U32 size)
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_SET_VERTEX);
+		if (bytes == nullptr)return counter.Fail();
+
+		U32 currentSize = (U32)m_data.size();
+		U32 byteSize = size * ms_stribeSize;
+		m_data.resize(currentSize + byteSize);
+		Platform::MemoryCopy(m_data.data() + currentSize, byteSize, bytes, byteSize);
+		counter.AddUpload(byteSize);
+		return 0;
+	}
+
+	S32 NullShape::Indices(const U32 index1, const U32 index2, const U32 index3)
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_SET_INDICES);
+
+		m_indices.push_back(index1);
+		m_indices.push_back(index2);
+		m_indices.push_back(index3);
+		counter.AddUpload(sizeof(U32) * 3);
+		return 0;
+	}
+	S32 NullShape::Indices(const U32* indices, const U32 count)
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_SET_INDICES);
+		if (indices == nullptr)return counter.Fail();
+
+		U32 currentSize = (U32)m_indices.size();
+		m_indices.resize(currentSize + count);
+		Platform::MemoryCopy(m_indices.data() + currentSize, sizeof(U32) * count, indices, sizeof(U32) * count);
+		counter.AddUpload(sizeof(U32) * count);
+		return 0;
+	}
+
+	Byte* NullShape::LockVertices()
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_LOCK_VERTICES);
+		if (m_data.empty())
+		{
+			counter.Fail();
+			return nullptr;
+		}
+		m_isLocked = true;
+		return m_data.data();
+	}
+
+	// 他のラッパーと同様に、頂点データ全体を転送したものとして数える
+	S32 NullShape::UnlockVertices()
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_UNLOCK_VERTICES);
+		if (!m_isLocked)return counter.Fail();
+
+		m_isLocked = false;
+		counter.AddUpload(m_data.size());
+		return 0;
+	}
+
+	S32 NullShape::GetStribeSize()
+	{
+		m_resource.GetCounter().Call(CALL_GET_SHAPE_INFO);
+		return ms_stribeSize;
+	}
+	S32 NullShape::GetVertexCount()
+	{
+		m_resource.GetCounter().Call(CALL_GET_SHAPE_INFO);
+		return (S32)(m_data.size() / ms_stribeSize);
+	}
+	S32 NullShape::GetIndexCount()
+	{
+		m_resource.GetCounter().Call(CALL_GET_SHAPE_INFO);
+		return (S32)m_indices.size();
+	}
+	const Byte* NullShape::GetVertices()
+	{
+		m_resource.GetCounter().Call(CALL_GET_SHAPE_INFO);
+		return m_data.empty() ? nullptr : m_data.data();
+	}
+	const U32* NullShape::GetIndices()
+	{
+		m_resource.GetCounter().Call(CALL_GET_SHAPE_INFO);
+		return m_indices.empty() ? nullptr : m_indices.data();
+	}
+	S32 NullShape::Optimize(const MeshOptimizeSettings& settings, MeshOptimizeReport* report)
+	{
+		auto& counter = m_resource.GetCounter();
+		counter.Call(CALL_OPTIMIZE_SHAPE);
+		if (m_isLocked)return counter.Fail();
+		if (MeshOptimizer::Optimize(m_data, m_indices, ms_stribeSize, settings, report))return counter.Fail();
+
+		counter.AddUpload(m_data.size() + sizeof(U32) * m_indices.size());
+		return 0;
+	}
+
+	U32 NullShape::GetTriangleCount()const
+	{
+		if (m_indices.empty())return (U32)(m_data.size() / ms_stribeSize / 3);
+		return (U32)(m_indices.size() / 3);
+	}
+}
\ No newline at end of file
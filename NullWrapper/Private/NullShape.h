@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include "IShape.h"
+#include "NullCounter.h"
+
+namespace og
+{
+	/// <summary>
+	/// 頂点とインデックスをCPUメモリ上にのみ保持する
+	/// </summary>
+	class NullShape :public IShape
+	{
+	private:
+		NullResource m_resource;
+		const U32 ms_stribeSize;
+
+		ArrayList<Byte> m_data;
+		ArrayList<U32> m_indices;
+
+		bool m_isLocked;
+
+	public:
+		NullShape(const SPtr<NullCounter>& counter, const U32 stribeSize);
+
+		S32 Vertex(const Byte* bytes, const U32 size)override;
+		S32 Indices(const U32 index1, const U32 index2, const U32 index3)override;
+		S32 Indices(const U32* indices, const U32 count)override;
+
+		Byte* LockVertices()override;
+		S32 UnlockVertices()override;
+
+		S32 GetStribeSize()override;
+		S32 GetVertexCount()override;
+		S32 GetIndexCount()override;
+		const Byte* GetVertices()override;
+		const U32* GetIndices()override;
+		S32 Optimize(const MeshOptimizeSettings& settings, MeshOptimizeReport* report)override;
+
+		/// <summary>
+		/// 1インスタンスあたりの三角形数。インデックスが無い場合は頂点を3つずつ三角形として数える
+		/// </summary>
+		U32 GetTriangleCount()const;
+
+		/// <summary>
+		/// インスタンスごとのデータとして使う場合の要素数(集計に含めない頂点数)
+		/// </summary>
+		inline U32 GetInstanceCount()const { return (U32)(m_data.size() / ms_stribeSize); }
+	};
+}
\ No newline at end of file
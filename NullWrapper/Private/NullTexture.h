@@ -0,0 +1,39 @@
+﻿#pragma once
+
+#include "ITexture.h"
+#include "NullCounter.h"
+
+namespace og
+{
+	/// <summary>
+	/// 画像を読み込まないテクスチャ
+	/// </summary>
+	/// <remarks>
+	/// ファイルの存在のみ確認し、内容は読み込まない。大きさは常に(1,1,1)となる。
+	/// </remarks>
+	class NullTexture :public ITexture
+	{
+	private:
+		NullResource m_resource;
+		const Path m_path;
+
+	public:
+		NullTexture(const SPtr<NullCounter>& counter, const Path& path)
+			:m_resource(counter, RESOURCE_TEXTURE), m_path(path) {}
+
+		inline const Path& GetPath()const { return m_path; }
+
+		Vector3 GetSize()override
+		{
+			m_resource.GetCounter().Call(CALL_GET_TEXTURE_INFO);
+			return Vector3(1.0f, 1.0f, 1.0f);
+		}
+
+		S32 GetDimension()override
+		{
+			m_resource.GetCounter().Call(CALL_GET_TEXTURE_INFO);
+			// 2次元テクスチャ
+			return 2;
+		}
+	};
+}
\ No newline at end of file
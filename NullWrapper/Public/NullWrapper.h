@@ -0,0 +1,130 @@
+﻿#pragma once
+
+#include "IGraphicWrapper.h"
+
+#if defined(PLATFORM_WINDOWS)
+#ifdef NULLWRAPPER_EXPORTS
+#define DLL_OG __declspec(dllexport)
+#else
+#define DLL_OG __declspec(dllimport)
+#endif
+#else
+#define DLL_OG __attribute__((visibility("default")))
+#endif
+
+namespace og
+{
+	/// <summary>
+	/// 回数を記録する関数
+	/// </summary>
+	enum NullCallType
+	{
+		// IGraphicWrapper
+		CALL_INIT,
+		CALL_SWAP_SCREEN,
+		CALL_CREATE_RENDER_TEXTURE,
+		CALL_LOAD_TEXTURE,
+		CALL_LOAD_SHADER,
+		CALL_CREATE_SHADER,
+		CALL_CREATE_GRAPHIC_PIPELINE,
+		CALL_CREATE_MATERIAL,
+		CALL_CREATE_SHAPE,
+		// IRenderTexture
+		CALL_BEGIN_DRAW,
+		CALL_END_DRAW,
+		CALL_SET_GRAPHIC_PIPELINE,
+		CALL_SET_MATERIAL,
+		CALL_DRAW_INSTANCED,
+		CALL_SET_CLEAR_COLOR,
+		// ITexture(GetSize、GetDimension)
+		CALL_GET_TEXTURE_INFO,
+		// IMaterial
+		CALL_LOCK_MATERIAL,
+		CALL_SET_TEXTURE,
+		CALL_SET_FLOAT4_PARAM,
+		CALL_SET_MATRIX_PARAM,
+		// IShape
+		CALL_SET_VERTEX,
+		CALL_SET_INDICES,
+		CALL_LOCK_VERTICES,
+		CALL_UNLOCK_VERTICES,
+		CALL_OPTIMIZE_SHAPE,
+		// IShape(GetStribeSize、GetVertexCount、GetIndexCount、GetVertices、GetIndices)
+		CALL_GET_SHAPE_INFO,
+		CALL_TYPE_COUNT,
+	};
+
+
+	/// <summary>
+	/// 生存数を記録するリソース
+	/// </summary>
+	enum NullResourceType
+	{
+		RESOURCE_RENDER_TEXTURE,
+		RESOURCE_TEXTURE,
+		RESOURCE_SHADER,
+		RESOURCE_GRAPHIC_PIPELINE,
+		RESOURCE_MATERIAL,
+		RESOURCE_SHAPE,
+		RESOURCE_TYPE_COUNT,
+	};
+
+
+	/// <summary>
+	/// 呼び出し回数と描画量の集計
+	/// </summary>
+	struct NullStatistics
+	{
+		/// <summary> 関数ごとの呼び出し回数。エラーを返した呼び出しも含む </summary>
+		U64 calls[CALL_TYPE_COUNT] = {};
+		/// <summary> エラーを返した呼び出しの回数 </summary>
+		U64 failedCalls = 0;
+		/// <summary> DrawInstancedで描画したインスタンス数の合計 </summary>
+		U64 instances = 0;
+		/// <summary> DrawInstancedで描画した三角形数の合計(インスタンス数を掛けたもの) </summary>
+		U64 triangles = 0;
+		/// <summary> 頂点、インデックス、マテリアルのパラメータとして受け取ったバイト数の合計 </summary>
+		U64 uploadedBytes = 0;
+		/// <summary> 現在生存しているリソースの数。ResetStatisticsではリセットされない </summary>
+		S64 liveResources[RESOURCE_TYPE_COUNT] = {};
+
+		/// <summary>
+		/// 全ての関数の呼び出し回数の合計
+		/// </summary>
+		inline U64 GetTotalCalls()const
+		{
+			U64 total = 0;
+			for (auto count : calls)total += count;
+			return total;
+		}
+	};
+
+
+	/// <summary>
+	/// GPUへの命令を一切発行しないグラフィックラッパー
+	/// </summary>
+	/// <remarks>
+	/// 描画処理のCPU側の負荷をGPUと切り離して計測するために使う。パラメータの保持や型の検査、リソースの参照管理といった
+	/// CPU側の処理は他のラッパーと同様に行い、全ての関数の呼び出し回数を記録する。ウィンドウもGPUも必要としないため、
+	/// Linuxのビルドマシン上でのベンチマークにも使える。
+	/// 集計はスレッドセーフで、作成したリソースがラッパーより後に破棄されても問題ない。
+	/// </remarks>
+	class INullGraphicWrapper :public IGraphicWrapper
+	{
+	public:
+		/// <summary>
+		/// 前回のResetStatisticsからの集計を取得する
+		/// </summary>
+		virtual NullStatistics GetStatistics()const = 0;
+
+		/// <summary>
+		/// 呼び出し回数と描画量の集計を0に戻す。リソースの生存数はそのまま残る
+		/// </summary>
+		virtual void ResetStatistics() = 0;
+	};
+
+
+	extern "C" {
+		DLL_OG IGraphicWrapper* CreateGraphicWrapper();
+	}
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "DirectoryAsset.h"
 
-#include <Windows.h>
+#include <filesystem>
+#include <system_error>
+#include <typeinfo>
 
 #include "UndefinedAsset.h"
 #include "AssetManager.h"
@@ -24,33 +26,20 @@ namespace OrigamiEngine {
 
 	void DirectoryAsset::LoadChildEntries()
 	{
-		HANDLE hFind;				// nh
-		WIN32_FIND_DATA win32fd;	// t@C
-
-		String searchPath = m_Path.Fullpath() + L"\\*";
-
-		// nh擾t@Cۑ
-		hFind = FindFirstFile(searchPath.c_str(), &win32fd);
-
-		// ȂƂ
-		if (hFind == INVALID_HANDLE_VALUE)
+		// JȂƂ͉ǉȂB"."".."͗񋓂Ȃ
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(m_Path.Fullpath(), error))
 		{
-			FindClose(hFind);
-			return;
-		}
-		do
-		{
-			String childPath = m_Path.Fullpath() + L"\\" + win32fd.cFileName;
-			if ((wcscmp(win32fd.cFileName, L".") == 0) || (wcscmp(win32fd.cFileName, L"..") == 0))continue;
+			String childPath = entry.path().wstring();
 			
 			SPtr<EntryAsset> childPtr;
 
-			if (win32fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+			if (entry.is_directory(error))
 			{
 				// tH_̂Ƃ
 				childPtr = MSPtr<DirectoryAsset>(childPath);
 			}
-			else if((wcscmp(win32fd.cFileName, L".") != 0) && (wcscmp(win32fd.cFileName, L"..") != 0))
+			else
 			{
 				// t@ĈƂ
 				String extention = m_Path.Extension();
@@ -71,9 +60,7 @@ namespace OrigamiEngine {
 			{
 				m_Children.emplace_back(childPtr);
 			}
-		} while (FindNextFile(hFind, &win32fd));
-
-		FindClose(hFind);
+		}
 	}
 
 
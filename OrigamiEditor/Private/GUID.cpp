@@ -1,5 +1,7 @@
 #include "GUID.h"
 
+#include <cwchar>
+
 namespace OrigamiEngine {
 
 	GUID::GUID()
@@ -22,7 +24,7 @@ namespace OrigamiEngine {
 	String GUID::ToString()
 	{
 		wchar_t buffer[64] = {};
-		swprintf_s(buffer,64, L"%8.X-%8.X-%8.X-%8.X", a,b,c,d);
+		swprintf(buffer, 64, L"%8.X-%8.X-%8.X-%8.X", a, b, c, d);
 		return String(buffer);
 	}
 
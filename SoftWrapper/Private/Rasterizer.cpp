@@ -0,0 +1,508 @@
+﻿#include "pch.h"
+#include "Rasterizer.h"
+
+#include "Simd.h"
+#include "SoftTexture.h"
+
+namespace
+{
+	using namespace og;
+
+	// 1つの塊でセットアップする三角形の数の目安
+	const size_t TRIANGLES_PER_CHUNK = 1024;
+	// 塊の最大数(タイルの振り分け先の数に比例して作業領域が増える)
+	const size_t MAX_CHUNKS = 64;
+	// 1回の呼び出しで処理する頂点の数
+	const size_t VERTEX_GRAIN = 256;
+	// 三角形を手前と奥の2平面でクリップしたときの頂点の最大数
+	const U32 MAX_CLIP_VERTICES = 5;
+
+	// クリップ空間の各平面の外側にあることを表すビット
+	const U32 OUTSIDE_LEFT = 1 << 0;
+	const U32 OUTSIDE_RIGHT = 1 << 1;
+	const U32 OUTSIDE_BOTTOM = 1 << 2;
+	const U32 OUTSIDE_TOP = 1 << 3;
+	const U32 OUTSIDE_NEAR = 1 << 4;
+	const U32 OUTSIDE_FAR = 1 << 5;
+
+	/// <summary>
+	/// 頂点データの先頭のF32x3をクリップ空間の座標とする
+	/// </summary>
+	inline void DefaultVertexShader(const SoftVertexInput& input, SoftVertexOutput& output)
+	{
+		F32 position[3];
+		memcpy(position, input.data, sizeof(position));
+		output.position = Vector4(position[0], position[1], position[2], 1.0f);
+	}
+
+	inline U32 ComputeOutcode(const Vector4& p)
+	{
+		U32 code = 0;
+		if (p.x < -p.w)code |= OUTSIDE_LEFT;
+		if (p.w < p.x)code |= OUTSIDE_RIGHT;
+		if (p.y < -p.w)code |= OUTSIDE_BOTTOM;
+		if (p.w < p.y)code |= OUTSIDE_TOP;
+		if (p.z < 0.0f)code |= OUTSIDE_NEAR;
+		if (p.w < p.z)code |= OUTSIDE_FAR;
+		return code;
+	}
+
+	inline bool LessPosition(const Vector4& a, const Vector4& b)
+	{
+		if (a.x != b.x)return a.x < b.x;
+		if (a.y != b.y)return a.y < b.y;
+		if (a.z != b.z)return a.z < b.z;
+		return a.w < b.w;
+	}
+
+	/// <summary>
+	/// 辺と平面の交点を求める
+	/// </summary>
+	/// <remarks>
+	/// 隣接する三角形で同じ交点になるように、辺の向きに関わらず同じ端点から補間する。
+	/// </remarks>
+	inline void Intersect(const SoftVertexOutput& a, const F32 da, const SoftVertexOutput& b, const F32 db, const U32 varyingCount, SoftVertexOutput& output)
+	{
+		const bool swap = LessPosition(b.position, a.position);
+		const SoftVertexOutput& p = swap ? b : a;
+		const SoftVertexOutput& q = swap ? a : b;
+		const F32 dp = swap ? db : da;
+		const F32 dq = swap ? da : db;
+
+		const F32 t = dp / (dp - dq);
+		output.position = p.position + (q.position - p.position) * t;
+		for (U32 i = 0; i < varyingCount; i++)
+		{
+			output.varyings[i] = p.varyings[i] + (q.varyings[i] - p.varyings[i]) * t;
+		}
+	}
+
+	/// <summary>
+	/// 多角形のうち平面の内側(distanceが0以上)の部分を切り取る
+	/// </summary>
+	/// <returns>切り取った多角形の頂点数</returns>
+	template<class Distance>
+	U32 ClipPolygon(const SoftVertexOutput* input, const U32 count, SoftVertexOutput* output, const U32 varyingCount, const Distance& distance)
+	{
+		U32 outputCount = 0;
+		for (U32 i = 0; i < count; i++)
+		{
+			const SoftVertexOutput& a = input[i];
+			const SoftVertexOutput& b = input[(i + 1) % count];
+			const F32 da = distance(a.position);
+			const F32 db = distance(b.position);
+			if (0.0f <= da)output[outputCount++] = a;
+			if ((0.0f <= da) != (0.0f <= db))Intersect(a, da, b, db, varyingCount, output[outputCount++]);
+		}
+		return outputCount;
+	}
+
+	/// <summary>
+	/// 描画先の色と合成する
+	/// </summary>
+	/// <remarks>
+	/// MIX、ADD、SUBSTRACT以外は、合成した色と描画先の色をピクセルシェーダーの出力のアルファで補間する。
+	/// REPLACEと未知の値は出力をそのまま書き込む。
+	/// </remarks>
+	inline Vector4 Blend(const Vector4& src, const Vector4& dst, const BlendMode mode)
+	{
+		const F32 a = src.w;
+		const F32 alpha = a + dst.w * (1.0f - a);
+		auto mix = [&](const Vector4& color)
+		{
+			Vector4 result = dst + (color - dst) * a;
+			result.w = alpha;
+			return result;
+		};
+
+		switch (mode)
+		{
+		case BlendMode::MIX:
+			return mix(src);
+		case BlendMode::ADD:
+		{
+			Vector4 result = dst + src * a;
+			result.w = alpha;
+			return result;
+		}
+		case BlendMode::SUBSTRACT:
+		{
+			Vector4 result = dst - src * a;
+			result.w = alpha;
+			return result;
+		}
+		case BlendMode::DARKEST:
+			return mix(Vector4(Mathf::Min(src.x, dst.x), Mathf::Min(src.y, dst.y), Mathf::Min(src.z, dst.z), 0));
+		case BlendMode::LIGHTEST:
+			return mix(Vector4(Mathf::Max(src.x, dst.x), Mathf::Max(src.y, dst.y), Mathf::Max(src.z, dst.z), 0));
+		case BlendMode::DIFF:
+			return mix(Vector4(Mathf::Abs(src.x - dst.x), Mathf::Abs(src.y - dst.y), Mathf::Abs(src.z - dst.z), 0));
+		case BlendMode::MULTIPLY:
+			return mix(src * dst);
+		case BlendMode::SCREEN:
+			return mix(Vector4(1 - (1 - src.x) * (1 - dst.x), 1 - (1 - src.y) * (1 - dst.y), 1 - (1 - src.z) * (1 - dst.z), 0));
+		case BlendMode::INVERT:
+			return mix(Vector4(1 - dst.x, 1 - dst.y, 1 - dst.z, 0));
+		default:
+			return src;
+		}
+	}
+}
+
+namespace og
+{
+	Rasterizer::Rasterizer() :m_width(0), m_height(0), m_tileCountX(0), m_tileCountY(0)
+	{
+	}
+
+	Rasterizer::~Rasterizer()
+	{
+	}
+
+	//===================================================================================//
+
+	void Rasterizer::Resize(const U32 width, const U32 height)
+	{
+		m_width = width;
+		m_height = height;
+		m_tileCountX = (width + TILE_SIZE - 1) / TILE_SIZE;
+		m_tileCountY = (height + TILE_SIZE - 1) / TILE_SIZE;
+		m_bins.clear();
+	}
+
+	//===================================================================================//
+
+	S32 Rasterizer::Draw(const SoftDrawCall& call, SoftSurface* const* targets, const U32 targetCount, F32* depth)
+	{
+		if (CheckArgs(call.vertices, call.params, targets, depth))return -1;
+		if (targetCount == 0 || MAX_TARGETS < targetCount || SOFT_MAX_VARYINGS < call.varyingCount)return -1;
+		if (call.stride == 0 || (call.vertexShader == nullptr && call.stride < sizeof(F32) * 3))return -1;
+		for (U32 i = 0; i < targetCount; i++)
+		{
+			if (targets[i] == nullptr || targets[i]->GetWidth() != m_width || targets[i]->GetHeight() != m_height)return -1;
+		}
+		if (call.indices)
+		{
+			for (U32 i = 0; i < call.indexCount; i++)
+			{
+				if (call.vertexCount <= call.indices[i])return -1;
+			}
+		}
+
+		const U32 trianglesPerInstance = (call.indices ? call.indexCount : call.vertexCount) / 3;
+		if (trianglesPerInstance == 0 || call.instanceCount == 0 || m_width == 0 || m_height == 0)return 0;
+
+		// 頂点シェーダー
+		const size_t vertexTotal = (size_t)call.vertexCount * call.instanceCount;
+		m_vertices.resize(vertexTotal);
+		Parallel::For(vertexTotal, VERTEX_GRAIN, [&](size_t begin, size_t end)
+			{
+				SoftVertexInput input;
+				input.params = call.params;
+				for (size_t i = begin; i < end; i++)
+				{
+					input.vertexID = (U32)(i % call.vertexCount);
+					input.instanceID = (U32)(i / call.vertexCount);
+					input.data = call.vertices + (size_t)input.vertexID * call.stride;
+					input.instanceData = call.instances ? call.instances + (size_t)input.instanceID * call.instanceStride : nullptr;
+					if (call.vertexShader)(*call.vertexShader)(input, m_vertices[i]);
+					else DefaultVertexShader(input, m_vertices[i]);
+				}
+			});
+
+		// 三角形のセットアップとタイルへの振り分け
+		const size_t triangleTotal = (size_t)trianglesPerInstance * call.instanceCount;
+		size_t chunkCount = (triangleTotal + TRIANGLES_PER_CHUNK - 1) / TRIANGLES_PER_CHUNK;
+		if (MAX_CHUNKS < chunkCount)chunkCount = MAX_CHUNKS;
+		const U32 tileCount = m_tileCountX * m_tileCountY;
+		if (m_chunkTriangles.size() < chunkCount)m_chunkTriangles.resize(chunkCount);
+		if (m_bins.size() < chunkCount * tileCount)m_bins.resize(chunkCount * tileCount);
+
+		Parallel::For(chunkCount, 1, [&](size_t begin, size_t end)
+			{
+				for (size_t chunk = begin; chunk < end; chunk++)
+				{
+					m_chunkTriangles[chunk].clear();
+					for (U32 tile = 0; tile < tileCount; tile++)m_bins[chunk * tileCount + tile].clear();
+					SetupTriangles(call, (U32)chunk, triangleTotal * chunk / chunkCount, triangleTotal * (chunk + 1) / chunkCount, trianglesPerInstance);
+				}
+			});
+
+		// タイルごとのラスタライズ
+		Parallel::For(tileCount, 1, [&](size_t begin, size_t end)
+			{
+				for (size_t tile = begin; tile < end; tile++)
+				{
+					RasterizeTile(call, (U32)tile, (U32)chunkCount, targets, targetCount, depth);
+				}
+			});
+
+		return 0;
+	}
+
+	//===================================================================================//
+
+	void Rasterizer::SetupTriangles(const SoftDrawCall& call, const U32 chunk, const size_t begin, const size_t end, const U32 trianglesPerInstance)
+	{
+		SoftVertexOutput polygon[MAX_CLIP_VERTICES];
+		SoftVertexOutput clipped[MAX_CLIP_VERTICES];
+
+		for (size_t t = begin; t < end; t++)
+		{
+			const U32 instanceID = (U32)(t / trianglesPerInstance);
+			const U32 local = (U32)(t % trianglesPerInstance);
+			const SoftVertexOutput* base = m_vertices.data() + (size_t)instanceID * call.vertexCount;
+
+			const SoftVertexOutput* v0 = base + (call.indices ? call.indices[local * 3 + 0] : local * 3 + 0);
+			const SoftVertexOutput* v1 = base + (call.indices ? call.indices[local * 3 + 1] : local * 3 + 1);
+			const SoftVertexOutput* v2 = base + (call.indices ? call.indices[local * 3 + 2] : local * 3 + 2);
+
+			const U32 code0 = ComputeOutcode(v0->position);
+			const U32 code1 = ComputeOutcode(v1->position);
+			const U32 code2 = ComputeOutcode(v2->position);
+
+			// 全ての頂点が同じ平面の外側にある
+			if (code0 & code1 & code2)continue;
+
+			// 手前と奥の平面をまたぐ三角形のみクリップする。左右上下は描画範囲で切り取る
+			if (((code0 | code1 | code2) & (OUTSIDE_NEAR | OUTSIDE_FAR)) == 0)
+			{
+				AddTriangle(call, chunk, v0, v1, v2, instanceID);
+				continue;
+			}
+
+			polygon[0] = *v0;
+			polygon[1] = *v1;
+			polygon[2] = *v2;
+			U32 count = ClipPolygon(polygon, 3, clipped, call.varyingCount, [](const Vector4& p) { return p.z; });
+			count = ClipPolygon(clipped, count, polygon, call.varyingCount, [](const Vector4& p) { return p.w - p.z; });
+			for (U32 i = 2; i < count; i++)
+			{
+				AddTriangle(call, chunk, &polygon[0], &polygon[i - 1], &polygon[i], instanceID);
+			}
+		}
+	}
+
+	//===================================================================================//
+
+	void Rasterizer::AddTriangle(const SoftDrawCall& call, const U32 chunk, const SoftVertexOutput* v0, const SoftVertexOutput* v1, const SoftVertexOutput* v2, const U32 instanceID)
+	{
+		const SoftVertexOutput* vertices[3] = { v0, v1, v2 };
+
+		// スクリーン座標(左上が原点、下向きがY+)
+		F32 x[3], y[3];
+		Triangle triangle;
+		for (U32 k = 0; k < 3; k++)
+		{
+			const Vector4& p = vertices[k]->position;
+			if (!(0.0f < p.w))return;
+			const F32 invW = 1.0f / p.w;
+			x[k] = (p.x * invW * 0.5f + 0.5f) * m_width;
+			y[k] = (0.5f - p.y * invW * 0.5f) * m_height;
+			triangle.z[k] = p.z * invW;
+			triangle.invW[k] = invW;
+		}
+
+		// 画面上で時計回りなら正
+		const F32 area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+		if (area == 0.0f || !std::isfinite(area))return;
+
+		triangle.isFrontFace = 0.0f < area;
+		if (call.cullMode == CullMode::BACK && !triangle.isFrontFace)return;
+		if (call.cullMode == CullMode::FRONT && triangle.isFrontFace)return;
+
+		// ピクセルの中心が範囲に入るピクセル
+		const F32 minX = Mathf::Min(x[0], Mathf::Min(x[1], x[2]));
+		const F32 maxX = Mathf::Max(x[0], Mathf::Max(x[1], x[2]));
+		const F32 minY = Mathf::Min(y[0], Mathf::Min(y[1], y[2]));
+		const F32 maxY = Mathf::Max(y[0], Mathf::Max(y[1], y[2]));
+		triangle.minX = (S32)Mathf::Max(Mathf::Ceil(minX - 0.5f), 0.0f);
+		triangle.minY = (S32)Mathf::Max(Mathf::Ceil(minY - 0.5f), 0.0f);
+		triangle.maxX = (S32)Mathf::Min(Mathf::Floor(maxX - 0.5f), (F32)(m_width - 1));
+		triangle.maxY = (S32)Mathf::Min(Mathf::Floor(maxY - 0.5f), (F32)(m_height - 1));
+		if (triangle.maxX < triangle.minX || triangle.maxY < triangle.minY)return;
+
+		const F32 orientation = 0.0f < area ? 1.0f : -1.0f;
+		for (U32 k = 0; k < 3; k++)
+		{
+			// 辺の端点を座標の小さい順に並べ、その向きで辺関数を計算する
+			const U32 p = (k + 1) % 3;
+			const U32 q = (k + 2) % 3;
+			const bool forward = x[p] < x[q] || (x[p] == x[q] && y[p] < y[q]);
+			const U32 start = forward ? p : q;
+			const U32 end = forward ? q : p;
+			const F32 dx = x[end] - x[start];
+			const F32 dy = y[end] - y[start];
+			const F32 sign = forward ? orientation : -orientation;
+
+			triangle.edgeA[k] = -dy * sign;
+			triangle.edgeB[k] = dx * sign;
+			triangle.originX[k] = x[start];
+			triangle.originY[k] = y[start];
+			triangle.includeEdge[k] = 0.0f < triangle.edgeA[k] || (triangle.edgeA[k] == 0.0f && 0.0f < triangle.edgeB[k]);
+			triangle.invEdgeLength[k] = 1.0f / Mathf::Sqrt(dx * dx + dy * dy);
+
+			for (U32 i = 0; i < call.varyingCount; i++)
+			{
+				triangle.attributes[k][i] = vertices[k]->varyings[i] * triangle.invW[k];
+			}
+		}
+		triangle.invArea = 1.0f / Mathf::Abs(area);
+		triangle.instanceID = instanceID;
+
+		auto& triangles = m_chunkTriangles[chunk];
+		const U32 index = (U32)triangles.size();
+		triangles.push_back(triangle);
+
+		const U32 tileCount = m_tileCountX * m_tileCountY;
+		for (U32 ty = triangle.minY / TILE_SIZE; ty <= triangle.maxY / TILE_SIZE; ty++)
+		{
+			for (U32 tx = triangle.minX / TILE_SIZE; tx <= triangle.maxX / TILE_SIZE; tx++)
+			{
+				m_bins[chunk * tileCount + ty * m_tileCountX + tx].push_back(index);
+			}
+		}
+	}
+
+	//===================================================================================//
+
+	void Rasterizer::RasterizeTile(const SoftDrawCall& call, const U32 tile, const U32 chunkCount, SoftSurface* const* targets, const U32 targetCount, F32* depth)const
+	{
+		const U32 tileCount = m_tileCountX * m_tileCountY;
+		const S32 tileMinX = (S32)((tile % m_tileCountX) * TILE_SIZE);
+		const S32 tileMinY = (S32)((tile / m_tileCountX) * TILE_SIZE);
+		const S32 tileMaxX = (tileMinX + TILE_SIZE < m_width ? tileMinX + TILE_SIZE : m_width) - 1;
+		const S32 tileMaxY = (tileMinY + TILE_SIZE < m_height ? tileMinY + TILE_SIZE : m_height) - 1;
+
+		for (U32 chunk = 0; chunk < chunkCount; chunk++)
+		{
+			const auto& triangles = m_chunkTriangles[chunk];
+			for (const U32 index : m_bins[chunk * tileCount + tile])
+			{
+				RasterizeTriangle(call, triangles[index], tileMinX, tileMinY, tileMaxX, tileMaxY, targets, targetCount, depth);
+			}
+		}
+	}
+
+	//===================================================================================//
+
+	void Rasterizer::RasterizeTriangle(const SoftDrawCall& call, const Triangle& triangle, const S32 tileMinX, const S32 tileMinY, const S32 tileMaxX, const S32 tileMaxY,
+		SoftSurface* const* targets, const U32 targetCount, F32* depth)const
+	{
+		const S32 beginX = triangle.minX < tileMinX ? tileMinX : triangle.minX;
+		const S32 endX = tileMaxX < triangle.maxX ? tileMaxX : triangle.maxX;
+		const S32 beginY = triangle.minY < tileMinY ? tileMinY : triangle.minY;
+		const S32 endY = tileMaxY < triangle.maxY ? tileMaxY : triangle.maxY;
+		if (endX < beginX || endY < beginY)return;
+
+		const F32x4 zero;
+		const F32x4 one = F32x4::Set1(1.0f);
+		const F32x4 laneOffsets = F32x4::Set(0.5f, 1.5f, 2.5f, 3.5f);
+		const F32x4 invArea = F32x4::Set1(triangle.invArea);
+
+		F32x4 edgeA[3], originX[3], invEdgeLength[3], z[3], invW[3];
+		for (U32 k = 0; k < 3; k++)
+		{
+			edgeA[k] = F32x4::Set1(triangle.edgeA[k]);
+			originX[k] = F32x4::Set1(triangle.originX[k]);
+			invEdgeLength[k] = F32x4::Set1(triangle.invEdgeLength[k]);
+			z[k] = F32x4::Set1(triangle.z[k]);
+			invW[k] = F32x4::Set1(triangle.invW[k]);
+		}
+
+		// 4ピクセル分の補間結果
+		F32 laneZ[4], laneW[4];
+		F32 laneVaryings[4][SOFT_MAX_VARYINGS];
+		F32 varying[4];
+
+		SoftPixelInput input;
+		input.instanceID = triangle.instanceID;
+		input.isFrontFace = triangle.isFrontFace;
+		input.params = call.params;
+
+		for (S32 py = beginY; py <= endY; py++)
+		{
+			const F32 centerY = py + 0.5f;
+			F32x4 rowTerms[3];
+			for (U32 k = 0; k < 3; k++)
+			{
+				rowTerms[k] = F32x4::Set1(triangle.edgeB[k] * (centerY - triangle.originY[k]));
+			}
+			F32* depthRow = depth + (size_t)py * m_width;
+
+			for (S32 px = beginX; px <= endX; px += 4)
+			{
+				const S32 remain = endX - px + 1;
+				S32 mask = remain < 4 ? (1 << remain) - 1 : 0xF;
+
+				const F32x4 centerX = F32x4::Set1((F32)px) + laneOffsets;
+				F32x4 edges[3];
+				for (U32 k = 0; k < 3; k++)
+				{
+					edges[k] = edgeA[k] * (centerX - originX[k]) + rowTerms[k];
+					if (triangle.includeEdge[k])mask &= ~F32x4::Less(edges[k], zero).MoveMask();
+					else mask &= F32x4::Less(zero, edges[k]).MoveMask();
+				}
+				if (mask == 0)continue;
+
+				if (call.useWireframe)
+				{
+					const F32x4 distance = F32x4::Min(edges[0] * invEdgeLength[0], F32x4::Min(edges[1] * invEdgeLength[1], edges[2] * invEdgeLength[2]));
+					mask &= F32x4::Less(distance, one).MoveMask();
+					if (mask == 0)continue;
+				}
+
+				const F32x4 b0 = edges[0] * invArea;
+				const F32x4 b1 = edges[1] * invArea;
+				const F32x4 b2 = edges[2] * invArea;
+				const F32x4 depthValue = b0 * z[0] + b1 * z[1] + b2 * z[2];
+
+				if (call.useDepth)
+				{
+					F32 stored[4] = { 0, 0, 0, 0 };
+					const S32 count = remain < 4 ? remain : 4;
+					for (S32 i = 0; i < count; i++)stored[i] = depthRow[px + i];
+					mask &= F32x4::Less(depthValue, F32x4::Load(stored)).MoveMask();
+					if (mask == 0)continue;
+				}
+
+				// 遠近補正した補間
+				const F32x4 w = one / (b0 * invW[0] + b1 * invW[1] + b2 * invW[2]);
+				depthValue.Store(laneZ);
+				w.Store(laneW);
+				for (U32 i = 0; i < call.varyingCount; i++)
+				{
+					const F32x4 value = (b0 * F32x4::Set1(triangle.attributes[0][i]) + b1 * F32x4::Set1(triangle.attributes[1][i]) + b2 * F32x4::Set1(triangle.attributes[2][i])) * w;
+					value.Store(varying);
+					for (U32 lane = 0; lane < 4; lane++)laneVaryings[lane][i] = varying[lane];
+				}
+
+				for (S32 lane = 0; lane < 4; lane++)
+				{
+					if ((mask & (1 << lane)) == 0)continue;
+					const S32 x = px + lane;
+
+					Vector4 colors[MAX_TARGETS];
+					if (call.pixelShader)
+					{
+						input.position = Vector4(x + 0.5f, centerY, laneZ[lane], laneW[lane]);
+						input.varyings = laneVaryings[lane];
+						if ((*call.pixelShader)(input, colors) == false)continue;
+					}
+					else
+					{
+						for (U32 t = 0; t < targetCount; t++)colors[t] = Vector4(1, 1, 1, 1);
+					}
+
+					const size_t offset = (size_t)py * m_width + x;
+					for (U32 t = 0; t < targetCount; t++)
+					{
+						Vector4& dst = targets[t]->GetPixels()[offset];
+						dst = SoftSurface::Quantize(Blend(colors[t], dst, call.blendModes[t]), targets[t]->GetFormat());
+					}
+					if (call.useDepth)depthRow[x] = laneZ[lane];
+				}
+			}
+		}
+	}
+}
\ No newline at end of file
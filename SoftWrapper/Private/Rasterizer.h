@@ -0,0 +1,127 @@
+﻿#pragma once
+
+#include "SoftWrapper.h"
+
+namespace og
+{
+	class SoftSurface;
+
+	/// <summary>
+	/// 1回の描画命令の内容
+	/// </summary>
+	struct SoftDrawCall
+	{
+		const Byte* vertices = nullptr;
+		U32 vertexCount = 0;
+		U32 stride = 0;
+		/// <summary> nullptrの場合は頂点を3つずつ三角形とする </summary>
+		const U32* indices = nullptr;
+		U32 indexCount = 0;
+		U32 instanceCount = 1;
+		/// <summary> インスタンスごとのデータ(firstInstance番目の要素の先頭)。nullptrの場合は無し </summary>
+		const Byte* instances = nullptr;
+		U32 instanceStride = 0;
+
+		/// <summary> nullptrの場合は標準の頂点シェーダー </summary>
+		const SoftVertexShader* vertexShader = nullptr;
+		U32 varyingCount = 0;
+		/// <summary> nullptrの場合は標準のピクセルシェーダー </summary>
+		const SoftPixelShader* pixelShader = nullptr;
+		const ISoftShaderParams* params = nullptr;
+
+		CullMode cullMode = CullMode::BACK;
+		bool useDepth = true;
+		bool useWireframe = false;
+		BlendMode blendModes[8];
+	};
+
+
+	/// <summary>
+	/// タイルに分割して三角形を並列に描画する
+	/// </summary>
+	/// <remarks>
+	/// 頂点シェーダー、三角形のセットアップとタイルへの振り分け、タイルごとのラスタライズの順に、それぞれParallel::Forで処理する。
+	/// タイルは互いに重ならないため、ラスタライズ中にピクセルを排他制御する必要はない。
+	/// 三角形は塊ごとにタイルへ振り分け、タイル内では塊の順に処理するため、描画順は入力の順に保たれる。
+	/// ラスタライズは横に並ぶ4ピクセルをF32x4でまとめて判定する。
+	/// 規約はDirect3Dに合わせ、クリップ空間の深度は0〜1、画面上で時計回りの三角形を表面とし、深度テストはLESSで行う。
+	/// </remarks>
+	class Rasterizer
+	{
+	public:
+		static const U32 TILE_SIZE = 64;
+		static const U32 MAX_TARGETS = 8;
+
+		/// <summary>
+		/// セットアップ済みの三角形
+		/// </summary>
+		/// <remarks>
+		/// 辺kは頂点kの対辺。辺関数 edgeA * (x - originX) + edgeB * (y - originY) は三角形の内側で正になり、
+		/// 三角形の面積の2倍で割ると頂点kの重心座標になる。
+		/// 隣接する三角形が共有する辺は、向きに関わらず同じ端点を原点として同じ順序で計算するため、値の符号が正確に反転する。
+		/// </remarks>
+		struct Triangle
+		{
+			F32 edgeA[3];
+			F32 edgeB[3];
+			F32 originX[3];
+			F32 originY[3];
+			/// <summary> 辺の上のピクセルを含めるか(左上規則) </summary>
+			bool includeEdge[3];
+			/// <summary> 辺関数をピクセル単位の距離にする係数(ワイヤーフレーム用) </summary>
+			F32 invEdgeLength[3];
+			/// <summary> 面積の2倍の逆数 </summary>
+			F32 invArea;
+
+			F32 z[3];
+			F32 invW[3];
+			/// <summary> varyingsにinvWを掛けたもの </summary>
+			F32 attributes[3][SOFT_MAX_VARYINGS];
+
+			// 描画するピクセルの範囲(両端を含む)
+			S32 minX;
+			S32 minY;
+			S32 maxX;
+			S32 maxY;
+
+			U32 instanceID;
+			bool isFrontFace;
+		};
+
+	private:
+		U32 m_width;
+		U32 m_height;
+		U32 m_tileCountX;
+		U32 m_tileCountY;
+
+		// 作業領域(描画ごとに再利用する)
+		ArrayList<SoftVertexOutput> m_vertices;
+		ArrayList<ArrayList<Triangle>> m_chunkTriangles;
+		ArrayList<ArrayList<U32>> m_bins;
+
+	public:
+		Rasterizer();
+		~Rasterizer();
+
+		/// <summary>
+		/// 描画先の大きさを設定する
+		/// </summary>
+		void Resize(const U32 width, const U32 height);
+
+		/// <summary>
+		/// 三角形を描画する
+		/// </summary>
+		/// <param name="call">描画命令</param>
+		/// <param name="targets">描画先(targetCount個)。大きさはResizeで設定したものと同じであること</param>
+		/// <param name="targetCount">描画先の数</param>
+		/// <param name="depth">深度バッファ(幅×高さ)</param>
+		/// <returns>　０：成功\n－１：引数が不正、またはインデックスが範囲外</returns>
+		S32 Draw(const SoftDrawCall& call, SoftSurface* const* targets, const U32 targetCount, F32* depth);
+
+	private:
+		void SetupTriangles(const SoftDrawCall& call, const U32 chunk, const size_t begin, const size_t end, const U32 trianglesPerInstance);
+		void AddTriangle(const SoftDrawCall& call, const U32 chunk, const SoftVertexOutput* v0, const SoftVertexOutput* v1, const SoftVertexOutput* v2, const U32 instanceID);
+		void RasterizeTile(const SoftDrawCall& call, const U32 tile, const U32 chunkCount, SoftSurface* const* targets, const U32 targetCount, F32* depth)const;
+		void RasterizeTriangle(const SoftDrawCall& call, const Triangle& triangle, const S32 tileMinX, const S32 tileMinY, const S32 tileMaxX, const S32 tileMaxY, SoftSurface* const* targets, const U32 targetCount, F32* depth)const;
+	};
+}
\ No newline at end of file
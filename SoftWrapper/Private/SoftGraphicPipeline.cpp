@@ -0,0 +1,41 @@
+﻿#include "pch.h"
+#include "SoftGraphicPipeline.h"
+
+#include "SoftShader.h"
+
+namespace og
+{
+	SoftGraphicPipeline::SoftGraphicPipeline(const GraphicPipelineDesc& desc)
+		:m_cullMode(desc.cullMode), m_useDepth(desc.useDepth), m_useWireframe(desc.useWireframe), m_targetNum(desc.numRenderTargets), m_isValid(false)
+	{
+		if (desc.numRenderTargets < 1 || MAX_RENDER_TARGETS < desc.numRenderTargets)return;
+
+		// このラッパーで作成したシェーダーのみ使用できる
+		auto vs = dynamic_cast<SoftShader*>(desc.vs.get());
+		auto ps = dynamic_cast<SoftShader*>(desc.ps.get());
+		if (desc.vs && (vs == nullptr || vs->GetType() != ShaderType::VERTEX))return;
+		if (desc.ps && (ps == nullptr || ps->GetType() != ShaderType::PIXEL))return;
+
+		for (S32 i = 0; i < MAX_RENDER_TARGETS; i++)
+		{
+			m_blendModes[i] = i < desc.numRenderTargets ? desc.blendMode[i] : BlendMode::REPLACE;
+		}
+
+		// リソースを参照に追加
+		m_vs = desc.vs;
+		m_ps = desc.ps;
+		m_isValid = true;
+	}
+
+
+
+	const SoftShader* SoftGraphicPipeline::GetVertexShader()const
+	{
+		return static_cast<const SoftShader*>(m_vs.get());
+	}
+
+	const SoftShader* SoftGraphicPipeline::GetPixelShader()const
+	{
+		return static_cast<const SoftShader*>(m_ps.get());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include "IGraphicPipeline.h"
+#include "GraphicPipelineDesc.h"
+
+namespace og
+{
+	class SoftShader;
+
+	/// <summary>
+	/// 描画に使用する情報をひとまとめにする
+	/// </summary>
+	/// <remarks>
+	/// 頂点シェーダーとピクセルシェーダー以外のステージには対応していない。トポロジーは常に三角形リストとして扱う。
+	/// </remarks>
+	class SoftGraphicPipeline :public IGraphicPipeline
+	{
+	public:
+		static const S32 MAX_RENDER_TARGETS = 8;
+	private:
+		// シェーダ参照
+		SPtr<IShader> m_vs;
+		SPtr<IShader> m_ps;
+
+		CullMode m_cullMode;
+		bool m_useDepth;
+		bool m_useWireframe;
+
+		S32 m_targetNum;
+		BlendMode m_blendModes[MAX_RENDER_TARGETS];
+
+		bool m_isValid;
+
+	public:
+		SoftGraphicPipeline(const GraphicPipelineDesc& desc);
+
+		/// <summary> 標準のシェーダーを使う場合はnullptr </summary>
+		const SoftShader* GetVertexShader()const;
+		/// <summary> 標準のシェーダーを使う場合はnullptr </summary>
+		const SoftShader* GetPixelShader()const;
+
+		inline CullMode GetCullMode()const { return m_cullMode; }
+		inline bool UseDepth()const { return m_useDepth; }
+		inline bool UseWireframe()const { return m_useWireframe; }
+		inline S32 GetTargetNum()const { return m_targetNum; }
+		inline BlendMode GetBlendMode(const S32 target)const { return m_blendModes[target]; }
+
+		/// <summary>
+		/// インスタンスの生成に成功しているか
+		/// </summary>
+		inline bool IsValid()const { return m_isValid; }
+	};
+}
\ No newline at end of file
@@ -0,0 +1,134 @@
+﻿#include "pch.h"
+#include "SoftGraphicWrapper.h"
+
+#include "Platform.h"
+
+#include "SoftGraphicPipeline.h"
+#include "SoftMaterial.h"
+#include "SoftRenderTexture.h"
+#include "SoftShader.h"
+#include "SoftShape.h"
+#include "SoftTexture.h"
+
+namespace og
+{
+	IGraphicWrapper* CreateGraphicWrapper()
+	{
+		return new SoftGraphicWrapper();
+	}
+
+
+
+	SoftGraphicWrapper::~SoftGraphicWrapper()
+	{
+	}
+
+
+
+	S32 SoftGraphicWrapper::Init()
+	{
+		return 0;
+	}
+
+	// 表示先が無いため、描画の完了のみ確認する
+	S32 SoftGraphicWrapper::SwapScreen(SPtr<IRenderTexture>& renderTarget)
+	{
+		if (CheckArgs(!!renderTarget))return -1;
+		return 0;
+	}
+
+
+
+	SPtr<IRenderTexture> SoftGraphicWrapper::CreateRenderTexture(const S32 width, const S32 height, const TextureFormat format)
+	{
+		ArrayList<TextureFormat> formats(1, format);
+		return CreateRenderTexture(width, height, formats);
+	}
+
+	SPtr<IRenderTexture> SoftGraphicWrapper::CreateRenderTexture(const S32 width, const S32 height, const ArrayList<TextureFormat>& formats)
+	{
+		if (width <= 0 || height <= 0)return nullptr;
+		auto texture = MSPtr<SoftRenderTexture>(formats, width, height);
+		if (texture->IsValid() == false)return nullptr;
+		return texture;
+	}
+
+	SPtr<ITexture> SoftGraphicWrapper::LoadTexture(const Path& path, const bool)
+	{
+		auto texture = MSPtr<SoftImageTexture>(path);
+		if (!texture->IsValid())return nullptr;
+		return texture;
+	}
+
+
+
+	SPtr<IShader> SoftGraphicWrapper::LoadShader(const String& path, ShaderType type, String& errorDest)
+	{
+		if (Platform::FileExists(Path(path)) == false)
+		{
+			errorDest = TC("file not found: ") + path;
+			return nullptr;
+		}
+		return MSPtr<SoftShader>(type, path);
+	}
+
+	SPtr<IShader> SoftGraphicWrapper::CreateShader(const String& src, ShaderType type, String&)
+	{
+		return MSPtr<SoftShader>(type, src);
+	}
+
+
+
+	SPtr<IGraphicPipeline> SoftGraphicWrapper::CreateGraphicPipeline(const GraphicPipelineDesc& desc)
+	{
+		auto gpipeline = MSPtr<SoftGraphicPipeline>(desc);
+		if (gpipeline->IsValid() == false)return nullptr;
+		return gpipeline;
+	}
+
+
+
+	SPtr<IMaterial> SoftGraphicWrapper::CreateMaterial(const SPtr<IGraphicPipeline>& pipeline, const S32, const S32)
+	{
+		if (CheckArgs(!!pipeline))return nullptr;
+		auto material = MSPtr<SoftMaterial>(pipeline);
+		if (material->IsValid() == false)return nullptr;
+		return material;
+	}
+
+
+
+	SPtr<IShape> SoftGraphicWrapper::CreateShape(const U32 stribeSize)
+	{
+		if (stribeSize <= 0)return nullptr;
+		return MSPtr<SoftShape>(stribeSize);
+	}
+
+
+
+	S32 SoftGraphicWrapper::RegisterVertexShader(const SPtr<IShader>& shader, const SoftVertexShader& function, const U32 varyingCount)
+	{
+		auto softShader = dynamic_cast<SoftShader*>(shader.get());
+		if (CheckArgs(softShader, !!function))return -1;
+		return softShader->SetVertexShader(function, varyingCount);
+	}
+
+	S32 SoftGraphicWrapper::RegisterPixelShader(const SPtr<IShader>& shader, const SoftPixelShader& function)
+	{
+		auto softShader = dynamic_cast<SoftShader*>(shader.get());
+		if (CheckArgs(softShader, !!function))return -1;
+		return softShader->SetPixelShader(function);
+	}
+
+	S32 SoftGraphicWrapper::ReadPixels(const SPtr<IRenderTexture>& texture, const S32 target, ArrayList<Byte>& dest)
+	{
+		auto renderTexture = dynamic_cast<SoftRenderTexture*>(texture.get());
+		if (CheckArgs(renderTexture))return -1;
+
+		auto surface = renderTexture->GetSurface(target);
+		if (CheckArgs(surface))return -1;
+
+		surface->Read(dest);
+		return 0;
+	}
+}
\ No newline at end of file
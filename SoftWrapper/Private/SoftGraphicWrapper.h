@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include "SoftWrapper.h"
+
+namespace og
+{
+	class SoftGraphicWrapper :public ISoftGraphicWrapper
+	{
+	public:
+		~SoftGraphicWrapper();
+
+#pragma region
+		// IGraphicWrapperの仮想関数の実装
+
+		S32 Init() override;
+		S32 SwapScreen(SPtr<IRenderTexture>& renderTarget) override;
+
+		//===================================================================================//
+
+		SPtr<IRenderTexture> CreateRenderTexture(const S32 width, const S32 height, const TextureFormat format)override;
+		SPtr<IRenderTexture> CreateRenderTexture(const S32 width, const S32 height, const ArrayList<TextureFormat>& formats)override;
+		SPtr<ITexture> LoadTexture(const Path& path, const bool async) override;
+
+		//===================================================================================//
+
+		SPtr<IShader> LoadShader(const String& path, ShaderType type, String& errorDest) override;
+		SPtr<IShader> CreateShader(const String& path, ShaderType type, String& errorDest) override;
+
+		//===================================================================================//
+
+		SPtr<IGraphicPipeline> CreateGraphicPipeline(const GraphicPipelineDesc& desc)override;
+
+		//===================================================================================//
+
+		SPtr<IMaterial> CreateMaterial(const SPtr<IGraphicPipeline>& pipeline, const S32 cBufferMask, const S32 texMask)override;
+
+		//===================================================================================//
+
+		SPtr<IShape> CreateShape(const U32 stribeSize) override;
+
+#pragma endregion
+
+#pragma region
+		// ISoftGraphicWrapperの仮想関数の実装
+
+		S32 RegisterVertexShader(const SPtr<IShader>& shader, const SoftVertexShader& function, const U32 varyingCount)override;
+		S32 RegisterPixelShader(const SPtr<IShader>& shader, const SoftPixelShader& function)override;
+		S32 ReadPixels(const SPtr<IRenderTexture>& texture, const S32 target, ArrayList<Byte>& dest)override;
+
+#pragma endregion
+	};
+}
\ No newline at end of file
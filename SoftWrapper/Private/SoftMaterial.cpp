@@ -0,0 +1,112 @@
+﻿#include "pch.h"
+#include "SoftMaterial.h"
+
+#include "SoftRenderTexture.h"
+#include "SoftTexture.h"
+
+namespace
+{
+	using namespace og;
+
+	/// <summary>
+	/// 何も設定されていないパラメータ
+	/// </summary>
+	class EmptyShaderParams :public ISoftShaderParams
+	{
+	public:
+		Vector4 GetFloat4(const String&)const override { return Vector4(); }
+		Matrix GetMatrix(const String&)const override { return Matrix(); }
+		Vector4 Sample(const String&, const Vector2&)const override { return Vector4(1, 1, 1, 1); }
+	};
+}
+
+namespace og
+{
+	SoftMaterial::SoftMaterial(const SPtr<IGraphicPipeline>& gpipeline)
+		:m_isLocked(false)
+	{
+		if (CheckArgs(!!gpipeline))return;
+		m_graphicPipeline = gpipeline;
+	}
+
+
+
+	S32 SoftMaterial::Lock()
+	{
+		if (!IsValid())return -1;
+		return 0;
+	}
+
+
+
+	S32 SoftMaterial::SetTexture(const String& name, const SPtr<ITexture>& texture, const S32 target)
+	{
+		if (!IsValid())return -1;
+		if (CheckArgs(!!texture))return -1;
+		if (m_isLocked)return -1;
+
+		// このラッパーで作成したテクスチャのみ使用できる
+		const SoftSurface* surface = nullptr;
+		if (auto image = dynamic_cast<SoftImageTexture*>(texture.get()))
+		{
+			if (target != 0)return -1;
+			surface = image->GetSurface();
+		}
+		else if (auto renderTexture = dynamic_cast<SoftRenderTexture*>(texture.get()))
+		{
+			surface = renderTexture->GetSurface(target);
+		}
+		if (surface == nullptr)return -1;
+
+		TextureBinding binding;
+		binding.texture = texture;
+		binding.surface = surface;
+		m_textures[name] = binding;
+		return 0;
+	}
+
+	S32 SoftMaterial::SetFloat4Param(const String& name, const Vector4& value)
+	{
+		if (!IsValid())return -1;
+		if (m_isLocked)return -1;
+		m_float4Params[name] = value;
+		return 0;
+	}
+
+	S32 SoftMaterial::SetMatrixParam(const String& name, const Matrix& value)
+	{
+		if (!IsValid())return -1;
+		if (m_isLocked)return -1;
+		m_matrixParams[name] = value;
+		return 0;
+	}
+
+
+
+	Vector4 SoftMaterial::GetFloat4(const String& name)const
+	{
+		auto itr = m_float4Params.find(name);
+		return itr == m_float4Params.end() ? Vector4() : itr->second;
+	}
+
+	Matrix SoftMaterial::GetMatrix(const String& name)const
+	{
+		auto itr = m_matrixParams.find(name);
+		return itr == m_matrixParams.end() ? Matrix() : itr->second;
+	}
+
+	Vector4 SoftMaterial::Sample(const String& name, const Vector2& uv)const
+	{
+		auto itr = m_textures.find(name);
+		if (itr == m_textures.end())return Vector4(1, 1, 1, 1);
+		return itr->second.surface->Sample(uv);
+	}
+
+
+
+	const ISoftShaderParams& SoftMaterial::GetDefaultParams()
+	{
+		static const EmptyShaderParams params;
+		return params;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+﻿#pragma once
+
+#include "IMaterial.h"
+#include "SoftWrapper.h"
+
+namespace og
+{
+	class IGraphicPipeline;
+	class ITexture;
+	class SoftSurface;
+
+	/// <summary>
+	/// 名前で管理するシェーダーパラメータ
+	/// </summary>
+	/// <remarks>
+	/// シェーダーの解析を行わないため、どの名前でも設定できる。レジスタの指定(cBufferMask、texMask)は使用しない。
+	/// 値は描画命令の時点で参照されるため、同じフレーム内でも描画ごとに異なる値を使える。
+	/// </remarks>
+	class SoftMaterial :public IMaterial, public ISoftShaderParams
+	{
+	private:
+		struct TextureBinding
+		{
+			SPtr<ITexture> texture;
+			const SoftSurface* surface;
+		};
+
+		// 依存関係
+		SPtr<IGraphicPipeline> m_graphicPipeline;
+
+		HashMap<String, Vector4> m_float4Params;
+		HashMap<String, Matrix> m_matrixParams;
+		HashMap<String, TextureBinding> m_textures;
+
+		bool m_isLocked;
+
+	public:
+		SoftMaterial(const SPtr<IGraphicPipeline>& gpipeline);
+
+		S32 Lock()override;
+
+		S32 SetTexture(const String& name, const SPtr<ITexture>& texture, const S32 target)override;
+
+		S32 SetFloat4Param(const String& name, const Vector4& value)override;
+		S32 SetMatrixParam(const String& name, const Matrix& value)override;
+
+		Vector4 GetFloat4(const String& name)const override;
+		Matrix GetMatrix(const String& name)const override;
+		Vector4 Sample(const String& name, const Vector2& uv)const override;
+
+		inline bool IsValid()const { return m_graphicPipeline != nullptr; };
+
+	public:
+		/// <summary>
+		/// マテリアルが設定されていない場合に使うパラメータ
+		/// </summary>
+		static const ISoftShaderParams& GetDefaultParams();
+	};
+}
\ No newline at end of file
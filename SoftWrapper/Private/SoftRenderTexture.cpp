@@ -0,0 +1,155 @@
+﻿#include "pch.h"
+#include "SoftRenderTexture.h"
+
+#include "IShape.h"
+#include "SoftGraphicPipeline.h"
+#include "SoftMaterial.h"
+#include "SoftShader.h"
+
+namespace og
+{
+	SoftRenderTexture::SoftRenderTexture(const ArrayList<TextureFormat>& formats, const U32 width, const U32 height)
+		:m_isDrawing(false)
+	{
+		m_clearColor.Set(0.0f, 0.0f, 0.0f);
+
+		if (formats.empty() || Rasterizer::MAX_TARGETS < formats.size())return;
+		if (width == 0 || height == 0)return;
+
+		for (auto format : formats)
+		{
+			m_surfaces.push_back(MUPtr<SoftSurface>(width, height, format));
+			m_targets.push_back(m_surfaces.back().get());
+		}
+		m_depth.resize((size_t)width * height, 1.0f);
+		m_rasterizer.Resize(width, height);
+	}
+
+
+
+	const SoftSurface* SoftRenderTexture::GetSurface(const S32 target)const
+	{
+		if (target < 0 || (S32)m_surfaces.size() <= target)return nullptr;
+		return m_surfaces[target].get();
+	}
+
+
+
+	S32 SoftRenderTexture::BeginDraw()
+	{
+		if (!IsValid())return -1;
+
+		for (auto& surface : m_surfaces)surface->Clear(m_clearColor);
+		std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+
+		m_isDrawing = true;
+		return 0;
+	}
+
+	S32 SoftRenderTexture::EndDraw()
+	{
+		if (!m_isDrawing)return -1;
+
+		m_graphicPipeline.reset();
+		m_material.reset();
+		m_isDrawing = false;
+		return 0;
+	}
+
+
+
+	S32 SoftRenderTexture::SetGraphicPipeline(SPtr<IGraphicPipeline> pipeline)
+	{
+		if (CheckArgs(!!pipeline))return -1;
+		if (dynamic_cast<SoftGraphicPipeline*>(pipeline.get()) == nullptr)return -1;
+		m_graphicPipeline = pipeline;
+		return 0;
+	}
+
+	S32 SoftRenderTexture::SetMaterial(SPtr<IMaterial> material)
+	{
+		if (CheckArgs(!!material))return -1;
+		if (dynamic_cast<SoftMaterial*>(material.get()) == nullptr)return -1;
+		m_material = material;
+		return 0;
+	}
+
+
+
+	S32 SoftRenderTexture::DrawInstanced(SPtr<IShape>& shape, const U32 count)
+	{
+		return Draw(shape, nullptr, 0, count);
+	}
+
+	S32 SoftRenderTexture::DrawInstanced(SPtr<IShape>& shape, SPtr<IShape>& instances, const U32 firstInstance, const U32 count)
+	{
+		if (CheckArgs(!!instances))return -1;
+		if ((U32)instances->GetVertexCount() < firstInstance + count)return -1;
+		if (count == 0)return Draw(shape, nullptr, 0, 0);
+
+		const U32 stride = (U32)instances->GetStribeSize();
+		return Draw(shape, instances->GetVertices() + (size_t)firstInstance * stride, stride, count);
+	}
+
+
+
+	S32 SoftRenderTexture::Draw(SPtr<IShape>& shape, const Byte* instances, const U32 instanceStride, const U32 count)
+	{
+		if (CheckArgs(!!shape, !!m_graphicPipeline))return -1;
+		if (!m_isDrawing)return -1;
+
+		auto pipeline = static_cast<SoftGraphicPipeline*>(m_graphicPipeline.get());
+		if ((S32)m_targets.size() < pipeline->GetTargetNum())return -1;
+
+		SoftDrawCall call;
+		call.vertices = shape->GetVertices();
+		call.vertexCount = (U32)shape->GetVertexCount();
+		call.stride = (U32)shape->GetStribeSize();
+		call.indices = shape->GetIndices();
+		call.indexCount = (U32)shape->GetIndexCount();
+		call.instanceCount = count;
+		call.instances = instances;
+		call.instanceStride = instanceStride;
+
+		if (auto vs = pipeline->GetVertexShader())
+		{
+			call.vertexShader = vs->GetVertexShader();
+			call.varyingCount = vs->GetVaryingCount();
+		}
+		if (auto ps = pipeline->GetPixelShader())
+		{
+			call.pixelShader = ps->GetPixelShader();
+		}
+		call.params = m_material ? static_cast<const ISoftShaderParams*>(static_cast<SoftMaterial*>(m_material.get())) : &SoftMaterial::GetDefaultParams();
+
+		call.cullMode = pipeline->GetCullMode();
+		call.useDepth = pipeline->UseDepth();
+		call.useWireframe = pipeline->UseWireframe();
+		const U32 targetCount = (U32)pipeline->GetTargetNum();
+		for (U32 i = 0; i < targetCount; i++)call.blendModes[i] = pipeline->GetBlendMode(i);
+
+		return m_rasterizer.Draw(call, m_targets.data(), targetCount, m_depth.data());
+	}
+
+
+
+	Vector3 SoftRenderTexture::GetSize()
+	{
+		if (!IsValid())return Vector3();
+		return Vector3((F32)m_surfaces[0]->GetWidth(), (F32)m_surfaces[0]->GetHeight(), 1.0f);
+	}
+
+	S32 SoftRenderTexture::GetDimension()
+	{
+		if (!IsValid())return 0;
+		// 2次元テクスチャ
+		return 2;
+	}
+
+
+
+	void SoftRenderTexture::SetClearColor(Color color)
+	{
+		m_clearColor = color;
+	}
+}
\ No newline at end of file
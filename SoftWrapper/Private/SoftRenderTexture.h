@@ -0,0 +1,66 @@
+﻿#pragma once
+#include "IRenderTexture.h"
+
+#include "Rasterizer.h"
+#include "SoftTexture.h"
+
+namespace og
+{
+	class SoftGraphicPipeline;
+	class SoftMaterial;
+
+	/// <summary>
+	/// CPUメモリ上のレンダーテクスチャ
+	/// </summary>
+	/// <remarks>
+	/// 描画はDrawInstancedを呼んだ時点で行い、BeginDrawからEndDrawの間でのみ受け付ける。
+	/// </remarks>
+	class SoftRenderTexture :public IRenderTexture
+	{
+	private:
+		ArrayList<UPtr<SoftSurface>> m_surfaces;
+		ArrayList<SoftSurface*> m_targets;
+		ArrayList<F32> m_depth;
+
+		Rasterizer m_rasterizer;
+
+		SPtr<IGraphicPipeline> m_graphicPipeline;
+		SPtr<IMaterial> m_material;
+
+		Color m_clearColor;
+		bool m_isDrawing;
+
+	public:
+		SoftRenderTexture(const ArrayList<TextureFormat>& formats, const U32 width, const U32 height);
+
+		inline bool IsValid()const { return m_surfaces.empty() == false; }
+
+		/// <summary>
+		/// レンダーターゲットの画像を取得する
+		/// </summary>
+		/// <returns>範囲外の場合はnullptr</returns>
+		const SoftSurface* GetSurface(const S32 target)const;
+
+
+
+		S32 BeginDraw()override;
+		S32 EndDraw()override;
+
+		S32 SetGraphicPipeline(SPtr<IGraphicPipeline> pipeline)override;
+
+		S32 SetMaterial(SPtr<IMaterial> material)override;
+
+		S32 DrawInstanced(SPtr<IShape>& shape, const U32 count = 1)override;
+		S32 DrawInstanced(SPtr<IShape>& shape, SPtr<IShape>& instances, const U32 firstInstance, const U32 count)override;
+
+
+		Vector3 GetSize()override;
+		S32 GetDimension()override;
+
+
+		void SetClearColor(Color color)override;
+
+	private:
+		S32 Draw(SPtr<IShape>& shape, const Byte* instances, const U32 instanceStride, const U32 count);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+﻿#pragma once
+
+#include "IShader.h"
+#include "SoftWrapper.h"
+
+namespace og
+{
+	/// <summary>
+	/// 登録されたC++の処理をシェーダーとして扱う
+	/// </summary>
+	/// <remarks>
+	/// シェーダーのソースはコンパイルせず、名前(ファイルパスまたはソース)として保持する。
+	/// </remarks>
+	class SoftShader :public IShader
+	{
+	private:
+		const ShaderType m_type;
+		const String m_name;
+
+		SoftVertexShader m_vertexShader;
+		U32 m_varyingCount;
+		SoftPixelShader m_pixelShader;
+
+	public:
+		SoftShader(const ShaderType type, const String& name) :m_type(type), m_name(name), m_varyingCount(0) {}
+
+		inline ShaderType GetType()const { return m_type; }
+		inline const String& GetName()const { return m_name; }
+
+		/// <summary>
+		/// 頂点シェーダーの処理を設定する
+		/// </summary>
+		/// <returns>　０：成功\n－１：頂点シェーダーではない、またはvaryingCountが大きすぎる</returns>
+		inline S32 SetVertexShader(const SoftVertexShader& function, const U32 varyingCount)
+		{
+			if (m_type != ShaderType::VERTEX || SOFT_MAX_VARYINGS < varyingCount)return -1;
+			m_vertexShader = function;
+			m_varyingCount = varyingCount;
+			return 0;
+		}
+
+		/// <summary>
+		/// ピクセルシェーダーの処理を設定する
+		/// </summary>
+		/// <returns>　０：成功\n－１：ピクセルシェーダーではない</returns>
+		inline S32 SetPixelShader(const SoftPixelShader& function)
+		{
+			if (m_type != ShaderType::PIXEL)return -1;
+			m_pixelShader = function;
+			return 0;
+		}
+
+		/// <summary> 登録されていない場合はnullptr </summary>
+		inline const SoftVertexShader* GetVertexShader()const { return m_vertexShader ? &m_vertexShader : nullptr; }
+		inline U32 GetVaryingCount()const { return m_varyingCount; }
+		/// <summary> 登録されていない場合はnullptr </summary>
+		inline const SoftPixelShader* GetPixelShader()const { return m_pixelShader ? &m_pixelShader : nullptr; }
+	};
+}
\ No newline at end of file
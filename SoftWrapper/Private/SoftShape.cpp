@@ -0,0 +1,79 @@
+﻿#include "pch.h"
+#include "SoftShape.h"
+
+#include <cassert>
+
+#include "Platform.h"
+
+namespace og
+{
+	SoftShape::SoftShape(const U32 stribeSize) :ms_stribeSize(stribeSize)
+	{
+		assert(0 < stribeSize);
+	}
+
+
+
+	S32 SoftShape::Vertex(const Byte* bytes, const U32 size)
+	{
+		if (bytes == nullptr)return -1;
+		U32 currentSize = (U32)m_data.size();
+		U32 byteSize = size * ms_stribeSize;
+		m_data.resize(currentSize + byteSize);
+		Platform::MemoryCopy(m_data.data() + currentSize, byteSize, bytes, byteSize);
+		return 0;
+	}
+
+	S32 SoftShape::Indices(const U32 index1, const U32 index2, const U32 index3)
+	{
+		m_indices.push_back(index1);
+		m_indices.push_back(index2);
+		m_indices.push_back(index3);
+		return 0;
+	}
+	S32 SoftShape::Indices(const U32* indices, const U32 count)
+	{
+		if (indices == nullptr)return -1;
+		U32 currentSize = (U32)m_indices.size();
+		m_indices.resize(currentSize + count);
+		Platform::MemoryCopy(m_indices.data() + currentSize, sizeof(U32) * count, indices, sizeof(U32) * count);
+		return 0;
+	}
+
+	// 描画時に直接参照するため、ロックによる転送は不要
+	Byte* SoftShape::LockVertices()
+	{
+		if (m_data.empty())return nullptr;
+		return m_data.data();
+	}
+
+	S32 SoftShape::UnlockVertices()
+	{
+		return 0;
+	}
+
+	S32 SoftShape::GetStribeSize()
+	{
+		return ms_stribeSize;
+	}
+	S32 SoftShape::GetVertexCount()
+	{
+		return (S32)(m_data.size() / ms_stribeSize);
+	}
+	S32 SoftShape::GetIndexCount()
+	{
+		return (S32)m_indices.size();
+	}
+	const Byte* SoftShape::GetVertices()
+	{
+		return m_data.empty() ? nullptr : m_data.data();
+	}
+	const U32* SoftShape::GetIndices()
+	{
+		return m_indices.empty() ? nullptr : m_indices.data();
+	}
+	S32 SoftShape::Optimize(const MeshOptimizeSettings& settings, MeshOptimizeReport* report)
+	{
+		return MeshOptimizer::Optimize(m_data, m_indices, ms_stribeSize, settings, report);
+	}
+}
\ No newline at end of file
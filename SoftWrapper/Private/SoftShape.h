@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "IShape.h"
+
+namespace og
+{
+	/// <summary>
+	/// CPUメモリ上の頂点とインデックス
+	/// </summary>
+	class SoftShape :public IShape
+	{
+	private:
+		const U32 ms_stribeSize;
+
+		ArrayList<Byte> m_data;
+		ArrayList<U32> m_indices;
+
+	public:
+		SoftShape(const U32 stribeSize);
+
+		S32 Vertex(const Byte* bytes, const U32 size)override;
+		S32 Indices(const U32 index1, const U32 index2, const U32 index3)override;
+		S32 Indices(const U32* indices, const U32 count)override;
+
+		Byte* LockVertices()override;
+		S32 UnlockVertices()override;
+
+		S32 GetStribeSize()override;
+		S32 GetVertexCount()override;
+		S32 GetIndexCount()override;
+		const Byte* GetVertices()override;
+		const U32* GetIndices()override;
+		S32 Optimize(const MeshOptimizeSettings& settings, MeshOptimizeReport* report)override;
+	};
+}
\ No newline at end of file
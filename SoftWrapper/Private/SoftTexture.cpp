@@ -0,0 +1,285 @@
+﻿#include "pch.h"
+#include "SoftTexture.h"
+
+#include <fstream>
+#include <iterator>
+
+namespace
+{
+	using namespace CommonLibrary;
+
+	inline F32 QuantizeUnorm(const F32 f, const F32 scale)
+	{
+		return Mathf::Round(Mathf::Clamp01(f) * scale) / scale;
+	}
+
+	inline F32 QuantizeSnorm(const F32 f, const F32 scale)
+	{
+		return Mathf::Round(Mathf::Clamp(f, -1.0f, 1.0f) * scale) / scale;
+	}
+
+	inline U32 ToUnorm(const F32 f, const F32 scale)
+	{
+		return (U32)Mathf::Round(Mathf::Clamp01(f) * scale);
+	}
+
+	inline S32 ToSnorm(const F32 f, const F32 scale)
+	{
+		return (S32)Mathf::Round(Mathf::Clamp(f, -1.0f, 1.0f) * scale);
+	}
+
+	template<class T>
+	inline void Write(Byte*& dest, const T value)
+	{
+		memcpy(dest, &value, sizeof(T));
+		dest += sizeof(T);
+	}
+
+	/// <summary>
+	/// 座標を[0, size)に繰り返す
+	/// </summary>
+	inline S32 Wrap(const S32 i, const S32 size)
+	{
+		const S32 m = i % size;
+		return m < 0 ? m + size : m;
+	}
+}
+
+namespace og
+{
+	SoftSurface::SoftSurface(const U32 width, const U32 height, const TextureFormat format)
+		:m_width(width), m_height(height), m_format(format), m_pixels((size_t)width* height)
+	{
+	}
+
+	//===================================================================================//
+
+	void SoftSurface::Clear(const Color& color)
+	{
+		const Vector4 value = Quantize(Vector4(color.r, color.g, color.b, color.a), m_format);
+		std::fill(m_pixels.begin(), m_pixels.end(), value);
+	}
+
+	//===================================================================================//
+
+	Vector4 SoftSurface::Sample(const Vector2& uv)const
+	{
+		if (m_pixels.empty())return Vector4(1, 1, 1, 1);
+
+		// ピクセルの中心を整数座標に合わせる
+		const F32 x = uv.x * m_width - 0.5f;
+		const F32 y = uv.y * m_height - 0.5f;
+		const F32 fx = Mathf::Floor(x);
+		const F32 fy = Mathf::Floor(y);
+		const F32 tx = x - fx;
+		const F32 ty = y - fy;
+
+		const S32 x0 = Wrap((S32)fx, (S32)m_width);
+		const S32 y0 = Wrap((S32)fy, (S32)m_height);
+		const S32 x1 = Wrap(x0 + 1, (S32)m_width);
+		const S32 y1 = Wrap(y0 + 1, (S32)m_height);
+
+		const Vector4& c00 = m_pixels[(size_t)y0 * m_width + x0];
+		const Vector4& c10 = m_pixels[(size_t)y0 * m_width + x1];
+		const Vector4& c01 = m_pixels[(size_t)y1 * m_width + x0];
+		const Vector4& c11 = m_pixels[(size_t)y1 * m_width + x1];
+
+		const Vector4 top = c00 * (1.0f - tx) + c10 * tx;
+		const Vector4 bottom = c01 * (1.0f - tx) + c11 * tx;
+		return top * (1.0f - ty) + bottom * ty;
+	}
+
+	//===================================================================================//
+
+	void SoftSurface::Read(ArrayList<Byte>& dest)const
+	{
+		dest.resize(m_pixels.size() * GetPixelSize(m_format));
+		Byte* ptr = dest.data();
+
+		for (const auto& c : m_pixels)
+		{
+			switch (m_format)
+			{
+			case TextureFormat::RGBA32:
+				Write(ptr, c.x); Write(ptr, c.y); Write(ptr, c.z); Write(ptr, c.w);
+				break;
+			case TextureFormat::RGBA16:
+				Write(ptr, (U16)ToUnorm(c.x, 65535.0f)); Write(ptr, (U16)ToUnorm(c.y, 65535.0f));
+				Write(ptr, (U16)ToUnorm(c.z, 65535.0f)); Write(ptr, (U16)ToUnorm(c.w, 65535.0f));
+				break;
+			case TextureFormat::RGBA8:
+				Write(ptr, (U8)ToUnorm(c.x, 255.0f)); Write(ptr, (U8)ToUnorm(c.y, 255.0f));
+				Write(ptr, (U8)ToUnorm(c.z, 255.0f)); Write(ptr, (U8)ToUnorm(c.w, 255.0f));
+				break;
+			case TextureFormat::RG8:
+				Write(ptr, (S8)ToSnorm(c.x, 127.0f)); Write(ptr, (S8)ToSnorm(c.y, 127.0f));
+				break;
+			case TextureFormat::R32:
+			case TextureFormat::Depth:
+				Write(ptr, c.x);
+				break;
+			case TextureFormat::R16:
+				Write(ptr, (U16)ToUnorm(c.x, 65535.0f));
+				break;
+			case TextureFormat::R8:
+				Write(ptr, (U8)ToUnorm(c.x, 255.0f));
+				break;
+			case TextureFormat::RGB565:
+				// 下位ビットから B, G, R
+				Write(ptr, (U16)(ToUnorm(c.z, 31.0f) | (ToUnorm(c.y, 63.0f) << 5) | (ToUnorm(c.x, 31.0f) << 11)));
+				break;
+			case TextureFormat::RGBA5551:
+				// 下位ビットから B, G, R, A
+				Write(ptr, (U16)(ToUnorm(c.z, 31.0f) | (ToUnorm(c.y, 31.0f) << 5) | (ToUnorm(c.x, 31.0f) << 10) | (ToUnorm(c.w, 1.0f) << 15)));
+				break;
+			}
+		}
+	}
+
+	//===================================================================================//
+
+	Vector4 SoftSurface::Quantize(const Vector4& c, const TextureFormat format)
+	{
+		switch (format)
+		{
+		case TextureFormat::RGBA32:		return c;
+		case TextureFormat::RGBA16:		return Vector4(QuantizeUnorm(c.x, 65535.0f), QuantizeUnorm(c.y, 65535.0f), QuantizeUnorm(c.z, 65535.0f), QuantizeUnorm(c.w, 65535.0f));
+		case TextureFormat::RGBA8:		return Vector4(QuantizeUnorm(c.x, 255.0f), QuantizeUnorm(c.y, 255.0f), QuantizeUnorm(c.z, 255.0f), QuantizeUnorm(c.w, 255.0f));
+		case TextureFormat::RG8:		return Vector4(QuantizeSnorm(c.x, 127.0f), QuantizeSnorm(c.y, 127.0f), 0, 1);
+		case TextureFormat::R32:		return Vector4(c.x, 0, 0, 1);
+		case TextureFormat::R16:		return Vector4(QuantizeUnorm(c.x, 65535.0f), 0, 0, 1);
+		case TextureFormat::R8:			return Vector4(QuantizeUnorm(c.x, 255.0f), 0, 0, 1);
+		case TextureFormat::Depth:		return Vector4(c.x, 0, 0, 1);
+		case TextureFormat::RGB565:		return Vector4(QuantizeUnorm(c.x, 31.0f), QuantizeUnorm(c.y, 63.0f), QuantizeUnorm(c.z, 31.0f), 1);
+		case TextureFormat::RGBA5551:	return Vector4(QuantizeUnorm(c.x, 31.0f), QuantizeUnorm(c.y, 31.0f), QuantizeUnorm(c.z, 31.0f), QuantizeUnorm(c.w, 1.0f));
+		}
+		return c;
+	}
+
+	//===================================================================================//
+
+	U32 SoftSurface::GetPixelSize(const TextureFormat format)
+	{
+		switch (format)
+		{
+		case TextureFormat::RGBA32:		return 16;
+		case TextureFormat::RGBA16:		return 8;
+		case TextureFormat::RGBA8:		return 4;
+		case TextureFormat::RG8:		return 2;
+		case TextureFormat::R32:		return 4;
+		case TextureFormat::R16:		return 2;
+		case TextureFormat::R8:			return 1;
+		case TextureFormat::Depth:		return 4;
+		case TextureFormat::RGB565:		return 2;
+		case TextureFormat::RGBA5551:	return 2;
+		}
+		return 0;
+	}
+
+	//===================================================================================//
+
+	SoftImageTexture::SoftImageTexture(const Path& path)
+	{
+		std::ifstream stream(path.ToString().c_str(), std::ios::binary);
+		if (!stream)return;
+
+		ArrayList<Byte> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+		String extension = path.Extension();
+		for (auto& c : extension)c = (char)tolower((unsigned char)c);
+		if (extension == TC("tga"))
+		{
+			if (LoadTga(file) == -1)m_surface.reset();
+		}
+	}
+
+	//===================================================================================//
+
+	S32 SoftImageTexture::LoadTga(const ArrayList<Byte>& file)
+	{
+		const size_t HEADER_SIZE = 18;
+		if (file.size() < HEADER_SIZE)return -1;
+
+		const U32 idLength = file[0];
+		const U32 colorMapType = file[1];
+		const U32 imageType = file[2];
+		const U32 width = file[12] | (file[13] << 8);
+		const U32 height = file[14] | (file[15] << 8);
+		const U32 bitsPerPixel = file[16];
+		const U32 descriptor = file[17];
+
+		// 2:非圧縮フルカラー、10:RLE圧縮フルカラー
+		if (colorMapType != 0 || (imageType != 2 && imageType != 10))return -1;
+		if (bitsPerPixel != 24 && bitsPerPixel != 32)return -1;
+		if (width == 0 || height == 0)return -1;
+
+		const U32 pixelSize = bitsPerPixel / 8;
+		const size_t pixelCount = (size_t)width * height;
+		size_t offset = HEADER_SIZE + idLength;
+
+		m_surface = MUPtr<SoftSurface>(width, height, TextureFormat::RGBA8);
+		Vector4* pixels = m_surface->GetPixels();
+
+		// BGR(A)の順に並ぶ
+		auto readPixel = [&](const size_t at)
+		{
+			const F32 a = pixelSize == 4 ? file[at + 3] / 255.0f : 1.0f;
+			return Vector4(file[at + 2] / 255.0f, file[at + 1] / 255.0f, file[at + 0] / 255.0f, a);
+		};
+
+		size_t count = 0;
+		if (imageType == 2)
+		{
+			if (file.size() < offset + pixelCount * pixelSize)return -1;
+			for (; count < pixelCount; count++, offset += pixelSize)pixels[count] = readPixel(offset);
+		}
+		else
+		{
+			while (count < pixelCount)
+			{
+				if (file.size() <= offset)return -1;
+				const U32 packet = file[offset++];
+				const size_t length = (packet & 0x7F) + 1;
+				if (pixelCount < count + length)return -1;
+
+				if (packet & 0x80)
+				{
+					if (file.size() < offset + pixelSize)return -1;
+					const Vector4 color = readPixel(offset);
+					offset += pixelSize;
+					for (size_t i = 0; i < length; i++)pixels[count++] = color;
+				}
+				else
+				{
+					if (file.size() < offset + length * pixelSize)return -1;
+					for (size_t i = 0; i < length; i++, offset += pixelSize)pixels[count++] = readPixel(offset);
+				}
+			}
+		}
+
+		// 原点が左下の場合は上下を反転する
+		if ((descriptor & 0x20) == 0)
+		{
+			for (U32 y = 0; y < height / 2; y++)
+			{
+				std::swap_ranges(pixels + (size_t)y * width, pixels + (size_t)(y + 1) * width, pixels + (size_t)(height - 1 - y) * width);
+			}
+		}
+		return 0;
+	}
+
+	//===================================================================================//
+
+	Vector3 SoftImageTexture::GetSize()
+	{
+		if (IsValid() == false)return Vector3();
+		return Vector3((F32)m_surface->GetWidth(), (F32)m_surface->GetHeight(), 1.0f);
+	}
+
+	S32 SoftImageTexture::GetDimension()
+	{
+		if (IsValid() == false)return 0;
+		// 2次元テクスチャ
+		return 2;
+	}
+}
\ No newline at end of file
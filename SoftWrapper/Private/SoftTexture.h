@@ -0,0 +1,84 @@
+﻿#pragma once
+#include "ITexture.h"
+
+namespace og
+{
+	/// <summary>
+	/// CPUメモリ上の1枚の画像
+	/// </summary>
+	/// <remarks>
+	/// ピクセルはフォーマットに関わらずF32のRGBAで保持し、書き込み時にフォーマットの精度に丸める。
+	/// </remarks>
+	class SoftSurface
+	{
+	private:
+		U32 m_width;
+		U32 m_height;
+		TextureFormat m_format;
+		ArrayList<Vector4> m_pixels;
+
+	public:
+		SoftSurface(const U32 width, const U32 height, const TextureFormat format);
+
+		inline U32 GetWidth()const { return m_width; }
+		inline U32 GetHeight()const { return m_height; }
+		inline TextureFormat GetFormat()const { return m_format; }
+
+		inline Vector4* GetPixels() { return m_pixels.data(); }
+		inline const Vector4* GetPixels()const { return m_pixels.data(); }
+
+		/// <summary>
+		/// 全てのピクセルを同じ色で塗りつぶす
+		/// </summary>
+		void Clear(const Color& color);
+
+		/// <summary>
+		/// バイリニア補間で読み取る。UVは0〜1の範囲を繰り返す
+		/// </summary>
+		Vector4 Sample(const Vector2& uv)const;
+
+		/// <summary>
+		/// フォーマットのバイト列に変換する
+		/// </summary>
+		void Read(ArrayList<Byte>& dest)const;
+
+		/// <summary>
+		/// 色をフォーマットで表現できる値に丸める
+		/// </summary>
+		static Vector4 Quantize(const Vector4& color, const TextureFormat format);
+
+		/// <summary>
+		/// フォーマットの1ピクセルのバイトサイズ
+		/// </summary>
+		static U32 GetPixelSize(const TextureFormat format);
+	};
+
+
+	/// <summary>
+	/// 画像ファイルから読み込んだテクスチャ
+	/// </summary>
+	class SoftImageTexture :public ITexture
+	{
+	private:
+		UPtr<SoftSurface> m_surface;
+
+	public:
+		/// <summary>
+		/// 画像ファイルを読み込む
+		/// </summary>
+		/// <remarks>
+		/// 対応しているのは非圧縮とRLE圧縮のTGA(24bit、32bit)のみ。失敗した場合はIsValidがfalseになる。
+		/// </remarks>
+		SoftImageTexture(const Path& path);
+
+		inline bool IsValid()const { return m_surface != nullptr; }
+
+		inline const SoftSurface* GetSurface()const { return m_surface.get(); }
+
+		Vector3 GetSize()override;
+		S32 GetDimension()override;
+
+	private:
+		S32 LoadTga(const ArrayList<Byte>& file);
+	};
+}
\ No newline at end of file
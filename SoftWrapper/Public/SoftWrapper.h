@@ -0,0 +1,161 @@
+﻿#pragma once
+
+#include "IGraphicWrapper.h"
+
+#include <functional>
+
+#if defined(PLATFORM_WINDOWS)
+#ifdef SOFTWRAPPER_EXPORTS
+#define DLL_OG __declspec(dllexport)
+#else
+#define DLL_OG __declspec(dllimport)
+#endif
+#else
+#define DLL_OG __attribute__((visibility("default")))
+#endif
+
+namespace og
+{
+	/// <summary>
+	/// シェーダーから参照するマテリアルのパラメータ
+	/// </summary>
+	/// <remarks>
+	/// 値は描画命令を発行した時点のマテリアルの内容となる。名前の検索を伴うため、
+	/// ピクセルごとに同じ値を使う場合は頂点シェーダーで取得してvaryingsで渡すほうが速い。
+	/// </remarks>
+	class ISoftShaderParams
+	{
+	public:
+		/// <summary>
+		/// SetFloat4Paramで設定した値を取得する
+		/// </summary>
+		/// <returns>設定されていない場合は(0,0,0,0)</returns>
+		virtual Vector4 GetFloat4(const String& name)const = 0;
+
+		/// <summary>
+		/// SetMatrixParamで設定した値を取得する
+		/// </summary>
+		/// <returns>設定されていない場合は単位行列</returns>
+		virtual Matrix GetMatrix(const String& name)const = 0;
+
+		/// <summary>
+		/// SetTextureで設定したテクスチャをバイリニア補間で読み取る
+		/// </summary>
+		/// <remarks>
+		/// UVは0〜1の範囲を繰り返す。描画中のレンダーテクスチャ自身を読み取った場合の結果は不定。
+		/// </remarks>
+		/// <returns>テクスチャが設定されていない場合は白(1,1,1,1)</returns>
+		virtual Vector4 Sample(const String& name, const Vector2& uv)const = 0;
+
+		virtual ~ISoftShaderParams() {};
+	};
+
+
+	/// <summary>
+	/// ピクセルシェーダーへ補間して渡せる値の最大数
+	/// </summary>
+	const U32 SOFT_MAX_VARYINGS = 16;
+
+
+	/// <summary>
+	/// 頂点シェーダーの入力
+	/// </summary>
+	struct SoftVertexInput
+	{
+		/// <summary> 頂点データの先頭(IShapeのストライブサイズ分) </summary>
+		const Byte* data;
+		U32 vertexID;
+		U32 instanceID;
+		/// <summary> インスタンスごとのデータを指定して描画した場合は、このインスタンスのデータの先頭。それ以外はnullptr </summary>
+		const Byte* instanceData;
+		const ISoftShaderParams* params;
+	};
+
+
+	/// <summary>
+	/// 頂点シェーダーの出力
+	/// </summary>
+	struct SoftVertexOutput
+	{
+		/// <summary> クリップ空間の座標(SV_POSITION) </summary>
+		Vector4 position;
+		/// <summary> ピクセルシェーダーへ遠近補正して渡す値。登録時に指定した数だけ書き込む </summary>
+		F32 varyings[SOFT_MAX_VARYINGS];
+	};
+
+
+	/// <summary>
+	/// ピクセルシェーダーの入力
+	/// </summary>
+	struct SoftPixelInput
+	{
+		/// <summary> xyはピクセルの中心の座標、zは深度、wはクリップ空間のw </summary>
+		Vector4 position;
+		/// <summary> 補間された値 </summary>
+		const F32* varyings;
+		U32 instanceID;
+		bool isFrontFace;
+		const ISoftShaderParams* params;
+	};
+
+
+	/// <summary>
+	/// 頂点シェーダーの処理。複数のスレッドから同時に呼ばれる
+	/// </summary>
+	using SoftVertexShader = std::function<void(const SoftVertexInput& input, SoftVertexOutput& output)>;
+
+	/// <summary>
+	/// ピクセルシェーダーの処理。targetsにレンダーターゲットの数だけ色を書き込む。falseを返すとピクセルを破棄する(discard)。
+	/// 複数のスレッドから同時に呼ばれる
+	/// </summary>
+	using SoftPixelShader = std::function<bool(const SoftPixelInput& input, Vector4* targets)>;
+
+
+	/// <summary>
+	/// CPUで描画を行うグラフィックラッパー
+	/// </summary>
+	/// <remarks>
+	/// GPUやウィンドウが無い環境(ビルドマシンでのテストやサムネイルの生成)で使用する。
+	/// シェーダーのソースはコンパイルされないため、CreateShaderやLoadShaderで作成したシェーダーにRegisterVertexShader、
+	/// RegisterPixelShaderでC++の処理を登録する。登録されていないシェーダーは、頂点データの先頭のF32x3をそのままクリップ空間の座標とし、
+	/// 白を出力する標準のシェーダーとして扱われる。
+	/// 描画はDrawInstancedを呼んだ時点で行われ、SwapScreenは画面への表示を行わない。結果はReadPixelsで取得する。
+	/// </remarks>
+	class ISoftGraphicWrapper :public IGraphicWrapper
+	{
+	public:
+		/// <summary>
+		/// シェーダーに頂点シェーダーの処理を登録する
+		/// </summary>
+		/// <param name="shader">CreateShaderまたはLoadShaderで作成した頂点シェーダー</param>
+		/// <param name="function">処理</param>
+		/// <param name="varyingCount">SoftVertexOutput::varyingsに書き込む値の数</param>
+		/// <returns>　０：成功\n－１：引数が不正</returns>
+		virtual S32 RegisterVertexShader(const SPtr<IShader>& shader, const SoftVertexShader& function, const U32 varyingCount) = 0;
+
+		/// <summary>
+		/// シェーダーにピクセルシェーダーの処理を登録する
+		/// </summary>
+		/// <param name="shader">CreateShaderまたはLoadShaderで作成したピクセルシェーダー</param>
+		/// <param name="function">処理</param>
+		/// <returns>　０：成功\n－１：引数が不正</returns>
+		virtual S32 RegisterPixelShader(const SPtr<IShader>& shader, const SoftPixelShader& function) = 0;
+
+		/// <summary>
+		/// レンダーテクスチャの内容をピクセルフォーマットのバイト列として取得する
+		/// </summary>
+		/// <remarks>
+		/// 行は上から順に並び、行の間に余白は無い。RGBA8の場合は1ピクセル4バイトのR,G,B,Aの順になる。
+		/// </remarks>
+		/// <param name="texture">このラッパーで作成したレンダーテクスチャ</param>
+		/// <param name="target">レンダーターゲットの番号</param>
+		/// <param name="dest">出力先</param>
+		/// <returns>　０：成功\n－１：引数が不正</returns>
+		virtual S32 ReadPixels(const SPtr<IRenderTexture>& texture, const S32 target, ArrayList<Byte>& dest) = 0;
+	};
+
+
+	extern "C" {
+		DLL_OG IGraphicWrapper* CreateGraphicWrapper();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,7 @@
+﻿#pragma once
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN             // Windows ヘッダーからほとんど使用されていない部分を除外する
+// Windows ヘッダー ファイル
+#include <windows.h>
+#endif